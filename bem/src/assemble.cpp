@@ -1,6 +1,7 @@
 /*
 FACILITY:           NMMTL
-MODULE DESCRIPTION: Contains nmmtl_assemble function.
+MODULE DESCRIPTION: Contains nmmtl_assemble and nmmtl_assemble_dielectric
+                    functions.
 AUTHOR(S):          Kevin J. Buchs
 CREATION DATE:      Mon Mar 30 12:47:58 1992
 COPYRIGHT:          Copyright (C) 1992 by Mayo Foundation. All rights reserved.
@@ -38,7 +39,7 @@ COPYRIGHT:          Copyright (C) 1992 by Mayo Foundation. All rights reserved.
 
   int conductor_counter,             - how many conductors
   CONDUCTOR_DATA_P conductor_data,   - array of data on conductors
-  DELEMENTS_P die_elements,          - all die element data
+  ELEMENT_STORE_P element_store,     - all the elements
   double length_scale,                - a scale factor based on element length
   double **assemble_matrix            - out: resultant assemble matrix
 
@@ -48,26 +49,25 @@ COPYRIGHT:          Copyright (C) 1992 by Mayo Foundation. All rights reserved.
 
   CALLING SEQUENCE:
 
-  nmmtl_assemble(conductor_counter,conductor_data,die_elements,
-                 assemble_matrix);
+  nmmtl_assemble(conductor_counter,conductor_data,element_store,
+                 length_scale,assemble_matrix);
 
   */
 
 void nmmtl_assemble(int conductor_counter,
         CONDUCTOR_DATA_P conductor_data,
-        DELEMENTS_P die_elements,
+        ELEMENT_STORE_P element_store,
         double length_scale,
         double **assemble_matrix) {
 
   int i,j,cond_num,inner_cond_num;
-  CELEMENTS_P cel,inner_cel;
-  DELEMENTS_P del,inner_del;
+  CELEMENTS_P cel,inner_cel,cel_end,inner_cel_end;
+  DELEMENTS_P inner_del,inner_del_end;
   int Legendre_counter;
   double x,y;  /* interpolated coordinates */
   double shape[INTERP_PTS];
   double value[INTERP_PTS];
   double Jacobian;
-  double coef1,coef2;
   double nu0;
   //double nu1;
 
@@ -77,27 +77,28 @@ void nmmtl_assemble(int conductor_counter,
      both conductors and then each element of each conductor */
 
   for(cond_num = 0; cond_num <= conductor_counter; cond_num++) {
-    cel=conductor_data[cond_num].elements;
-    while(cel != NULL) {
+    cel = conductor_data[cond_num].elements;
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    while(cel < cel_end) {
       for(Legendre_counter = 0; Legendre_counter < Legendre_root_a_max; Legendre_counter++) {
         nmmtl_shape(Legendre_root_a[Legendre_counter],shape);
 
   /* interpolate x,y coordinate using no_edge shape function */
   x = 0.;
   y = 0.;
-  for(i=0; i < INTERP_PTS; i++) {
+  for(i=0; i < ELEMENT_PTS; i++) {
     x += shape[i]*cel->xpts[i];
     y += shape[i]*cel->ypts[i];
   }
 
   /* if an edge element - recalculate shape using edge effects */
 
-  if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+  if(cel->edge[0] || cel->edge[1])
   {
     /* if given edge is really an edge, set the true value of nu,
        otherwise, don't really care */
-    nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-    //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+    nu0 = cel->edge[0] ? cel->nu[0] : 0;
+    //nu1 = cel->edge[1] ? cel->nu[1] : 0;
     //nmmtl_shape_c_edge(Legendre_root_a[Legendre_counter],shape,cel,nu0,nu1);
     nmmtl_shape_c_edge(Legendre_root_a[Legendre_counter],shape,cel,nu0);
   }
@@ -115,14 +116,15 @@ void nmmtl_assemble(int conductor_counter,
   /* PART 1 */
 
   for(inner_cond_num = 0; inner_cond_num < cond_num; inner_cond_num++) {
-    inner_cel=conductor_data[inner_cond_num].elements;
-    while(inner_cel != NULL) {
+    inner_cel = conductor_data[inner_cond_num].elements;
+    inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+    while(inner_cel < inner_cel_end) {
       /* outer element is a conductor - TRUE,0,0 for last args */
       nmmtl_interval_c(x,y,inner_cel,value,TRUE,0,0);
 
       /* now add in the contributions to the the basis points */
-      for(i=0;i < INTERP_PTS;i++)
-        for(j=0;j < INTERP_PTS;j++) {
+      for(i=0;i < ELEMENT_PTS;i++)
+        for(j=0;j < ELEMENT_PTS;j++) {
 #ifdef BEM3_VARIANT
     double x;
     double y;
@@ -136,13 +138,14 @@ void nmmtl_assemble(int conductor_counter,
         shape[i] * value[j] * Jacobian;
 #endif
         }
-      inner_cel = inner_cel->next;
+      inner_cel++;
     } /* while inner looping on elements of a particular conductor */
   } /* for inner looping on the conductors */
 
   /* PART 2 */
-  inner_cel=conductor_data[inner_cond_num].elements;
-  while(inner_cel != NULL)
+  inner_cel = conductor_data[inner_cond_num].elements;
+  inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+  while(inner_cel < inner_cel_end)
   {
     /* Are we at the self element ? */
     if(cel == inner_cel)
@@ -153,8 +156,8 @@ void nmmtl_assemble(int conductor_counter,
       nmmtl_interval_c(x,y,inner_cel,value,TRUE,0,0);
 
     /* now add in the contributions to the the basis points */
-    for(i=0;i < INTERP_PTS;i++)
-      for(j=0;j < INTERP_PTS;j++)
+    for(i=0;i < ELEMENT_PTS;i++)
+      for(j=0;j < ELEMENT_PTS;j++)
       {
 #ifdef BEM3_VARIANT
         double x,y;
@@ -169,20 +172,21 @@ void nmmtl_assemble(int conductor_counter,
 #endif
       }
 
-    inner_cel = inner_cel->next;
+    inner_cel++;
   } /* while inner looping on elements of a particular conductor */
 
 
   /* PART 3 */
   for(inner_cond_num++; inner_cond_num <= conductor_counter; inner_cond_num++) {
-    inner_cel=conductor_data[inner_cond_num].elements;
-    while(inner_cel != NULL) {
+    inner_cel = conductor_data[inner_cond_num].elements;
+    inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+    while(inner_cel < inner_cel_end) {
       /* outer element is a conductor - TRUE,0,0 for last args */
       nmmtl_interval_c(x,y,inner_cel,value,TRUE,0,0);
 
       /* now add in the contributions to the the basis points */
-      for(i=0;i < INTERP_PTS;i++)
-        for(j=0;j < INTERP_PTS;j++)
+      for(i=0;i < ELEMENT_PTS;i++)
+        for(j=0;j < ELEMENT_PTS;j++)
         {
 #ifdef BEM3_VARIANT
     double x,y;
@@ -196,22 +200,23 @@ void nmmtl_assemble(int conductor_counter,
         shape[i] * value[j] * Jacobian;
 #endif
         }
-      inner_cel = inner_cel->next;
+      inner_cel++;
     } /* while inner looping on elements of a particular conductor */
   } /* for inner looping on the conductors */
 
 
   /* inner loop on dielectric elements */
 
-  inner_del = die_elements;
-  while(inner_del != NULL)
+  inner_del = element_store->delements;
+  inner_del_end = inner_del + element_store->number_delements;
+  while(inner_del < inner_del_end)
   {
     /* outer element is a conductor - TRUE,0,0 for last args */
     nmmtl_interval_d(x,y,inner_del,value,TRUE,0,0);
 
     /* now add in the contributions to the the basis points */
-    for(i=0;i < INTERP_PTS;i++)
-      for(j=0;j < INTERP_PTS;j++)
+    for(i=0;i < ELEMENT_PTS;i++)
+      for(j=0;j < ELEMENT_PTS;j++)
       {
 #ifdef BEM3_VARIANT
         double x,y;
@@ -225,21 +230,69 @@ void nmmtl_assemble(int conductor_counter,
           shape[i] * value[j] * Jacobian;
 #endif
       }
-    inner_del = inner_del->next;
+    inner_del++;
   } /* while inner looping on dielectric elements */
 
       } /* while stepping through Guass-Legendre roots */
 
-      cel = cel->next;
+      cel++;
 
     } /* while outer looping on elments of a conductor */
   } /* while outer looping on conductors */
 
+  nmmtl_assemble_dielectric(conductor_counter,conductor_data,element_store,
+                            length_scale,assemble_matrix);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_assemble_dielectric
+
+  FUNCTIONAL DESCRIPTION:
+
+  Adds the contributions of the dielectric-dielectric elements to the
+  assemble matrix, the part of nmmtl_assemble that depends on the
+  permittivities.  It is linear in them, so with each permittivity
+  replaced by its derivative with respect to a parameter it gives the
+  derivative of the assemble matrix, see nmmtl_sensitivity_calculate.
+
+  FORMAL PARAMETERS:
+
+  As for nmmtl_assemble.
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_assemble_dielectric(conductor_counter,conductor_data,element_store,
+                            length_scale,assemble_matrix);
+
+  */
+
+void nmmtl_assemble_dielectric(int conductor_counter,
+        CONDUCTOR_DATA_P conductor_data,
+        ELEMENT_STORE_P element_store,
+        double length_scale,
+        double **assemble_matrix) {
+
+  int i,j,inner_cond_num;
+  CELEMENTS_P inner_cel,inner_cel_end;
+  DELEMENTS_P del,inner_del,del_end,inner_del_end;
+  int Legendre_counter;
+  double x,y;  /* interpolated coordinates */
+  double shape[INTERP_PTS];
+  double value[INTERP_PTS];
+  double Jacobian;
+  double coef1,coef2;
 
-  /* now create outer loop on the the dielectric elements */
+  /* outer loop on the the dielectric elements */
 
-  del = die_elements;
-  while(del != NULL)
+  del = element_store->delements;
+  del_end = del + element_store->number_delements;
+  while(del < del_end)
   {
 #ifdef BEM3_VARIANT
     coef2 = length_scale * (del->epsilonplus - del->epsilonminus) *
@@ -262,7 +315,7 @@ void nmmtl_assemble(int conductor_counter,
       /* interpolate x,y coordinate using no_edge shape function */
       x = 0.0;
       y = 0.0;
-      for(i=0;i < INTERP_PTS;i++)
+      for(i=0;i < ELEMENT_PTS;i++)
       {
   x += shape[i]*del->xpts[i];
   y += shape[i]*del->ypts[i];
@@ -272,8 +325,8 @@ void nmmtl_assemble(int conductor_counter,
 
       /* first one double integral */
 
-      for(i=0;i < INTERP_PTS;i++)
-  for(j=0;j < INTERP_PTS;j++)
+      for(i=0;i < ELEMENT_PTS;i++)
+  for(j=0;j < ELEMENT_PTS;j++)
     assemble_matrix[del->node[j]][del->node[i]] +=
       coef1 * Legendre_weight_a[Legendre_counter] *
         shape[i] * shape[j] * Jacobian;
@@ -290,8 +343,9 @@ void nmmtl_assemble(int conductor_counter,
   for(inner_cond_num = 0; inner_cond_num <= conductor_counter;
       inner_cond_num++)
   {
-    inner_cel=conductor_data[inner_cond_num].elements;
-    while(inner_cel != NULL)
+    inner_cel = conductor_data[inner_cond_num].elements;
+    inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+    while(inner_cel < inner_cel_end)
     {
       /* outer element is not a conductor - FALSE,normalx,normaly
          for last args */
@@ -299,21 +353,22 @@ void nmmtl_assemble(int conductor_counter,
            del->normaly);
 
       /* now add in the contributions to the the basis points */
-      for(i=0;i < INTERP_PTS;i++)
-        for(j=0;j < INTERP_PTS;j++)
+      for(i=0;i < ELEMENT_PTS;i++)
+        for(j=0;j < ELEMENT_PTS;j++)
         {
     assemble_matrix[inner_cel->node[j]][del->node[i]] +=
       coef2 * Legendre_weight_a[Legendre_counter] *
         shape[i] * value[j] * Jacobian;
         }
-      inner_cel = inner_cel->next;
+      inner_cel++;
     } /* while inner looping on elements of a particular conductor */
   } /* while inner looping on the conductors */
 
   /* inner loop on dielectric elements */
 
-  inner_del = die_elements;
-  while(inner_del != NULL)
+  inner_del = element_store->delements;
+  inner_del_end = inner_del + element_store->number_delements;
+  while(inner_del < inner_del_end)
   {
     /* Are we at the self element ? */
     if(del == inner_del)
@@ -331,20 +386,20 @@ void nmmtl_assemble(int conductor_counter,
     }
 
     /* now add in the contributions to the the basis points */
-    for(i=0;i < INTERP_PTS;i++)
-      for(j=0;j < INTERP_PTS;j++)
+    for(i=0;i < ELEMENT_PTS;i++)
+      for(j=0;j < ELEMENT_PTS;j++)
       {
         assemble_matrix[inner_del->node[j]][del->node[i]] +=
     coef2 * Legendre_weight_a[Legendre_counter] *
       shape[i] * value[j] * Jacobian;
       }
-    inner_del = inner_del->next;
+    inner_del++;
   } /* while inner looping on dielectric elements */
 
       } /* if coef2 != 0.0 */
 
     } /* while stepping through Guass-Legendre roots */
-    del = del->next;
+    del++;
 
   } /* while outer looping on die elements */
 }
@@ -68,8 +68,8 @@ void nmmtl_assemble_free_space(int conductor_counter,
                                CONDUCTOR_DATA_P conductor_data,
                                double **assemble_matrix) {
   int i,j,cond_num,inner_cond_num;
-  CELEMENTS_P cel;
-  CELEMENTS_P inner_cel;
+  CELEMENTS_P cel,cel_end;
+  CELEMENTS_P inner_cel,inner_cel_end;
   int Legendre_counter;
   double x,y;  /* interpolated coordinates */
   double shape[INTERP_PTS];
@@ -84,24 +84,25 @@ void nmmtl_assemble_free_space(int conductor_counter,
      both conductors and then each element of each conductor */
   for (cond_num = 0; cond_num <= conductor_counter; cond_num++) {
     cel = conductor_data[cond_num].elements;
-    while (cel != NULL) {
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    while(cel < cel_end) {
       for (Legendre_counter = 0; Legendre_counter < Legendre_root_a_max; Legendre_counter++) {
         nmmtl_shape(Legendre_root_a[Legendre_counter],shape);
         /* interpolate x,y coordinate using no_edge shape function */
         x = 0.0;
         y = 0.0;
-        for (i=0; i < INTERP_PTS; i++) {
+        for (i=0; i < ELEMENT_PTS; i++) {
           x += shape[i]*cel->xpts[i];
           y += shape[i]*cel->ypts[i];
         }
 
         /* if an edge element - recalculate shape using edge effects */
 
-        if (cel->edge[0] != NULL || cel->edge[1] != NULL) {
+        if (cel->edge[0] || cel->edge[1]) {
           /* if given edge is really an edge, set the true value of nu,
              otherwise, don't really care */
-          nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-          //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+          nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+          //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
           //nmmtl_shape_c_edge(Legendre_root_a[Legendre_counter],shape,cel,nu0,nu1);
           nmmtl_shape_c_edge(Legendre_root_a[Legendre_counter], shape, cel, nu0);
         }
@@ -118,26 +119,28 @@ void nmmtl_assemble_free_space(int conductor_counter,
 
         /* PART 1 */
         for (inner_cond_num = 0; inner_cond_num < cond_num; inner_cond_num++) {
-          inner_cel=conductor_data[inner_cond_num].elements;
-          while (inner_cel != NULL) {
+          inner_cel = conductor_data[inner_cond_num].elements;
+          inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+          while(inner_cel < inner_cel_end) {
             nmmtl_interval_c_fs(x,y,inner_cel,value);
 
             /* now add in the contributions to the the basis points */
-            for (i=0; i < INTERP_PTS; i++) {
-              for (j=0; j < INTERP_PTS; j++) {
+            for (i=0; i < ELEMENT_PTS; i++) {
+              for (j=0; j < ELEMENT_PTS; j++) {
                 assemble_matrix[inner_cel->node[j]][cel->node[i]] +=
                   ASSEMBLE_CONST_1 * Legendre_weight_a[Legendre_counter] *
                     shape[i] * value[j] * Jacobian;
               }
             }
 
-            inner_cel = inner_cel->next;
+            inner_cel++;
           } /* while inner looping on elements of a particular conductor */
         } /* for inner looping on the conductors */
 
         /* PART 2 */
         inner_cel = conductor_data[inner_cond_num].elements;
-        while (inner_cel != NULL) {
+        inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+        while(inner_cel < inner_cel_end) {
           /* Are we at the self element ? */
           if (cel == inner_cel) {
             nmmtl_interval_self_c_fs(x,
@@ -153,36 +156,37 @@ void nmmtl_assemble_free_space(int conductor_counter,
           }
 
           /* now add in the contributions to the the basis points */
-          for (i=0; i < INTERP_PTS; i++) {
-            for (j=0; j < INTERP_PTS; j++) {
+          for (i=0; i < ELEMENT_PTS; i++) {
+            for (j=0; j < ELEMENT_PTS; j++) {
               assemble_matrix[inner_cel->node[j]][cel->node[i]] +=
                 ASSEMBLE_CONST_1 * Legendre_weight_a[Legendre_counter] *
                 shape[i] * value[j] * Jacobian;
             }
           }
-          inner_cel = inner_cel->next;
+          inner_cel++;
         } /* while inner looping on elements of a particular conductor */
 
         /* PART 3 */
         for (inner_cond_num++; inner_cond_num <= conductor_counter; inner_cond_num++) {
-          inner_cel=conductor_data[inner_cond_num].elements;
-          while (inner_cel != NULL) {
+          inner_cel = conductor_data[inner_cond_num].elements;
+          inner_cel_end = inner_cel + conductor_data[inner_cond_num].number_elements;
+          while(inner_cel < inner_cel_end) {
             nmmtl_interval_c_fs(x,y,inner_cel,value);
 
             /* now add in the contributions to the the basis points */
-            for(i=0;i < INTERP_PTS;i++) {
-              for(j=0;j < INTERP_PTS;j++) {
+            for(i=0;i < ELEMENT_PTS;i++) {
+              for(j=0;j < ELEMENT_PTS;j++) {
                 assemble_matrix[inner_cel->node[j]][cel->node[i]] +=
                   ASSEMBLE_CONST_1 * Legendre_weight_a[Legendre_counter] *
                   shape[i] * value[j] * Jacobian;
               }
             }
-            inner_cel = inner_cel->next;
+            inner_cel++;
           } /* while inner looping on elements of a particular conductor */
         } /* for inner looping on the conductors */
 
       } /* while stepping through Guass-Legendre roots */
-      cel = cel->next;
+      cel++;
     } /* while outer looping on elments of a conductor */
   } /* while outer looping on conductors */
 }
@@ -8,4 +8,8 @@
 // only of units.
 int conversion(char *from_string, char *to_string, double &scaled_number);
 
+// Fills in the unit tables.  conversion() does this on first use; a
+// multithreaded caller should do it up front.
+void setunits(void);
+
 #endif
@@ -24,6 +24,7 @@
 *          { internal: init_invert_matrix
 *      invert_matrix
 *      invert_matrix_cond
+*      release_invert_matrix
 *          { internal: d_set_invert_matrix
 *          { internal: d_init_invert_matrix
 *      d_invert_matrix
@@ -40,6 +41,7 @@
 *      dlu_factor
 *
 *      lu_solve_linear
+*      lu_solve_transpose
 *      dlu_solve_linear
 *
 */
@@ -49,10 +51,11 @@
 #include "magicad.h"
 #include "math_library.h"
 
-int n_invert_matrix = 0;
-int n_init_invert_matrix = 0;
-int *invert_matrix_ipvt = NULL;
-double *invert_matrix_wrk = NULL;
+/* work space kept between calls, one set per thread */
+thread_local int n_invert_matrix = 0;
+thread_local int n_init_invert_matrix = 0;
+thread_local int *invert_matrix_ipvt = NULL;
+thread_local double *invert_matrix_wrk = NULL;
 
 /* ***********************************************************************
  * ROUTINE NAME set_invert_matrix
@@ -92,7 +95,7 @@ double *invert_matrix_wrk = NULL;
 void set_invert_matrix(int *n)
 
 {
-  extern int n_invert_matrix;
+  extern thread_local int n_invert_matrix;
 
   if (n_invert_matrix < (*n))
     n_invert_matrix = (*n);
@@ -135,11 +138,11 @@ void set_invert_matrix(int *n)
 void init_invert_matrix(int *status)
 {
 
-  extern int *invert_matrix_ipvt;
-  extern double *invert_matrix_wrk;
+  extern thread_local int *invert_matrix_ipvt;
+  extern thread_local double *invert_matrix_wrk;
 
-  extern int n_invert_matrix;
-  extern int n_init_invert_matrix;
+  extern thread_local int n_invert_matrix;
+  extern thread_local int n_init_invert_matrix;
 
   int n;
   n = n_init_invert_matrix = n_invert_matrix;
@@ -158,6 +161,52 @@ void init_invert_matrix(int *status)
   (*status) = SUCCESS;
   return;
 }
+
+/* ***********************************************************************
+ * ROUTINE NAME  release_invert_matrix
+ *
+ *
+ * ABSTRACT  this routine frees the workspace of the calling thread for
+ *             the routine invert_matrix.  A thread which has inverted
+ *             matrices calls it before it exits or goes idle; the next
+ *             invert_matrix sets the workspace up again.
+ *
+ *
+ * ENVIRONMENT  release_invert_matrix
+ *
+ *
+ *
+ *
+ * INPUTS
+ *
+ * OUTPUTS
+ *
+ * FUNCTIONS CALLED
+ *
+ *
+ *
+ *
+ * MODIFICATION HISTORY
+ * 1.01     Free the thread's workspace              10-18-26
+ *
+ * ***********************************************************************
+ */
+void release_invert_matrix(void)
+{
+
+  extern thread_local int *invert_matrix_ipvt;
+  extern thread_local double *invert_matrix_wrk;
+
+  extern thread_local int n_invert_matrix;
+  extern thread_local int n_init_invert_matrix;
+
+  free(invert_matrix_ipvt);
+  free(invert_matrix_wrk);
+  invert_matrix_ipvt = NULL;
+  invert_matrix_wrk = NULL;
+  n_invert_matrix = n_init_invert_matrix = 0;
+  return;
+}
 
 /* ***********************************************************************
  * ROUTINE NAME invert_matrix
@@ -202,10 +251,10 @@ void invert_matrix(int *n,double *a,double *b,
        int *lda, int *ldb, int *status)
 
 {
-  extern int *invert_matrix_ipvt;
-  extern double *invert_matrix_wrk;
+  extern thread_local int *invert_matrix_ipvt;
+  extern thread_local double *invert_matrix_wrk;
 
-  extern int n_init_invert_matrix;
+  extern thread_local int n_init_invert_matrix;
 
   double t1[2];           /* workspace matricies */
   double rcond;            /* value indicating condition of input matrix */
@@ -611,4 +660,48 @@ void lu_solve_linear(int *n, double *a, double *x, double *b, int *lda,
   return;
 }
 
+/* ***********************************************************************
+ * ROUTINE NAME lu_solve_transpose
+ *
+ *
+ * ABSTRACT  Solves the transposed system TRANS(A)*X=B using the factors
+ *       computed from lu_factor, as the adjoint of lu_solve_linear.
+ *
+ * ENVIRONMENT  lu_solve_transpose(n, a, x, b, lda, ipvt, status)
+ *
+ * INPUTS
+ *    int *n;               the order of matrix a
+ *    double *a;             lu factored matrix output from lu_factor
+ *    double *b;             right hand side vector (trans(a)*x=b)
+ *    int *lda;             leading dimension of matrix
+ *    int *ipvt;      integer vector of pivot indices from lu_factor
+ *
+ * OUTPUTS
+ *    double *x;       the solution vector
+ *                          if b is not needed, pass b or NULL in for x
+ *    int     *status;      SUCCESS
+ *
+ * FUNCTIONS CALLED
+ *    sgesl (NSWC originally from LINPACK)
+ *
+ * ***********************************************************************
+ */
+
+void lu_solve_transpose(int *n, double *a, double *x, double *b, int *lda,
+         int *ipvt, int *status) {
+  int i;  /* loop indices */
+  int job=1;  /* indicates to solve trans(a)*x=b */
+
+  if ((x != NULL) && (x != b)) {
+    for (i = 0; i < (*n); i++)
+      x[i] = b[i];
+    SGESL(a, lda, n, ipvt, x, &job);
+  } else {
+    SGESL(a, lda, n, ipvt, b, &job);
+  }
+
+  (*status) = SUCCESS;
+  return;
+}
+
 #endif
@@ -30,6 +30,7 @@
 #define invert_matrix invert_matrix_
 #define lu_factor lu_factor_
 #define lu_solve_linear lu_solve_linear_
+#define lu_solve_transpose lu_solve_transpose_
 
 //  For Gnu gcc and g77, we need double-underbars, before and after
 // the name.
@@ -60,6 +61,8 @@ extern "C" void set_invert_matrix(int *n);
 
 extern "C" void init_invert_matrix(int *status);
 
+extern "C" void release_invert_matrix(void);
+
 extern "C" void invert_matrix(int *n,double *a,double *b,
          int *lda, int *ldb, int *status);
 
@@ -69,6 +72,9 @@ extern "C" void lu_factor(int *n, double *a, double *lu, int *lda,
 extern "C" void lu_solve_linear(int *n, double *a, double *x, double *b, int *lda,
      int *ipvt, int *status);
 
+extern "C" void lu_solve_transpose(int *n, double *a, double *x, double *b,
+     int *lda, int *ipvt, int *status);
+
 /* Declarations of NSWC routines */
 extern "C"  void MSLV(int *calc_inv,int *n,int *zero_dim1,
         double *b,int *ldb,int *dum,int *zero_dim2,
@@ -0,0 +1,565 @@
+/*
+
+  FACILITY:  libmmtl_bem
+
+  MODULE DESCRIPTION:
+
+  Solves a cross section built with the mmtl_xsctn_* functions in memory
+  and hands back the results, with no files read or written.  This is the
+  same sequence nmmtl.cpp goes through for a .xsctn file.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void nmmtl_solve_modes(int num_signals,
+                              double **electrostatic_induction,
+                              int number_points,
+                              double **inductance,
+                              double **resistance,
+                              double **conductance,
+                              double **velocity,
+                              double **impedance,
+                              double **attenuation,
+                              double **voltage_modes,
+                              double **current_modes);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_solve
+
+  FUNCTIONAL DESCRIPTION:
+
+  Expand the cross section into the dielectric and contour lists and
+  solve them with nmmtl_solve_lists.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn         - the cross section to solve
+  MMTL_RESULTS_P *results    - output: results, free with mmtl_results_free
+
+  RETURN VALUE:
+
+  MMTL_SUCCESS or MMTL_FAIL
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_solve(xsctn,&results);
+
+  */
+
+int mmtl_xsctn_solve(MMTL_XSCTN_P xsctn,
+                     MMTL_RESULTS_P *results)
+{
+  int status;
+  int cntr_seg, pln_seg;
+  double coupling, risetime, conductivity;
+  double half_minimum_dimension;
+  int gnd_planes;
+  double top_ground_plane_thickness, bottom_ground_plane_thickness;
+  struct dielectric *dielectrics = NULL;
+  struct contour *signals = NULL;
+  struct contour *groundwires = NULL;
+  int num_signals = 0, num_grounds = 0;
+
+  *results = NULL;
+  if(xsctn == NULL) return(MMTL_FAIL);
+
+  status = nmmtl_xsctn_expand(xsctn,&cntr_seg,&pln_seg,&coupling,&risetime,
+                              &conductivity,&half_minimum_dimension,
+                              &gnd_planes,&top_ground_plane_thickness,
+                              &bottom_ground_plane_thickness,
+                              &dielectrics,&signals,&groundwires,
+                              &num_signals,&num_grounds);
+
+  if(status == SUCCESS)
+    status = nmmtl_solve_lists(cntr_seg,pln_seg,coupling,risetime,
+                               conductivity,half_minimum_dimension,
+                               gnd_planes,dielectrics,signals,groundwires,
+                               num_signals,xsctn->number_frequencies,
+                               xsctn->frequencies,xsctn->number_pairs,
+                               xsctn->pairs,xsctn->sensitivities,
+                               &xsctn->settings,results);
+
+  nmmtl_free_dielectrics(dielectrics);
+  nmmtl_free_contours(signals);
+  nmmtl_free_contours(groundwires);
+
+  return(status == SUCCESS ? MMTL_SUCCESS : MMTL_FAIL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_solve_lists
+
+  FUNCTIONAL DESCRIPTION:
+
+  Calculate the quasi-static parameters, dc resistance and crosstalk for
+  a cross section already in the form of dielectric and contour lists
+  (from nmmtl_xsctn_expand or the .xsctn parser), and the resistance,
+  inductance and conductance at any frequencies given, and collect them
+  into
+  a newly allocated results structure.  The lists are left alone.
+
+  FORMAL PARAMETERS:
+
+  int cntr_seg, pln_seg         - segmentation
+  double coupling, risetime     - for crosstalk
+  double conductivity           - default conductivity of the signals
+  double half_minimum_dimension - from the parser
+  int gnd_planes                - number of ground planes
+  struct dielectric *dielectrics
+  struct contour *signals
+  struct contour *groundwires
+  int num_signals               - length of the signals list
+  int number_frequencies        - how many frequencies to give R, L
+                                  and G at, may be 0
+  double *frequencies           - the frequencies, Hz
+  int number_pairs              - how many differential pairs are named,
+                                  0 to find them from the conductor names
+  char (*pairs)[2][SIZE_SIG_NAME] - the signal names of each pair
+  int sensitivities             - TRUE for the derivatives of B and L
+  MESH_SETTINGS_P settings      - element order, refinement, extrapolation
+                                  and grading
+  MMTL_RESULTS_P *results       - output: free with mmtl_results_free
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_solve_lists(cntr_seg,pln_seg,coupling,risetime,
+                             conductivity,half_minimum_dimension,
+                             gnd_planes,dielectrics,signals,groundwires,
+                             num_signals,number_frequencies,frequencies,
+                             number_pairs,pairs,sensitivities,settings,
+                             &results);
+
+  */
+
+int nmmtl_solve_lists(int cntr_seg,
+                      int pln_seg,
+                      double coupling,
+                      double risetime,
+                      double conductivity,
+                      double half_minimum_dimension,
+                      int gnd_planes,
+                      struct dielectric *dielectrics,
+                      struct contour *signals,
+                      struct contour *groundwires,
+                      int num_signals,
+                      int number_frequencies,
+                      double *frequencies,
+                      int number_pairs,
+                      char (*pairs)[2][SIZE_SIG_NAME],
+                      int sensitivities,
+                      MESH_SETTINGS_P settings,
+                      MMTL_RESULTS_P *results)
+{
+  int status;
+  struct contour *sigs;
+  int i;
+  double **electrostatic_induction;
+  double **inductance;
+  double **forward_xtk;
+  double **backward_xtk;
+  double **Rdc;
+  double **conductance;
+  double **resistance_f, **inductance_f, **conductance_f;
+  SKIN_EFFECT skin_effect;
+  SENSITIVITY sensitivity = { 0, NULL, NULL, NULL,
+                             { 0, 0, "", 0.0, 0, NULL }, NULL };
+  int f, k, p;
+  MMTL_RESULTS_P res;
+
+  *results = NULL;
+  if(num_signals < 1) return(FAIL);
+
+  res = (MMTL_RESULTS_P)calloc(1,sizeof(MMTL_RESULTS));
+  res->num_signals = num_signals;
+  res->signal_names = (char (*)[MMTL_SIG_NAME_SIZE])
+    calloc(num_signals,MMTL_SIG_NAME_SIZE);
+  res->characteristic_impedance = (double *)calloc(num_signals,sizeof(double));
+  res->propagation_velocity = (double *)calloc(num_signals,sizeof(double));
+  res->equivalent_dielectric = (double *)calloc(num_signals,sizeof(double));
+  res->pairs = (int *)malloc(sizeof(int[2]) * (number_pairs + num_signals / 2));
+
+  electrostatic_induction = (double **) dim2(num_signals,num_signals,sizeof(double));
+  inductance = (double **) dim2(num_signals,num_signals,sizeof(double));
+  forward_xtk = (double **) dim2(num_signals,num_signals,sizeof(double));
+  backward_xtk = (double **) dim2(num_signals,num_signals,sizeof(double));
+  Rdc = (double **) dim2(num_signals,num_signals,sizeof(double));
+  conductance = (double **) dim2(num_signals,num_signals,sizeof(double));
+  skin_effect.conductivity = (double *)malloc(sizeof(double) * (num_signals + 1));
+  skin_effect.resistance = (double **) dim2(num_signals,num_signals,sizeof(double));
+  nmmtl_skin_effect_conductivity(conductivity, signals, skin_effect.conductivity);
+
+  for(i = 0, sigs = signals; sigs != NULL; i++, sigs = sigs->next)
+  {
+    snprintf(res->signal_names[i],MMTL_SIG_NAME_SIZE,"%s",sigs->name);
+  }
+
+  if(sensitivities)
+    sensitivities = nmmtl_sensitivity_parameters(dielectrics, signals,
+                                                 groundwires, num_signals,
+                                                 &sensitivity) == SUCCESS;
+
+  /* G comes out of the solve as the derivative of B along the loss
+     tangents */
+  status = SUCCESS;
+  if(number_frequencies > 0)
+    status = nmmtl_conductance_parameters(dielectrics, num_signals,
+                                          conductance, &sensitivity);
+
+  if(status == SUCCESS)
+    status = nmmtl_qsp_calculate(dielectrics, signals, groundwires,
+                                 gnd_planes, half_minimum_dimension,
+                                 cntr_seg, pln_seg, coupling, risetime,
+                                 electrostatic_induction,
+                                 inductance, res->characteristic_impedance,
+                                 res->propagation_velocity,
+                                 res->equivalent_dielectric,
+                                 NULL, NULL,
+                                 number_frequencies > 0 ? &skin_effect : NULL,
+                                 sensitivities ||
+                                 sensitivity.conductance != NULL ?
+                                 &sensitivity : NULL, settings);
+
+  /* the derivatives, one matrix after the other */
+  if(status == SUCCESS && sensitivities)
+  {
+    k = sensitivity.number_parameters;
+    res->num_parameters = k;
+    res->parameter_kinds = (int *)malloc(sizeof(int) * k);
+    res->parameter_layers = (int *)malloc(sizeof(int) * k);
+    res->parameter_names = (char (*)[MMTL_SIG_NAME_SIZE])
+      calloc(k,MMTL_SIG_NAME_SIZE);
+    res->parameter_values = (double *)malloc(sizeof(double) * k);
+    res->induction_sensitivity = (double *)malloc(sizeof(double) * k *
+                                                  num_signals * num_signals);
+    res->inductance_sensitivity = (double *)malloc(sizeof(double) * k *
+                                                   num_signals * num_signals);
+    for(p = 0; p < k; p++)
+    {
+      res->parameter_kinds[p] = sensitivity.parameters[p].kind;
+      res->parameter_layers[p] = sensitivity.parameters[p].layer;
+      snprintf(res->parameter_names[p],MMTL_SIG_NAME_SIZE,"%s",
+               sensitivity.parameters[p].name);
+      res->parameter_values[p] = sensitivity.parameters[p].value;
+      memcpy(&res->induction_sensitivity[p * num_signals * num_signals],
+             sensitivity.induction[p][0],
+             sizeof(double) * num_signals * num_signals);
+      memcpy(&res->inductance_sensitivity[p * num_signals * num_signals],
+             sensitivity.inductance[p][0],
+             sizeof(double) * num_signals * num_signals);
+    }
+  }
+  nmmtl_sensitivity_free(&sensitivity);
+
+  if(status == SUCCESS && number_frequencies > 0)
+  {
+    /* R, L and G at each frequency */
+    res->num_frequencies = number_frequencies;
+    res->frequencies = (double *)malloc(sizeof(double) * number_frequencies);
+    res->resistance = (double *)malloc(sizeof(double) * number_frequencies *
+                                       num_signals * num_signals);
+    res->ac_inductance = (double *)malloc(sizeof(double) * number_frequencies *
+                                          num_signals * num_signals);
+    res->conductance = (double *)malloc(sizeof(double) * number_frequencies *
+                                        num_signals * num_signals);
+    resistance_f = (double **)malloc(sizeof(double *) * number_frequencies *
+                                     num_signals);
+    inductance_f = (double **)malloc(sizeof(double *) * number_frequencies *
+                                     num_signals);
+    conductance_f = (double **)malloc(sizeof(double *) * number_frequencies *
+                                      num_signals);
+    for(f = 0; f < number_frequencies; f++)
+    {
+      res->frequencies[f] = frequencies[f];
+      for(i = 0; i < num_signals; i++)
+      {
+        k = (f * num_signals + i) * num_signals;
+        resistance_f[f * num_signals + i] = &res->resistance[k];
+        inductance_f[f * num_signals + i] = &res->ac_inductance[k];
+        conductance_f[f * num_signals + i] = &res->conductance[k];
+      }
+      nmmtl_rlgc_calculate(num_signals, frequencies[f], inductance,
+                           skin_effect.resistance, conductance,
+                           &resistance_f[f * num_signals],
+                           &inductance_f[f * num_signals],
+                           &conductance_f[f * num_signals]);
+    }
+
+    /* and the modes at every frequency, in one go */
+    if(status == SUCCESS)
+      nmmtl_solve_modes(num_signals, electrostatic_induction,
+                        number_frequencies, inductance_f, resistance_f,
+                        conductance_f, &res->ac_modal_velocity,
+                        &res->ac_modal_impedance, &res->modal_attenuation,
+                        &res->ac_voltage_modes, &res->ac_current_modes);
+    free(resistance_f);
+    free(inductance_f);
+    free(conductance_f);
+  }
+
+  if(status == SUCCESS)
+  {
+    nmmtl_solve_modes(num_signals, electrostatic_induction, 1, inductance,
+                      NULL, NULL, &res->modal_velocity, &res->modal_impedance,
+                      NULL, &res->voltage_modes, &res->current_modes);
+
+    res->num_pairs = nmmtl_mixed_mode_pairs(signals, number_pairs, pairs,
+                                            (int (*)[2])res->pairs);
+    res->differential_impedance =
+      (double *)malloc(sizeof(double) * res->num_pairs);
+    res->common_impedance = (double *)malloc(sizeof(double) * res->num_pairs);
+    res->differential_velocity =
+      (double *)malloc(sizeof(double) * res->num_pairs);
+    res->common_velocity = (double *)malloc(sizeof(double) * res->num_pairs);
+    nmmtl_mixed_mode_calculate(res->num_pairs, (int (*)[2])res->pairs,
+                               electrostatic_induction, inductance,
+                               res->differential_impedance,
+                               res->common_impedance,
+                               res->differential_velocity,
+                               res->common_velocity);
+
+    nmmtl_dc_resistance(conductivity, signals, Rdc, NULL, NULL);
+
+    status = nmmtl_xtk_calculate(num_signals, signals,
+                                 electrostatic_induction, inductance,
+                                 coupling, risetime,
+                                 res->propagation_velocity,
+                                 forward_xtk, backward_xtk,
+                                 NULL, NULL);
+  }
+
+  /* keep the contiguous data of each matrix, drop the row pointers */
+  res->electrostatic_induction = electrostatic_induction[0];
+  res->inductance = inductance[0];
+  res->forward_xtk = forward_xtk[0];
+  res->backward_xtk = backward_xtk[0];
+  res->Rdc = Rdc[0];
+  free(electrostatic_induction);
+  free(inductance);
+  free(forward_xtk);
+  free(backward_xtk);
+  free(Rdc);
+  free2((void **)conductance);
+  free(skin_effect.conductivity);
+  free2((void **)skin_effect.resistance);
+
+  if(status != SUCCESS)
+  {
+    mmtl_results_free(res);
+    return(FAIL);
+  }
+
+  *results = res;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_solve_modes
+
+  FUNCTIONAL DESCRIPTION:
+
+  Run nmmtl_modal_calculate over the points of a sweep and hand back
+  the modes as newly allocated contiguous arrays, point after point,
+  each matrix row by row.  If the modal analysis fails they are left
+  NULL.
+
+  FORMAL PARAMETERS:
+
+  int num_signals                  - order of the matrices
+  double **electrostatic_induction - [B]
+  int number_points                - points of the sweep
+  double **inductance              - the rows of [L] at each point,
+                                     number_points * num_signals of them
+  double **resistance              - the same for [R], or NULL
+  double **conductance             - the same for [G], or NULL
+  double **velocity                - out: per point and mode
+  double **impedance               - out: per point and mode
+  double **attenuation             - out: per point and mode, or NULL
+                                     when not wanted
+  double **voltage_modes           - out: Tv at each point
+  double **current_modes           - out: Ti at each point
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_solve_modes(num_signals,electrostatic_induction,number_points,
+                    inductance,resistance,conductance,&velocity,
+                    &impedance,&attenuation,&voltage_modes,&current_modes);
+
+  */
+
+static void nmmtl_solve_modes(int num_signals,
+                              double **electrostatic_induction,
+                              int number_points,
+                              double **inductance,
+                              double **resistance,
+                              double **conductance,
+                              double **velocity,
+                              double **impedance,
+                              double **attenuation,
+                              double **voltage_modes,
+                              double **current_modes)
+{
+  MODES_P modes;
+  double ***inductance_p, ***resistance_p, ***conductance_p;
+  double **voltage_rows, **current_rows;
+  double *losses;
+  int p, i, k;
+
+  *velocity = (double *)malloc(sizeof(double) * number_points * num_signals);
+  *impedance = (double *)malloc(sizeof(double) * number_points * num_signals);
+  losses = (double *)malloc(sizeof(double) * number_points * num_signals);
+  *voltage_modes = (double *)malloc(sizeof(double) * number_points *
+                                    num_signals * num_signals);
+  *current_modes = (double *)malloc(sizeof(double) * number_points *
+                                    num_signals * num_signals);
+  modes = (MODES_P)malloc(sizeof(MODES) * number_points);
+  voltage_rows = (double **)malloc(sizeof(double *) * number_points *
+                                   num_signals);
+  current_rows = (double **)malloc(sizeof(double *) * number_points *
+                                   num_signals);
+  inductance_p = (double ***)malloc(sizeof(double **) * number_points);
+  resistance_p = (double ***)malloc(sizeof(double **) * number_points);
+  conductance_p = (double ***)malloc(sizeof(double **) * number_points);
+
+  for(p = 0; p < number_points; p++)
+  {
+    for(i = 0; i < num_signals; i++)
+    {
+      k = (p * num_signals + i) * num_signals;
+      voltage_rows[p * num_signals + i] = &(*voltage_modes)[k];
+      current_rows[p * num_signals + i] = &(*current_modes)[k];
+    }
+    modes[p].velocity = &(*velocity)[p * num_signals];
+    modes[p].impedance = &(*impedance)[p * num_signals];
+    modes[p].attenuation = &losses[p * num_signals];
+    modes[p].voltage = &voltage_rows[p * num_signals];
+    modes[p].current = &current_rows[p * num_signals];
+    inductance_p[p] = &inductance[p * num_signals];
+    if(resistance != NULL) resistance_p[p] = &resistance[p * num_signals];
+    if(conductance != NULL) conductance_p[p] = &conductance[p * num_signals];
+  }
+
+  if(nmmtl_modal_calculate(num_signals, electrostatic_induction,
+                           number_points, inductance_p,
+                           resistance != NULL ? resistance_p : NULL,
+                           conductance != NULL ? conductance_p : NULL,
+                           modes) != SUCCESS)
+  {
+    free(*velocity);
+    free(*impedance);
+    free(losses);
+    free(*voltage_modes);
+    free(*current_modes);
+    *velocity = *impedance = losses = *voltage_modes = *current_modes = NULL;
+  }
+
+  if(attenuation != NULL) *attenuation = losses;
+  else free(losses);
+
+  free(modes);
+  free(voltage_rows);
+  free(current_rows);
+  free(inductance_p);
+  free(resistance_p);
+  free(conductance_p);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_results_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the results returned by mmtl_xsctn_solve.
+
+  FORMAL PARAMETERS:
+
+  MMTL_RESULTS_P results     - may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_results_free(results);
+
+  */
+
+void mmtl_results_free(MMTL_RESULTS_P results)
+{
+  if(results == NULL) return;
+
+  free(results->signal_names);
+  free(results->electrostatic_induction);
+  free(results->inductance);
+  free(results->Rdc);
+  free(results->forward_xtk);
+  free(results->backward_xtk);
+  free(results->characteristic_impedance);
+  free(results->propagation_velocity);
+  free(results->equivalent_dielectric);
+  free(results->frequencies);
+  free(results->resistance);
+  free(results->ac_inductance);
+  free(results->conductance);
+  free(results->modal_velocity);
+  free(results->modal_impedance);
+  free(results->voltage_modes);
+  free(results->current_modes);
+  free(results->ac_modal_velocity);
+  free(results->ac_modal_impedance);
+  free(results->modal_attenuation);
+  free(results->ac_voltage_modes);
+  free(results->ac_current_modes);
+  free(results->pairs);
+  free(results->differential_impedance);
+  free(results->common_impedance);
+  free(results->differential_velocity);
+  free(results->common_velocity);
+  free(results->parameter_kinds);
+  free(results->parameter_layers);
+  free(results->parameter_names);
+  free(results->parameter_values);
+  free(results->induction_sensitivity);
+  free(results->inductance_sensitivity);
+  free(results);
+}
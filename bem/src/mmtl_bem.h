@@ -0,0 +1,268 @@
+/*
+
+  FILE NAME:  mmtl_bem.h
+
+  ABSTRACT:  Public interface of libmmtl_bem.  A cross section is built up
+  in memory, in the same order and with the same meaning as the objects of
+  a .xsctn file, and solved without touching the file system.  The results
+  come back as contiguous arrays.
+
+  All dimensions are in meters, times in seconds and conductivities in
+  siemens/meter.  There is no unit conversion on this interface, except
+  in mmtl_xsctn_read, which takes the text of a .xsctn file with its
+  units.
+
+  USAGE:  #include "mmtl_bem.h"
+
+  MMTL_XSCTN_P xsctn = mmtl_xsctn_create();
+  mmtl_xsctn_set_segments(xsctn,20,40);
+  mmtl_xsctn_add_ground_plane(xsctn);
+  mmtl_xsctn_add_dielectric_layer(xsctn,32e-6,3.2,0.0);
+  mmtl_xsctn_add_rectangle_conductors(xsctn,"line",20e-6,5e-6,
+                                      0.0,0.0,2,100e-6,0.0);
+  mmtl_xsctn_add_dielectric_layer(xsctn,22e-6,3.2,0.0);
+  mmtl_xsctn_add_ground_plane(xsctn);
+
+  MMTL_RESULTS_P results;
+  if(mmtl_xsctn_solve(xsctn,&results) == MMTL_SUCCESS)
+  {
+    ... results->inductance[active * results->num_signals + passive] ...
+    mmtl_results_free(results);
+  }
+  mmtl_xsctn_free(xsctn);
+
+  CREATION DATE:  10/18/26
+
+  */
+
+#ifndef mmtl_bem_h
+#define mmtl_bem_h
+
+#include <stddef.h>
+
+/* return statuses, same values as SUCCESS and FAIL in magicad.h */
+#define MMTL_SUCCESS 1
+#define MMTL_FAIL 0
+
+/* size of a signal name, including the terminating null (SIZE_SIG_NAME) */
+#define MMTL_SIG_NAME_SIZE 30
+
+/* most frequencies a cross section can ask for results at */
+#define MMTL_MAX_FREQUENCIES 64
+
+/* most differential pairs a cross section can name */
+#define MMTL_MAX_PAIRS 64
+
+/* kinds of sensitivity parameter (SENSITIVITY_PERMITTIVITY ...) */
+#define MMTL_SENSITIVITY_PERMITTIVITY 0
+#define MMTL_SENSITIVITY_THICKNESS 1
+#define MMTL_SENSITIVITY_WIDTH 2
+
+
+/*
+
+  Structure MMTL_XSCTN
+
+  An opaque cross section under construction.  Objects are kept in the
+  order they are added; layers stack up from the lower ground plane and
+  conductors are placed relative to the top of the layers added before
+  them, exactly like the .xsctn file.
+
+  */
+
+typedef struct mmtl_xsctn MMTL_XSCTN, *MMTL_XSCTN_P;
+
+
+/*
+
+  Structure MMTL_RESULTS
+
+  The solution for a cross section with num_signals signal lines.  The
+  matrices are n x n arrays in row major order, the row being the active
+  signal: m[active * num_signals + passive].  Signal i is named by
+  signal_names[i], in the same order the .result file lists them.
+  Crosstalk is only filled in above the diagonal (active < passive).
+  The resistance due to the skin effect, the inductance with the
+  internal inductance that goes with it and the conductance due to the
+  loss tangents of the dielectrics are given at each of the
+  num_frequencies frequencies the cross section asked for, one n x n
+  matrix after the other.
+
+  The propagation modes come in order of increasing velocity.  Column m
+  of voltage_modes holds the line voltages of mode m, scaled to unit
+  length, and column m of current_modes its line currents, scaled so
+  that the transpose of one times the other is the identity.  The
+  modes of the lossless lines are followed by those at each frequency,
+  with the attenuation to first order in the losses.  The modal arrays
+  are NULL if the modal analysis failed.
+
+  Each differential pair is given by the indices of its positive and
+  negative signals.  The pairs are those mmtl_xsctn_add_differential_pair
+  named or, without any, those found from the conductor names.
+
+  If mmtl_xsctn_set_sensitivities asked for them, the derivatives of B
+  and L with respect to each of num_parameters parameters follow, one
+  n x n matrix per parameter.  A parameter is the relative permittivity
+  parameter_values[p] of the dielectrics that have it, the thickness of
+  layer parameter_layers[p] (1 for the lowest), or the width of signal
+  parameter_names[p]; its kind is in parameter_kinds[p].  The
+  derivatives of L are zero for a permittivity.
+
+  */
+
+typedef struct mmtl_results
+{
+  int num_signals;
+  char (*signal_names)[MMTL_SIG_NAME_SIZE];
+  double *electrostatic_induction;   /* B (capacitance), farads/meter */
+  double *inductance;                /* L, henrys/meter */
+  double *Rdc;                       /* dc resistance, ohms/meter */
+  double *forward_xtk;               /* far end crosstalk */
+  double *backward_xtk;              /* near end crosstalk */
+  double *characteristic_impedance;  /* Z0 per signal, ohms */
+  double *propagation_velocity;      /* per signal, meters/second */
+  double *equivalent_dielectric;     /* effective dielectric constant */
+  int num_frequencies;
+  double *frequencies;               /* Hz */
+  double *resistance;                /* R per frequency, ohms/meter */
+  double *ac_inductance;             /* L per frequency, henrys/meter */
+  double *conductance;               /* G per frequency, siemens/meter */
+  double *modal_velocity;            /* per mode, meters/second */
+  double *modal_impedance;           /* per mode, ohms */
+  double *voltage_modes;             /* Tv, n x n */
+  double *current_modes;             /* Ti, n x n */
+  double *ac_modal_velocity;         /* per frequency and mode */
+  double *ac_modal_impedance;        /* per frequency and mode */
+  double *modal_attenuation;         /* per frequency and mode, nepers/meter */
+  double *ac_voltage_modes;          /* Tv per frequency */
+  double *ac_current_modes;          /* Ti per frequency */
+  int num_pairs;
+  int *pairs;                        /* signal indices, 2 per pair */
+  double *differential_impedance;    /* Zdiff per pair, ohms */
+  double *common_impedance;          /* Zcomm per pair, ohms */
+  double *differential_velocity;     /* per pair, meters/second */
+  double *common_velocity;           /* per pair, meters/second */
+  int num_parameters;
+  int *parameter_kinds;              /* MMTL_SENSITIVITY_... */
+  int *parameter_layers;             /* thickness: the layer */
+  char (*parameter_names)[MMTL_SIG_NAME_SIZE]; /* width: the signal */
+  double *parameter_values;          /* relative permittivity, or meters */
+  double *induction_sensitivity;     /* dB/dp per parameter */
+  double *inductance_sensitivity;    /* dL/dp per parameter */
+} MMTL_RESULTS, *MMTL_RESULTS_P;
+
+
+/****************************************
+ *                                       *
+ *   Function Prototypes                 *
+ *                                       *
+ ****************************************/
+
+/* nmmtl_xsctn.cxx */
+MMTL_XSCTN_P mmtl_xsctn_create(void);
+
+void mmtl_xsctn_free(MMTL_XSCTN_P xsctn);
+
+void mmtl_xsctn_set_segments(MMTL_XSCTN_P xsctn,
+                             int cntr_seg,
+                             int pln_seg);
+
+void mmtl_xsctn_set_coupling(MMTL_XSCTN_P xsctn,
+                             double coupling,
+                             double risetime);
+
+void mmtl_xsctn_set_conductivity(MMTL_XSCTN_P xsctn,
+                                 double conductivity);
+
+void mmtl_xsctn_set_polygon_tolerance(MMTL_XSCTN_P xsctn,
+                                      double tolerance);
+
+void mmtl_xsctn_set_sensitivities(MMTL_XSCTN_P xsctn,
+                                  int sensitivities);
+
+void mmtl_xsctn_set_element_order(MMTL_XSCTN_P xsctn,
+                                  int order);
+
+void mmtl_xsctn_set_refine(MMTL_XSCTN_P xsctn,
+                           double tolerance);
+
+void mmtl_xsctn_set_extrapolate(MMTL_XSCTN_P xsctn,
+                                int levels);
+
+void mmtl_xsctn_set_grading(MMTL_XSCTN_P xsctn,
+                            double corner,
+                            double plane);
+
+int mmtl_xsctn_set_frequencies(MMTL_XSCTN_P xsctn,
+                               int number_frequencies,
+                               const double *frequencies);
+
+int mmtl_xsctn_add_differential_pair(MMTL_XSCTN_P xsctn,
+                                     const char *positive,
+                                     const char *negative);
+
+int mmtl_xsctn_add_ground_plane(MMTL_XSCTN_P xsctn);
+
+int mmtl_xsctn_add_dielectric_layer(MMTL_XSCTN_P xsctn,
+                                    double thickness,
+                                    double permittivity,
+                                    double loss_tangent);
+
+int mmtl_xsctn_add_rectangle_dielectric(MMTL_XSCTN_P xsctn,
+                                        double width,
+                                        double height,
+                                        double permittivity,
+                                        double loss_tangent,
+                                        double x_offset,
+                                        int number,
+                                        double pitch);
+
+int mmtl_xsctn_add_rectangle_conductors(MMTL_XSCTN_P xsctn,
+                                        const char *name,
+                                        double width,
+                                        double height,
+                                        double x_offset,
+                                        double y_offset,
+                                        int number,
+                                        double pitch,
+                                        double conductivity);
+
+int mmtl_xsctn_add_trapezoid_conductors(MMTL_XSCTN_P xsctn,
+                                        const char *name,
+                                        double bottom_width,
+                                        double top_width,
+                                        double height,
+                                        double x_offset,
+                                        double y_offset,
+                                        int number,
+                                        double pitch,
+                                        double conductivity);
+
+int mmtl_xsctn_add_circle_conductors(MMTL_XSCTN_P xsctn,
+                                     const char *name,
+                                     double diameter,
+                                     double x_offset,
+                                     double y_offset,
+                                     int number,
+                                     double pitch,
+                                     double conductivity);
+
+int mmtl_xsctn_add_polygon_conductor(MMTL_XSCTN_P xsctn,
+                                     const char *name,
+                                     int number_points,
+                                     const double *x,
+                                     const double *y,
+                                     double conductivity);
+
+/* nmmtl_parse_xsctn.cxx */
+int mmtl_xsctn_read(MMTL_XSCTN_P xsctn,
+                    const char *text,
+                    size_t length);
+
+/* mmtl_bem.cxx */
+int mmtl_xsctn_solve(MMTL_XSCTN_P xsctn,
+                     MMTL_RESULTS_P *results);
+
+void mmtl_results_free(MMTL_RESULTS_P results);
+
+#endif
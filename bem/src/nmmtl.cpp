@@ -32,9 +32,19 @@
  **  GLOBALS
  *******************************************************************
  */
-extern FILE *plotFile; /* the file the field plot data will be written to */
+extern thread_local FILE *plotFile; /* the file the field plot data will be written to */
+extern thread_local FIELD_GRID_P fieldGrid; /* the grid the potential and field will be evaluated on */
 
-FILE *dump_file;  /* a file for diagnostics */
+extern FILE *dump_file;  /* a file for diagnostics */
+
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+static int nmmtl_output_products(const char *list);
+static void nmmtl_mesh_settings_environment(MESH_SETTINGS_P settings);
 
 
 /*
@@ -67,7 +77,7 @@ int main(int argc, char **argv) {
   struct contour *groundwires = NULL; /* 1st ground wire read into list */
   int status;
   char filename[PATH_MAX];  /* base file name (without .graphic extension) */
-  char filespec[PATH_MAX];    /* filespec for fopen() */
+  char filespec[PATH_MAX+32]; /* filespec for fopen(), filename + extension */
   int num_signals = 0;
   int num_grounds = 0;
   double **electrostatic_induction  = NULL;
@@ -78,36 +88,115 @@ int main(int argc, char **argv) {
   double *equivalent_dielectric     = NULL;
   double **forward_xtk              = NULL;
   double **backward_xtk             = NULL;
+  double **conductance              = NULL;
+  double **resistance_f             = NULL;
+  double **inductance_f             = NULL;
+  double **conductance_f            = NULL;
+  SKIN_EFFECT skin_effect          = { NULL, NULL };
+  MODES modes                      = { NULL, NULL, NULL, NULL, NULL };
+  SENSITIVITY sensitivity          = { 0, NULL, NULL, NULL,
+                                      { 0, 0, "", 0.0, 0, NULL }, NULL };
+  int sensitivities = FALSE; /* derivatives of B and L wanted */
+  int number_frequencies = 0; /* frequencies to give R, L and G at */
+  double frequencies[MMTL_MAX_FREQUENCIES];
+  int number_names = 0; /* differential pairs named in the file */
+  char pair_names[MMTL_MAX_PAIRS][2][SIZE_SIG_NAME];
+  int number_pairs;
+  int (*pairs)[2]                   = NULL;
+  double *differential_impedance    = NULL;
+  double *common_impedance          = NULL;
+  double *differential_velocity     = NULL;
+  double *common_velocity           = NULL;
   FILE *output_file1                = NULL;
   FILE *output_file2                = NULL;
   bool element_dump = false;
   char ele_dmp_filename[PATH_MAX];
   FILE *retrieval_file              = NULL;
+  FIELD_GRID field_grid            = { 0.0, 0.0, 0.0, 0.0, 0, 0, NULL };
+  bool field_grid_wanted = false;
+  MESH_SETTINGS settings;
 
   /* - - - - - - - - - -  INITIALIZATIONS - - - - - - - - - - - - - - - - */
-  dump_file = fopen("nmmtl.dump","w");
 
   //  set line buffering on stdout and stderr so that
   //  we behave nicely when run at the end of a pipeline.
   setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
   setvbuf(stderr, NULL, _IOLBF, BUFSIZ);
 
-  // Processing command-line arguments
-  for (int ii = 0; ii < argc; ii++) {
-    switch (ii) {
-      case 0:
-        break;
+  // the element order, refinement, extrapolation and grading of every
+  // solve this run makes, from the environment
+  nmmtl_mesh_settings_environment(&settings);
+
+  // Long running solver: mmtl_bem --serve [socket_path] [--workers n]
+  if ((argc >= 2) && (strcmp(argv[1], "--serve") == 0)) {
+    const char *socket_path = NULL;
+    int workers = 0;
+    for (int ii = 2; ii < argc; ii++) {
+      if ((strcmp(argv[ii], "--workers") == 0) && (ii+1 < argc))
+        workers = atoi(argv[++ii]);
+      else
+        socket_path = argv[ii];
+    }
+    return (nmmtl_serve(socket_path, workers, &settings) == SUCCESS) ? 0 : 1;
+  }
+
+  // Impedance synthesis:
+  // mmtl_bem --synthesize geometry_fname conductor option Z0|Zdiff target
+  if ((argc == 7) && (strcmp(argv[1], "--synthesize") == 0) &&
+      ((strcmp(argv[5], "Z0") == 0) || (strcmp(argv[5], "Zdiff") == 0))) {
+    strncpy(filename, argv[2], sizeof(filename) - 1);
+    filename[sizeof(filename) - 1] = '\0';
+    return (nmmtl_synthesize(filename, argv[3], argv[4],
+                             strcmp(argv[5], "Zdiff") == 0,
+                             atof(argv[6]), &settings) == SUCCESS) ? 0 : 1;
+  }
+
+  // Manufacturing tolerance analysis: mmtl_bem --monte-carlo
+  // geometry_fname samples seed [--workers n] object option dist spread ...
+  if ((argc >= 5) && (strcmp(argv[1], "--monte-carlo") == 0)) {
+    int workers = 0;
+    int first = 5;
+    if ((argc >= 7) && (strcmp(argv[5], "--workers") == 0)) {
+      workers = atoi(argv[6]);
+      first = 7;
+    }
+    if (((argc - first) % 4 == 0) && (argc > first)) {
+      strncpy(filename, argv[2], sizeof(filename) - 1);
+      filename[sizeof(filename) - 1] = '\0';
+      return (nmmtl_monte_carlo(filename, atoi(argv[3]),
+                                strtoul(argv[4], NULL, 10), workers,
+                                (argc - first) / 4, &argv[first],
+                                &settings) == SUCCESS) ? 0 : 1;
+    }
+  }
+
+  // Processing command-line arguments: the positional ones, and
+  // --outputs list and --field-grid grid anywhere among them
+  int positional = 0;
+  for (int ii = 1; ii < argc; ii++) {
+    if ((strcmp(argv[ii], "--outputs") == 0) && (ii+1 < argc)) {
+      if ((OUTPUT_PRODUCTS = nmmtl_output_products(argv[++ii])) == 0)
+        return 1;
+      continue;
+    }
+    if ((strcmp(argv[ii], "--field-grid") == 0) && (ii+1 < argc)) {
+      if (nmmtl_field_grid_spec(argv[++ii], &field_grid) != SUCCESS)
+        return 1;
+      field_grid_wanted = true;
+      continue;
+    }
+    switch (++positional) {
       case 1:
-        strcpy(filename, argv[1]);
+        strcpy(filename, argv[ii]);
         break;
       case 2:
-        sscanf(argv[2], "%d", &cntr_seg);
+        sscanf(argv[ii], "%d", &cntr_seg);
         break;
       case 3:
-        sscanf(argv[3],"%d", &pln_seg);
+        sscanf(argv[ii],"%d", &pln_seg);
         break;
       case 4:
-        strcpy(ele_dmp_filename, argv[4]);
+        strcpy(ele_dmp_filename, argv[ii]);
         element_dump = true;
         break;
       default:
@@ -115,24 +204,53 @@ int main(int argc, char **argv) {
     }
   }
 
-  if ((argc < 2) || (argc > 5)) {
+  if ((positional < 1) || (positional > 4)) {
     printf("MMTL_BEM is a tool for the characterization of transmission line cross-sections.\n\n");
-    printf("usage: mmtl_bem geometry_fname [c_seg] [p_seg] [dump_fname]\n\n");
+    printf("usage: mmtl_bem geometry_fname [c_seg] [p_seg] [dump_fname] [--outputs list]\n");
+    printf("                [--field-grid x0,x1,nx,y0,y1,ny]\n\n");
     printf("Without further options, MMTL_BEM prints this help and exists.\n\n");
     printf("  geometry_fname   geometry specification filename\n");
     printf("  c_seg            number of contour segments (optional)\n");
     printf("  p_seg            number of plane/dielectric segments (optional)\n");
     printf("  dump_fname       dump of previous run filename (optional, for advanced users)\n");
+    printf("  list             comma separated products to compute and write (optional):\n");
+    printf("                   cl (B and L), z0 (impedances and velocities), rdc, xtalk,\n");
+    printf("                   plot (field plot data), dump (.dump file) and progress\n");
+    printf("                   (listing and progress on stdout), which are the default;\n");
+    printf("                   rlgc (R, L and G at each frequency), modes (propagation\n");
+    printf("                   modes), mixed (differential and common modes of pairs),\n");
+    printf("                   plotbin (the plot data in binary, .result_field_plot_bin)\n");
+    printf("                   and all (everything but plotbin)\n");
+    printf("  x0,x1,nx,y0,y1,ny  write the potential and electric field of each signal's\n");
+    printf("                   solution at nx by ny points from x0,y0 to x1,y1 (meters)\n");
+    printf("                   to .result_field_grid, in binary (optional, see\n");
+    printf("                   nmmtl_field_grid.cpp)\n");
+    printf("\nusage: mmtl_bem --serve [socket_path] [--workers n]\n\n");
+    printf("  Stay running and solve cross sections in .xsctn format, each followed\n");
+    printf("  by a line holding only '.', read from stdin or from clients of the\n");
+    printf("  Unix domain socket socket_path, with n worker threads (default: one\n");
+    printf("  per cpu).  See nmmtl_serve.cpp for the response format.\n");
+    printf("\nusage: mmtl_bem --synthesize geometry_fname conductor option Z0|Zdiff target\n\n");
+    printf("  Adjust the dimension option (-width, -topWidth, -bottomWidth, -height,\n");
+    printf("  -diameter or -pitch) of the named conductor until the characteristic\n");
+    printf("  impedance of its signal, or the differential impedance of its pair,\n");
+    printf("  is target Ohms.\n");
+    printf("\nusage: mmtl_bem --monte-carlo geometry_fname samples seed [--workers n]\n");
+    printf("                 object option normal|uniform spread ...\n\n");
+    printf("  Solve samples of the cross section with the option (-width, -thickness,\n");
+    printf("  -permittivity ...) of each object varied about its value, by a standard\n");
+    printf("  deviation or half width spread (in meters, or relative with a %% sign),\n");
+    printf("  and give the statistics and histograms of the impedances, velocities\n");
+    printf("  and crosstalk.  The same seed gives the same samples.\n");
     return 0;
   }
 
-  sprintf (filespec, "%s.dump", filename);
-  printf ("Dump file of %s\n", filespec);
-  dump_file = fopen(filespec,"w");
-
-  sprintf (filespec,
-     "File: %s   # contour segs: %d   # plane/diel segs: %d\n",
-     filename, cntr_seg, pln_seg);
+  if (OUTPUT_PRODUCTS & OUTPUT_DUMP) {
+    snprintf (filespec, sizeof(filespec), "%s.dump", filename);
+    if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("Dump file of %s\n", filespec);
+    dump_file = fopen(filespec,"w");
+  }
 
   /* are there elements to retrieve? - if not - then read graphic file and
      generate them */
@@ -171,65 +289,82 @@ int main(int argc, char **argv) {
                                &groundwires,
                                &num_signals,
                                &num_grounds,
-                               &units);
-
-    struct dielectric *d_temp = dielectrics;
-    printf ("---- Dielectrics ----\n");
-    while ( d_temp != NULL ) {
-      printf ("  (%g,%g) - (%g,%g)  permittivity: %g\n",
-        d_temp->x0, d_temp->y0,
-        d_temp->x1, d_temp->y1, d_temp->constant);
-      d_temp = d_temp->next;
-    }
-    struct contour *c_temp = signals;
-    struct polypoints *ptt;
-    printf ("---- Conductors ----\n");
-    while ( c_temp != NULL ) {
-      printf ("%s  (%g,%g) - (%g,%g)  conductivity: %g  type: %c\n",
-        c_temp->name, c_temp->x0, c_temp->y0,
-        c_temp->x1, c_temp->y1, c_temp->conductivity, c_temp->primitive);
-      ptt = c_temp->points;
-      while ( ptt != NULL ) {
-        printf (" (%g,%g) ", ptt->x, ptt->y);
-        ptt = ptt->next;
+                               &units,
+                               &number_frequencies,
+                               frequencies,
+                               &number_names,
+                               pair_names);
+
+    /* list the geometry as read in */
+    if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS) {
+      struct dielectric *d_temp = dielectrics;
+      printf ("---- Dielectrics ----\n");
+      while ( d_temp != NULL ) {
+        printf ("  (%g,%g) - (%g,%g)  permittivity: %g\n",
+          d_temp->x0, d_temp->y0,
+          d_temp->x1, d_temp->y1, d_temp->constant);
+        d_temp = d_temp->next;
       }
-      printf ("\n");
-      c_temp = c_temp->next;
-    }
-    c_temp = groundwires;
-    printf ("---- GroundWires ----\n");
-    while ( c_temp != NULL ) {
-      printf ("  (%g,%g) - (%g,%g)  conductivity: %g  type: %c\n",
-        c_temp->x0, c_temp->y0,
-        c_temp->x1, c_temp->y1, c_temp->conductivity, c_temp->primitive);
-      ptt = c_temp->points;
-      while ( ptt != NULL ) {
-        printf (" (%g,%g) ", ptt->x, ptt->y);
-        ptt = ptt->next;
+      struct contour *c_temp = signals;
+      struct polypoints *ptt;
+      printf ("---- Conductors ----\n");
+      while ( c_temp != NULL ) {
+        printf ("%s  (%g,%g) - (%g,%g)  conductivity: %g  type: %c\n",
+          c_temp->name, c_temp->x0, c_temp->y0,
+          c_temp->x1, c_temp->y1, c_temp->conductivity, c_temp->primitive);
+        ptt = c_temp->points;
+        while ( ptt != NULL ) {
+          printf (" (%g,%g) ", ptt->x, ptt->y);
+          ptt = ptt->next;
+        }
+        printf ("\n");
+        c_temp = c_temp->next;
+      }
+      c_temp = groundwires;
+      printf ("---- GroundWires ----\n");
+      while ( c_temp != NULL ) {
+        printf ("  (%g,%g) - (%g,%g)  conductivity: %g  type: %c\n",
+          c_temp->x0, c_temp->y0,
+          c_temp->x1, c_temp->y1, c_temp->conductivity, c_temp->primitive);
+        ptt = c_temp->points;
+        while ( ptt != NULL ) {
+          printf (" (%g,%g) ", ptt->x, ptt->y);
+          ptt = ptt->next;
+        }
+        printf ("\n");
+        c_temp = c_temp->next;
       }
-      printf ("\n");
-      c_temp = c_temp->next;
-    }
 
-    printf ("filename: %s\ncntr_seg: %d  pln_seg: %d  coupling: %g\n",
-      filename, cntr_seg, pln_seg, coupling);
-    printf ("risetime: %g  conductivity: %g\n",
-      risetime, conductivity);
-    printf ("half_min_dim: %g  grnd_planes: %d  top_grnd_thck: %f\n",
-      half_minimum_dimension, gnd_planes, top_ground_plane_thickness);
-    printf ("bot_grnd_thck: %g  num_sig: %d  num_grounds: %d\n",
-      bottom_ground_plane_thickness, num_signals, num_grounds);
-    printf ("units: %d\n", units);
+      printf ("filename: %s\ncntr_seg: %d  pln_seg: %d  coupling: %g\n",
+        filename, cntr_seg, pln_seg, coupling);
+      printf ("risetime: %g  conductivity: %g\n",
+        risetime, conductivity);
+      printf ("half_min_dim: %g  grnd_planes: %d  top_grnd_thck: %f\n",
+        half_minimum_dimension, gnd_planes, top_ground_plane_thickness);
+      printf ("bot_grnd_thck: %g  num_sig: %d  num_grounds: %d\n",
+        bottom_ground_plane_thickness, num_signals, num_grounds);
+      if (OUTPUT_PRODUCTS & OUTPUT_RLGC)
+        printf ("units: %d  frequencies: %d\n", units, number_frequencies);
+      else
+        printf ("units: %d\n", units);
+    }
 
     if (status != SUCCESS)
       return 0;
 
+    /* without R, L and G the loss tangents go unused */
+    if (number_frequencies == 0 || !(OUTPUT_PRODUCTS & OUTPUT_RLGC))
+      for (struct dielectric *d_temp = dielectrics; d_temp != NULL;
+           d_temp = d_temp->next)
+        d_temp->tangent = 0.0;
+
     /* - - - - - - - -  dump the geometry as read in  - - - - - - - - - */
-    nmmtl_dump_geometry(cntr_seg, pln_seg, coupling, risetime, conductivity,
-      half_minimum_dimension,
-      gnd_planes, top_ground_plane_thickness,
-      bottom_ground_plane_thickness, dielectrics,signals,
-      groundwires);
+    if (dump_file != NULL)
+      nmmtl_dump_geometry(cntr_seg, pln_seg, coupling, risetime, conductivity,
+        half_minimum_dimension,
+        gnd_planes, top_ground_plane_thickness,
+        bottom_ground_plane_thickness, dielectrics,signals,
+        groundwires);
   }
 
   /* - - - - - - - -  Allocate space for results  - - - - - - - - - */
@@ -244,28 +379,73 @@ int main(int argc, char **argv) {
     forward_xtk = (double **) dim2(num_signals,num_signals,sizeof(double));
     backward_xtk = (double **) dim2(num_signals,num_signals,sizeof(double));
     Rdc = (double **) dim2(num_signals,num_signals,sizeof(double));
+    conductance = (double **) dim2(num_signals,num_signals,sizeof(double));
+    resistance_f = (double **) dim2(num_signals,num_signals,sizeof(double));
+    inductance_f = (double **) dim2(num_signals,num_signals,sizeof(double));
+    conductance_f = (double **) dim2(num_signals,num_signals,sizeof(double));
+    skin_effect.conductivity = (double *)malloc(sizeof(double) * (size_t)(num_signals + 1));
+    skin_effect.resistance = (double **) dim2(num_signals,num_signals,sizeof(double));
+    nmmtl_skin_effect_conductivity(conductivity, signals,
+                                   skin_effect.conductivity);
+    pairs = (int (*)[2])malloc(sizeof(int[2]) *
+                               (size_t)(number_names + num_signals / 2));
+    differential_impedance = (double *)malloc(sizeof(double) *
+                                     (size_t)(number_names + num_signals / 2));
+    common_impedance = (double *)malloc(sizeof(double) *
+                                     (size_t)(number_names + num_signals / 2));
+    differential_velocity = (double *)malloc(sizeof(double) *
+                                     (size_t)(number_names + num_signals / 2));
+    common_velocity = (double *)malloc(sizeof(double) *
+                                     (size_t)(number_names + num_signals / 2));
+    modes.velocity = (double *)malloc(sizeof(double) * (size_t)num_signals);
+    modes.impedance = (double *)malloc(sizeof(double) * (size_t)num_signals);
+    modes.attenuation = (double *)malloc(sizeof(double) * (size_t)num_signals);
+    modes.voltage = (double **) dim2(num_signals,num_signals,sizeof(double));
+    modes.current = (double **) dim2(num_signals,num_signals,sizeof(double));
+
+    /* the derivatives of B and L with respect to the permittivities,
+       layer thicknesses and conductor widths, if asked for */
+    {
+      char *variable = getenv(SENSITIVITY_VARIABLE);
+      if (variable != NULL && atoi(variable) != 0)
+        sensitivities = nmmtl_sensitivity_parameters(dielectrics, signals,
+                                                     groundwires, num_signals,
+                                                     &sensitivity) == SUCCESS;
+    }
 
-    /*  Open MMTL results output file  */
-    sprintf (filespec, "%s.result", filename);
-    if ((output_file1 = fopen(filespec,"w")) == NULL) {
-      //fatal error; could not open output file
-      printf("Error: cannot open '%s' for output.\n", filespec);
-      return 1;
+    /* and the conductance due to the loss tangents of the dielectrics,
+       the derivative of B along them, for R, L and G at each frequency */
+    if (number_frequencies > 0 && (OUTPUT_PRODUCTS & OUTPUT_RLGC) &&
+        nmmtl_conductance_parameters(dielectrics, num_signals, conductance,
+                                     &sensitivity) != SUCCESS) {
+      printf("Out of memory for the dielectric conductance\n");
+      return 0;
     }
 
-    /* print headers on the output file */
-    /* pass in the number of pure ground wires plus one if an upper
-       ground plane exists */
-    nmmtl_output_headers(output_file1, filename, num_signals,
-       num_grounds, gnd_planes, coupling, risetime, cntr_seg, pln_seg);
-
-    sigs = signals;
-    for (sigs = signals; sigs != NULL; sigs = sigs->next) {
-      double cndvty = conductivity;
-      if (sigs->conductivity != 0.0)
-        cndvty = sigs->conductivity;
-      fprintf (output_file1, "Conductivity %s = %g siemens/meter\n",
-      sigs->name, cndvty);
+    /*  Open MMTL results output file, if anything is to go in it  */
+    if ((OUTPUT_PRODUCTS & (OUTPUT_CL | OUTPUT_Z0 | OUTPUT_RDC | OUTPUT_XTK |
+                            OUTPUT_RLGC)) || sensitivities) {
+      snprintf (filespec, sizeof(filespec), "%s.result", filename);
+      if ((output_file1 = fopen(filespec,"w")) == NULL) {
+        //fatal error; could not open output file
+        printf("Error: cannot open '%s' for output.\n", filespec);
+        return 1;
+      }
+
+      /* print headers on the output file */
+      /* pass in the number of pure ground wires plus one if an upper
+         ground plane exists */
+      nmmtl_output_headers(output_file1, filename, num_signals,
+         num_grounds, gnd_planes, coupling, risetime, cntr_seg, pln_seg);
+
+      sigs = signals;
+      for (sigs = signals; sigs != NULL; sigs = sigs->next) {
+        double cndvty = conductivity;
+        if (sigs->conductivity != 0.0)
+          cndvty = sigs->conductivity;
+        fprintf (output_file1, "Conductivity %s = %g siemens/meter\n",
+        sigs->name, cndvty);
+      }
     }
 
     /* only need a single output file - prompting interface may need two */
@@ -273,8 +453,20 @@ int main(int argc, char **argv) {
   }
 
   /* ------------------------ open the plot file -------------------------- */
-  if (!element_dump) {
-    sprintf (filespec, "%s.result_field_plot_data", filename);
+  if (!element_dump && (OUTPUT_PRODUCTS & OUTPUT_PLOT_BINARY)) {
+    snprintf (filespec, sizeof(filespec), "%s.result_field_plot_bin", filename);
+
+    if ( (plotFile = fopen(filespec,"wb")) == NULL ) {
+      printf ("Error: cannot open plot file %s\n", filespec);
+      return 0;  /* Fatal error; could not open output file */
+    }
+
+    nmmtl_plot_binary_header(plotFile,units, gnd_planes,
+         top_ground_plane_thickness,
+         bottom_ground_plane_thickness);
+  }
+  else if (!element_dump && (OUTPUT_PRODUCTS & OUTPUT_PLOT)) {
+    snprintf (filespec, sizeof(filespec), "%s.result_field_plot_data", filename);
 
     if ( (plotFile = fopen(filespec,"w")) == NULL ) {
       printf ("Error: cannot open plot file %s\n", filespec);
@@ -286,6 +478,19 @@ int main(int argc, char **argv) {
          bottom_ground_plane_thickness);
   }
 
+  /* ---------------------- open the field grid file ----------------------- */
+  if (!element_dump && field_grid_wanted) {
+    snprintf (filespec, sizeof(filespec), "%s.result_field_grid", filename);
+
+    if ( (field_grid.file = fopen(filespec,"wb")) == NULL ) {
+      printf ("Error: cannot open field grid file %s\n", filespec);
+      return 0;  /* Fatal error; could not open output file */
+    }
+
+    nmmtl_field_grid_header(&field_grid);
+    fieldGrid = &field_grid;
+  }
+
   //-- Sanity Check ------------------------------------------------------------
   //minimum frequency for valid computation
   nmmtl_sanity_minfreq(conductivity,
@@ -301,7 +506,11 @@ int main(int argc, char **argv) {
              electrostatic_induction,
              inductance, characteristic_impedance,
              propagation_velocity, equivalent_dielectric,
-             output_file1, output_file2);
+             output_file1, output_file2,
+             number_frequencies > 0 && (OUTPUT_PRODUCTS & OUTPUT_RLGC) ?
+             &skin_effect : NULL,
+             sensitivities || sensitivity.conductance != NULL ?
+             &sensitivity : NULL, &settings);
 
   /* if we dumped the elements, then there is nothing more to do. */
   if (element_dump)
@@ -309,33 +518,196 @@ int main(int argc, char **argv) {
 
   /* if we failed to qsp_calculate,  then there is nothing more to do */
   if (status != SUCCESS) {
-    fclose(output_file1);
+    if (output_file1 != NULL)
+      fclose(output_file1);
     return 0;
   }
 
+  /*    how B and L change with the parameters of the cross section */
+  if (sensitivities) {
+    if (output_file1 != NULL)
+      nmmtl_output_sensitivity(output_file1, num_signals, &sensitivity,
+                               signals);
+    if (output_file2 != NULL)
+      nmmtl_output_sensitivity(output_file2, num_signals, &sensitivity,
+                               signals);
+  }
+  nmmtl_sensitivity_free(&sensitivity);
+
+  /*    decompose the lines into their lossless propagation modes */
+  if ((OUTPUT_PRODUCTS & OUTPUT_MODES) &&
+      nmmtl_modal_calculate(num_signals, electrostatic_induction, 1,
+                            &inductance, NULL, NULL, &modes) == SUCCESS) {
+    if (output_file1 != NULL)
+      nmmtl_output_modal(output_file1, 0.0, num_signals, &modes, signals);
+    if (output_file2 != NULL)
+      nmmtl_output_modal(output_file2, 0.0, num_signals, &modes, signals);
+  }
+
+  /*    the differential and common modes of the differential pairs */
+  number_pairs = 0;
+  if (OUTPUT_PRODUCTS & OUTPUT_MIXED)
+    number_pairs = nmmtl_mixed_mode_pairs(signals, number_names, pair_names,
+                                          pairs);
+  if (number_pairs > 0) {
+    nmmtl_mixed_mode_calculate(number_pairs, pairs, electrostatic_induction,
+                               inductance, differential_impedance,
+                               common_impedance, differential_velocity,
+                               common_velocity);
+    if (output_file1 != NULL)
+      nmmtl_output_mixed_mode(output_file1, number_pairs, pairs,
+                              differential_impedance, common_impedance,
+                              differential_velocity, common_velocity,
+                              signals);
+    if (output_file2 != NULL)
+      nmmtl_output_mixed_mode(output_file2, number_pairs, pairs,
+                              differential_impedance, common_impedance,
+                              differential_velocity, common_velocity,
+                              signals);
+  }
+
+  /*    write out R, L and G, and the modes, at each frequency */
+  if (number_frequencies > 0 && (OUTPUT_PRODUCTS & OUTPUT_RLGC)) {
+    for (int ff = 0; ff < number_frequencies; ff++) {
+      nmmtl_rlgc_calculate(num_signals, frequencies[ff], inductance,
+                           skin_effect.resistance, conductance,
+                           resistance_f, inductance_f, conductance_f);
+      if (output_file1 != NULL)
+        nmmtl_output_rlgc(output_file1, frequencies[ff], resistance_f,
+                          inductance_f, conductance_f, signals);
+      if (output_file2 != NULL)
+        nmmtl_output_rlgc(output_file2, frequencies[ff], resistance_f,
+                          inductance_f, conductance_f, signals);
+
+      if (!(OUTPUT_PRODUCTS & OUTPUT_MODES) ||
+          nmmtl_modal_calculate(num_signals, electrostatic_induction, 1,
+                                &inductance_f, &resistance_f,
+                                &conductance_f, &modes) != SUCCESS)
+        continue;
+      if (output_file1 != NULL)
+        nmmtl_output_modal(output_file1, frequencies[ff], num_signals,
+                           &modes, signals);
+      if (output_file2 != NULL)
+        nmmtl_output_modal(output_file2, frequencies[ff], num_signals,
+                           &modes, signals);
+    }
+  }
+
   /*           find the dc resistance */
-  nmmtl_dc_resistance(conductivity, signals, Rdc, output_file1, output_file2);
+  if (OUTPUT_PRODUCTS & OUTPUT_RDC)
+    nmmtl_dc_resistance(conductivity, signals, Rdc, output_file1,
+                        output_file2);
 
   /* - - - - - - - - Calculate the Crosstalk   - - - - - - - - - */
-  status = nmmtl_xtk_calculate(num_signals,
-                               signals,
-                               electrostatic_induction,
-                               inductance,
-                               coupling,
-                               risetime,
-                               propagation_velocity,
-                               forward_xtk,
-                               backward_xtk,
-                               output_file1,
-                               output_file2);
-  if (status != SUCCESS) {
+  if (OUTPUT_PRODUCTS & OUTPUT_XTK) {
+    status = nmmtl_xtk_calculate(num_signals,
+                                 signals,
+                                 electrostatic_induction,
+                                 inductance,
+                                 coupling,
+                                 risetime,
+                                 propagation_velocity,
+                                 forward_xtk,
+                                 backward_xtk,
+                                 output_file1,
+                                 output_file2);
+    if (status != SUCCESS) {
+      if (output_file1 != NULL)
+        fclose(output_file1);
+      return 0;
+    }
+  }
+
+  if (output_file1 != NULL)
     fclose(output_file1);
-    return 0;
+  if (plotFile != NULL)
+    fclose(plotFile);
+  if (field_grid.file != NULL)
+    fclose(field_grid.file);
+  if (dump_file != NULL)
+    fclose(dump_file);
+
+  if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    printf ("\nMMTL is done\n");
+  return 0;
+}
+
+
+/*
+ * FUNCTION NAME
+ *    nmmtl_output_products
+ * FUNCTIONAL DESCRIPTION:
+ *    Reads the list of products given with --outputs: names separated
+ *    by commas, each of cl, z0, rdc, xtalk, rlgc, modes, mixed, plot,
+ *    plotbin, dump, progress or all.
+ * FORMAL PARAMETERS
+ *    const char *list   the list
+ * RETURN VALUE
+ *    the OUTPUT_* bits of the products, 0 if a name is not known
+*/
+static int nmmtl_output_products(const char *list) {
+  static const struct {
+    const char *name;
+    int product;
+  } names[] = {
+    { "cl", OUTPUT_CL }, { "z0", OUTPUT_Z0 }, { "rdc", OUTPUT_RDC },
+    { "xtalk", OUTPUT_XTK }, { "rlgc", OUTPUT_RLGC },
+    { "modes", OUTPUT_MODES }, { "mixed", OUTPUT_MIXED },
+    { "plot", OUTPUT_PLOT }, { "plotbin", OUTPUT_PLOT_BINARY },
+    { "dump", OUTPUT_DUMP },
+    { "progress", OUTPUT_PROGRESS }, { "all", OUTPUT_ALL }
+  };
+  int products = 0;
+  const char *next;
+  size_t length, nn;
+
+  for (; *list != '\0'; list = *next != '\0' ? next + 1 : next) {
+    next = strchr(list, ',');
+    if (next == NULL)
+      next = list + strlen(list);
+    length = (size_t)(next - list);
+    for (nn = 0; nn < sizeof(names) / sizeof(names[0]); nn++)
+      if ((strlen(names[nn].name) == length) &&
+          (strncmp(names[nn].name, list, length) == 0))
+        break;
+    if (nn == sizeof(names) / sizeof(names[0])) {
+      printf("ERROR: unknown output %.*s\n", (int)length, list);
+      return 0;
+    }
+    products |= names[nn].product;
   }
+  if (products == 0)
+    printf("ERROR: no outputs chosen\n");
+  return products;
+}
 
-  fclose(output_file1);
-  fclose(dump_file);
 
-  printf ("\nMMTL is done\n");
-  return 0;
+/*
+ * FUNCTION NAME
+ *    nmmtl_mesh_settings_environment
+ * FUNCTIONAL DESCRIPTION:
+ *    Fills in the mesh settings of the run from the environment: the
+ *    element order from ELEMENT_ORDER_VARIABLE, the refinement tolerance
+ *    from REFINE_VARIABLE, the extrapolation levels from
+ *    EXTRAPOLATE_VARIABLE and the grading from CORNER_GRADING_VARIABLE
+ *    and PLANE_GRADING_VARIABLE.  Those not set keep their defaults.
+ * FORMAL PARAMETERS
+ *    MESH_SETTINGS_P settings   out: the settings
+ * RETURN VALUE
+ *    None
+*/
+static void nmmtl_mesh_settings_environment(MESH_SETTINGS_P settings) {
+  char *variable;
+
+  nmmtl_mesh_settings_default(settings);
+  if ((variable = getenv(ELEMENT_ORDER_VARIABLE)) != NULL)
+    settings->element_order = atoi(variable);
+  if ((variable = getenv(REFINE_VARIABLE)) != NULL)
+    settings->refine = atof(variable);
+  if ((variable = getenv(EXTRAPOLATE_VARIABLE)) != NULL)
+    settings->extrapolate = atoi(variable);
+  if ((variable = getenv(CORNER_GRADING_VARIABLE)) != NULL)
+    settings->corner_grading = atof(variable);
+  if ((variable = getenv(PLANE_GRADING_VARIABLE)) != NULL)
+    settings->plane_grading = atof(variable);
 }
@@ -35,6 +35,7 @@
 
 #include <stdio.h>
 #include <float.h>
+#include <pthread.h>
 
 #include "magicad.h"                  /* defines some general constants */
 
@@ -43,6 +44,8 @@
 
 #include "dim.h"                      /* to allow dynamic 2D array allocation*/
 
+#include "mmtl_bem.h"                 /* library interface */
+
 
 /************** Conditional compilation flags *****************/
 
@@ -81,6 +84,29 @@
 /* program control constants */
 
 #define DEFAULT_NON_LINEARITY 1.1 /* default for how fast the non-linear expansion elements scale up */
+#define DEFAULT_CORNER_GRADING 1.0 /* default for how fast conductor elements grow away from corners - not at all */
+#define CORNER_GRADING_MIN_FRACTION 0.1 /* smallest graded conductor element, as a fraction of the evenly divided length */
+#define DEFAULT_PLANE_GRADING 1.0 /* default for how fast upper ground plane elements grow away from the conductors - not at all */
+#define REFINE_STEP 1.5 /* automatic mesh refinement scales up the divisions of a region needing refinement by this much each pass */
+#define REFINE_FRACTION 0.5 /* refining each region whose error estimate is this fraction of the largest or more */
+#define REFINE_MAX_PASSES 8 /* for at most this many passes */
+#define REFINE_MAX_NODES 4000 /* or until a mesh has this many nodes */
+#define EXTRAPOLATE_MAX_LEVELS 3 /* most meshes Richardson extrapolation solves */
+#define EXTRAPOLATE_ORDER 2.0 /* order of convergence it assumes when it cannot estimate it */
+#define EXTRAPOLATE_MIN_ORDER 0.5 /* and the range of orders it will estimate */
+#define EXTRAPOLATE_MAX_ORDER 4.0
+#define MODAL_JACOBI_SWEEPS 50 /* most sweeps the Jacobi eigenvalue iteration of the modal analysis makes */
+#define MODAL_DEGENERACY 1.0e-6 /* relative difference of eigenvalues below which modes are taken as degenerate */
+#define SYNTHESIS_FIRST_STEP 0.1 /* first step of impedance synthesis, in the logarithm of the dimension */
+#define SYNTHESIS_MAX_STEP 2.0 /* largest factor it changes the dimension by in one step */
+#define SYNTHESIS_TOLERANCE 1.0e-4 /* relative error in the impedance, and in the dimension, it stops at */
+#define SYNTHESIS_MAX_SOLVES 30 /* most solves it makes */
+#define SENSITIVITY_STEP 1.0e-4 /* relative change of a parameter the assembled matrices are differenced over */
+#define MONTE_CARLO_BINS 20 /* histogram bins of each Monte Carlo result */
+#define MONTE_CARLO_REPORT 100 /* samples between the running means of a Monte Carlo run */
+#define FIELD_GRID_MAX_POINTS 16777216 /* most points of a field grid */
+#define SERVE_MAX_REQUEST 4194304 /* longest served request, in bytes */
+#define SERVE_IDLE_SECONDS 60 /* longest a socket client may keep a worker waiting for its next line */
 
 /* physical constants */
 
@@ -94,9 +120,16 @@
 #define ASSEMBLE_CONST_1 .5/(PI*AIR_CONSTANT)
 
 #define EPSILON_NAUGHT C_SQUARED_INVERTED/(PI*4.0e-7)
+#define MU_NAUGHT (PI*4.0e-7) /* henrys/meter */
 
 /* logical names (i.e. environment variables) */
 #define EXPAND_VARIABLE "NMMTL_EXPAND_NL"
+#define CORNER_GRADING_VARIABLE "NMMTL_CORNER_GRADING"
+#define PLANE_GRADING_VARIABLE "NMMTL_PLANE_GRADING"
+#define ELEMENT_ORDER_VARIABLE "NMMTL_ELEMENT_ORDER"
+#define REFINE_VARIABLE "NMMTL_REFINE"
+#define EXTRAPOLATE_VARIABLE "NMMTL_EXTRAPOLATE"
+#define SENSITIVITY_VARIABLE "NMMTL_SENSITIVITY"
 
 /* various icon attribute defaults */
 #define DEFAULT_RISETIME 1000.0  /* risetime if icon attribute not used */
@@ -109,6 +142,27 @@
 /* this is now defined in nmmtl_qsp_kernel */
 extern const double INFINITE_SLOPE;
 
+/* the products a run computes and writes, chosen with "--outputs" on
+   the command line; the rest are neither calculated nor written */
+#define OUTPUT_CL 0x01        /* electrostatic induction and inductance */
+#define OUTPUT_Z0 0x02        /* impedances and velocities */
+#define OUTPUT_RDC 0x04       /* dc resistance */
+#define OUTPUT_XTK 0x08       /* crosstalk */
+#define OUTPUT_RLGC 0x10      /* R, L and G at each frequency */
+#define OUTPUT_PLOT 0x20      /* .result_field_plot_data */
+#define OUTPUT_DUMP 0x40      /* .dump of the geometry */
+#define OUTPUT_PROGRESS 0x80  /* geometry listing and progress on stdout */
+#define OUTPUT_PLOT_BINARY 0x100 /* the plot data in binary, in place of text */
+#define OUTPUT_MODES 0x200    /* propagation modes, at each frequency with rlgc */
+#define OUTPUT_MIXED 0x400    /* differential and common modes of pairs */
+/* without "--outputs", what MMTL has always written */
+#define OUTPUT_DEFAULT (OUTPUT_CL | OUTPUT_Z0 | OUTPUT_RDC | OUTPUT_XTK | \
+                        OUTPUT_PLOT | OUTPUT_DUMP | OUTPUT_PROGRESS)
+#define OUTPUT_ALL (OUTPUT_DEFAULT | OUTPUT_RLGC | OUTPUT_MODES | OUTPUT_MIXED)
+
+/* defined in nmmtl_qsp_kernel, set by the main for the whole run */
+extern int OUTPUT_PRODUCTS;
+
 /* 1.06 The file cad$common:gpge_electro.attributes sets the maximum size for
    the attributes entered. It states that the SIG_NAME primitive attribute
    can be only 10 characters long. SIZE_SIG_NAME must be at least that big. */
@@ -144,8 +198,14 @@ extern const double INFINITE_SLOPE;
 
 /* Numerical algorithm constants */
 
-#define INTERP_ORDER 2
-#define INTERP_PTS (INTERP_ORDER + 1)
+#define INTERP_ORDER 2     /* default order of the element interpolation */
+#define MAX_INTERP_ORDER 3 /* highest order there are shape functions for */
+#define INTERP_PTS (MAX_INTERP_ORDER + 1) /* most nodes on one element */
+
+/* the order of interpolation of the elements being solved, from the
+   cross section's MESH_SETTINGS, and so how many nodes each has */
+extern thread_local int ELEMENT_ORDER;
+#define ELEMENT_PTS (ELEMENT_ORDER + 1)
 
 
 /* Various global external variables - tables of Legendre Numbers declared
@@ -214,7 +274,9 @@ typedef char *BIGPOINTER;
   Points is a linked list of coordinates for POLYGONS ONLY.  The next
   pointer is used to make a linked list of signals or all grounds.
   Conductivity is a pointer used for the self-inductance program
-  and should be set to NULL.
+  and should be set to NULL.  Block is the array the contour was
+  allocated in, together with the rest of its list, or NULL if it was
+  allocated on its own; nmmtl_free_contours frees either kind.
   */
 
 typedef struct contour
@@ -225,6 +287,7 @@ typedef struct contour
   double x0,y0,x1,y1;
   int primitive;
   char name[SIZE_SIG_NAME];
+  struct contour *block;
 } CONTOURS, *CONTOURS_P;
 
 
@@ -274,7 +337,9 @@ typedef struct dielectric
 
   Used to build up matching pairs of horizontal or vertical boundaries.
   At holds the y coordinate for horizontal sub segments, and the x coordinate
-  for vertical sub segments.  Start and end contain the endpoints.
+  for vertical sub segments.  Start and end contain the endpoints.  Group
+  is the place on its list of the sub segment a piece was split from, used
+  while pairing them up.
 
   */
 
@@ -285,6 +350,7 @@ typedef struct dielectric_sub_segments
   double start, end;
   double epsilon;
   int divisions;
+  int group;
 } DIELECTRIC_SUB_SEGMENTS;
 
 /*
@@ -311,10 +377,39 @@ typedef struct dielectric_segments
   int divisions;
   int segment_number;
   unsigned char end_in_conductor;
+  unsigned char removed;  /* taken off the list once intersections are done */
   unsigned int orientation; /* one of VERTICAL_ORIENTATION, HORIZONTAL_ORI */
 } DIELECTRIC_SEGMENTS, *DIELECTRIC_SEGMENTS_P;
 
 
+/*
+  Dielectric Segment Index
+
+  The dielectric segments as they stood before intersecting them with
+  the conductors, for looking up the ones near a conductor segment.
+  Group g is the segment groups[g] together with the pieces split off it
+  behind it on the list, up to groups[g+1]; groups[number_groups] is
+  NULL.  The horizontal and vertical intervals are sorted on at and
+  cover [low,high] along the interface.  Candidates has room for a
+  group number per group, for the answers to queries.
+*/
+
+typedef struct die_seg_interval
+{
+  double at, low, high;
+  int group;
+} DIE_SEG_INTERVAL, *DIE_SEG_INTERVAL_P;
+
+typedef struct die_seg_index
+{
+  int number_groups;
+  DIELECTRIC_SEGMENTS_P *groups;
+  int number_horizontal, number_vertical;
+  DIE_SEG_INTERVAL_P horizontal, vertical;
+  int *candidates;
+} DIE_SEG_INDEX, *DIE_SEG_INDEX_P;
+
+
 /*
   Circle Segments
 
@@ -338,6 +433,35 @@ typedef struct circle_segments
 } CIRCLE_SEGMENTS, *CIRCLE_SEGMENTS_P;
 
 
+/*
+  Circle Segment Index
+
+  The circle segments as they stood before intersecting them with the
+  dielectric interfaces, for looking up the ones near an interface.
+  Group g is the segment groups[g] together with the pieces split off it
+  behind it on the list, up to groups[g+1]; groups[number_groups] is
+  NULL.  by_x and by_y hold the box of each group sorted on x_min and
+  y_min, and x_reach[i] (y_reach[i]) is the largest x_max (y_max) of
+  by_x[0..i] (by_y[0..i]).  Candidates has room for a group number per
+  group, for the answers to queries.
+*/
+
+typedef struct cir_seg_box
+{
+  double x_min, x_max, y_min, y_max;
+  int group;
+} CIR_SEG_BOX, *CIR_SEG_BOX_P;
+
+typedef struct cir_seg_index
+{
+  int number_groups;
+  CIRCLE_SEGMENTS_P *groups;
+  CIR_SEG_BOX_P by_x, by_y;
+  double *x_reach, *y_reach;
+  int *candidates;
+} CIR_SEG_INDEX, *CIR_SEG_INDEX_P;
+
+
 /*
   Line Segments
 
@@ -382,7 +506,6 @@ typedef struct line_segments
 
 typedef struct delements
 {
-  struct delements *next;
   double xpts[INTERP_PTS],ypts[INTERP_PTS];
   double epsilonplus,epsilonminus;
   double normalx,normaly;
@@ -393,40 +516,231 @@ typedef struct delements
 
 /* Conductor elements
 
-   For celement: next is a pointer to the next element for the same conductor.
+   The elements of each conductor lie next to each other in the
+   element store, and the array of conductor_data structures gives
+   the first one and how many there are.
 
-   all conductor element lists start from an array of conductor_data
-   structures which points to the first celement, and then you can
-   follow the next pointer to access the rest of the list.
+   edge[0] and edge[1] are set if the start or end of the element is a
+   conductor edge, in which case nu and free_space_nu hold the edge
+   data for that end.
 
    */
 
-/* Edge data needed by conductor elements */
-
-typedef struct edgedata {
-  double nu;
-  double free_space_nu;
-} EDGEDATA, *EDGEDATA_P;
-
-/* the actual conductor elements */
-
 typedef struct celements {
-  struct celements *next;
-  EDGEDATA_P edge[2];
   double xpts[INTERP_PTS];
   double ypts[INTERP_PTS];
+  double nu[2];
+  double free_space_nu[2];
   double epsilon;
   int node[INTERP_PTS];
+  int edge[2];
 } CELEMENTS, *CELEMENTS_P;
 
-/* the head of the conductor element lists - will be used in an array */
+/* the range of elements of a conductor - will be used in an array */
 
 typedef struct conductor_data {
   CELEMENTS_P elements;
+  int number_elements;
   unsigned int node_start;
   unsigned int node_end;
 } CONDUCTOR_DATA, *CONDUCTOR_DATA_P;
 
+/* Element store
+
+   All the elements of a mesh.  While they are generated, the arrays
+   grow as needed and conductor[] records which conductor each
+   conductor element belongs to.  When generation is done, the
+   elements are moved into a single allocation, the conductor
+   elements grouped by conductor, celements points to it and
+   finished is set.
+
+   */
+
+typedef struct element_store {
+  CELEMENTS_P celements;
+  int number_celements;
+  int allocated_celements;
+  int *conductor;
+  DELEMENTS_P delements;
+  int number_delements;
+  int allocated_delements;
+  int finished;
+} ELEMENT_STORE, *ELEMENT_STORE_P;
+
+
+/* Plot writer
+
+   Writes the field plot data of a mesh on a thread of its own (see
+   nmmtl_plot_writer.cpp).  The conductors' charge distributions wait
+   in the queue from first to last until it gets to them.
+
+   */
+
+typedef struct plot_solution
+{
+  CONTOURS_P signal;
+  double *sigma_vector;
+  struct plot_solution *next;
+} PLOT_SOLUTION, *PLOT_SOLUTION_P;
+
+typedef struct plot_writer
+{
+  FILE *file;
+  int binary;
+  int conductor_counter;
+  ELEMENT_STORE_P element_store;
+  CONDUCTOR_DATA_P conductor_data;
+  int node_point_counter;
+  int element_order;
+  int threaded;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t ready;
+  PLOT_SOLUTION_P first, last;
+  int writing, finished;
+} PLOT_WRITER, *PLOT_WRITER_P;
+
+
+/* Field grid
+
+   The rectangular grid the potential and electric field of each
+   conductor's solution are evaluated on (see nmmtl_field_grid.cpp): nx
+   by ny points from x0,y0 to x1,y1, in meters, and the file they are
+   written to.
+   */
+
+typedef struct field_grid
+{
+  double x0, x1, y0, y1;
+  int nx, ny;
+  FILE *file;
+} FIELD_GRID, *FIELD_GRID_P;
+
+
+/* Mesh refinement
+
+   For automatic mesh refinement, the factors the divisions of the
+   segments are scaled by: conductor[] for the segments of each
+   conductor, where [0] covers the ground wires and the ground planes,
+   and dielectric for the dielectric-dielectric interfaces.
+   */
+
+typedef struct mesh_refinement {
+  double *conductor;
+  double dielectric;
+} MESH_REFINEMENT, *MESH_REFINEMENT_P;
+
+/* Mesh error
+
+   The estimates of the error in a mesh that guide refinement: for the
+   same regions as mesh_refinement, the largest jump in charge density
+   between neighbouring elements, weighted by their length, as a
+   fraction of the total charge; the asymmetry ratios of the inductance
+   and electrostatic induction matrices; and the number of nodes.
+   */
+
+typedef struct mesh_error {
+  double *conductor;
+  double dielectric;
+  double inductance_asymmetry;
+  double induction_asymmetry;
+  unsigned int nodes;
+} MESH_ERROR, *MESH_ERROR_P;
+
+/* Mesh settings
+
+   How a cross section is meshed and solved beyond the divisions CSEG
+   and DSEG give: the interpolation order of the elements; the relative
+   change in the results automatic mesh refinement stops at, 0 for a
+   single solve; how many meshes the results are extrapolated from, 0
+   for a single solve; and how fast the elements grow away from the
+   conductor corners and from the part of the upper ground plane over
+   the conductors.  Values out of range are taken as the defaults.
+   */
+
+typedef struct mesh_settings {
+  int element_order;
+  double refine;
+  int extrapolate;
+  double corner_grading;
+  double plane_grading;
+} MESH_SETTINGS, *MESH_SETTINGS_P;
+
+/* Skin effect
+
+   What the kernel needs to give the resistance of the conductors at
+   frequencies where the current flows in a thin layer at their
+   surfaces, and what it gives back: the conductivity of each conductor,
+   the ground (0) and its lower ground plane included, and the
+   resistance matrix at 1 Hz.  The resistance goes as the square root of
+   the frequency.
+   */
+
+typedef struct skin_effect {
+  double *conductivity;
+  double **resistance;
+} SKIN_EFFECT, *SKIN_EFFECT_P;
+
+/* Sensitivity
+
+   The parameters the kernel gives the derivatives of the electrostatic
+   induction and inductance matrices with respect to, and those
+   derivatives, one n x n matrix per parameter.  A permittivity
+   parameter changes every element bordering a dielectric of that
+   relative permittivity.  A thickness or width parameter moves the y
+   or x coordinate of every element point by the piecewise linear
+   displacement the knots give, per meter of change in the value: the
+   layers above a thicker layer move up, and a wider conductor pushes
+   its sides out into the gaps next to it.
+
+   The loss parameter scales every permittivity by one plus the value
+   times its loss tangent, the knots pairing each relative permittivity
+   with its tangent.  The derivative of B along it is G/w, which goes
+   to the caller's conductance matrix rather than into induction.
+   */
+
+#define SENSITIVITY_PERMITTIVITY 0
+#define SENSITIVITY_THICKNESS 1
+#define SENSITIVITY_WIDTH 2
+#define SENSITIVITY_LOSS 3
+
+typedef struct sensitivity_parameter {
+  int kind;
+  int layer;                  /* thickness: 1 for the lowest layer */
+  char name[SIZE_SIG_NAME];   /* width: the signal */
+  double value;               /* relative permittivity, or meters */
+  int number_knots;
+  double (*knots)[2];         /* coordinate, displacement, or
+                                 permittivity, loss tangent */
+} SENSITIVITY_PARAMETER, *SENSITIVITY_PARAMETER_P;
+
+typedef struct sensitivity {
+  int number_parameters;
+  SENSITIVITY_PARAMETER_P parameters;
+  double ***induction;        /* dB/dp */
+  double ***inductance;       /* dL/dp */
+  SENSITIVITY_PARAMETER loss; /* the loss tangents */
+  double **conductance;       /* G/w, the caller's, NULL for none */
+} SENSITIVITY, *SENSITIVITY_P;
+
+/* Propagation modes
+
+   The modes of the lines at one point of a sweep.  Column m of voltage
+   holds the line voltages of mode m, scaled to unit length, and column m
+   of current its line currents, scaled so that the transpose of voltage
+   times current is the identity: V = voltage Vm and I = current Im.
+   The impedance of mode m is then Vm/Im.  The modes are in order of
+   increasing velocity.  The attenuation is zero without losses.
+   */
+
+typedef struct modes {
+  double *velocity;
+  double *impedance;
+  double *attenuation;
+  double **voltage;
+  double **current;
+} MODES, *MODES_P;
+
 
 /*
   Point
@@ -469,7 +783,9 @@ typedef struct arc{
   fpksl
 
   Floating point keyed sorted list - used for generating a sorted linked
-  list based on a floating point (double) key.
+  list based on a floating point (double) key.  The entries of a list,
+  and the data they point to, are allocated in one block headed by the
+  first entry.
 
   */
 typedef struct fpksl
@@ -497,7 +813,7 @@ typedef FLT_KEY_LIST_P SORTED_GND_DIE_LIST_P;
 
   gnd_die_list
 
-  Unsorted List of dielectric regions along ground planes.  Compare to
+  Unsorted array of dielectric regions along ground planes.  Compare to
   SORTED_GND_DIE_LIST.
   */
 
@@ -505,7 +821,6 @@ typedef struct gnd_die_list
 {
   double start,end;
   double epsilon;
-  struct gnd_die_list *next;
 } GND_DIE_LIST, *GND_DIE_LIST_P;
 
 
@@ -534,6 +849,86 @@ typedef struct extent_data
 } EXTENT_DATA, *EXTENT_DATA_P;
 
 
+/*
+
+   xsctn_object
+
+   One object of a cross section as described by the user, through the
+   mmtl_xsctn_* interface or a .xsctn file.  Conductor sets keep their
+   number and pitch; nmmtl_xsctn_expand turns them into contours.
+   Kind is one of the XSCTN_* constants, type is the keyletter used in
+   generated signal names ('R', 'T', 'C' or 'G').  Name is NULL for a
+   ground plane, and for dielectrics not read from a file.  Dielectric
+   layers keep their thickness in height.  Points holds number_points (x,y) pairs
+   for a polygon conductor.
+
+   */
+
+#define XSCTN_GROUND_PLANE 0
+#define XSCTN_DIELECTRIC_LAYER 1
+#define XSCTN_RECTANGLE_DIELECTRIC 2
+#define XSCTN_CONDUCTORS 3
+
+typedef struct xsctn_object
+{
+  int kind;
+  int primitive;
+  int type;
+  char *name;
+  double width, top_width, bottom_width, height, diameter;
+  double x_offset, y_offset, pitch;
+  int number;
+  double permittivity, loss_tangent;
+  double conductivity;
+  int number_points;
+  double *points;
+} XSCTN_OBJECT, *XSCTN_OBJECT_P;
+
+/*
+
+   xsctn_arena_block
+
+   One block of the arena a cross section keeps the names and polygon
+   points of its objects in.  The data follows the header; blocks are
+   only ever freed all together.
+
+   */
+
+typedef struct xsctn_arena_block
+{
+  struct xsctn_arena_block *next;
+  size_t used, size;
+} XSCTN_ARENA_BLOCK, *XSCTN_ARENA_BLOCK_P;
+
+/*
+
+   mmtl_xsctn
+
+   The cross section behind the opaque MMTL_XSCTN of mmtl_bem.h: the
+   header attributes and the objects in the order they were added, in
+   one contiguous array.  Everything the objects point to comes out of
+   the arena, newest block first.
+
+   */
+
+struct mmtl_xsctn
+{
+  int cntr_seg, pln_seg;
+  double coupling, risetime;
+  double conductivity;
+  double polygon_tolerance;
+  int sensitivities;
+  MESH_SETTINGS settings;
+  int number_frequencies;
+  double frequencies[MMTL_MAX_FREQUENCIES];
+  int number_pairs;
+  char pairs[MMTL_MAX_PAIRS][2][SIZE_SIG_NAME];
+  int number_objects, allocated_objects;
+  XSCTN_OBJECT_P objects;
+  XSCTN_ARENA_BLOCK_P arena;
+};
+
+
 /****************************************
  *                                       *
  *   Function Prototypes                 *
@@ -555,7 +950,10 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
             double *propagation_velocity,
             double *equivalent_dielectric,
             FILE *output_file1,
-            FILE *output_file2);
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings);
 
 /*
   Notes:
@@ -625,8 +1023,25 @@ int nmmtl_xtk_calculate(int number_conductors,
   4) returns a status of FAIL or SUCCESS.
   */
 
-/* nmmtl_add_to_sorted_list.c */
-void nmmtl_add_to_sorted_list(FLT_KEY_LIST_P *list, double key, char *data);
+/* mmtl_bem.cxx */
+int nmmtl_solve_lists(int cntr_seg,
+                      int pln_seg,
+                      double coupling,
+                      double risetime,
+                      double conductivity,
+                      double half_minimum_dimension,
+                      int gnd_planes,
+                      struct dielectric *dielectrics,
+                      struct contour *signals,
+                      struct contour *groundwires,
+                      int num_signals,
+                      int number_frequencies,
+                      double *frequencies,
+                      int number_pairs,
+                      char (*pairs)[2][SIZE_SIG_NAME],
+                      int sensitivities,
+                      MESH_SETTINGS_P settings,
+                      MMTL_RESULTS_P *results);
 
 /* nmmtl_angle_of_intersections.c */
 double nmmtl_angle_of_intersection(double x1, double y1, double x2, double y2);
@@ -634,7 +1049,13 @@ double nmmtl_angle_of_intersection(double x1, double y1, double x2, double y2);
 /* nmmtl_assemble.cxx */
 void nmmtl_assemble(int conductor_counter,
         CONDUCTOR_DATA_P conductor_data,
-        DELEMENTS_P die_elements,
+        ELEMENT_STORE_P element_store,
+        double length_scale,
+        double **assemble_matrix);
+
+void nmmtl_assemble_dielectric(int conductor_counter,
+        CONDUCTOR_DATA_P conductor_data,
+        ELEMENT_STORE_P element_store,
         double length_scale,
         double **assemble_matrix);
 
@@ -644,11 +1065,6 @@ void nmmtl_assemble_free_space(int conductor_counter,
              double **assemble_matrix);
 
 
-/* nmmtl_build_gnd_die_list.cxx */
-GND_DIE_LIST_P nmmtl_build_gnd_die_list(GND_DIE_LIST_P *head,
-                                        GND_DIE_LIST_P tail,
-                                        DIELECTRICS_P dielectrics);
-
 /* nmmtl_charge.cxx */
 void nmmtl_charge(double *sigma_vector,
       int conductor_counter,
@@ -696,6 +1112,22 @@ int nmmtl_combine_die(struct dielectric *dielectrics,
           SORTED_GND_DIE_LIST_P *lower_sorted_gdl,
           SORTED_GND_DIE_LIST_P *upper_sorted_gdl);
 
+/* nmmtl_cir_seg_index.cxx */
+int nmmtl_cir_seg_index_build(CIRCLE_SEGMENTS_P circle_segments,
+                              CIR_SEG_INDEX_P index);
+
+int nmmtl_cir_seg_index_query(CIR_SEG_INDEX_P index,
+                              double x_min, double x_max,
+                              double y_min, double y_max);
+
+void nmmtl_cir_seg_index_free(CIR_SEG_INDEX_P index);
+
+/* nmmtl_conductance.cxx */
+int nmmtl_conductance_parameters(struct dielectric *dielectrics,
+                                 int conductor_counter,
+                                 double **conductance,
+                                 SENSITIVITY_P sensitivity);
+
 /* nmmtl_containment.c */
 int nmmtl_seg_in_die_rect(DIELECTRICS_P die_rect,LINESEG_P line);
 
@@ -718,6 +1150,18 @@ int nmmtl_determine_arc_intersectio(CIRCLE_SEGMENTS_P *circle_segments,
 int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
                                   DIELECTRIC_SEGMENTS_P *dielectric_segments);
 
+/* nmmtl_die_seg_index.cxx */
+int nmmtl_die_seg_index_build(DIELECTRIC_SEGMENTS_P dielectric_segments,
+                              DIE_SEG_INDEX_P index);
+
+int nmmtl_die_seg_index_query(DIE_SEG_INDEX_P index,
+                              double x_min, double x_max,
+                              double y_min, double y_max);
+
+void nmmtl_die_seg_index_compact(DIELECTRIC_SEGMENTS_P *dielectric_segments);
+
+void nmmtl_die_seg_index_free(DIE_SEG_INDEX_P index);
+
 /* nmmtl_dump.cxx */
 void nmmtl_dump(FILE *dump_file,
                 int cntr_seg,
@@ -727,7 +1171,7 @@ void nmmtl_dump(FILE *dump_file,
                 struct contour *signals,
                 int conductor_counter,
                 CONDUCTOR_DATA_P conductor_data,
-                DELEMENTS_P die_elements,
+                ELEMENT_STORE_P element_store,
                 unsigned int node_point_counter,
                 unsigned int highest_conductor_node);
 
@@ -751,6 +1195,18 @@ void nmmtl_dump_geometry(int cntr_seg,
                          struct contour *signals,
                          struct contour *groundwires);
 
+/* nmmtl_element_store.cxx */
+CELEMENTS_P nmmtl_element_store_add_c(ELEMENT_STORE_P element_store,
+                                      int conductor);
+
+DELEMENTS_P nmmtl_element_store_add_d(ELEMENT_STORE_P element_store);
+
+int nmmtl_element_store_finish(ELEMENT_STORE_P element_store,
+                               int conductor_counter,
+                               CONDUCTOR_DATA_P conductor_data);
+
+void nmmtl_element_store_free(ELEMENT_STORE_P element_store);
+
 /* nmmtl_evaluate_circles.cxx */
 int nmmtl_evaluate_circles(int cntr_seg,
 #ifndef NO_HALF_MIN_CHECKING
@@ -794,6 +1250,16 @@ int nmmtl_evaluate_rectangles(int cntr_seg,
             LINE_SEGMENTS_P *segments,
             EXTENT_DATA_P extent_data);
 
+/* nmmtl_field_grid.cxx */
+int nmmtl_field_grid_spec(const char *spec, FIELD_GRID_P grid);
+void nmmtl_field_grid_header(FIELD_GRID_P grid);
+int nmmtl_field_grid_evaluate(FIELD_GRID_P grid,
+                              CONTOURS_P signal,
+                              int conductor_counter,
+                              CONDUCTOR_DATA_P conductor_data,
+                              ELEMENT_STORE_P element_store,
+                              double *sigma_vector);
+
 /* nmmtl_fill_die_gaps.cxx */
 int nmmtl_fill_die_gaps(int orientation,int *segment_number,
       double top_stack,
@@ -835,7 +1301,8 @@ double nmmtl_find_nu(double epsilon1,
                      double theta1,
                      double theta2);
 
-double nmmtl_nu_function(double *nu);
+double nmmtl_nu_function(double nu, double epsilon_term, double theta2,
+                         double theta_term);
 
 /* nmmtl_intersections.c */
 POINT_P nmmtl_cd_intersect(CONTOURS_P this_contour,
@@ -899,10 +1366,24 @@ int
         SORTED_GND_DIE_LIST_P *lower_sorted_gdl,
         SORTED_GND_DIE_LIST_P *upper_sorted_gdl);
 
+/* nmmtl_free.cxx */
+void nmmtl_free_contours(struct contour *contours);
+
+void nmmtl_free_dielectrics(struct dielectric *dielectrics);
+
+void nmmtl_free_segments(LINE_SEGMENTS_P conductor_ls,
+                         CIRCLE_SEGMENTS_P conductor_cs,
+                         DIELECTRIC_SEGMENTS_P dielectric_segments);
+
+void nmmtl_free_sorted_list(FLT_KEY_LIST_P list);
+
+void nmmtl_free_elements(CONDUCTOR_DATA_P conductor_data,
+                         ELEMENT_STORE_P element_store);
+
 /* nmmtl_genel.cxx */
 int nmmtl_generate_elements(int conductor_counter,
           CONDUCTOR_DATA_P *conductor_data,
-          DELEMENTS_P *die_elements,
+          ELEMENT_STORE_P element_store,
           unsigned int *node_point_counter,
           unsigned int *highest_conductor_node,
           LINE_SEGMENTS_P conductor_ls,
@@ -918,24 +1399,23 @@ int nmmtl_generate_elements(int conductor_counter,
 
 /* nmmtl_genel_ccs.cxx */
 int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
-        CELEMENTS_P *head,
-        CELEMENTS_P *tail,
+        ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter);
 
 /* nmmtl_genel_cls.cxx */
 int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
-        CELEMENTS_P *head,
-        CELEMENTS_P *tail,
+        ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter);
 
 /* nmmtl_genel_die.cxx */
-DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
-                                        unsigned int *node_point_counter,
-                                        int *number_elements,
-                                        EXTENT_DATA_P extent_data);
+int nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
+                                ELEMENT_STORE_P element_store,
+                                unsigned int *node_point_counter,
+                                int *number_elements,
+                                EXTENT_DATA_P extent_data);
 
 /* nmmtl_genel_gnd.cxx */
-int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
+int nmmtl_generate_elements_gnd(ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter,
         int gnd_planes,
         int pln_seg,
@@ -945,7 +1425,8 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
 #ifdef GND_PLANE_COND_PROJECTION
         COND_PROJ_LIST_P cond_projections,
 #endif
-        SORTED_GND_DIE_LIST_P upper_sorted_gdl);
+        SORTED_GND_DIE_LIST_P upper_sorted_gdl,
+        EXTENT_DATA_P extent_data);
 
 /* nmmtl_intersections.cxx */
 POINT_P nmmtl_cd_intersect(CONTOURS_P contour,
@@ -1029,6 +1510,18 @@ void nmmtl_interval_self_d(double x,
          double normalx,
          double normaly);
 
+int nmmtl_interval_sources_c(CELEMENTS_P cel,
+                             double *sigma_vector,
+                             double *X,
+                             double *Y,
+                             double *charge);
+
+int nmmtl_interval_sources_d(DELEMENTS_P del,
+                             double *sigma_vector,
+                             double *X,
+                             double *Y,
+                             double *charge);
+
 /* nmmtl_jacobian.cxx */
 void nmmtl_jacobian_d(double local, DELEMENTS_P del, double *Jacobian);
 
@@ -1059,12 +1552,44 @@ int
            int orientation,int segment_number,
            double overlap_left, double overlap_right);
 
+/* nmmtl_mixed_mode.cxx */
+int nmmtl_mixed_mode_pairs(struct contour *signals,
+                           int number_names,
+                           char (*names)[2][SIZE_SIG_NAME],
+                           int (*pairs)[2]);
+void nmmtl_mixed_mode_calculate(int number_pairs,
+                                int (*pairs)[2],
+                                double **electrostatic_induction,
+                                double **inductance,
+                                double *differential_impedance,
+                                double *common_impedance,
+                                double *differential_velocity,
+                                double *common_velocity);
+
+/* nmmtl_modal_calculate.cxx */
+int nmmtl_modal_calculate(int conductor_counter,
+                          double **electrostatic_induction,
+                          int number_points,
+                          double ***inductance,
+                          double ***resistance,
+                          double ***conductance,
+                          MODES_P modes);
+
+/* nmmtl_monte_carlo.cxx */
+int nmmtl_monte_carlo(char *filename,
+                      int samples,
+                      unsigned long seed,
+                      int workers,
+                      int number_parameters,
+                      char **words,
+                      MESH_SETTINGS_P settings);
+
 /* nmmtl_nl_expand.cxx */
-void nmmtl_nl_expand(double xstart, double xend, double incr_start,
+int nmmtl_nl_expand(double xstart, double xend, double incr_start,
          double epsilonplus,
                      double epsilonminus,double normaly,double y,
                      unsigned int *node_point_counter,
-                     DELEMENTS_P *element_p,
+                     ELEMENT_STORE_P element_store,
                      int *number_elements,unsigned int common_node);
 
 /* nmmtl_orphans.cxx */
@@ -1103,12 +1628,62 @@ void nmmtl_output_headers(FILE *output_file,
 void nmmtl_output_matrices(FILE *output_fp, double **electrostatic_induction,
          double **inductance, struct contour *signal);
 
+/* nmmtl_output_rlgc.cxx */
+void nmmtl_output_rlgc(FILE *output_fp, double frequency,
+                       double **resistance, double **inductance,
+                       double **conductance, struct contour *signals);
+
+/* nmmtl_output_mixed_mode.cxx */
+void nmmtl_output_mixed_mode(FILE *output_fp, int number_pairs,
+                             int (*pairs)[2],
+                             double *differential_impedance,
+                             double *common_impedance,
+                             double *differential_velocity,
+                             double *common_velocity,
+                             struct contour *signals);
+
+/* nmmtl_output_modal.cxx */
+void nmmtl_output_modal(FILE *output_fp, double frequency,
+                        int number_conductors, MODES_P modes,
+                        struct contour *signals);
+
+/* nmmtl_output_sensitivity.cxx */
+void nmmtl_output_sensitivity(FILE *output_fp, int number_conductors,
+                              SENSITIVITY_P sensitivity,
+                              struct contour *signals);
+
 /* nmmtl_overlap_parallel_set.cxx */
 int nmmtl_overlap_parallel_seg(struct dielectric_sub_segments *list1,
              struct dielectric_sub_segments *list2,
              double *overlap_left, double *overlap_right,
              int *left_overhang, int *right_overhang);
 
+/* nmmtl_plot_writer.cxx */
+PLOT_WRITER_P nmmtl_plot_writer_start(FILE *file,
+                                      int binary,
+                                      int conductor_counter,
+                                      ELEMENT_STORE_P element_store,
+                                      CONDUCTOR_DATA_P conductor_data,
+                                      int node_point_counter);
+void nmmtl_plot_writer_queue(PLOT_WRITER_P writer,
+                             CONTOURS_P signal,
+                             double *sigma_vector);
+void nmmtl_plot_writer_drain(PLOT_WRITER_P writer);
+void nmmtl_plot_writer_finish(PLOT_WRITER_P writer);
+void nmmtl_plot_binary_header(FILE *plotFile,
+                              int units,
+                              int gnd_planes,
+                              double top_ground_plane_thickness,
+                              double bottom_ground_plane_thickness);
+void nmmtl_plot_binary_geometry(FILE *plotFile,
+                                double upper,
+                                double lower,
+                                double right,
+                                double left,
+                                struct contour *signals,
+                                struct contour *groundwires,
+                                struct dielectric *dielectrics);
+
 /* nmmtl_parse_xsctn.cxx */
 int nmmtl_parse_xsctn(char *filename,
       int *cntr_seg,
@@ -1125,7 +1700,34 @@ int nmmtl_parse_xsctn(char *filename,
       struct contour **groundwires,
       int *num_signals,
       int *num_grounds,
-      int *units);
+      int *units,
+      int *number_frequencies,
+      double *frequencies,
+      int *number_pairs,
+      char (*pairs)[2][SIZE_SIG_NAME]);
+
+int nmmtl_parse_xsctn_buffer(const char *text,
+      size_t length,
+      const char *source_name,
+      int *cntr_seg,
+      int *pln_seg,
+      double *coupling,
+      double *risetime,
+      double *conductivity,
+      double *half_minimum_dimension,
+      int *gnd_planes,
+      double *top_ground_plane_thickness,
+      double *bottom_ground_plane_thickness,
+      struct dielectric **dielectrics,
+      struct contour **signals,
+      struct contour **groundwires,
+      int *num_signals,
+      int *num_grounds,
+      int *units,
+      int *number_frequencies,
+      double *frequencies,
+      int *number_pairs,
+      char (*pairs)[2][SIZE_SIG_NAME]);
 
 /* nmmtl_projections.cxx */
 void nmmtl_project_polygon(COND_PROJ_LIST_P *cond_projections,
@@ -1137,10 +1739,31 @@ void nmmtl_project_rectangle(COND_PROJ_LIST_P *cond_projections,
 void nmmtl_project_circle(COND_PROJ_LIST_P *cond_projections,
                           CONTOURS_P contour);
 
+/* nmmtl_qsp_extrapolate.cxx */
+int nmmtl_qsp_extrapolate(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings);
+
 /* nmmtl_qsp_kernel.cxx */
 int nmmtl_qsp_kernel(int conductor_counter,
          CONDUCTOR_DATA_P conductor_data,
-         DELEMENTS_P die_elements,
+         ELEMENT_STORE_P element_store,
          unsigned int node_point_counter,
          unsigned int highest_conductor_node,
          double length_scale,
@@ -1151,7 +1774,65 @@ int nmmtl_qsp_kernel(int conductor_counter,
          double *equivalent_dielectric,
          FILE *output_file1,
          FILE *output_file2,
-         CONTOURS_P signals);
+         CONTOURS_P signals,
+         MESH_ERROR_P mesh_error,
+         SKIN_EFFECT_P skin_effect,
+         SENSITIVITY_P sensitivity);
+
+/* nmmtl_qsp_calculate.cxx */
+int nmmtl_qsp_solve_mesh(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            MESH_REFINEMENT_P refinement,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            MESH_ERROR_P mesh_error,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings);
+void nmmtl_mesh_settings_default(MESH_SETTINGS_P settings);
+
+/* nmmtl_qsp_refine.cxx */
+int nmmtl_qsp_refine(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings);
+int nmmtl_refine_divisions(int divisions, double factor);
+void nmmtl_refine_segments(MESH_REFINEMENT_P refinement,
+                           LINE_SEGMENTS_P conductor_ls,
+                           CIRCLE_SEGMENTS_P conductor_cs,
+                           DIELECTRIC_SEGMENTS_P dielectric_segments);
+void nmmtl_mesh_error(double *sigma_vector,
+                      int conductor_counter,
+                      CONDUCTOR_DATA_P conductor_data,
+                      ELEMENT_STORE_P element_store,
+                      MESH_ERROR_P mesh_error);
 
 /* nmmtl_retrieve.cxx */
 int nmmtl_retrieve(FILE *retrieve_file,
@@ -1163,10 +1844,46 @@ int nmmtl_retrieve(FILE *retrieve_file,
              int *sig_cnt,
              int *pconductor_counter,
              CONDUCTOR_DATA_P *pconductor_data,
-             DELEMENTS_P *pdie_elements,
+             ELEMENT_STORE_P element_store,
              unsigned int *pnode_point_counter,
              unsigned int *phighest_conductor_node);
 
+/* nmmtl_rlgc_calculate.cxx */
+void nmmtl_rlgc_calculate(int conductor_counter,
+                          double frequency,
+                          double **inductance,
+                          double **skin_resistance,
+                          double **conductance,
+                          double **resistance_f,
+                          double **inductance_f,
+                          double **conductance_f);
+
+/* nmmtl_sensitivity.cxx */
+int nmmtl_sensitivity_parameters(struct dielectric *dielectrics,
+                                 struct contour *signals,
+                                 struct contour *groundwires,
+                                 int conductor_counter,
+                                 SENSITIVITY_P sensitivity);
+int nmmtl_sensitivity_calculate(int conductor_counter,
+                                CONDUCTOR_DATA_P conductor_data,
+                                ELEMENT_STORE_P element_store,
+                                unsigned int node_point_counter,
+                                unsigned int highest_conductor_node,
+                                double length_scale,
+                                double **assemble_matrix,
+                                int *ipvt,
+                                double **sigma,
+                                double **free_space_matrix,
+                                int *free_space_ipvt,
+                                double **free_space_sigma,
+                                double **inductance,
+                                SENSITIVITY_P sensitivity);
+void nmmtl_sensitivity_free(SENSITIVITY_P sensitivity);
+
+/* nmmtl_serve.cxx */
+int nmmtl_serve(const char *socket_path, int workers,
+                MESH_SETTINGS_P settings);
+
 /* nmmtl_set_offset.cxx */
 int nmmtl_set_offset(double offset,struct dielectric *dielectrics,
          struct contour *signals,
@@ -1177,10 +1894,27 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
 
 void nmmtl_shape(double point, double *shape);
 
+int nmmtl_element_interior(double *xpts, double *ypts, int *node,
+                           unsigned int *node_point_counter);
+
+/* nmmtl_simplify_polygon.cxx */
+int nmmtl_simplify_polygon(const double *points, int number_points,
+                           double tolerance, unsigned char *keep);
+
+/* nmmtl_skin_effect.cxx */
+void nmmtl_skin_effect(int conductor_counter,
+                       CONDUCTOR_DATA_P conductor_data,
+                       double **free_space_sigma,
+                       double **inductance,
+                       SKIN_EFFECT_P skin_effect);
+void nmmtl_skin_effect_conductivity(double conductivity,
+                                    CONTOURS_P signals,
+                                    double *conductor_conductivity);
+
 /* nmmtl_sort_gnd_die_list.cxx */
-void nmmtl_sort_gnd_die_list(GND_DIE_LIST_P lower_gdl_head,
+void nmmtl_sort_gnd_die_list(GND_DIE_LIST_P lower_gdl, int number_lower_gdl,
            SORTED_GND_DIE_LIST_P *lower_sorted_gdl,
-           GND_DIE_LIST_P upper_gdl_head,
+           GND_DIE_LIST_P upper_gdl, int number_upper_gdl,
            SORTED_GND_DIE_LIST_P *upper_sorted_gdl,
            double left, double right);
 
@@ -1196,9 +1930,66 @@ void plotFileInitialization(FILE *plotFile,
           double top_ground_plane_thickness,
           double bottom_ground_plane_thickness);
 
+/* nmmtl_synthesize.cxx */
+int nmmtl_synthesize(char *filename,
+                     const char *conductor,
+                     const char *parameter,
+                     int differential,
+                     double target,
+                     MESH_SETTINGS_P settings);
+
 /* nmmtl_unload.cxx */
 void nmmtl_unload(double *potential_vector,
       int conductor_number,
       CONDUCTOR_DATA_P conductor_data);
 
+int nmmtl_xsctn_read(MMTL_XSCTN_P xsctn,
+                     const char *text,
+                     size_t length,
+                     const char *source_name);
+
+/* nmmtl_write_plot_data.cxx */
+void nmmtl_write_plot_data(CONTOURS_P signal,
+                           int conductor_counter,
+                           ELEMENT_STORE_P element_store,
+                           CONDUCTOR_DATA_P conductor_data,
+                           double *sigma_vector,
+                           FILE *outputFile);
+
+/* nmmtl_xsctn.cxx */
+void *nmmtl_xsctn_arena_alloc(MMTL_XSCTN_P xsctn, size_t size);
+
+int nmmtl_xsctn_expand(MMTL_XSCTN_P xsctn,
+                       int *cntr_seg,
+                       int *pln_seg,
+                       double *coupling,
+                       double *risetime,
+                       double *conductivity,
+                       double *half_minimum_dimension,
+                       int *gnd_planes,
+                       double *top_ground_plane_thickness,
+                       double *bottom_ground_plane_thickness,
+                       struct dielectric **dielectrics,
+                       struct contour **signals,
+                       struct contour **groundwires,
+                       int *num_signals,
+                       int *num_grounds);
+
+int nmmtl_xsctn_outline_elements(const double *points, int number_points,
+                                 const unsigned char *keep, int cntr_seg,
+                                 int *sides, int *elements);
+
+int nmmtl_xsctn_finish(double total_width,
+                       double offset,
+                       double highest_dielectric,
+                       double minimum_dimension,
+                       double *half_minimum_dimension,
+                       int *gnd_planes,
+                       double *top_ground_plane_thickness,
+                       double *bottom_ground_plane_thickness,
+                       struct dielectric **dielectrics,
+                       struct contour **signals,
+                       struct contour **groundwires,
+                       int *num_grounds);
+
 #endif
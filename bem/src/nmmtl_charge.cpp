@@ -68,7 +68,7 @@ void nmmtl_charge(double *sigma_vector,
       CONDUCTOR_DATA_P conductor_data,
       double *electrostatic_induction) {
   int cond_num;
-  CELEMENTS_P cel;
+  CELEMENTS_P cel,cel_end;
   int Legendre_counter;
   double Jacobian;
   int i;
@@ -80,14 +80,15 @@ void nmmtl_charge(double *sigma_vector,
     /* zero it out */
     electrostatic_induction[cond_num-1] = 0.0;
 
-    cel=conductor_data[cond_num].elements;
-    while(cel != NULL) {
+    cel = conductor_data[cond_num].elements;
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    while(cel < cel_end) {
       for(Legendre_counter = 0; Legendre_counter < Legendre_root_c_max; Legendre_counter++) {
-        if(cel->edge[0] != NULL || cel->edge[1] != NULL) {
+        if(cel->edge[0] || cel->edge[1]) {
         /* if given edge is really an edge, set the true value of nu,
            otherwise, don't really care */
-        nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-        //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+        nu0 = cel->edge[0] ? cel->nu[0] : 0;
+        //nu1 = cel->edge[1] ? cel->nu[1] : 0;
         //nmmtl_shape_c_edge(Legendre_root_c[Legendre_counter],shape,cel,nu0,nu1);
         nmmtl_shape_c_edge(Legendre_root_c[Legendre_counter],shape,cel,nu0);
       } else {
@@ -97,14 +98,14 @@ void nmmtl_charge(double *sigma_vector,
       nmmtl_jacobian_c(Legendre_root_c[Legendre_counter],cel,&Jacobian);
 
       /* now add in the contributions to the the basis points */
-      for (i=0;i < INTERP_PTS;i++)
+      for (i=0;i < ELEMENT_PTS;i++)
         electrostatic_induction[cond_num-1] +=
           cel->epsilon * Legendre_weight_c[Legendre_counter] *
             shape[i] * sigma_vector[cel->node[i]] * Jacobian;
 
       } /* for looping on the Legendre points */
 
-      cel = cel->next;
+      cel++;
     } /* while looping on elements of particular conductor */
   } /* for all conductors */
 }
@@ -149,7 +150,7 @@ void nmmtl_charge_free_space(double *sigma_vector,
            double *electrostatic_induction)
 {
   int cond_num;
-  CELEMENTS_P cel;
+  CELEMENTS_P cel,cel_end;
   int Legendre_counter;
   double Jacobian;
   int i;
@@ -162,18 +163,19 @@ void nmmtl_charge_free_space(double *sigma_vector,
     /* zero it out */
     electrostatic_induction[cond_num-1] = 0.0;
 
-    cel=conductor_data[cond_num].elements;
-    while(cel != NULL)
+    cel = conductor_data[cond_num].elements;
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    while(cel < cel_end)
     {
       for(Legendre_counter = 0; Legendre_counter < Legendre_root_c_max;
     Legendre_counter++)
       {
-  if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+  if(cel->edge[0] || cel->edge[1])
   {
     /* if given edge is really an edge, set the true value of nu,
        otherwise, don't really care */
-    nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-    //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+    nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+    //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
     //nmmtl_shape_c_edge(Legendre_root_c[Legendre_counter],shape,cel,nu0,nu1);
     nmmtl_shape_c_edge(Legendre_root_c[Legendre_counter],shape,cel,nu0);
   }
@@ -183,14 +185,14 @@ void nmmtl_charge_free_space(double *sigma_vector,
   nmmtl_jacobian_c(Legendre_root_c[Legendre_counter],cel,&Jacobian);
 
   /* now add in the contributions to the the basis points */
-  for(i=0;i < INTERP_PTS;i++)
+  for(i=0;i < ELEMENT_PTS;i++)
     electrostatic_induction[cond_num-1] +=
       AIR_CONSTANT * Legendre_weight_c[Legendre_counter] *
         shape[i] * sigma_vector[cel->node[i]] * Jacobian;
 
       } /* for looping on the Legendre points */
 
-      cel = cel->next;
+      cel++;
 
     } /* while looping on elements of particular conductor */
   } /* for all conductors */
@@ -0,0 +1,369 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the index of conductor circle segments used while finding
+  their intersections with the dielectric interfaces.  Each arc is
+  boxed using its angular bounds, and the boxes are kept sorted on
+  their lower edge in x and in y, so that an interface only has to be
+  checked against the arcs whose box it crosses.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* the boxes are grown by this fraction of the radius, to stay clear of
+   the roundoff in the intersection and angle calculations */
+#define CIR_SEG_BOX_MARGIN 1.0e-6
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void nmmtl_cir_seg_box(CIRCLE_SEGMENTS_P segment, CIR_SEG_BOX_P box);
+
+static int nmmtl_cir_seg_x_compare(const void *a, const void *b);
+
+static int nmmtl_cir_seg_y_compare(const void *a, const void *b);
+
+static int nmmtl_cir_seg_group_compare(const void *a, const void *b);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_index_build
+
+  FUNCTIONAL DESCRIPTION:
+
+  Index a list of circle segments.  Each segment on the list starts a
+  group, numbered in list order, which also takes in the pieces later
+  split off it and inserted behind it, so the group spans the list from
+  groups[g] up to groups[g+1].  A group is indexed by the box of its
+  first segment, which holds all of its pieces.
+
+  FORMAL PARAMETERS:
+
+  CIRCLE_SEGMENTS_P circle_segments - the list, may be empty
+  CIR_SEG_INDEX_P index             - output: the index
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_cir_seg_index_build(*circle_segments,&index);
+
+  */
+
+int nmmtl_cir_seg_index_build(CIRCLE_SEGMENTS_P circle_segments,
+                              CIR_SEG_INDEX_P index)
+{
+  CIRCLE_SEGMENTS_P segment;
+  int number = 0;
+  int g;
+
+  for(segment = circle_segments; segment != NULL; segment = segment->next)
+    number++;
+
+  index->number_groups = number;
+  index->groups = (CIRCLE_SEGMENTS_P *)
+    malloc(sizeof(CIRCLE_SEGMENTS_P) * (size_t)(number + 1));
+  index->by_x = (CIR_SEG_BOX_P)malloc(sizeof(CIR_SEG_BOX) * (size_t)(number + 1));
+  index->by_y = (CIR_SEG_BOX_P)malloc(sizeof(CIR_SEG_BOX) * (size_t)(number + 1));
+  index->x_reach = (double *)malloc(sizeof(double) * (size_t)(number + 1));
+  index->y_reach = (double *)malloc(sizeof(double) * (size_t)(number + 1));
+  index->candidates = (int *)malloc(sizeof(int) * (size_t)(number + 1));
+
+  if(index->groups == NULL || index->by_x == NULL || index->by_y == NULL ||
+     index->x_reach == NULL || index->y_reach == NULL ||
+     index->candidates == NULL)
+  {
+    nmmtl_cir_seg_index_free(index);
+    return(FAIL);
+  }
+
+  for(g = 0, segment = circle_segments; segment != NULL;
+      g++, segment = segment->next)
+  {
+    index->groups[g] = segment;
+    nmmtl_cir_seg_box(segment,&index->by_x[g]);
+    index->by_x[g].group = g;
+    index->by_y[g] = index->by_x[g];
+  }
+  index->groups[number] = NULL;
+
+  qsort(index->by_x,(size_t)number,sizeof(CIR_SEG_BOX),
+        nmmtl_cir_seg_x_compare);
+  qsort(index->by_y,(size_t)number,sizeof(CIR_SEG_BOX),
+        nmmtl_cir_seg_y_compare);
+
+  /* the reach of entry i is the furthest any box up to i extends */
+  for(g = 0; g < number; g++)
+  {
+    index->x_reach[g] = index->by_x[g].x_max;
+    index->y_reach[g] = index->by_y[g].y_max;
+    if(g > 0 && index->x_reach[g-1] > index->x_reach[g])
+      index->x_reach[g] = index->x_reach[g-1];
+    if(g > 0 && index->y_reach[g-1] > index->y_reach[g])
+      index->y_reach[g] = index->y_reach[g-1];
+  }
+
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_index_query
+
+  FUNCTIONAL DESCRIPTION:
+
+  Find the groups whose box overlaps a query box, edges included.  The
+  search runs along the axis in which the query box is thinner, which
+  for a dielectric interface is the one it sits at: binary search for
+  the last box starting at or below the top of the query, then step
+  down for as long as the reach of the boxes gets to its bottom.  The
+  group numbers are left in index->candidates in list order.
+
+  FORMAL PARAMETERS:
+
+  CIR_SEG_INDEX_P index         - the index
+  double x_min, x_max           - extent of the query in x
+  double y_min, y_max           - extent of the query in y
+
+  RETURN VALUE:
+
+  number of groups found
+
+  CALLING SEQUENCE:
+
+  number_candidates = nmmtl_cir_seg_index_query(&index,x_min,x_max,
+                                                y_min,y_max);
+
+  */
+
+int nmmtl_cir_seg_index_query(CIR_SEG_INDEX_P index,
+                              double x_min, double x_max,
+                              double y_min, double y_max)
+{
+  CIR_SEG_BOX_P boxes, box;
+  double *reach;
+  double low, high;
+  int first = 0, last = index->number_groups, middle;
+  int by_y = (y_max - y_min) <= (x_max - x_min);
+  int number_candidates = 0;
+
+  if(by_y)
+  {
+    boxes = index->by_y;
+    reach = index->y_reach;
+    low = y_min;
+    high = y_max;
+  }
+  else
+  {
+    boxes = index->by_x;
+    reach = index->x_reach;
+    low = x_min;
+    high = x_max;
+  }
+
+  /* first box which starts above the query */
+  while(first < last)
+  {
+    middle = (first + last) / 2;
+    if((by_y ? boxes[middle].y_min : boxes[middle].x_min) <= high)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  while(--first >= 0 && reach[first] >= low)
+  {
+    box = &boxes[first];
+    if(box->x_min <= x_max && box->x_max >= x_min &&
+       box->y_min <= y_max && box->y_max >= y_min)
+      index->candidates[number_candidates++] = box->group;
+  }
+
+  if(number_candidates > 1)
+    qsort(index->candidates,(size_t)number_candidates,sizeof(int),
+          nmmtl_cir_seg_group_compare);
+
+  return(number_candidates);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_index_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the arrays of an index.  The segments are left alone.
+
+  FORMAL PARAMETERS:
+
+  CIR_SEG_INDEX_P index         - the index
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_cir_seg_index_free(&index);
+
+  */
+
+void nmmtl_cir_seg_index_free(CIR_SEG_INDEX_P index)
+{
+  free(index->groups);
+  free(index->by_x);
+  free(index->by_y);
+  free(index->x_reach);
+  free(index->y_reach);
+  free(index->candidates);
+  index->groups = NULL;
+  index->by_x = NULL;
+  index->by_y = NULL;
+  index->x_reach = NULL;
+  index->y_reach = NULL;
+  index->candidates = NULL;
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_box
+
+  FUNCTIONAL DESCRIPTION:
+
+  Box an arc: its two endpoints, plus the extreme points of the circle
+  at 0, PI/2, PI, 3PI/2 and 2PI radians that lie between its starting
+  and ending angles, grown by CIR_SEG_BOX_MARGIN.
+
+  FORMAL PARAMETERS:
+
+  CIRCLE_SEGMENTS_P segment     - the arc
+  CIR_SEG_BOX_P box             - output: its box
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_cir_seg_box(segment,&box);
+
+  */
+
+static void nmmtl_cir_seg_box(CIRCLE_SEGMENTS_P segment, CIR_SEG_BOX_P box)
+{
+  double x, y, margin;
+  int quarter;
+
+  x = cos(segment->startangle);
+  y = sin(segment->startangle);
+  box->x_min = box->x_max = x;
+  box->y_min = box->y_max = y;
+
+  x = cos(segment->endangle);
+  y = sin(segment->endangle);
+  if(x < box->x_min) box->x_min = x;
+  if(x > box->x_max) box->x_max = x;
+  if(y < box->y_min) box->y_min = y;
+  if(y > box->y_max) box->y_max = y;
+
+  for(quarter = 0; quarter <= 4; quarter++)
+  {
+    if(quarter * PI / 2 < segment->startangle ||
+       quarter * PI / 2 > segment->endangle) continue;
+    switch(quarter % 4)
+    {
+    case 0: box->x_max = 1.0; break;
+    case 1: box->y_max = 1.0; break;
+    case 2: box->x_min = -1.0; break;
+    case 3: box->y_min = -1.0; break;
+    }
+  }
+
+  margin = CIR_SEG_BOX_MARGIN;
+  box->x_min = segment->centerx + segment->radius * (box->x_min - margin);
+  box->x_max = segment->centerx + segment->radius * (box->x_max + margin);
+  box->y_min = segment->centery + segment->radius * (box->y_min - margin);
+  box->y_max = segment->centery + segment->radius * (box->y_max + margin);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_x_compare, nmmtl_cir_seg_y_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  qsort comparisons of two boxes by their lower edge in x or in y.
+
+  */
+
+static int nmmtl_cir_seg_x_compare(const void *a, const void *b)
+{
+  CIR_SEG_BOX_P ba = (CIR_SEG_BOX_P)a;
+  CIR_SEG_BOX_P bb = (CIR_SEG_BOX_P)b;
+
+  if(ba->x_min < bb->x_min) return(-1);
+  if(ba->x_min > bb->x_min) return(1);
+  return(ba->group - bb->group);
+}
+
+static int nmmtl_cir_seg_y_compare(const void *a, const void *b)
+{
+  CIR_SEG_BOX_P ba = (CIR_SEG_BOX_P)a;
+  CIR_SEG_BOX_P bb = (CIR_SEG_BOX_P)b;
+
+  if(ba->y_min < bb->y_min) return(-1);
+  if(ba->y_min > bb->y_min) return(1);
+  return(ba->group - bb->group);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_cir_seg_group_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  qsort comparison of two group numbers.
+
+  */
+
+static int nmmtl_cir_seg_group_compare(const void *a, const void *b)
+{
+  return(*(const int *)a - *(const int *)b);
+}
@@ -0,0 +1,151 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_conductance_parameters, which sets up the conductance
+  matrix G due to the loss tangents of the dielectrics to be found
+  along with the solve.
+
+  With a complex permittivity eps_k (1 - j tan_k) in each dielectric,
+  and the electrostatic induction B homogeneous of degree one in the
+  permittivities, to first order in the loss tangents
+
+    G = w * sum over k of tan_k eps_k dB/d(eps_k)
+
+  which is w times the derivative of B along the direction in which each
+  permittivity is scaled up by its own loss tangent.  Rather than solve
+  the complex problem, or solve the cross section again with perturbed
+  permittivities, the derivative is taken by the adjoint method of
+  nmmtl_sensitivity_calculate, from the factored dielectric system of
+  the solve itself.  G/w does not depend on the frequency, so the one
+  derivative serves every frequency.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_conductance_parameters
+
+  FUNCTIONAL DESCRIPTION:
+
+  Zeroes G/w, the conductance matrix per unit angular frequency, and
+  sets up the loss parameter of the sensitivity so that the kernel fills
+  it in; nmmtl_rlgc_calculate gives G at each frequency.  When no
+  dielectric has a loss tangent, G is left zero and the sensitivity is
+  not touched.
+
+  The elements know only their permittivities, and where two touching
+  dielectrics have the same permittivity the mesh has no boundary
+  between them.  Dielectrics of the same permittivity with different
+  loss tangents therefore share the mean of their tangents, weighted by
+  their areas, and a note says so.
+
+  Call it after nmmtl_sensitivity_parameters, if that is called, and
+  pass the sensitivity to the solve if sensitivity->conductance is set.
+  nmmtl_sensitivity_free frees what this allocates.
+
+  FORMAL PARAMETERS:
+
+  struct dielectric *dielectrics - the dielectrics
+  int conductor_counter          - the number of signals
+  double **conductance           - out: G/w, siemens/meter per
+                                   radian/second, allocated with dim2
+                                   by the caller
+  SENSITIVITY_P sensitivity      - out: the loss parameter
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_conductance_parameters(dielectrics,conductor_counter,
+                                        conductance,&sensitivity);
+
+  */
+
+int nmmtl_conductance_parameters(struct dielectric *dielectrics,
+                                 int conductor_counter,
+                                 double **conductance,
+                                 SENSITIVITY_P sensitivity)
+{
+  SENSITIVITY_PARAMETER_P loss = &sensitivity->loss;
+  struct dielectric *die, *other;
+  double largest_tangent = 0.0;
+  double area, total_area;
+  int number = 0, mixed;
+  int i, j;
+
+  for(i = 0; i < conductor_counter; i++)
+    for(j = 0; j < conductor_counter; j++)
+      conductance[i][j] = 0.0;
+
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    number++;
+    if(fabs(die->tangent) > largest_tangent)
+      largest_tangent = fabs(die->tangent);
+  }
+  if(largest_tangent == 0.0) return(SUCCESS);
+
+  loss->knots = (double (*)[2])malloc(sizeof(double[2]) * (size_t)number);
+  if(loss->knots == NULL) return(FAIL);
+
+  /* one knot for each different permittivity */
+  loss->number_knots = 0;
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    for(other = dielectrics; other != die; other = other->next)
+      if(other->constant == die->constant) break;
+    if(other != die) continue;
+
+    total_area = 0.0;
+    mixed = FALSE;
+    loss->knots[loss->number_knots][0] = die->constant;
+    loss->knots[loss->number_knots][1] = 0.0;
+    for(other = die; other != NULL; other = other->next)
+    {
+      if(other->constant != die->constant) continue;
+      if(other->tangent != die->tangent) mixed = TRUE;
+      area = (other->x1 - other->x0) * (other->y1 - other->y0);
+      loss->knots[loss->number_knots][1] += area * other->tangent;
+      total_area += area;
+    }
+    if(total_area > 0.0) loss->knots[loss->number_knots][1] /= total_area;
+    else loss->knots[loss->number_knots][1] = die->tangent;
+
+    if(mixed)
+      printf("Conductance: the dielectrics of permittivity %g have "
+             "different loss tangents, %g is used for them all\n",
+             die->constant,loss->knots[loss->number_knots][1]);
+    loss->number_knots++;
+  }
+
+  /* the step nmmtl_sensitivity_calculate differences over then changes
+     no permittivity by more than SENSITIVITY_STEP of itself */
+  loss->kind = SENSITIVITY_LOSS;
+  loss->value = 1.0 / largest_tangent;
+  sensitivity->conductance = conductance;
+  return(SUCCESS);
+}
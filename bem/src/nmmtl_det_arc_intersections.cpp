@@ -494,6 +494,10 @@
   if at terminal point of arc and right turn (-90) to the die from
   normal, then it is outside.
 
+  The circle segments are indexed by nmmtl_cir_seg_index_build, so each
+  dielectric segment is only checked against the arcs whose bounding
+  box it crosses, still in list order.
+
 
   FORMAL PARAMETERS:
 
@@ -531,6 +535,8 @@ int nmmtl_determine_arc_intersectio(CIRCLE_SEGMENTS_P *circle_segments,
   int cond_hits,die_hits; /* number of intersections that are on endpoints */
 
   int break_out_of_conductor_loop = FALSE;
+  CIR_SEG_INDEX index;
+  int number_candidates, candidate, group;
 
   /* Now detemine the intersections of conductor circle segments with
      dielectric-dielectric segments.
@@ -539,6 +545,9 @@ int nmmtl_determine_arc_intersectio(CIRCLE_SEGMENTS_P *circle_segments,
      move ta loop to the outside to avoid repeating that work
      */
 
+  if(nmmtl_cir_seg_index_build(*circle_segments,&index) != SUCCESS)
+    return(FAIL);
+
   dieseg = *dielectric_segments;
   last_dieseg = NULL;
 
@@ -556,9 +565,27 @@ int nmmtl_determine_arc_intersectio(CIRCLE_SEGMENTS_P *circle_segments,
       dseg.x[1] = dieseg->end;
       vert_die = FALSE;
     }
-    segment = *circle_segments;
+    /* only the groups of circle segments near the dielectric segment
+       can intersect it - walk those in list order */
+
+    number_candidates = nmmtl_cir_seg_index_query(&index,
+                                                  dseg.x[0] < dseg.x[1] ?
+                                                  dseg.x[0] : dseg.x[1],
+                                                  dseg.x[0] < dseg.x[1] ?
+                                                  dseg.x[1] : dseg.x[0],
+                                                  dseg.y[0] < dseg.y[1] ?
+                                                  dseg.y[0] : dseg.y[1],
+                                                  dseg.y[0] < dseg.y[1] ?
+                                                  dseg.y[1] : dseg.y[0]);
+
     break_out_of_conductor_loop = FALSE;
-    while(segment != NULL && break_out_of_conductor_loop == FALSE)
+    for(candidate = 0; candidate < number_candidates &&
+          break_out_of_conductor_loop == FALSE; candidate++)
+    {
+      group = index.candidates[candidate];
+    segment = index.groups[group];
+    while(segment != index.groups[group+1] &&
+          break_out_of_conductor_loop == FALSE)
     {
       /* determine if the dieseg was adjusted within the loop and hence,
    dseg needs to be recomputed */
@@ -2129,18 +2156,22 @@ int nmmtl_determine_arc_intersectio(CIRCLE_SEGMENTS_P *circle_segments,
 
   default :
     fprintf(stderr,"ELECTRO-F-INTERNAL Internal error:  checking intersections between conductors and dielectrics; Choices for circle segment/die intersection types fell through\n");
+    nmmtl_cir_seg_index_free(&index);
     return(FAIL);
   }                          /* switch on intersection type */
 
       }                            /* if there is an intersection */
       segment = segment->next;
     }                                /* while looping through the segments */
+    }                                /* for loop on the candidate groups */
 
     if(break_out_of_conductor_loop == FALSE) {
       last_dieseg = dieseg;
       dieseg = dieseg->next;
     }
   }                              /* looping on the dielectric segs */
+
+  nmmtl_cir_seg_index_free(&index);
   return(SUCCESS);
 
 }
@@ -154,6 +154,11 @@
   CL_SD1C0, (overhang of init die and term cond)
   CL_SD1C1  (overhang on initial side of die and cond)
 
+  The dielectric segments are indexed by nmmtl_die_seg_index_build, so
+  each conductor segment is only checked against the ones its bounding
+  box touches, still in list order.  Segments removed along the way are
+  marked and taken off the list at the end.
+
   FORMAL PARAMETERS:
 
   LINE_SEGMENTS_P *line_segments          The list of line segments to be
@@ -174,7 +179,9 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
   int colinear;
   POINT intersection1,intersection2;
   LINE_SEGMENTS_P segment, new_ls = NULL, new_ls_2;
-  DIELECTRIC_SEGMENTS_P dieseg, last_dieseg, new_ds;
+  DIELECTRIC_SEGMENTS_P dieseg, new_ds;
+  DIE_SEG_INDEX index;
+  int number_candidates, candidate, group;
   double theta1;
   double turn_angle;
   double deltax;
@@ -192,6 +199,9 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
   /* now detemine the intersections of conductor line segments with */
   /* dielectric-dielectric segments */
 
+  if(nmmtl_die_seg_index_build(*dielectric_segments,&index) != SUCCESS)
+    return(FAIL);
+
   segment = *line_segments;
   while(segment != NULL)
   {
@@ -213,11 +223,28 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
       else cond_inc_dir = FALSE;
     }
 
-    dieseg = *dielectric_segments;
-    last_dieseg = NULL;
-
-    while(dieseg != NULL)
+    /* only the groups of dielectric segments near the conductor segment
+       can intersect it - walk those in list order, skipping the ones
+       already removed */
+
+    number_candidates = nmmtl_die_seg_index_query(&index,
+                                                  cseg.x[0] < cseg.x[1] ?
+                                                  cseg.x[0] : cseg.x[1],
+                                                  cseg.x[0] < cseg.x[1] ?
+                                                  cseg.x[1] : cseg.x[0],
+                                                  cseg.y[0] < cseg.y[1] ?
+                                                  cseg.y[0] : cseg.y[1],
+                                                  cseg.y[0] < cseg.y[1] ?
+                                                  cseg.y[1] : cseg.y[0]);
+
+    for(candidate = 0; candidate < number_candidates; candidate++)
     {
+      group = index.candidates[candidate];
+    for(dieseg = index.groups[group]; dieseg != index.groups[group+1];
+        dieseg = dieseg->next)
+    {
+      if(dieseg->removed) continue;
+
       if(dieseg->orientation == VERTICAL_ORIENTATION)
       {
   dseg.x[0] = dieseg->at;
@@ -533,6 +560,7 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
       new_ds->segment_number = dieseg->segment_number;
       new_ds->end_in_conductor = dieseg->end_in_conductor;
       new_ds->orientation = dieseg->orientation;
+      new_ds->removed = FALSE;
       new_ds->length = new_ds->end - new_ds->start;
       new_ds->divisions = (int)(dieseg->divisions *
         (new_ds->length/dieseg->length) + 1.0);
@@ -720,31 +748,11 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
       }
       /* dielectric segment action: remove whole segment
 
-         To do this, we are slightly tricky.  The end of the
-         dielectric loop has these statements:
-
-         last_dieseg = dieseg;
-         dieseg = dieseg->next;
-
-         To play into this correctly, we just set the value of
-         dieseg back to last_dieseg.  This will allow last_dieseg to
-         remain unchanged, but dieseg will advance to the next one,
-         which is the one after the one we removed.
+         It is only marked here, so that the index stays valid, and
+         taken off the list once all intersections have been found.
 
          */
-      /* is this not the first element on the list ? */
-      if(last_dieseg != NULL)
-      {
-        last_dieseg->next = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = last_dieseg;
-      }
-      else /* first element on the list - do special operations */
-      {
-        last_dieseg = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = NULL;
-      }
+      dieseg->removed = TRUE;
 
       break;
 
@@ -961,6 +969,7 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
       new_ds->epsilonminus = dieseg->epsilonminus;
       new_ds->segment_number = dieseg->segment_number;
       new_ds->orientation = dieseg->orientation;
+      new_ds->removed = FALSE;
       /* clear initial end_in_conductor bit - bit 0 */
       new_ds->end_in_conductor = dieseg->end_in_conductor & 2;
       /* clear terminal end_in_conductor bit - bit 1 */
@@ -1136,31 +1145,11 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
 
       /* dielectric segment action: remove whole segment
 
-         To do this, we are slightly tricky.  The end of the
-         dielectric loop has these statements:
-
-         last_dieseg = dieseg;
-         dieseg = dieseg->next;
-
-         To play into this correctly, we just set the value of
-         dieseg back to last_dieseg.  This will allow last_dieseg to
-         remain unchanged, but dieseg will advance to the next one,
-         which is the one after the one we removed.
+         It is only marked here, so that the index stays valid, and
+         taken off the list once all intersections have been found.
 
          */
-      /* is this not the first element on the list ? */
-      if(last_dieseg != NULL)
-      {
-        last_dieseg->next = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = last_dieseg;
-      }
-      else /* first element on the list - do special operations */
-      {
-        last_dieseg = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = NULL;
-      }
+      dieseg->removed = TRUE;
       break;
 
     case CL_C1:
@@ -1285,31 +1274,11 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
 
       /* dielectric segment action: remove whole segment
 
-         To do this, we are slightly tricky.  The end of the
-         dielectric loop has these statements:
-
-         last_dieseg = dieseg;
-         dieseg = dieseg->next;
-
-         To play into this correctly, we just set the value of
-         dieseg back to last_dieseg.  This will allow last_dieseg to
-         remain unchanged, but dieseg will advance to the next one,
-         which is the one after the one we removed.
+         It is only marked here, so that the index stays valid, and
+         taken off the list once all intersections have been found.
 
          */
-      /* is this not the first element on the list ? */
-      if(last_dieseg != NULL)
-      {
-        last_dieseg->next = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = last_dieseg;
-      }
-      else /* first element on the list - do special operations */
-      {
-        last_dieseg = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = NULL;
-      }
+      dieseg->removed = TRUE;
       break;
 
     case CL_C2:
@@ -1468,31 +1437,11 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
 
       /* dielectric segment action: remove whole segment
 
-         To do this, we are slightly tricky.  The end of the
-         dielectric loop has these statements:
-
-         last_dieseg = dieseg;
-         dieseg = dieseg->next;
-
-         To play into this correctly, we just set the value of
-         dieseg back to last_dieseg.  This will allow last_dieseg to
-         remain unchanged, but dieseg will advance to the next one,
-         which is the one after the one we removed.
+         It is only marked here, so that the index stays valid, and
+         taken off the list once all intersections have been found.
 
          */
-      /* is this not the first element on the list ? */
-      if(last_dieseg != NULL)
-      {
-        last_dieseg->next = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = last_dieseg;
-      }
-      else /* first element on the list - do special operations */
-      {
-        last_dieseg = dieseg->next; /* bypass on list */
-        free(dieseg);
-        dieseg = NULL;
-      }
+      dieseg->removed = TRUE;
       break;
 
     case CL_SD0C0:
@@ -2100,23 +2049,13 @@ int nmmtl_determine_intersections(LINE_SEGMENTS_P *line_segments,
 
       }                            /* if there is an intersection */
 
-      /* check if first element from list was removed */
-      if(dieseg == NULL)
-      {
-  dieseg = last_dieseg;
-  *dielectric_segments = dieseg;
-  last_dieseg = NULL;
-      }
-      else
-      {
-  last_dieseg = dieseg;
-  dieseg = dieseg->next;
-      }
-
-
     }                              /* for loop on the dielectric segs */
+    }                              /* for loop on the candidate groups */
     segment = segment->next;
   }                                /* while looping through the segments */
+
+  nmmtl_die_seg_index_free(&index);
+  nmmtl_die_seg_index_compact(dielectric_segments);
   return(SUCCESS);
 }
 
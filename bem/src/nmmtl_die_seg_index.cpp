@@ -0,0 +1,361 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the index of dielectric segments used while finding their
+  intersections with the conductor segments: the dielectric-dielectric
+  interfaces, kept in arrays sorted on the coordinate they sit at, one
+  for each orientation, so that a conductor segment only has to be
+  checked against the interfaces its bounding box touches.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_die_seg_interval_compare(const void *a, const void *b);
+
+static int nmmtl_die_seg_group_compare(const void *a, const void *b);
+
+static int nmmtl_die_seg_index_scan(DIE_SEG_INTERVAL_P intervals,
+                                    int number_intervals,
+                                    double at_min, double at_max,
+                                    double low, double high,
+                                    int *candidates, int number_candidates);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_index_build
+
+  FUNCTIONAL DESCRIPTION:
+
+  Index a list of dielectric segments.  Each segment on the list starts
+  a group, numbered in list order, which also takes in the pieces later
+  split off it and inserted behind it, so the group spans the list from
+  groups[g] up to groups[g+1].  A group is indexed by the extent of its
+  first segment, which holds all of its pieces.  The removed flag of
+  every segment is cleared.
+
+  FORMAL PARAMETERS:
+
+  DIELECTRIC_SEGMENTS_P dielectric_segments - the list, may be empty
+  DIE_SEG_INDEX_P index                     - output: the index
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_die_seg_index_build(*dielectric_segments,&index);
+
+  */
+
+int nmmtl_die_seg_index_build(DIELECTRIC_SEGMENTS_P dielectric_segments,
+                              DIE_SEG_INDEX_P index)
+{
+  DIELECTRIC_SEGMENTS_P dieseg;
+  DIE_SEG_INTERVAL_P interval;
+  int number = 0;
+  int g;
+
+  for(dieseg = dielectric_segments; dieseg != NULL; dieseg = dieseg->next)
+    number++;
+
+  index->number_groups = number;
+  index->number_horizontal = 0;
+  index->number_vertical = 0;
+  index->groups = (DIELECTRIC_SEGMENTS_P *)
+    malloc(sizeof(DIELECTRIC_SEGMENTS_P) * (size_t)(number + 1));
+  index->horizontal = (DIE_SEG_INTERVAL_P)
+    malloc(sizeof(DIE_SEG_INTERVAL) * (size_t)(number + 1));
+  index->vertical = (DIE_SEG_INTERVAL_P)
+    malloc(sizeof(DIE_SEG_INTERVAL) * (size_t)(number + 1));
+  index->candidates = (int *)malloc(sizeof(int) * (size_t)(number + 1));
+
+  if(index->groups == NULL || index->horizontal == NULL ||
+     index->vertical == NULL || index->candidates == NULL)
+  {
+    nmmtl_die_seg_index_free(index);
+    return(FAIL);
+  }
+
+  for(g = 0, dieseg = dielectric_segments; dieseg != NULL;
+      g++, dieseg = dieseg->next)
+  {
+    dieseg->removed = FALSE;
+    index->groups[g] = dieseg;
+
+    if(dieseg->orientation == VERTICAL_ORIENTATION)
+      interval = &index->vertical[index->number_vertical++];
+    else
+      interval = &index->horizontal[index->number_horizontal++];
+
+    interval->at = dieseg->at;
+    if(dieseg->start < dieseg->end)
+    {
+      interval->low = dieseg->start;
+      interval->high = dieseg->end;
+    }
+    else
+    {
+      interval->low = dieseg->end;
+      interval->high = dieseg->start;
+    }
+    interval->group = g;
+  }
+  index->groups[number] = NULL;
+
+  qsort(index->horizontal,(size_t)index->number_horizontal,
+        sizeof(DIE_SEG_INTERVAL),nmmtl_die_seg_interval_compare);
+  qsort(index->vertical,(size_t)index->number_vertical,
+        sizeof(DIE_SEG_INTERVAL),nmmtl_die_seg_interval_compare);
+
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_index_query
+
+  FUNCTIONAL DESCRIPTION:
+
+  Find the groups with an interface touching a box, including its edges.
+  Since two segments can only intersect inside both of their bounding
+  boxes, these are all the groups a conductor segment inside the box can
+  intersect.  The group numbers are left in index->candidates in list
+  order, so walking them visits the segments in the same order as
+  walking the list itself.
+
+  FORMAL PARAMETERS:
+
+  DIE_SEG_INDEX_P index         - the index
+  double x_min, x_max           - extent of the box in x
+  double y_min, y_max           - extent of the box in y
+
+  RETURN VALUE:
+
+  number of groups found
+
+  CALLING SEQUENCE:
+
+  number_candidates = nmmtl_die_seg_index_query(&index,x_min,x_max,
+                                                y_min,y_max);
+
+  */
+
+int nmmtl_die_seg_index_query(DIE_SEG_INDEX_P index,
+                              double x_min, double x_max,
+                              double y_min, double y_max)
+{
+  int number_candidates;
+
+  /* horizontal interfaces sit at a y and run along x */
+  number_candidates = nmmtl_die_seg_index_scan(index->horizontal,
+                                               index->number_horizontal,
+                                               y_min,y_max,x_min,x_max,
+                                               index->candidates,0);
+
+  number_candidates = nmmtl_die_seg_index_scan(index->vertical,
+                                               index->number_vertical,
+                                               x_min,x_max,y_min,y_max,
+                                               index->candidates,
+                                               number_candidates);
+
+  if(number_candidates > 1)
+    qsort(index->candidates,(size_t)number_candidates,sizeof(int),
+          nmmtl_die_seg_group_compare);
+
+  return(number_candidates);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_index_compact
+
+  FUNCTIONAL DESCRIPTION:
+
+  Take the segments marked removed off the list and free them, once
+  the intersections have all been found.
+
+  FORMAL PARAMETERS:
+
+  DIELECTRIC_SEGMENTS_P *dielectric_segments - the list
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_die_seg_index_compact(dielectric_segments);
+
+  */
+
+void nmmtl_die_seg_index_compact(DIELECTRIC_SEGMENTS_P *dielectric_segments)
+{
+  DIELECTRIC_SEGMENTS_P *link = dielectric_segments;
+  DIELECTRIC_SEGMENTS_P dieseg;
+
+  while((dieseg = *link) != NULL)
+  {
+    if(dieseg->removed)
+    {
+      *link = dieseg->next;
+      free(dieseg);
+    }
+    else
+      link = &dieseg->next;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_index_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the arrays of an index.  The segments are left alone.
+
+  FORMAL PARAMETERS:
+
+  DIE_SEG_INDEX_P index         - the index
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_die_seg_index_free(&index);
+
+  */
+
+void nmmtl_die_seg_index_free(DIE_SEG_INDEX_P index)
+{
+  free(index->groups);
+  free(index->horizontal);
+  free(index->vertical);
+  free(index->candidates);
+  index->groups = NULL;
+  index->horizontal = NULL;
+  index->vertical = NULL;
+  index->candidates = NULL;
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_index_scan
+
+  FUNCTIONAL DESCRIPTION:
+
+  Binary search an interval array for the first interface at or above
+  at_min, and collect the groups of those up to at_max which overlap
+  [low,high].
+
+  FORMAL PARAMETERS:
+
+  DIE_SEG_INTERVAL_P intervals  - sorted on at
+  int number_intervals          - length of intervals
+  double at_min, at_max         - range of at
+  double low, high              - range along the interfaces
+  int *candidates               - groups found so far
+  int number_candidates         - how many
+
+  RETURN VALUE:
+
+  new number of candidates
+
+  CALLING SEQUENCE:
+
+  number_candidates = nmmtl_die_seg_index_scan(index->vertical,...);
+
+  */
+
+static int nmmtl_die_seg_index_scan(DIE_SEG_INTERVAL_P intervals,
+                                    int number_intervals,
+                                    double at_min, double at_max,
+                                    double low, double high,
+                                    int *candidates, int number_candidates)
+{
+  int first = 0, last = number_intervals, middle;
+
+  while(first < last)
+  {
+    middle = (first + last) / 2;
+    if(intervals[middle].at < at_min) first = middle + 1;
+    else last = middle;
+  }
+
+  for(; first < number_intervals && intervals[first].at <= at_max; first++)
+  {
+    if(intervals[first].low <= high && intervals[first].high >= low)
+      candidates[number_candidates++] = intervals[first].group;
+  }
+
+  return(number_candidates);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_interval_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  qsort comparison of two intervals by at.
+
+  */
+
+static int nmmtl_die_seg_interval_compare(const void *a, const void *b)
+{
+  DIE_SEG_INTERVAL_P ia = (DIE_SEG_INTERVAL_P)a;
+  DIE_SEG_INTERVAL_P ib = (DIE_SEG_INTERVAL_P)b;
+
+  if(ia->at < ib->at) return(-1);
+  if(ia->at > ib->at) return(1);
+  return(ia->group - ib->group);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_die_seg_group_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  qsort comparison of two group numbers.
+
+  */
+
+static int nmmtl_die_seg_group_compare(const void *a, const void *b)
+{
+  return(*(const int *)a - *(const int *)b);
+}
@@ -39,7 +39,8 @@
 
   FUNCTIONAL DESCRIPTION:
 
-  Just put out a dump file of conductor and dielectric elements.
+  Just put out a dump file of conductor and dielectric elements, with
+  all ELEMENT_PTS nodes of each.
 
   FORMAL PARAMETERS:
 
@@ -49,7 +50,7 @@
   struct contour *signals          - signals data structure
   int conductor_counter,           - how many conductors (gnd not included)
   CONDUCTOR_DATA_P conductor_data, - array of data on conductors
-  DELEMENTS_P die_elements         - list of dielectric elements
+  ELEMENT_STORE_P element_store    - all the elements
   unsigned int node_point_counter           - highest node number
   unsigned int highest_conductor_node       - highest node for a conductor
 
@@ -59,7 +60,9 @@
 
   CALLING SEQUENCE:
 
-  nmmtl_dump(dump_file,conductor_counter,cd,*die_elements);
+  nmmtl_dump(dump_file,cntr_seg,pln_seg,coupling,risetime,signals,
+             conductor_counter,cd,element_store,node_point_counter,
+             highest_conductor_node);
 
   */
 
@@ -71,10 +74,11 @@ void nmmtl_dump(FILE *dump_file,
                 struct contour *signals,
                 int conductor_counter,
                 CONDUCTOR_DATA_P conductor_data,
-                DELEMENTS_P die_elements,
+                ELEMENT_STORE_P element_store,
                 unsigned int node_point_counter,
                 unsigned int highest_conductor_node) {
-  CELEMENTS_P ce;
+  CELEMENTS_P ce,ce_end;
+  DELEMENTS_P de,de_end;
   int cntr,i;
 
   fprintf(dump_file,"%d %d %g %g\n",cntr_seg,pln_seg,
@@ -91,18 +95,20 @@ void nmmtl_dump(FILE *dump_file,
     fprintf(dump_file,"%d %d \n",
       conductor_data[cntr].node_start,
       conductor_data[cntr].node_end);
-    for (ce = conductor_data[cntr].elements;ce != NULL;ce = ce->next) {
+    ce_end = conductor_data[cntr].elements +
+      conductor_data[cntr].number_elements;
+    for (ce = conductor_data[cntr].elements;ce < ce_end;ce++) {
       fprintf(dump_file,"%g ",ce->epsilon);
       if(ce->edge[0]) fputs("1 ",dump_file);
       else fputs("0 ",dump_file);
       if(ce->edge[1]) fputs("1 ",dump_file);
       else fputs("0 ",dump_file);
-      if(ce->edge[0]) fprintf(dump_file,"%g %g ",ce->edge[0]->nu,
-            ce->edge[0]->free_space_nu);
-      if(ce->edge[1]) fprintf(dump_file,"%g %g ",ce->edge[1]->nu,
-            ce->edge[1]->free_space_nu);
+      if(ce->edge[0]) fprintf(dump_file,"%g %g ",ce->nu[0],
+            ce->free_space_nu[0]);
+      if(ce->edge[1]) fprintf(dump_file,"%g %g ",ce->nu[1],
+            ce->free_space_nu[1]);
       fputs("\n",dump_file);
-      for(i = 0; i < 3; i++)
+      for(i = 0; i < ELEMENT_PTS; i++)
       {
   fprintf(dump_file,"%d %-23.21g %-23.21g\n",ce->node[i],ce->xpts[i],ce->ypts[i]);
       }
@@ -110,13 +116,14 @@ void nmmtl_dump(FILE *dump_file,
     fputs(".\n",dump_file);
   }
 
-  for(; die_elements != NULL; die_elements = die_elements->next) {
+  de_end = element_store->delements + element_store->number_delements;
+  for(de = element_store->delements; de < de_end; de++) {
     fprintf(dump_file,"%g %g %g %g\n",
-      die_elements->epsilonplus,die_elements->epsilonminus,
-      die_elements->normalx,die_elements->normaly);
-    for(i = 0; i < 3; i++) {
-      fprintf(dump_file,"%d %-23.21g %-23.21g\n",die_elements->node[i],
-        die_elements->xpts[i],die_elements->ypts[i]);
+      de->epsilonplus,de->epsilonminus,
+      de->normalx,de->normaly);
+    for(i = 0; i < ELEMENT_PTS; i++) {
+      fprintf(dump_file,"%d %-23.21g %-23.21g\n",de->node[i],
+        de->xpts[i],de->ypts[i]);
     }
   }
 
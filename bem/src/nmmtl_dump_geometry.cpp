@@ -33,7 +33,7 @@
  */
 
 
-extern FILE *dump_file;
+FILE *dump_file = NULL;  /* a file for diagnostics, opened by the main */
 
 
 /*
@@ -0,0 +1,274 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the element store, which holds all the conductor and
+  dielectric elements of a mesh in arrays rather than a list of
+  separately allocated nodes, so that the assembly loops, which walk
+  all the elements once for every integration point, run through
+  memory in order.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include <string.h>
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* the arrays start out this long and double each time they fill */
+#define ELEMENT_STORE_INITIAL 256
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_store_add_c
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a conductor element to a store which is still being generated.
+  The element has no edges set; the rest of it is for the caller to
+  fill in.  The pointer returned is only good until the next element
+  is added, since the array may move as it grows.
+
+  FORMAL PARAMETERS:
+
+  ELEMENT_STORE_P element_store - the store, zeroed to start with
+  int conductor                 - conductor the element belongs to
+
+  RETURN VALUE:
+
+  the new element, NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  element = nmmtl_element_store_add_c(element_store,conductor);
+
+  */
+
+CELEMENTS_P nmmtl_element_store_add_c(ELEMENT_STORE_P element_store,
+                                      int conductor)
+{
+  CELEMENTS_P celements;
+  int *conductors;
+  int allocated;
+  CELEMENTS_P element;
+
+  if(element_store->number_celements == element_store->allocated_celements)
+  {
+    allocated = element_store->allocated_celements > 0 ?
+      2 * element_store->allocated_celements : ELEMENT_STORE_INITIAL;
+    celements = (CELEMENTS_P)realloc(element_store->celements,
+                                     sizeof(CELEMENTS) * (size_t)allocated);
+    if(celements == NULL) return(NULL);
+    element_store->celements = celements;
+    conductors = (int *)realloc(element_store->conductor,
+                                sizeof(int) * (size_t)allocated);
+    if(conductors == NULL) return(NULL);
+    element_store->conductor = conductors;
+    element_store->allocated_celements = allocated;
+  }
+
+  element_store->conductor[element_store->number_celements] = conductor;
+  element = &element_store->celements[element_store->number_celements++];
+  element->edge[0] = FALSE;
+  element->edge[1] = FALSE;
+  element->nu[0] = element->nu[1] = 0.0;
+  element->free_space_nu[0] = element->free_space_nu[1] = 0.0;
+  return(element);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_store_add_d
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a dielectric element to a store which is still being generated.
+  The pointer returned is only good until the next element is added.
+
+  FORMAL PARAMETERS:
+
+  ELEMENT_STORE_P element_store - the store, zeroed to start with
+
+  RETURN VALUE:
+
+  the new element, NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  element = nmmtl_element_store_add_d(element_store);
+
+  */
+
+DELEMENTS_P nmmtl_element_store_add_d(ELEMENT_STORE_P element_store)
+{
+  DELEMENTS_P delements;
+  int allocated;
+
+  if(element_store->number_delements == element_store->allocated_delements)
+  {
+    allocated = element_store->allocated_delements > 0 ?
+      2 * element_store->allocated_delements : ELEMENT_STORE_INITIAL;
+    delements = (DELEMENTS_P)realloc(element_store->delements,
+                                     sizeof(DELEMENTS) * (size_t)allocated);
+    if(delements == NULL) return(NULL);
+    element_store->delements = delements;
+    element_store->allocated_delements = allocated;
+  }
+
+  return(&element_store->delements[element_store->number_delements++]);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_store_finish
+
+  FUNCTIONAL DESCRIPTION:
+
+  Once all the elements are generated, move them into a single
+  allocation: the conductor elements first, grouped by conductor and
+  otherwise in the order they were added, then the dielectric
+  elements.  The range of each conductor is set in conductor_data.
+
+  FORMAL PARAMETERS:
+
+  ELEMENT_STORE_P element_store    - the store
+  int conductor_counter            - number of conductors
+  CONDUCTOR_DATA_P conductor_data  - conductor_counter+1 entries
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_element_store_finish(element_store,conductor_counter,
+                                      conductor_data);
+
+  */
+
+int nmmtl_element_store_finish(ELEMENT_STORE_P element_store,
+                               int conductor_counter,
+                               CONDUCTOR_DATA_P conductor_data)
+{
+  CELEMENTS_P celements;
+  DELEMENTS_P delements;
+  int *next;
+  int conductor, i, start;
+  size_t size;
+
+  size = sizeof(CELEMENTS) * (size_t)element_store->number_celements +
+    sizeof(DELEMENTS) * (size_t)element_store->number_delements;
+  celements = (CELEMENTS_P)malloc(size > 0 ? size : 1);
+  next = (int *)malloc(sizeof(int) * (size_t)(conductor_counter + 1));
+  if(celements == NULL || next == NULL)
+  {
+    free(celements);
+    free(next);
+    return(FAIL);
+  }
+  delements = (DELEMENTS_P)(celements + element_store->number_celements);
+
+  /* count the elements of each conductor, and from that where each
+     conductor's range starts */
+  for(conductor = 0; conductor <= conductor_counter; conductor++)
+    conductor_data[conductor].number_elements = 0;
+  for(i = 0; i < element_store->number_celements; i++)
+    conductor_data[element_store->conductor[i]].number_elements++;
+
+  start = 0;
+  for(conductor = 0; conductor <= conductor_counter; conductor++)
+  {
+    next[conductor] = start;
+    conductor_data[conductor].elements =
+      conductor_data[conductor].number_elements > 0 ?
+      celements + start : NULL;
+    start += conductor_data[conductor].number_elements;
+  }
+
+  for(i = 0; i < element_store->number_celements; i++)
+    celements[next[element_store->conductor[i]]++] =
+      element_store->celements[i];
+
+  if(element_store->number_delements > 0)
+    memcpy(delements,element_store->delements,
+           sizeof(DELEMENTS) * (size_t)element_store->number_delements);
+
+  free(next);
+  free(element_store->celements);
+  free(element_store->conductor);
+  free(element_store->delements);
+
+  element_store->celements = celements;
+  element_store->allocated_celements = element_store->number_celements;
+  element_store->conductor = NULL;
+  element_store->delements = delements;
+  element_store->allocated_delements = element_store->number_delements;
+  element_store->finished = TRUE;
+
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_store_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the elements of a store, finished or not, and leave it empty.
+
+  FORMAL PARAMETERS:
+
+  ELEMENT_STORE_P element_store - the store
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_element_store_free(element_store);
+
+  */
+
+void nmmtl_element_store_free(ELEMENT_STORE_P element_store)
+{
+  /* once finished, the dielectric elements share the conductor
+     elements' allocation */
+  if(!element_store->finished) free(element_store->delements);
+  free(element_store->celements);
+  free(element_store->conductor);
+
+  element_store->celements = NULL;
+  element_store->number_celements = 0;
+  element_store->allocated_celements = 0;
+  element_store->conductor = NULL;
+  element_store->delements = NULL;
+  element_store->number_delements = 0;
+  element_store->allocated_delements = 0;
+  element_store->finished = FALSE;
+}
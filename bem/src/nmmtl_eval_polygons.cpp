@@ -157,7 +157,7 @@ int nmmtl_evaluate_polygons(int cntr_seg,
           CONTOURS_P contour,
           LINE_SEGMENTS_P *segments,
           EXTENT_DATA_P extent_data) {
-  static PGNPTS_P head = NULL,last,current;
+  static thread_local PGNPTS_P head = NULL,last,current;
   POLYPOINTS_P point, last_point;
   int i;
   double sum_of_angles;
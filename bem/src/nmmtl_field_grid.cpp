@@ -0,0 +1,457 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Evaluates the potential and the electric field of each conductor's
+  solution on a rectangular grid, from the charge distribution the
+  solver found, and writes them to the field grid file.
+
+  The potential at a point is the integral over all the elements, of
+  the conductors and of the dielectric interfaces, of the charge times
+  the Green's Function the matrix equation is assembled with,
+  log(d2/d1)/(2 PI EPSILON_NAUGHT), where d1 is the distance to the
+  charge and d2 that to its image in the lower ground plane.  The field
+  is minus its gradient.  The integrals are taken at the Legendre roots
+  nmmtl_interval_c and nmmtl_interval_d use, whose charges
+  nmmtl_interval_sources_c and _d work out once for each solution.
+  The grid points are then shared out a row at a time among a thread
+  for each cpu, each point a sum over the same flat arrays of
+  integration points.  Near an element, closer than its integration
+  points are apart, the sums lose accuracy; on one they are not finite.
+
+  The file is a sequence of records as in the binary plot file (see
+  nmmtl_plot_writer.cpp), each a four character tag, a 64 bit byte count
+  and that many bytes, as the machine holds them:
+
+  "FGRD"  version (int 1), 0x01020304 (int, to tell the byte order),
+          nx and ny (ints), x0, x1, y0 and y1 (doubles, meters)
+  "FELD"  active line name (SIZE_SIG_NAME characters), then the
+          potential (Volts), the x component and the y component of the
+          field (Volts/meter) at each point, each nx * ny floats with x
+          varying fastest, from x0,y0
+
+  FGRD is written once, then one FELD for each conductor.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* the integration points of one solution and the grid being filled */
+typedef struct field_grid_job
+{
+  FIELD_GRID_P grid;
+  int sources;
+  double *X, *Y, *charge;
+  float *potential, *field_x, *field_y;
+  pthread_mutex_t lock;
+  int next_row;
+} FIELD_GRID_JOB, *FIELD_GRID_JOB_P;
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void *nmmtl_field_grid_worker(void *arg);
+static void nmmtl_field_grid_row(FIELD_GRID_JOB_P job, int row);
+static void nmmtl_field_grid_write(FILE *file, const char *tag,
+                                   const void *data, size_t length,
+                                   size_t rest);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_spec
+
+  FUNCTIONAL DESCRIPTION:
+
+  Reads the grid given on the command line, "x0,x1,nx,y0,y1,ny".
+
+  FORMAL PARAMETERS:
+
+  const char *spec      - the grid
+  FIELD_GRID_P grid     - out: its corners and points, file not touched
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL with a message if it is not a grid
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_field_grid_spec(argv[++ii],&field_grid);
+
+  */
+
+int nmmtl_field_grid_spec(const char *spec, FIELD_GRID_P grid)
+{
+  char extra;
+
+  if(sscanf(spec,"%lf,%lf,%d,%lf,%lf,%d%c",&grid->x0,&grid->x1,&grid->nx,
+            &grid->y0,&grid->y1,&grid->ny,&extra) != 6)
+  {
+    printf("ERROR: field grid %s is not x0,x1,nx,y0,y1,ny\n",spec);
+    return(FAIL);
+  }
+  if(grid->nx < 1 || grid->ny < 1 ||
+     (double)grid->nx * grid->ny > FIELD_GRID_MAX_POINTS)
+  {
+    printf("ERROR: field grid needs from 1 to %d points, not %d by %d\n",
+           FIELD_GRID_MAX_POINTS,grid->nx,grid->ny);
+    return(FAIL);
+  }
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_header
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the FGRD record, which the main does once, when it opens the
+  field grid file.
+
+  FORMAL PARAMETERS:
+
+  FIELD_GRID_P grid     - the grid, and its file
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_field_grid_header(&field_grid);
+
+  */
+
+void nmmtl_field_grid_header(FIELD_GRID_P grid)
+{
+  int32_t ints[4];
+  double corners[4];
+
+  ints[0] = 1;
+  ints[1] = 0x01020304;
+  ints[2] = grid->nx;
+  ints[3] = grid->ny;
+  corners[0] = grid->x0;
+  corners[1] = grid->x1;
+  corners[2] = grid->y0;
+  corners[3] = grid->y1;
+
+  nmmtl_field_grid_write(grid->file,"FGRD",ints,sizeof(ints),
+                         sizeof(corners));
+  fwrite(corners,sizeof(corners),1,grid->file);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_evaluate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Evaluate the potential and field of a solution on the grid, and write
+  them as a FELD record.
+
+  FORMAL PARAMETERS:
+
+  FIELD_GRID_P grid                 - the grid, and its file
+  CONTOURS_P signal                 - the active signal
+  int conductor_counter             - how many signals
+  CONDUCTOR_DATA_P conductor_data   - the elements of each conductor
+  ELEMENT_STORE_P element_store     - and of the dielectric interfaces
+  double *sigma_vector              - the charge at each node
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_field_grid_evaluate(fieldGrid,activeLine,
+                                     conductor_counter,conductor_data,
+                                     element_store,sigma_vector);
+
+  */
+
+int nmmtl_field_grid_evaluate(FIELD_GRID_P grid,
+                              CONTOURS_P signal,
+                              int conductor_counter,
+                              CONDUCTOR_DATA_P conductor_data,
+                              ELEMENT_STORE_P element_store,
+                              double *sigma_vector)
+{
+  FIELD_GRID_JOB job;
+  CELEMENTS_P cel,cel_end;
+  DELEMENTS_P del,del_end;
+  pthread_t *threads;
+  int *started;
+  int cond_num, elements, workers, i;
+  size_t points;
+  char name[SIZE_SIG_NAME];
+
+  /* - - - - - - - - - - - - the integration points - - - - - - - - - - - */
+
+  elements = element_store->number_delements;
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+    elements += conductor_data[cond_num].number_elements;
+
+  points = (size_t)grid->nx * (size_t)grid->ny;
+  job.grid = grid;
+  job.X = (double *)malloc(sizeof(double) * (size_t)elements *
+                           Legendre_root_i_max);
+  job.Y = (double *)malloc(sizeof(double) * (size_t)elements *
+                           Legendre_root_i_max);
+  job.charge = (double *)malloc(sizeof(double) * (size_t)elements *
+                                Legendre_root_i_max);
+  job.potential = (float *)malloc(sizeof(float) * 3 * points);
+  if(job.X == NULL || job.Y == NULL || job.charge == NULL ||
+     job.potential == NULL)
+  {
+    printf("Error: out of memory for the field grid\n");
+    free(job.X);
+    free(job.Y);
+    free(job.charge);
+    free(job.potential);
+    return(FAIL);
+  }
+  job.field_x = job.potential + points;
+  job.field_y = job.field_x + points;
+
+  job.sources = 0;
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+  {
+    cel = conductor_data[cond_num].elements;
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    for(; cel < cel_end; cel++)
+      job.sources += nmmtl_interval_sources_c(cel,sigma_vector,
+                                              job.X + job.sources,
+                                              job.Y + job.sources,
+                                              job.charge + job.sources);
+  }
+  del = element_store->delements;
+  del_end = del + element_store->number_delements;
+  for(; del < del_end; del++)
+    job.sources += nmmtl_interval_sources_d(del,sigma_vector,
+                                            job.X + job.sources,
+                                            job.Y + job.sources,
+                                            job.charge + job.sources);
+
+  /* - - - - - - - - - - - the rows, a thread per cpu - - - - - - - - - - - */
+
+  workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if(workers > grid->ny) workers = grid->ny;
+  if(workers < 1) workers = 1;
+
+  pthread_mutex_init(&job.lock,NULL);
+  job.next_row = 0;
+
+  /* the calling thread takes rows too, and any a thread could not be
+     started for are left to it */
+  threads = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)workers);
+  started = (int *)calloc((size_t)workers,sizeof(int));
+  if(threads != NULL && started != NULL)
+    for(i = 1; i < workers; i++)
+      started[i] = pthread_create(&threads[i],NULL,nmmtl_field_grid_worker,
+                                  &job) == 0;
+  nmmtl_field_grid_worker(&job);
+  if(threads != NULL && started != NULL)
+    for(i = 1; i < workers; i++)
+      if(started[i]) pthread_join(threads[i],NULL);
+  free(threads);
+  free(started);
+  pthread_mutex_destroy(&job.lock);
+
+  /* - - - - - - - - - - - - - - the FELD record - - - - - - - - - - - - - */
+
+  memset(name,0,sizeof(name));
+  memcpy(name,signal->name,strnlen(signal->name,sizeof(name) - 1));
+  nmmtl_field_grid_write(grid->file,"FELD",name,sizeof(name),
+                         sizeof(float) * 3 * points);
+  fwrite(job.potential,sizeof(float),3 * points,grid->file);
+
+  free(job.X);
+  free(job.Y);
+  free(job.charge);
+  free(job.potential);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_worker
+
+  FUNCTIONAL DESCRIPTION:
+
+  Evaluate rows of the grid until there are none left.
+
+  FORMAL PARAMETERS:
+
+  void *arg   - the FIELD_GRID_JOB
+
+  RETURN VALUE:
+
+  NULL
+
+  CALLING SEQUENCE:
+
+  pthread_create(&threads[i],NULL,nmmtl_field_grid_worker,&job);
+
+  */
+
+static void *nmmtl_field_grid_worker(void *arg)
+{
+  FIELD_GRID_JOB_P job = (FIELD_GRID_JOB_P)arg;
+  int row;
+
+  for(;;)
+  {
+    pthread_mutex_lock(&job->lock);
+    row = job->next_row++;
+    pthread_mutex_unlock(&job->lock);
+    if(row >= job->grid->ny) break;
+    nmmtl_field_grid_row(job,row);
+  }
+  return(NULL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_row
+
+  FUNCTIONAL DESCRIPTION:
+
+  Evaluate the potential and field at the points of a row of the grid.
+  The loop over the integration points reads only flat arrays and keeps
+  nothing from one point to the next but the sums, so the compiler may
+  vectorize it.
+
+  FORMAL PARAMETERS:
+
+  FIELD_GRID_JOB_P job    - the integration points and the grid
+  int row                 - which row, from y0
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_field_grid_row(job,row);
+
+  */
+
+static void nmmtl_field_grid_row(FIELD_GRID_JOB_P job, int row)
+{
+  FIELD_GRID_P grid = job->grid;
+  const double *X = job->X, *Y = job->Y, *charge = job->charge;
+  double scale = (ASSEMBLE_CONST_1) / (EPSILON_NAUGHT);
+  double x,y,dx,dy1,dy2,d1,d2;
+  double potential,field_x,field_y;
+  size_t point;
+  int column,k;
+
+  y = grid->ny > 1 ?
+    grid->y0 + (grid->y1 - grid->y0) * row / (grid->ny - 1) : grid->y0;
+
+  for(column = 0; column < grid->nx; column++)
+  {
+    x = grid->nx > 1 ?
+      grid->x0 + (grid->x1 - grid->x0) * column / (grid->nx - 1) : grid->x0;
+
+    potential = 0.0;
+    field_x = 0.0;
+    field_y = 0.0;
+    for(k = 0; k < job->sources; k++)
+    {
+      /* squared distances to the charge and to its image */
+      dx = x - X[k];
+      dy1 = y - Y[k];
+      dy2 = y + Y[k];
+      d1 = dx*dx + dy1*dy1;
+      d2 = dx*dx + dy2*dy2;
+
+      potential += charge[k] * log(d2/d1);
+      field_x += charge[k] * ( dx/d1 - dx/d2 );
+      field_y += charge[k] * ( dy1/d1 - dy2/d2 );
+    }
+
+    /* log(d2/d1) above is of the squared distances */
+    point = (size_t)row * (size_t)grid->nx + (size_t)column;
+    job->potential[point] = (float)(0.5 * scale * potential);
+    job->field_x[point] = (float)(scale * field_x);
+    job->field_y[point] = (float)(scale * field_y);
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_field_grid_write
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the tag and byte count of a record and the first of its data;
+  the caller writes the rest.
+
+  FORMAL PARAMETERS:
+
+  FILE *file          - the field grid file
+  const char *tag     - four characters
+  const void *data    - the first of the data
+  size_t length       - its length
+  size_t rest         - the length of the data the caller writes
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_field_grid_write(file,"FELD",name,sizeof(name),rest);
+
+  */
+
+static void nmmtl_field_grid_write(FILE *file, const char *tag,
+                                   const void *data, size_t length,
+                                   size_t rest)
+{
+  int64_t total = (int64_t)(length + rest);
+
+  fwrite(tag,1,4,file);
+  fwrite(&total,sizeof(total),1,file);
+  fwrite(data,1,length,file);
+}
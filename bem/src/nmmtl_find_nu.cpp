@@ -6,7 +6,7 @@
   MODULE DESCRIPTION:
 
   Contains nmmtl_find_nu - to find an edge effects constant
-  and an #ifdefed main to test it
+  and an #ifdefed main to test it.  Safe to call from any thread.
 
   AUTHOR(S):
 
@@ -26,16 +26,29 @@
  */
 
 #include "nmmtl.h"
-#ifdef FORTRAN_UNDERBARS
-#define FMIN fmin_
-#else
-#define FMIN fmin
-#endif
+
+#include <pthread.h>
+
 /*
  *******************************************************************
  **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
  *******************************************************************
  */
+
+/* the constants of the nu equation for one edge - see nmmtl_nu_function */
+typedef struct nu_equation
+{
+  double epsilon_term;  /* (epsilon1 - epsilon2)/(epsilon1 + epsilon2) */
+  double theta2;
+  double theta_term;    /* 2*theta1 - theta2 */
+} NU_EQUATION, *NU_EQUATION_P;
+
+/* a solved edge: the equation and the nu found */
+typedef struct nu_cache_entry
+{
+  NU_EQUATION equation;
+  double nu;
+} NU_CACHE_ENTRY, *NU_CACHE_ENTRY_P;
 /*
  *******************************************************************
  **  MACRO DEFINITIONS
@@ -46,24 +59,42 @@
  **  PREPROCESSOR CONSTANTS
  *******************************************************************
  */
+
+/* number of solved edges remembered by nmmtl_find_nu */
+#define NU_CACHE_SIZE 64
+
+/* nu is looked for in (0,1], the range of an edge singularity, by
+   stepping across it this many times to bracket the smallest root */
+#define NU_SCAN_STEPS 16
+
+/* how closely nu is found */
+#define NU_TOLERANCE 1.0e-12
+
+/* how close an angle has to be to take a closed form */
+#define NU_ANGLE_TOLERANCE 1.0e-9
 /*
  *******************************************************************
  **  GLOBALS
  *******************************************************************
  */
 
-static double EPSILON_TERM; /* the constant term in nu equation */
-static double THETA2;       /* constant in nu equation */
-static double THETA_TERM;   /* constant in nu equation 2*theta1 - theta2 */
+/* The same few corner angles and dielectric pairs come up over and over,
+   within a cross section and from one cross section to the next in a long
+   running process, so the solutions are kept.  Shared by all threads. */
+static NU_CACHE_ENTRY nu_cache[NU_CACHE_SIZE];
+static int nu_cache_count = 0;      /* entries in use */
+static int nu_cache_next = 0;       /* next entry to replace when full */
+static pthread_mutex_t nu_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  *******************************************************************
  **  FUNCTION DECLARATIONS
  *******************************************************************
  */
-extern "C" void FMIN(double (*nmmtl_nu_function)(double *), double *a,
-  double *b, double *x, double *w, double *aerr, double *rerr,
-  double *error, int *ind);
+static int nmmtl_nu_closed_form(NU_EQUATION_P equation, double *nu);
+static double nmmtl_nu_solve(NU_EQUATION_P equation);
+static double nmmtl_nu_brent(NU_EQUATION_P equation, double a, double b,
+                             double fa, double fb);
 /*
  *******************************************************************
  **  FUNCTION DEFINITIONS
@@ -79,26 +110,35 @@ extern "C" void FMIN(double (*nmmtl_nu_function)(double *), double *a,
 
   Solve the transcendental equation:
 
-  0 = ( sin( nu * theta2 ) - sin( nu * (2 * theta1 - theta2)
-  * ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 ) )**2
-
-  The second term is given by the variable EPSILON_TERM.
+  0 = sin( nu * theta2 ) - sin( nu * (2 * theta1 - theta2) )
+  * ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 )
 
   for nu, given the value of theta1, theta2, epsilon1 and epsilon2.
-  We will make an attempt to use the NSWC function FMIN to find the
-  minimum of this function.
+  The root wanted is the smallest one above zero, which sets how the
+  charge density goes to infinity at the edge, so it is looked for in
+  (0,1]; if there is no root there, the edge has no singularity and 1 is
+  returned.
+
+  The equation depends only on the three constants of NU_EQUATION, and
+  changes only in sign when the sign of both the epsilon term and theta
+  term changes, so it is put in that form with the theta term positive,
+  and then:
+
+  1) where there is a closed form, it is used - see nmmtl_nu_closed_form.
+  2) otherwise previously found solutions are looked up in nu_cache.
+  3) otherwise the root is bracketed and found by Brent's method, and
+     kept in nu_cache.
 
   FORMAL PARAMETERS:
 
-  float epsilon1     epsilon value passed in
-  float epsilon2     epsilon value passed in
-  float theta1       angle passed in
-  float theta2       angle passed in
+  double epsilon1     epsilon value passed in
+  double epsilon2     epsilon value passed in
+  double theta1       angle passed in
+  double theta2       angle passed in
 
   RETURN VALUE:
 
-  value of nu satisfying equation, -1.0 if no accurate solution, since
-  nu should be a positive constant.
+  value of nu satisfying equation
 
   CALLING SEQUENCE:
 
@@ -110,66 +150,293 @@ double nmmtl_find_nu(double epsilon1,
                      double epsilon2,
                      double theta1,
                      double theta2) {
-  double a,b;
+  NU_EQUATION equation;
   double nu;
-  double fofnu;
-  double AERR,RERR;
-  double ERROR;
-  int IND;
+  int i;
+
+  equation.epsilon_term = (epsilon1 - epsilon2)/(epsilon1 + epsilon2);
+  equation.theta2 = theta2;
+  equation.theta_term = 2.*theta1 - theta2;
+  if(equation.theta_term < 0.0)
+  {
+    equation.theta_term = -equation.theta_term;
+    equation.epsilon_term = -equation.epsilon_term;
+  }
 
-  /* setup constants to call to FMIN */
+  if(nmmtl_nu_closed_form(&equation,&nu)) return(nu);
+
+  /* already solved? */
+  pthread_mutex_lock(&nu_cache_lock);
+  for(i = 0; i < nu_cache_count; i++)
+  {
+    if(nu_cache[i].equation.epsilon_term == equation.epsilon_term &&
+       nu_cache[i].equation.theta2 == equation.theta2 &&
+       nu_cache[i].equation.theta_term == equation.theta_term)
+    {
+      nu = nu_cache[i].nu;
+      pthread_mutex_unlock(&nu_cache_lock);
+      return(nu);
+    }
+  }
+  pthread_mutex_unlock(&nu_cache_lock);
+
+  nu = nmmtl_nu_solve(&equation);
 
-  a = 1.0e-4F;      /* lower endpoint of interval */
-  b = 1.0F;     /* upper endpoint of interval */
-  AERR = 10.0e-7F;  /* absolute error tolerance- 7 significant digits */
-  RERR = 0.0F;      /* relative error tolerance- to machine precision */
+#ifdef TEST_FIND_NU
+  printf("nu=%f, f(nu)=%g\n",nu,nmmtl_nu_function(nu,equation.epsilon_term,
+                                                 equation.theta2,
+                                                 equation.theta_term));
+#endif
 
+  pthread_mutex_lock(&nu_cache_lock);
+  if(nu_cache_count < NU_CACHE_SIZE) i = nu_cache_count++;
+  else
+  {
+    i = nu_cache_next;
+    nu_cache_next = (nu_cache_next + 1) % NU_CACHE_SIZE;
+  }
+  nu_cache[i].equation = equation;
+  nu_cache[i].nu = nu;
+  pthread_mutex_unlock(&nu_cache_lock);
 
-  /* setup globals for nmmtl_nu_function() */
+  return(nu);
+}
 
-  EPSILON_TERM = (epsilon1 - epsilon2)/(epsilon1 + epsilon2);
-  THETA2 = theta2;
-  THETA_TERM = 2.*theta1 - theta2;
 
-  FMIN(nmmtl_nu_function,&a,&b,&nu,&fofnu,&AERR,&RERR,&ERROR,&IND);
+/*
 
-#ifdef TEST_FIND_NU
-  printf("nu=%f, f(nu)=%f, error=%f\n",nu,fofnu,ERROR);
-#endif
+  FUNCTION NAME:  nmmtl_nu_closed_form
 
-  if (IND == 0) {
-    return(nu);
-  } else {
-    fprintf(stderr,"ELECTRO-F-NOSOLUTION No solution for transcendental equation for edge effects was found, error=%f\n",ERROR);
-    return(-1.0F);
+
+  FUNCTIONAL DESCRIPTION:
+
+  Solve the nu equation directly in the cases where that can be done:
+
+  - a homogeneous dielectric (epsilon term 0), or an interface bisecting
+    the edge (theta term 0): sin( nu * theta2 ) = 0, so nu = PI/theta2.
+
+  - a right angle conductor corner with the interface along one side:
+    theta2 = 3*PI/2 and theta term PI/2.  With x = nu*PI/2,
+    sin(3x) = 3 sin(x) - 4 sin(x)**3, so
+
+    sin(x)**2 = ( 3 - epsilon term ) / 4
+
+    which is the corner of every rectangular conductor on or under a
+    dielectric layer.
+
+  FORMAL PARAMETERS:
+
+  NU_EQUATION_P equation  - the equation, theta term not negative
+  double *nu              - nu returned, if solved
+
+  RETURN VALUE:
+
+  TRUE if solved, FALSE if not
+
+  CALLING SEQUENCE:
+
+  if(nmmtl_nu_closed_form(&equation,&nu)) return(nu);
+
+  */
+
+static int nmmtl_nu_closed_form(NU_EQUATION_P equation, double *nu)
+{
+  if(equation->epsilon_term == 0.0 ||
+     equation->theta_term < NU_ANGLE_TOLERANCE)
+  {
+    *nu = PI/equation->theta2;
+    if(*nu > 1.0) *nu = 1.0;
+    return(TRUE);
+  }
+
+  if(fabs(equation->theta2 - 1.5*PI) < NU_ANGLE_TOLERANCE &&
+     fabs(equation->theta_term - 0.5*PI) < NU_ANGLE_TOLERANCE)
+  {
+    *nu = 2.0/PI * asin(sqrt(0.25*(3.0 - equation->epsilon_term)));
+    return(TRUE);
   }
+
+  return(FALSE);
 }
 
 
 /*
 
-  FUNCTION NAME:  nmmtl_nu_function(float *nu);
+  FUNCTION NAME:  nmmtl_nu_solve
 
 
   FUNCTIONAL DESCRIPTION:
 
-  evaluate the equation to minimize for determining the value of nu.
+  Find the smallest root of the nu equation in (0,1].  The function
+  rises from zero at nu = 0, since the magnitude of the epsilon term is
+  below one and the theta term is no bigger than theta2, so the root is
+  bracketed by stepping along until it changes sign, and then closed in
+  on by Brent's method.
 
-  0 = ( sin( nu * theta2 ) / sin( nu * (2 * theta1 - theta2) )
-  - ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 ) )**2
+  FORMAL PARAMETERS:
+
+  NU_EQUATION_P equation  - the equation
+
+  RETURN VALUE:
+
+  nu, or 1.0 if there is no root in (0,1]
+
+  CALLING SEQUENCE:
+
+  nu = nmmtl_nu_solve(&equation);
+
+  */
+
+static double nmmtl_nu_solve(NU_EQUATION_P equation)
+{
+  double a,b,fa,fb;
+  int step;
+
+  a = 1.0/NU_SCAN_STEPS;
+  fa = nmmtl_nu_function(a,equation->epsilon_term,equation->theta2,
+                         equation->theta_term);
+  for(step = 2; step <= NU_SCAN_STEPS; step++)
+  {
+    b = (double)step/NU_SCAN_STEPS;
+    fb = nmmtl_nu_function(b,equation->epsilon_term,equation->theta2,
+                           equation->theta_term);
+    if(fb == 0.0) return(b);
+    if((fa < 0.0) != (fb < 0.0))
+      return(nmmtl_nu_brent(equation,a,b,fa,fb));
+    a = b;
+    fa = fb;
+  }
+
+  return(1.0);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_nu_brent
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Brent's method for the root of the nu equation between a and b, at
+  which the function has opposite signs: inverse quadratic or secant
+  steps where they stay inside the bracket and shrink it fast enough,
+  bisection where not.
+
+  FORMAL PARAMETERS:
+
+  NU_EQUATION_P equation  - the equation
+  double a,b              - the bracket
+  double fa,fb            - the function at a and b
+
+  RETURN VALUE:
+
+  the root
+
+  CALLING SEQUENCE:
+
+  nu = nmmtl_nu_brent(equation,a,b,fa,fb);
+
+  */
+
+static double nmmtl_nu_brent(NU_EQUATION_P equation, double a, double b,
+                             double fa, double fb)
+{
+  double c,fc,d,e;
+  double m,tol,p,q,r,s;
+
+  c = a;
+  fc = fa;
+  d = e = b - a;
+
+  for(;;)
+  {
+    /* keep b the best estimate, with the root between b and c */
+    if((fb < 0.0) == (fc < 0.0))
+    {
+      c = a;
+      fc = fa;
+      d = e = b - a;
+    }
+    if(fabs(fc) < fabs(fb))
+    {
+      a = b;  b = c;  c = a;
+      fa = fb;  fb = fc;  fc = fa;
+    }
+
+    tol = 2.0*DBL_EPSILON*fabs(b) + 0.5*NU_TOLERANCE;
+    m = 0.5*(c - b);
+    if(fabs(m) <= tol || fb == 0.0) return(b);
+
+    if(fabs(e) < tol || fabs(fa) <= fabs(fb))
+    {
+      /* bisect */
+      d = e = m;
+    }
+    else
+    {
+      s = fb/fa;
+      if(a == c)
+      {
+        /* secant */
+        p = 2.0*m*s;
+        q = 1.0 - s;
+      }
+      else
+      {
+        /* inverse quadratic */
+        q = fa/fc;
+        r = fb/fc;
+        p = s*(2.0*m*q*(q - r) - (b - a)*(r - 1.0));
+        q = (q - 1.0)*(r - 1.0)*(s - 1.0);
+      }
+      if(p > 0.0) q = -q;
+      else p = -p;
+
+      if(2.0*p < 3.0*m*q - fabs(tol*q) && p < fabs(0.5*e*q))
+      {
+        e = d;
+        d = p/q;
+      }
+      else
+      {
+        d = e = m;
+      }
+    }
+
+    a = b;
+    fa = fb;
+    b += fabs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+    fb = nmmtl_nu_function(b,equation->epsilon_term,equation->theta2,
+                           equation->theta_term);
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_nu_function
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  evaluate the equation whose root is nu.
+
+  0 = sin( nu * theta2 ) / sin( nu * (2 * theta1 - theta2) )
+  - ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 )
 
   this equation divides by zero when theta1 = 1/2 theta2, therefore multiply
   both sides by sin( nu * (2 * theta1 - theta2) ) and use the new equation:
 
-  0 = ( sin( nu * theta2 ) - sin( nu * (2 * theta1 - theta2)
-  * ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 ) )**2
+  0 = sin( nu * theta2 ) - sin( nu * (2 * theta1 - theta2) )
+  * ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 )
 
   FORMAL PARAMETERS:
 
-  float *nu;  the value of nu to use
-  Note: this function accepts a pointer to nu since this function
-  must be called from FORTRAN which by default passes arguments by
-  reference
+  double nu            the value of nu to use
+  double epsilon_term  ( epsilon1 - epsilon2 ) / ( epsilon1 + epsilon2 )
+  double theta2
+  double theta_term    2 * theta1 - theta2
 
   RETURN VALUE:
 
@@ -177,12 +444,13 @@ double nmmtl_find_nu(double epsilon1,
 
   CALLING SEQUENCE:
 
+  f = nmmtl_nu_function(nu,epsilon_term,theta2,theta_term);
+
   */
-double nmmtl_nu_function(double *nu)
+double nmmtl_nu_function(double nu, double epsilon_term, double theta2,
+                         double theta_term)
 {
-  double x;
-  x = sin(*nu * THETA2) - sin(*nu * THETA_TERM) * EPSILON_TERM;
-  return( x * x );
+  return(sin(nu * theta2) - sin(nu * theta_term) * epsilon_term);
 }
 
 /*
@@ -213,7 +481,7 @@ double nmmtl_nu_function(double *nu)
 main()
 {
   double nu;
-  double theta1;
+  double theta1,theta2;
 
 
   printf("symmetry test1\n");
@@ -234,16 +502,15 @@ main()
    PI/3,31*PI/16,1.0F,2.0F,nmmtl_find_nu(1.0F,2.0F,PI/3,31*PI/16));
 
   printf("now entering evaluation phase:\nenter theta1 and theta2\n");
-  scanf("%f %f",&theta1,&THETA2);
-
-  THETA_TERM = 2*theta1 - THETA2;
+  scanf("%lf %lf",&theta1,&theta2);
 
   nu = 0.0;
   while(nu >= 0.0F) {
     printf("enter nu:\n");
-    scanf("%f",&nu);
+    scanf("%lf",&nu);
     if(nu < 0.0F) break;
-    printf("f(nu)=%f\n\n",nmmtl_nu_function(&nu));
+    printf("f(nu)=%f\n\n",nmmtl_nu_function(nu,-1.0/3.0,theta2,
+                                            2*theta1 - theta2));
   }
 }
 #endif
@@ -85,16 +85,25 @@ int nmmtl_form_die_subseg(int plane_segments,
         SORTED_GND_DIE_LIST_P *upper_sorted_gdl) {
 
   struct dielectric_sub_segments *new_seg;
-  GND_DIE_LIST_P lower_gdl      = NULL;
-  GND_DIE_LIST_P lower_gdl_head = NULL;
-  GND_DIE_LIST_P upper_gdl      = NULL;
-  GND_DIE_LIST_P upper_gdl_head = NULL;
+  struct dielectric *die;
+  GND_DIE_LIST_P lower_gdl, upper_gdl;
+  int number_lower_gdl = 0, number_upper_gdl = 0;
+  int number_dielectrics = 0;
+
+  /* at most every dielectric touches each ground plane */
+  for(die = dielectrics; die != NULL; die = die->next) number_dielectrics++;
+  lower_gdl = (GND_DIE_LIST_P)malloc(sizeof(GND_DIE_LIST) *
+                                     (size_t)(2 * number_dielectrics + 1));
+  upper_gdl = lower_gdl + number_dielectrics;
 
   for( ; dielectrics != NULL; dielectrics = dielectrics->next) {
     /* new top segment */
     /* does dielectric top touch upper ground plane? */
     if (dielectrics->y1 == bottom_of_top_plane) {
-      upper_gdl = nmmtl_build_gnd_die_list(&upper_gdl_head, upper_gdl, dielectrics);
+      upper_gdl[number_upper_gdl].start = dielectrics->x0;
+      upper_gdl[number_upper_gdl].end = dielectrics->x1;
+      upper_gdl[number_upper_gdl].epsilon = dielectrics->constant;
+      number_upper_gdl++;
     } else {
       new_seg = (struct dielectric_sub_segments *)
   malloc(sizeof(struct dielectric_sub_segments));
@@ -117,8 +126,10 @@ int nmmtl_form_die_subseg(int plane_segments,
     /* does dielectric bottom sit on lower ground plane? */
     if(dielectrics->y0 == top_of_bottom_plane)
     {
-      lower_gdl = nmmtl_build_gnd_die_list(&lower_gdl_head,lower_gdl,
-             dielectrics);
+      lower_gdl[number_lower_gdl].start = dielectrics->x0;
+      lower_gdl[number_lower_gdl].end = dielectrics->x1;
+      lower_gdl[number_lower_gdl].epsilon = dielectrics->constant;
+      number_lower_gdl++;
     }
     else  /* just regular lower die subsegment */
     {
@@ -179,11 +190,13 @@ int nmmtl_form_die_subseg(int plane_segments,
 
   /* clean up and sort the list of dielectric-ground plane intersections */
 
-  nmmtl_sort_gnd_die_list(lower_gdl_head,lower_sorted_gdl,
-        upper_gdl_head,upper_sorted_gdl,
+  nmmtl_sort_gnd_die_list(lower_gdl,number_lower_gdl,lower_sorted_gdl,
+        upper_gdl,number_upper_gdl,upper_sorted_gdl,
         left_of_gnd_planes,
         right_of_gnd_planes);
 
+  free(lower_gdl);
+
 
   return(SUCCESS);
 }
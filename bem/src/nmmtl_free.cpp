@@ -0,0 +1,226 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the functions which release the geometry lists, segment lists
+  and elements built up while processing a cross section, so that one
+  process can solve many cross sections.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_contours
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free a list of signal or ground wire contours, along with the points
+  of the polygons.
+
+  FORMAL PARAMETERS:
+
+  struct contour *contours    - head of the list, may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_contours(signals);
+
+  */
+
+void nmmtl_free_contours(struct contour *contours)
+{
+  struct contour *next_contour, *block = NULL;
+  POLYPOINTS_P point, next_point;
+
+  while(contours != NULL)
+  {
+    next_contour = contours->next;
+    for(point = contours->points; point != NULL; point = next_point)
+    {
+      next_point = point->next;
+      free(point);
+    }
+    /* the contours of a list allocated together go with their array */
+    if(contours->block == NULL) free(contours);
+    else block = contours->block;
+    contours = next_contour;
+  }
+  free(block);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_dielectrics
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free a list of dielectric rectangles.
+
+  FORMAL PARAMETERS:
+
+  struct dielectric *dielectrics  - head of the list, may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_dielectrics(dielectrics);
+
+  */
+
+void nmmtl_free_dielectrics(struct dielectric *dielectrics)
+{
+  struct dielectric *next;
+
+  while(dielectrics != NULL)
+  {
+    next = dielectrics->next;
+    free(dielectrics);
+    dielectrics = next;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_segments
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the conductor line and circle segments and the dielectric
+  segments once the elements have been generated from them.
+
+  FORMAL PARAMETERS:
+
+  LINE_SEGMENTS_P conductor_ls               - may be NULL
+  CIRCLE_SEGMENTS_P conductor_cs             - may be NULL
+  DIELECTRIC_SEGMENTS_P dielectric_segments  - may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_segments(conductor_ls,conductor_cs,dielectric_segments);
+
+  */
+
+void nmmtl_free_segments(LINE_SEGMENTS_P conductor_ls,
+                         CIRCLE_SEGMENTS_P conductor_cs,
+                         DIELECTRIC_SEGMENTS_P dielectric_segments)
+{
+  LINE_SEGMENTS_P next_ls;
+  CIRCLE_SEGMENTS_P next_cs;
+  DIELECTRIC_SEGMENTS_P next_ds;
+
+  while(conductor_ls != NULL)
+  {
+    next_ls = conductor_ls->next;
+    free(conductor_ls);
+    conductor_ls = next_ls;
+  }
+
+  while(conductor_cs != NULL)
+  {
+    next_cs = conductor_cs->next;
+    free(conductor_cs);
+    conductor_cs = next_cs;
+  }
+
+  while(dielectric_segments != NULL)
+  {
+    next_ds = dielectric_segments->next;
+    free(dielectric_segments);
+    dielectric_segments = next_ds;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_sorted_list
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free a floating point keyed sorted list, such as the sorted ground
+  plane - dielectric lists, along with the data each entry points to.
+  These all live in the one block headed by the first entry.
+
+  FORMAL PARAMETERS:
+
+  FLT_KEY_LIST_P list     - head of the list, may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_sorted_list(upper_sorted_gdl);
+
+  */
+
+void nmmtl_free_sorted_list(FLT_KEY_LIST_P list)
+{
+  free(list);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_elements
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the elements in the element store and the conductor data array
+  which gives the range of each conductor's elements.
+
+  FORMAL PARAMETERS:
+
+  CONDUCTOR_DATA_P conductor_data    - may be NULL
+  ELEMENT_STORE_P element_store      - the store
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_elements(conductor_data,&element_store);
+
+  */
+
+void nmmtl_free_elements(CONDUCTOR_DATA_P conductor_data,
+                         ELEMENT_STORE_P element_store)
+{
+  free(conductor_data);
+  nmmtl_element_store_free(element_store);
+}
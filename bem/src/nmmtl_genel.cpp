@@ -30,16 +30,18 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
 
   Take the list of segments for conductors and dielectric boundaries and
   generate the small elements from that.  Point each element to appropriate
-  array indicies for the Main arrays used in calculation.
+  array indicies for the Main arrays used in calculation.  The elements
+  all go into the element store, and the conductor data array is set to
+  the range of elements of each conductor.
 
 
   FORMAL PARAMETERS:
 
   int conductor_counter,            a count of the number of conductors
-  CONDUCTOR_DATA_P *conductor_data,  to-be-allocated array of pointers to
+  CONDUCTOR_DATA_P *conductor_data,  to-be-allocated array of ranges of
   conductor elements (output)
-  DELEMENTS_P *die_elements,         pointer to start of list of die elements
-  generated by this function (output)
+  ELEMENT_STORE_P element_store,     store of all the elements, zeroed to
+  start with (output)
   unsigned int *node_point_counter   counter of all node points used.
   unsigned int *highest_conductor_node,  highest node number of conductors
   LINE_SEGMENTS_P conductor_ls,      list of conductor line segments
@@ -61,7 +63,7 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   CALLING SEQUENCE:
 
   status = nmmtl_generate_elements(conductor_counter,&conductor_data,
-                                   &die_elements,
+                                   &element_store,
            &node_point_counter,
            &highest_conductor_node,
            conductor_ls,conductor_cs,
@@ -78,7 +80,7 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   */
 int nmmtl_generate_elements(int conductor_counter,
           CONDUCTOR_DATA_P *conductor_data,
-          DELEMENTS_P *die_elements,
+          ELEMENT_STORE_P element_store,
           unsigned int *node_point_counter,
           unsigned int *highest_conductor_node,
           LINE_SEGMENTS_P conductor_ls,
@@ -96,12 +98,9 @@ int nmmtl_generate_elements(int conductor_counter,
   CONDUCTOR_DATA_P cd;
   LINE_SEGMENTS_P cls;
   CIRCLE_SEGMENTS_P ccs;
-  CELEMENTS_P head                = NULL;
-  CELEMENTS_P tail                = NULL;
-  CELEMENTS_P gnd_list            = NULL;
-  CELEMENTS_P gnd_list_head       = NULL;
-  CELEMENTS_P gnd_plane_list_head = NULL;
   unsigned int node_point_counter_start;
+  int number_celements;
+  int gnd_elements = FALSE;
   int number_elements = 0;
   char infostring[256];
 
@@ -114,34 +113,35 @@ int nmmtl_generate_elements(int conductor_counter,
   cls = conductor_ls;
   while(cls != NULL) {
     current_conductor = cls->conductor;
+    number_celements = element_store->number_celements;
     if(current_conductor != 0) {
       cd[current_conductor].node_start = *node_point_counter;
-      nmmtl_generate_elements_cls(&cls, &head, &tail, node_point_counter);
-      if(head == NULL) {
+      if(nmmtl_generate_elements_cls(&cls, element_store,
+                                     node_point_counter) != SUCCESS ||
+         element_store->number_celements == number_celements) {
         printf ("**** Error in element generation: from conductor line segment\n");
         return(FAIL);
       }
-      cd[current_conductor].elements = head;
       cd[current_conductor].node_end = *node_point_counter-1;
       number_elements +=
         (cd[current_conductor].node_end -
-         cd[current_conductor].node_start + 1)/2;
+         cd[current_conductor].node_start + 1)/ELEMENT_ORDER;
     } else {
-      if (gnd_list_head == NULL)
+      if (!gnd_elements)
         cd[0].node_start = *node_point_counter;
 
       node_point_counter_start = *node_point_counter;
 
-      nmmtl_generate_elements_cls(&cls,&head,&tail,node_point_counter);
-      if(gnd_list_head == NULL)
-        gnd_list_head = head;
-      else
-        gnd_list->next = head;
-
-      gnd_list = tail;
+      if(nmmtl_generate_elements_cls(&cls,element_store,
+                                     node_point_counter) != SUCCESS) {
+        printf ("**** Error in element generation: from conductor line segment\n");
+        return(FAIL);
+      }
+      gnd_elements = TRUE;
       cd[0].node_end = *node_point_counter-1;
 
-      number_elements += (cd[0].node_end - node_point_counter_start + 1)/2;
+      number_elements +=
+        (cd[0].node_end - node_point_counter_start + 1)/ELEMENT_ORDER;
     }
     /* if(cls != NULL) cls = cls->next; */
   }
@@ -150,59 +150,58 @@ int nmmtl_generate_elements(int conductor_counter,
   ccs = conductor_cs;
   while(ccs != NULL) {
     current_conductor = ccs->conductor;
+    number_celements = element_store->number_celements;
     if(current_conductor != 0) {
       cd[current_conductor].node_start = *node_point_counter;
-      nmmtl_generate_elements_ccs(&ccs,&head,&tail,node_point_counter);
-      if(head == NULL) {
+      if(nmmtl_generate_elements_ccs(&ccs,element_store,
+                                     node_point_counter) != SUCCESS ||
+         element_store->number_celements == number_celements) {
         printf ("**** Error in element generation: from conductor circle segment");
         return(FAIL);
       }
-      cd[current_conductor].elements = head;
       cd[current_conductor].node_end = *node_point_counter-1;
       number_elements +=
         (cd[current_conductor].node_end -
-         cd[current_conductor].node_start + 1)/2;
+         cd[current_conductor].node_start + 1)/ELEMENT_ORDER;
     } else {
-      if (gnd_list_head == NULL)
+      if (!gnd_elements)
         cd[0].node_start = *node_point_counter;
 
       node_point_counter_start = *node_point_counter;
 
-      nmmtl_generate_elements_ccs(&ccs, &head, &tail, node_point_counter);
-      if(gnd_list_head == NULL)
-        gnd_list_head = head;
-      else
-        gnd_list->next = head;
-
-      gnd_list = tail;
+      if(nmmtl_generate_elements_ccs(&ccs,element_store,
+                                     node_point_counter) != SUCCESS) {
+        printf ("**** Error in element generation: from conductor circle segment");
+        return(FAIL);
+      }
+      gnd_elements = TRUE;
       cd[0].node_end = *node_point_counter-1;
 
-      number_elements += (cd[0].node_end - node_point_counter_start + 1)/2;
+      number_elements +=
+        (cd[0].node_end - node_point_counter_start + 1)/ELEMENT_ORDER;
     }
     /* if(ccs != NULL) ccs = ccs->next; */
   }
 
   /* process the ground planes */
-  if(gnd_list_head == NULL) {
+  if(!gnd_elements) {
     cd[0].node_start = *node_point_counter;
   }
 
   node_point_counter_start = *node_point_counter;
 
-  nmmtl_generate_elements_gnd(&gnd_plane_list_head,
-                              node_point_counter,
-                              gnd_planes,
-                              pln_seg,
-                              bottom_of_top_plane,
-                              left_of_gnd_planes,
-                              right_of_gnd_planes,
-                              upper_sorted_gdl);
-
-  /* attach ground plane elements with other ground wire elements */
-  if(gnd_list_head == NULL)
-    gnd_list_head = gnd_plane_list_head;
-  else
-    gnd_list->next = gnd_plane_list_head;
+  if(nmmtl_generate_elements_gnd(element_store,
+                                 node_point_counter,
+                                 gnd_planes,
+                                 pln_seg,
+                                 bottom_of_top_plane,
+                                 left_of_gnd_planes,
+                                 right_of_gnd_planes,
+                                 upper_sorted_gdl,
+                                 extent_data) != SUCCESS) {
+    printf ("**** Error in element generation: from ground plane\n");
+    return(FAIL);
+  }
 
   /* were any ground elements actually generated?  See if counter advanced */
   if (*node_point_counter == cd[0].node_start) {
@@ -212,32 +211,42 @@ int nmmtl_generate_elements(int conductor_counter,
     cd[0].node_end = *node_point_counter - 1;
   }
 
-  if (cd[0].node_end != 0)
-    number_elements += (cd[0].node_end - node_point_counter_start + 1)/2;
-
-  /* put the ground wire and ground plane elements
-     all in the conductor data array */
-  cd[0].elements = gnd_list_head;
-
+  /* count only what the planes added, ground wires may have come before
+     them, and the planes may have added nothing */
+  if (*node_point_counter > node_point_counter_start)
+    number_elements +=
+      (*node_point_counter - 1 - node_point_counter_start)/ELEMENT_ORDER;
 
   /* record how high the conductor nodes go */
   *highest_conductor_node = *node_point_counter - 1;
 
   /* process the dielectric boundaries */
-  *die_elements = nmmtl_generate_elements_die(dielectric_segments,
-                node_point_counter,
-                &number_elements,
-                extent_data);
+  if(nmmtl_generate_elements_die(dielectric_segments,
+                                 element_store,
+                                 node_point_counter,
+                                 &number_elements,
+                                 extent_data) != SUCCESS) {
+    printf ("**** Error in element generation: from dielectric segment\n");
+    return(FAIL);
+  }
+
+  /* gather the elements of each conductor together */
+  if(nmmtl_element_store_finish(element_store,conductor_counter,cd) !=
+     SUCCESS) {
+    printf ("**** Error in element generation: out of memory\n");
+    return(FAIL);
+  }
 
   sprintf(infostring,"%d elements and %d nodes were generated\n  largest matrix to be inverted is %d X %d\n",
     number_elements, *node_point_counter, *node_point_counter,
     *node_point_counter);
 
-  printf ("%s", infostring);
+  if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    printf ("%s", infostring);
 
   /* dump the elements generated */
 #ifdef NMMTL_DUMP_DIAG
-  nmmtl_dump_elements(conductor_counter, cd, *die_elements);
+  nmmtl_dump_elements(conductor_counter, cd, element_store);
 #endif
 
   return(SUCCESS);
@@ -30,10 +30,8 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   FUNCTIONAL DESCRIPTION:
 
   Generate the elements from conductor circle segments - called from
-  nmmtl_generate_elements.  Organize the elements in a linked list -
-  called a sub-list.  This sub-list may become part of a bigger list
-  or it may be used by itself.  Use output parameters head and tail
-  to return a pointer to the first and last elements on the sub-list.
+  nmmtl_generate_elements.  The elements of one conductor are added
+  to the element store.
 
 
   FORMAL PARAMETERS:
@@ -43,33 +41,32 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   segments - advanced in this routine, only
   until the next conductor is encountered.
 
-  CELEMENTS_P *head,             return head of sub-list created here
-  CELEMENTS_P *tail,             return tail of sub-list created here
+  ELEMENT_STORE_P element_store,  store the elements are added to
 
   unsigned int *node_point_counter,  counting nodes allocated in elements
                                      allocated.
 
   RETURN VALUE:
 
-  SUCCESS, FAIL
+  SUCCESS, FAIL if out of memory
 
   CALLING SEQUENCE:
 
-  status = nmmtl_generate_elements_ccs(&ccs,&head,&tail,&node_point_counter);
+  status = nmmtl_generate_elements_ccs(&ccs,element_store,
+                                       &node_point_counter);
 
   */
 
 int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
-        CELEMENTS_P *head,
-        CELEMENTS_P *tail,
+        ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter)
 {
   int conductor;
   CIRCLE_SEGMENTS_P ccs;
   CELEMENTS_P element = NULL;
-  CELEMENTS_P start   = NULL;
   unsigned int divisions;
   unsigned int npcntr;
+  int end = INTERP_ORDER;
   unsigned int first_node;
   double anglehalfincr,angleincr,angle;
   double x,y;
@@ -102,25 +99,9 @@ int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
 
     while( divisions > 0 )
     {
-      if(start == NULL)  /* first time through */
-      {
-  /* create the head of the list */
-  element = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  start = element;
-      }
-      else /* subsequent times through */
-      {
-  /* link up to the last element created */
-  element->next = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  element = element->next;
-      }
-
-      /* terminate the list for now */
-      element->next = NULL;
-
       /* no edge effects stuff for circular elements */
-      element->edge[0] = NULL;
-      element->edge[1] = NULL;
+      element = nmmtl_element_store_add_c(element_store,conductor);
+      if(element == NULL) return(FAIL);
 
       /* the global coordinates at the various nodes */
       /* starting point - already calculated */
@@ -144,8 +125,9 @@ int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
 
       /* array indicies into the BIG arrays */
       element->node[0] = npcntr++;
-      element->node[1] = npcntr++;
-      element->node[2] = npcntr;     /* set up for overlap of node points */
+      end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                                   &npcntr);
+      element->node[end] = npcntr;     /* set up for overlap of node points */
 
       /* advance to the next element */
       divisions--;
@@ -160,7 +142,7 @@ int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
   /* Now, the last node of the last element must really be the same as the
      first node of the first element - the conductor is continuous */
 
-  element->node[2] = first_node;
+  element->node[end] = first_node;
 
   /* The next time this gets called, it will be a different conductor
      or dielectric and thus we should advance the counter to a new node.
@@ -178,10 +160,6 @@ int nmmtl_generate_elements_ccs(CIRCLE_SEGMENTS_P *ccsp,
 
   *node_point_counter = npcntr;
 
-  /* return head and tail of list */
-  *head = start;
-  *tail = element;
-
   /* adjust pointer over segments processed */
   *ccsp = ccs;
 
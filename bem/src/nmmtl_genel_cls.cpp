@@ -15,6 +15,15 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
  */
 #include "nmmtl.h"
 
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static double nmmtl_corner_weight(LINE_SEGMENTS_P cls, unsigned int element,
+                                  unsigned int divisions);
+
 /*
  *******************************************************************
  **  FUNCTION DEFINITIONS
@@ -29,10 +38,15 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   FUNCTIONAL DESCRIPTION:
 
   Generate the elements from conductor line segments - called from
-  nmmtl_generate_elements.  Organize the elements in a linked list -
-  called a sub-list.  This sub-list may become part of a bigger list
-  or it may be used by itself.  Use output parameters head and tail
-  to return a pointer to the first and last elements on the sub-list.
+  nmmtl_generate_elements.  The elements of one conductor are added
+  to the element store.
+
+  A side is divided evenly, unless it ends in a corner and
+  CORNER_GRADING_FACTOR is above one.  The elements then shrink
+  geometrically toward the corners, where the charge density is
+  singular, by that factor per element, down to no less than
+  CORNER_GRADING_MIN_FRACTION of the even division.  Finer elements
+  than that leave the matrix singular.
 
   FORMAL PARAMETERS:
 
@@ -40,34 +54,36 @@ COPYRIGHT:   Copyright (C) 1992 by Mayo Foundation. All rights reserved.
   segments - advanced in this routine, only
   until the next conductor is encountered.
 
-  CELEMENTS_P *head,             return head of sub-list created here
-  CELEMENTS_P *tail,             return tail of sub-list created here
+  ELEMENT_STORE_P element_store,  store the elements are added to
 
   unsigned int *node_point_counter,  counting nodes allocated in elements
                                      allocated.
 
   RETURN VALUE:
 
-  SUCCESS, FAIL
+  SUCCESS, FAIL if out of memory
 
   CALLING SEQUENCE:
 
-  nmmtl_generate_elements_cls(&cls,&head,&tail,&node_point_counter);
+  nmmtl_generate_elements_cls(&cls,element_store,&node_point_counter);
 
   */
 int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
-        CELEMENTS_P *head,
-        CELEMENTS_P *tail,
+        ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter) {
   int conductor;
   LINE_SEGMENTS_P cls;
   CELEMENTS_P element = NULL;
-  CELEMENTS_P start   = NULL;
   unsigned int divisions;
   unsigned int npcntr;
+  int end = INTERP_ORDER;
   unsigned int first_node;
   double xincr,xhalfincr,x,yincr,yhalfincr,y;
   unsigned char firstelement;
+  extern thread_local double CORNER_GRADING_FACTOR;
+  unsigned int total_divisions, k;
+  double total_weight, t;
+  int graded;
 
   cls = *clsp;
   conductor = cls->conductor;
@@ -99,25 +115,25 @@ int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
 
     firstelement = TRUE;
 
+    /* graded sides: t runs from 0 to 1 along the side, each element
+       taking its weight's share of it */
+    total_divisions = divisions;
+    graded = CORNER_GRADING_FACTOR > 1.0 && divisions > 1 &&
+      (cls->theta2[0] != 0.0 || cls->theta2[1] != 0.0);
+    total_weight = 0.0;
+    if(graded)
+    {
+      for(k = 0; k < total_divisions; k++)
+        total_weight += nmmtl_corner_weight(cls,k,total_divisions);
+    }
+    t = 0.0;
+
     /* loop based on a count of the number of divisions */
 
     while( divisions > 0 )
     {
-      if(start == NULL)  /* first time through */
-      {
-  /* create the head of the list */
-  element = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  start = element;
-      }
-      else /* subsequent times through */
-      {
-  /* link up to the last element created */
-  element->next = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  element = element->next;
-      }
-
-      /* terminate the list for now */
-      element->next = NULL;
+      element = nmmtl_element_store_add_c(element_store,conductor);
+      if(element == NULL) return(FAIL);
 
 
       /* set up edge effects stuff, if either side is an edge
@@ -129,39 +145,50 @@ int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
   firstelement = FALSE;
   if(cls->theta2[0] != 0.0)
   {
-    element->edge[0] = (EDGEDATA_P)malloc(sizeof(EDGEDATA));
-    element->edge[0]->nu = cls->nu[0];
-    element->edge[0]->free_space_nu = cls->free_space_nu[0];
+    element->edge[0] = TRUE;
+    element->nu[0] = cls->nu[0];
+    element->free_space_nu[0] = cls->free_space_nu[0];
   }
-  else element->edge[0] = NULL;
       }
-      else element->edge[0] = NULL;
 
       if(divisions == 1) /* last element */
       {
   if(cls->theta2[1] != 0.0)
   {
-    element->edge[1] = (EDGEDATA_P)malloc(sizeof(EDGEDATA));
-    element->edge[1]->nu = cls->nu[1];
-    element->edge[1]->free_space_nu = cls->free_space_nu[1];
+    element->edge[1] = TRUE;
+    element->nu[1] = cls->nu[1];
+    element->free_space_nu[1] = cls->free_space_nu[1];
   }
-  else element->edge[1] = NULL;
       }
-      else element->edge[1] = NULL;
 
       /* the global coordinates at the various nodes */
       element->xpts[0] = x;
       element->ypts[0] = y;
 
-      /* advance to the midpoint */
-      x += xhalfincr;
-      y += yhalfincr;
-      element->xpts[1] = x;
-      element->ypts[1] = y;
-
-      /* advance to the endpoint */
-      x += xhalfincr;
-      y += yhalfincr;
+      if(graded)
+      {
+        t += nmmtl_corner_weight(cls,total_divisions - divisions,
+                                 total_divisions) / total_weight;
+        if(divisions == 1) t = 1.0;
+        x = cls->startx + t * (cls->endx - cls->startx);
+        y = cls->starty + t * (cls->endy - cls->starty);
+
+        /* the midpoint */
+        element->xpts[1] = 0.5 * (element->xpts[0] + x);
+        element->ypts[1] = 0.5 * (element->ypts[0] + y);
+      }
+      else
+      {
+        /* advance to the midpoint */
+        x += xhalfincr;
+        y += yhalfincr;
+        element->xpts[1] = x;
+        element->ypts[1] = y;
+
+        /* advance to the endpoint */
+        x += xhalfincr;
+        y += yhalfincr;
+      }
       element->xpts[2] = x;
       element->ypts[2] = y;
 
@@ -170,8 +197,9 @@ int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
 
       /* array indicies into the BIG arrays */
       element->node[0] = npcntr++;
-      element->node[1] = npcntr++;
-      element->node[2] = npcntr;     /* set up for overlap of node points */
+      end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                                   &npcntr);
+      element->node[end] = npcntr;     /* set up for overlap of node points */
 
       /* advance to the next element */
       divisions--;
@@ -186,7 +214,7 @@ int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
   /* Now, the last node of the last element must really be the same as the
      first node of the first element - the conductor is continuous */
 
-  element->node[2] = first_node;
+  element->node[end] = first_node;
 
 
   /* The next time this gets called, it will be a different conductor
@@ -205,12 +233,60 @@ int nmmtl_generate_elements_cls(LINE_SEGMENTS_P *clsp,
 
   *node_point_counter = npcntr;
 
-  /* return head and tail of list */
-  *head = start;
-  *tail = element;
-
   /* adjust pointer over segments processed */
   *clsp = cls;
 
   return(SUCCESS);
 }
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_corner_weight
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Relative size of an element on a graded side: CORNER_GRADING_FACTOR
+  raised to the number of elements between it and the nearest end of
+  the side that is a corner, but at most 1/CORNER_GRADING_MIN_FRACTION.
+  Only the elements nearest the corners are graded, the rest of the side
+  is divided evenly.
+
+  FORMAL PARAMETERS:
+
+  LINE_SEGMENTS_P cls,           the side
+  unsigned int element,          which element on it, from 0 at the start
+  unsigned int divisions,        how many elements there are
+
+  RETURN VALUE:
+
+  the weight
+
+  CALLING SEQUENCE:
+
+  weight = nmmtl_corner_weight(cls,k,total_divisions);
+
+  */
+
+static double nmmtl_corner_weight(LINE_SEGMENTS_P cls, unsigned int element,
+                                  unsigned int divisions)
+{
+  extern thread_local double CORNER_GRADING_FACTOR;
+  unsigned int from_corner = divisions;
+  double weight;
+
+  if(cls->theta2[0] != 0.0)
+    from_corner = element;
+  if(cls->theta2[1] != 0.0 && divisions - 1 - element < from_corner)
+    from_corner = divisions - 1 - element;
+
+  weight = pow(CORNER_GRADING_FACTOR,(double)from_corner);
+
+  /* level off, so that no element is less than CORNER_GRADING_MIN_FRACTION
+     of the evenly divided length */
+  if(weight > 1.0/CORNER_GRADING_MIN_FRACTION)
+    weight = 1.0/CORNER_GRADING_MIN_FRACTION;
+
+  return(weight);
+}
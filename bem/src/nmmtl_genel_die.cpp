@@ -64,6 +64,8 @@ typedef struct chain
  **  FUNCTION DECLARATIONS
  *******************************************************************
  */
+
+static void nmmtl_free_chain(CHAIN_P chain);
 /*
  *******************************************************************
  **  FUNCTION DEFINITIONS
@@ -91,23 +93,26 @@ typedef struct chain
   FORMAL PARAMETERS:
 
   DIELECTRIC_SEGMENTS_P *ds,        - list of dielectric segments
+  ELEMENT_STORE_P element_store,    - store the elements are added to
   unsigned int *node_point_counter, - counter of node points
   int *number_elements              - total number of elements
   EXTENT_DATA_P extent_data         - given and desired extents
 
   RETURN VALUE:
 
-  None
+  SUCCESS, FAIL if out of memory
 
   CALLING SEQUENCE:
 
-  nmmtl_generate_elements_die(die_elements,&node_point_counter,
-                              &number_elements,extent_data);
+  status = nmmtl_generate_elements_die(dielectric_segments,element_store,
+                                       &node_point_counter,
+                                       &number_elements,extent_data);
 
   */
 
 
-DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
+int nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
+          ELEMENT_STORE_P element_store,
           unsigned int *node_point_counter,
           int *number_elements,
           EXTENT_DATA_P extent_data) {
@@ -115,11 +120,12 @@ DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
   CHAIN_P first_link = NULL,last_link,scan_chain;
   unsigned char intersection[2];
   unsigned int intersection_node[2];
-  DELEMENTS_P start = NULL,element;
+  DELEMENTS_P element;
   double endx[2],endy[2];
   unsigned int cntr;
   unsigned int divisions;
   unsigned int npcntr;
+  int end = INTERP_ORDER;
   double xincr,xhalfincr,x,yincr,yhalfincr,y;
   int first_element;
   double normalx,normaly;
@@ -230,21 +236,12 @@ DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
     {
       (*number_elements)++;
 
-      if(start == NULL)  /* first time through */
+      element = nmmtl_element_store_add_d(element_store);
+      if(element == NULL)
       {
-        /* create the head of the list */
-        element = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-        start = element;
+        nmmtl_free_chain(first_link);
+        return(FAIL);
       }
-      else /* subsequent times through */
-      {
-        /* link up to the last element created */
-        element->next = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-        element = element->next;
-      }
-
-      /* terminate the list for now */
-      element->next = NULL;
 
       /* the global coordinates at the various nodes */
       element->xpts[0] = x;
@@ -286,8 +283,9 @@ DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
       }
       else element->node[0] = npcntr++;
 
-      /* middle node */
-      element->node[1] = npcntr++;
+      /* interior nodes */
+      end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                                   &npcntr);
 
       /* last node
          if this isn't the last element for this segment, set up for
@@ -301,11 +299,11 @@ DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
       /* is this the last element ? */
       if (divisions == 1) {
         if(intersection[1])
-          element->node[2] = last_link->nodeend = intersection_node[1];
+          element->node[end] = last_link->nodeend = intersection_node[1];
         else
-          element->node[2] = last_link->nodeend = npcntr++;
+          element->node[end] = last_link->nodeend = npcntr++;
       } else {
-        element->node[2] = npcntr;
+        element->node[end] = npcntr;
       }
 
       /* advance to the next element */
@@ -325,42 +323,94 @@ DELEMENTS_P nmmtl_generate_elements_die(DIELECTRIC_SEGMENTS_P ds,
        * approached the left edge of the edge of the drawn cross section
        * (left_cs_extent = end of dielectric segment (end[0]).
        */
-      if (extent_data->expand_left && (extent_data->left_cs_extent == endx[0]))
-        nmmtl_nl_expand(endx[0],
-                        extent_data->desired_left,
-                        -1*xincr,
-                        die_seg->epsilonplus,
-                        die_seg->epsilonminus,
-                        normaly,
-                        y,
-                        &npcntr,
-                        &element,
-                        number_elements,
-                        last_link->nodestart);
+      if (extent_data->expand_left && (extent_data->left_cs_extent == endx[0]) &&
+          nmmtl_nl_expand(endx[0],
+                          extent_data->desired_left,
+                          -1*xincr,
+                          die_seg->epsilonplus,
+                          die_seg->epsilonminus,
+                          normaly,
+                          y,
+                          &npcntr,
+                          element_store,
+                          number_elements,
+                          last_link->nodestart) != SUCCESS)
+      {
+        nmmtl_free_chain(first_link);
+        return(FAIL);
+      }
 
       /* need expansion on right end? */
-      if (extent_data->expand_right && (extent_data->right_cs_extent == endx[1]))
-        nmmtl_nl_expand(endx[1],extent_data->desired_right,xincr,die_seg->epsilonplus,
-                        die_seg->epsilonminus,normaly,y,&npcntr,&element,
-                        number_elements,last_link->nodeend);
+      if (extent_data->expand_right && (extent_data->right_cs_extent == endx[1]) &&
+          nmmtl_nl_expand(endx[1],extent_data->desired_right,xincr,die_seg->epsilonplus,
+                          die_seg->epsilonminus,normaly,y,&npcntr,element_store,
+                          number_elements,last_link->nodeend) != SUCCESS)
+      {
+        nmmtl_free_chain(first_link);
+        return(FAIL);
+      }
 
     /* Or does this segment goes right to left */
     } else if (normaly < 0.0) {
       /* need expansion on left end? */
-      if (extent_data->expand_left && (extent_data->left_cs_extent == endx[1]))
-        nmmtl_nl_expand(endx[1],extent_data->desired_left,xincr,die_seg->epsilonplus,
-                        die_seg->epsilonminus,normaly,y,&npcntr,&element,
-                        number_elements,last_link->nodeend);
+      if (extent_data->expand_left && (extent_data->left_cs_extent == endx[1]) &&
+          nmmtl_nl_expand(endx[1],extent_data->desired_left,xincr,die_seg->epsilonplus,
+                          die_seg->epsilonminus,normaly,y,&npcntr,element_store,
+                          number_elements,last_link->nodeend) != SUCCESS)
+      {
+        nmmtl_free_chain(first_link);
+        return(FAIL);
+      }
 
       /* need expansion on right end? */
-      if (extent_data->expand_right && (extent_data->right_cs_extent == endx[0]))
-        nmmtl_nl_expand(endx[0],extent_data->desired_right,-1*xincr,die_seg->epsilonplus,
-                        die_seg->epsilonminus,normaly,y,&npcntr,&element,
-                        number_elements,last_link->nodestart);
+      if (extent_data->expand_right && (extent_data->right_cs_extent == endx[0]) &&
+          nmmtl_nl_expand(endx[0],extent_data->desired_right,-1*xincr,die_seg->epsilonplus,
+                          die_seg->epsilonminus,normaly,y,&npcntr,element_store,
+                          number_elements,last_link->nodestart) != SUCCESS)
+      {
+        nmmtl_free_chain(first_link);
+        return(FAIL);
+      }
     }
     die_seg = die_seg->next;
   }
 
+  nmmtl_free_chain(first_link);
   *node_point_counter = npcntr;
-  return(start);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_free_chain
+
+  FUNCTIONAL DESCRIPTION:
+
+  Free the list of finished segments kept for intersection detection.
+
+  FORMAL PARAMETERS:
+
+  CHAIN_P chain - the first link, may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_free_chain(first_link);
+
+  */
+
+static void nmmtl_free_chain(CHAIN_P chain)
+{
+  CHAIN_P next;
+
+  while(chain != NULL)
+  {
+    next = chain->next;
+    free(chain);
+    chain = next;
+  }
 }
@@ -39,8 +39,20 @@
 
   FUNCTIONAL DESCRIPTION:
 
-  Generate the elements from the ground plane(s).  Follow the projections
-  on to the upper plane, if any.
+  Generate the elements from the ground plane(s), adding them to the
+  element store as conductor 0.  Follow the projections on to the upper
+  plane, if any.
+
+  The upper plane is divided evenly into pln_seg elements, unless
+  PLANE_GRADING_FACTOR is above one.  The elements then keep that size
+  only over the conductors, and as far again to either side as the
+  lowest conductor is below the plane, and outside of that they grow
+  geometrically by that factor per element, as the dielectric interface
+  expansion elements of nmmtl_nl_expand do.  The element starting at
+  distance d out from the dense region is (h + (f-1)*d) long, h being
+  the even size and f the factor, which is the geometric series written
+  in terms of distance; coming in from the left, the same holds for the
+  end of the element nearest the region.
 
   There is extra code here to:
   1) apply minimum element size to ground plane
@@ -55,7 +67,7 @@
 
   FORMAL PARAMETERS:
 
-  CELEMENTS_P *gnd_plane_list_head,   Head of list - output
+  ELEMENT_STORE_P element_store,     store the elements are added to
   unsigned int *node_point_counter,  counting nodes allocated in elements
   allocated.
   int gnd_planes,                    number of ground planes
@@ -69,24 +81,26 @@
   ground plane
   SORTED_GND_DIE_LIST_P upper_sorted_gdl   list of where upper ground plane
                                             die intersections are
+  EXTENT_DATA_P extent_data                extents of the conductor region
 
   RETURN VALUE:
 
-  SUCCESS, FAIL
+  SUCCESS, FAIL if out of memory
 
   CALLING SEQUENCE:
 
-  nmmtl_generate_elements_gnd(&gnd_plane_list_head,
+  nmmtl_generate_elements_gnd(element_store,
   &node_point_counter
   gnd_planes,
   pln_seg,
   bottom_of_top_plane,
   left_of_gnd_planes,
   right_of_gnd_planes,
-  upper_sorted_gdl);
+  upper_sorted_gdl,
+  extent_data);
 
   */
-int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
+int nmmtl_generate_elements_gnd(ELEMENT_STORE_P element_store,
         unsigned int *node_point_counter,
         int gnd_planes,
         int pln_seg,
@@ -96,13 +110,19 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
 #ifdef GND_PLANE_COND_PROJECTION
         COND_PROJ_LIST_P cond_projections,
 #endif
-        SORTED_GND_DIE_LIST_P upper_sorted_gdl) {
-  CELEMENTS_P element,start = NULL;
+        SORTED_GND_DIE_LIST_P upper_sorted_gdl,
+        EXTENT_DATA_P extent_data) {
+  CELEMENTS_P element;
   unsigned int npcntr;
+  int end = INTERP_ORDER;
   double xhalfincr;
   double x;
   double width;
   double close_enough;
+  extern thread_local double PLANE_GRADING_FACTOR;
+  double growth = PLANE_GRADING_FACTOR - 1.0;
+  double dense_left = 0.0, dense_right = 0.0;
+  double incr;
 
   npcntr = *node_point_counter;
   width = right_of_gnd_planes - left_of_gnd_planes;
@@ -128,30 +148,26 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
   x = left_of_gnd_planes;
   close_enough = 1e-10*xhalfincr;
 
+  /* the region kept at the even size */
+  if(growth > 0.0)
+  {
+    dense_left = extent_data->left_cond_extent -
+      (bottom_of_top_plane - extent_data->min_cond_height);
+    dense_right = extent_data->right_cond_extent +
+      (bottom_of_top_plane - extent_data->min_cond_height);
+  }
+
   /* add in checking against "close_enough"
      to avoid floating point comparison problems */
 
   while ((x < right_of_gnd_planes)
         && (fabs(x - right_of_gnd_planes) > close_enough)) {
-    if(start == NULL) {  /* first time through */
-      /* create the head of the list */
-      element = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-      start = element;
-    } else { /* subsequent times through */
-      /* link up to the last element created */
-      element->next = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-      element = element->next;
-    }
-
-    /* terminate the list for now */
-    element->next = NULL;
-
     /* no edge effects stuff */
-    element->edge[0] = NULL;
-    element->edge[1] = NULL;
+    element = nmmtl_element_store_add_c(element_store,0);
+    if(element == NULL) return(FAIL);
 
     /* set the dielectric coeficient that the ground plane sees */
-    element->epsilon = *((float *)upper_sorted_gdl->data);
+    element->epsilon = *((double *)upper_sorted_gdl->data);
 
     /* Set the global coordinates at the various nodes */
 
@@ -161,10 +177,20 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
     element->ypts[1] = bottom_of_top_plane;
     element->ypts[2] = bottom_of_top_plane;
 
+    /* the normal length of an element starting here */
+    incr = 2.*xhalfincr;
+    if(growth > 0.0)
+    {
+      if(x + incr < dense_left)
+        incr = (incr + growth*(dense_left - x)) / PLANE_GRADING_FACTOR;
+      else if(x > dense_right)
+        incr += growth*(x - dense_right);
+    }
+
     /* is there a dielectric break sooner than the next normal length-based
        break? */
 
-    if (x + 2.*xhalfincr > upper_sorted_gdl->key) {
+    if (x + incr > upper_sorted_gdl->key) {
       /* also - do not project the conductors - for now */
 #ifdef GND_PLANE_COND_PROJECTION
       /* is there a conductor projection break sooner than that? */
@@ -203,7 +229,7 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
     /* is there a conductor projection break sooner than the next */
     /* normal length-based break? */
     else if ((cond_projections != NULL)
-    && (x + 2.*xhalfincr > cond_projections->key)) {
+    && (x + incr > cond_projections->key)) {
 
       /* advance to the midpoint */
       x = .5*(x + cond_projections->key);
@@ -219,6 +245,15 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
 #endif
 
     /* else - just take the normal length-based break */
+    else if(growth > 0.0)
+    {
+      /* advance to the midpoint */
+      element->xpts[1] = x + .5*incr;
+
+      /* advance to the endpoint */
+      x += incr;
+      element->xpts[2] = x;
+    }
     else
     {
       /* advance to the midpoint */
@@ -232,8 +267,9 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
 
     /* array indicies into the BIG arrays */
     element->node[0] = npcntr++;
-    element->node[1] = npcntr++;
-    element->node[2] = npcntr;     /* set up for overlap of node points */
+    end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                                 &npcntr);
+    element->node[end] = npcntr;     /* set up for overlap of node points */
 
   }   /* while traversing the upper ground plane */
 
@@ -247,8 +283,5 @@ int nmmtl_generate_elements_gnd(CELEMENTS_P *gnd_plane_list_head,
 
   *node_point_counter = ++npcntr;
 
-  /* return head of list */
-  *gnd_plane_list_head = start;
-
   return(SUCCESS);
 }
@@ -73,7 +73,7 @@ Functions contained herein:
 POINT_P nmmtl_cd_intersect(CONTOURS_P contour,
          DIELECTRIC_SEGMENTS_P dieseg)
 {
-  static POINT intersection;
+  static thread_local POINT intersection;
   LINESEG segment;
   int an_intersection;
 
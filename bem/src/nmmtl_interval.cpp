@@ -14,6 +14,12 @@
   (conductor self element in _free_space)
   nmmtl_interval_d   (dielectric)
   nmmtl_interval_self_d (dielectric self element)
+  nmmtl_interval_sources_c (conductor integration points)
+  nmmtl_interval_sources_d (dielectric integration points)
+
+  Each is worked by a template on the order of interpolation, chosen by
+  ELEMENT_ORDER, with the shape functions and their derivatives at the
+  Legendre roots taken from tables.
 
 
   AUTHOR(S):
@@ -34,6 +40,75 @@
  */
 
 #include "nmmtl.h"
+#include "nmmtl_shape.h"
+
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+template <int ORDER>
+static void nmmtl_interval_c_order(double x,
+                                   double y,
+                                   CELEMENTS_P cel,
+                                   double *value,
+                                   int outer_cond_flag,
+                                   double normalx,
+                                   double normaly);
+
+template <int ORDER>
+static void nmmtl_interval_self_c_order(double x,
+                                        double y,
+                                        CELEMENTS_P cel,
+                                        double *value,
+                                        double point);
+
+template <int ORDER>
+static void nmmtl_interval_c_fs_order(double x,
+                                      double y,
+                                      CELEMENTS_P cel,
+                                      double *value);
+
+template <int ORDER>
+static void nmmtl_interval_self_c_fs_order(double x,
+                                           double y,
+                                           CELEMENTS_P cel,
+                                           double *value,
+                                           double point);
+
+template <int ORDER>
+static void nmmtl_interval_d_order(double x,
+                                   double y,
+                                   DELEMENTS_P del,
+                                   double *value,
+                                   int outer_cond_flag,
+                                   double normalx,
+                                   double normaly);
+
+template <int ORDER>
+static void nmmtl_interval_self_d_order(double x,
+                                        double y,
+                                        DELEMENTS_P del,
+                                        double *value,
+                                        double point,
+                                        double normalx,
+                                        double normaly);
+
+template <int ORDER>
+static int nmmtl_interval_sources_c_order(CELEMENTS_P cel,
+                                          double *sigma_vector,
+                                          double *X,
+                                          double *Y,
+                                          double *charge);
+
+template <int ORDER>
+static int nmmtl_interval_sources_d_order(DELEMENTS_P del,
+                                          double *sigma_vector,
+                                          double *X,
+                                          double *Y,
+                                          double *charge);
 
 
 /*
@@ -78,45 +153,72 @@ void nmmtl_interval_c(double x,
           double normalx,
           double normaly)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_c_order<1>(x,y,cel,value,outer_cond_flag,normalx,normaly);
+    break;
+  case 3:
+    nmmtl_interval_c_order<3>(x,y,cel,value,outer_cond_flag,normalx,normaly);
+    break;
+  default:
+    nmmtl_interval_c_order<2>(x,y,cel,value,outer_cond_flag,normalx,normaly);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_c_order(double x,
+                                   double y,
+                                   CELEMENTS_P cel,
+                                   double *value,
+                                   int outer_cond_flag,
+                                   double normalx,
+                                   double normaly)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
   double nu0;
   //double nu1;
 
+  nmmtl_shape_table<ORDER,Legendre_root_i_max> const &table =
+    nmmtl_shape_table_i<ORDER>();
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   for(Legendre_counter = 0; Legendre_counter < Legendre_root_i_max;
       Legendre_counter++)
   {
-    nmmtl_shape(Legendre_root_i[Legendre_counter],shape);
+    for(i=0;i <= ORDER;i++)
+      shape[i] = table.shape[Legendre_counter][i];
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(Legendre_root_i[Legendre_counter],cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(table.derivative[Legendre_counter],
+                                           cel->xpts,cel->ypts);
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+      nu0 = cel->edge[0] ? cel->nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->nu[1] : 0;
       //nmmtl_shape_c_edge(Legendre_root_i[Legendre_counter],shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(Legendre_root_i[Legendre_counter],shape,cel,nu0);
     }
@@ -139,7 +241,7 @@ void nmmtl_interval_c(double x,
   ( dx2*normalx + dy2*normaly ) / ( d2*d2 );
     }
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian;
@@ -180,11 +282,32 @@ void nmmtl_interval_self_c(double x,
          double *value,
          double point)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_self_c_order<1>(x,y,cel,value,point);
+    break;
+  case 3:
+    nmmtl_interval_self_c_order<3>(x,y,cel,value,point);
+    break;
+  default:
+    nmmtl_interval_self_c_order<2>(x,y,cel,value,point);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_self_c_order(double x,
+                                        double y,
+                                        CELEMENTS_P cel,
+                                        double *value,
+                                        double point)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
@@ -194,7 +317,7 @@ void nmmtl_interval_self_c(double x,
   //double nu1;
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   /* This section - starting with the assignment to alpha is replicated
@@ -210,27 +333,27 @@ void nmmtl_interval_self_c(double x,
   {
     local_coord = point * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(local_coord,cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,cel->xpts,cel->ypts);
 
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+      nu0 = cel->edge[0] ? cel->nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->nu[1] : 0;
       //nmmtl_shape_c_edge(local_coord,shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(local_coord,shape,cel,nu0);
     }
@@ -245,7 +368,7 @@ void nmmtl_interval_self_c(double x,
 
     Greens_Function = log(d2/d1);
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -263,27 +386,27 @@ void nmmtl_interval_self_c(double x,
   {
     local_coord = point + (1.0 - point) * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(local_coord,cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,cel->xpts,cel->ypts);
 
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+      nu0 = cel->edge[0] ? cel->nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->nu[1] : 0;
       //nmmtl_shape_c_edge(local_coord,shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(local_coord,shape,cel,nu0);
     }
@@ -298,7 +421,7 @@ void nmmtl_interval_self_c(double x,
 
     Greens_Function = log(d2/d1);
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -338,45 +461,69 @@ void nmmtl_interval_c_fs(double x,
        CELEMENTS_P cel,
        double *value)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_c_fs_order<1>(x,y,cel,value);
+    break;
+  case 3:
+    nmmtl_interval_c_fs_order<3>(x,y,cel,value);
+    break;
+  default:
+    nmmtl_interval_c_fs_order<2>(x,y,cel,value);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_c_fs_order(double x,
+                                      double y,
+                                      CELEMENTS_P cel,
+                                      double *value)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
   double nu0;
   //double nu1;
 
+  nmmtl_shape_table<ORDER,Legendre_root_i_max> const &table =
+    nmmtl_shape_table_i<ORDER>();
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   for(Legendre_counter = 0; Legendre_counter < Legendre_root_i_max;
       Legendre_counter++)
   {
-    nmmtl_shape(Legendre_root_i[Legendre_counter],shape);
+    for(i=0;i <= ORDER;i++)
+      shape[i] = table.shape[Legendre_counter][i];
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(Legendre_root_i[Legendre_counter],cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(table.derivative[Legendre_counter],
+                                           cel->xpts,cel->ypts);
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+      nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
       //nmmtl_shape_c_edge(Legendre_root_i[Legendre_counter],shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(Legendre_root_i[Legendre_counter],shape,cel,nu0);
     }
@@ -391,7 +538,7 @@ void nmmtl_interval_c_fs(double x,
 
     Greens_Function = log(d2/d1);
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian;
@@ -436,11 +583,32 @@ void nmmtl_interval_self_c_fs(double x,
             double *value,
             double point)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_self_c_fs_order<1>(x,y,cel,value,point);
+    break;
+  case 3:
+    nmmtl_interval_self_c_fs_order<3>(x,y,cel,value,point);
+    break;
+  default:
+    nmmtl_interval_self_c_fs_order<2>(x,y,cel,value,point);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_self_c_fs_order(double x,
+                                           double y,
+                                           CELEMENTS_P cel,
+                                           double *value,
+                                           double point)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
@@ -450,7 +618,7 @@ void nmmtl_interval_self_c_fs(double x,
   //double nu1;
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   /* This section - starting with the assignment to alpha is replicated
@@ -466,27 +634,27 @@ void nmmtl_interval_self_c_fs(double x,
   {
     local_coord = point * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(local_coord,cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,cel->xpts,cel->ypts);
 
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+      nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
       //nmmtl_shape_c_edge(local_coord,shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(local_coord,shape,cel,nu0);
     }
@@ -501,7 +669,7 @@ void nmmtl_interval_self_c_fs(double x,
 
     Greens_Function = log(d2/d1);
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -519,27 +687,27 @@ void nmmtl_interval_self_c_fs(double x,
   {
     local_coord = point + (1.0 - point) * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*cel->xpts[i];
       Y += shape[i]*cel->ypts[i];
     }
 
-    nmmtl_jacobian_c(local_coord,cel,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,cel->xpts,cel->ypts);
 
     /* if an edge element - recalculate shape using edge effects */
 
-    if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+    if(cel->edge[0] || cel->edge[1])
     {
       /* if given edge is really an edge, set the true value of nu,
    otherwise, don't really care */
-      nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-      //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+      nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+      //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
       //nmmtl_shape_c_edge(local_coord,shape,cel,nu0,nu1);
       nmmtl_shape_c_edge(local_coord,shape,cel,nu0);
     }
@@ -554,7 +722,7 @@ void nmmtl_interval_self_c_fs(double x,
 
     Greens_Function = log(d2/d1);
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -599,35 +767,62 @@ void nmmtl_interval_d(double x,
           double normalx,
           double normaly)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_d_order<1>(x,y,del,value,outer_cond_flag,normalx,normaly);
+    break;
+  case 3:
+    nmmtl_interval_d_order<3>(x,y,del,value,outer_cond_flag,normalx,normaly);
+    break;
+  default:
+    nmmtl_interval_d_order<2>(x,y,del,value,outer_cond_flag,normalx,normaly);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_d_order(double x,
+                                   double y,
+                                   DELEMENTS_P del,
+                                   double *value,
+                                   int outer_cond_flag,
+                                   double normalx,
+                                   double normaly)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
 
+  nmmtl_shape_table<ORDER,Legendre_root_i_max> const &table =
+    nmmtl_shape_table_i<ORDER>();
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   for(Legendre_counter = 0; Legendre_counter < Legendre_root_i_max;
       Legendre_counter++)
   {
-    nmmtl_shape(Legendre_root_i[Legendre_counter],shape);
+    for(i=0;i <= ORDER;i++)
+      shape[i] = table.shape[Legendre_counter][i];
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*del->xpts[i];
       Y += shape[i]*del->ypts[i];
     }
 
-    nmmtl_jacobian_d(Legendre_root_i[Legendre_counter],del,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(table.derivative[Legendre_counter],
+                                           del->xpts,del->ypts);
 
     dx1 = x - X;
     dy1 = y - Y;
@@ -648,7 +843,7 @@ void nmmtl_interval_d(double x,
     }
 
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian;
@@ -692,11 +887,34 @@ void nmmtl_interval_self_d(double x,
          double normalx,
          double normaly)
 {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_interval_self_d_order<1>(x,y,del,value,point,normalx,normaly);
+    break;
+  case 3:
+    nmmtl_interval_self_d_order<3>(x,y,del,value,point,normalx,normaly);
+    break;
+  default:
+    nmmtl_interval_self_d_order<2>(x,y,del,value,point,normalx,normaly);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_interval_self_d_order(double x,
+                                        double y,
+                                        DELEMENTS_P del,
+                                        double *value,
+                                        double point,
+                                        double normalx,
+                                        double normaly)
+{
 
   int i;
   int Legendre_counter;
   double X,Y;  /* interpolated coordinates */
-  double shape[INTERP_PTS];
+  double shape[ORDER + 1];
   double Jacobian;
   double dx1,dx2,dy1,dy2,d1,d2;
   double Greens_Function;
@@ -704,7 +922,7 @@ void nmmtl_interval_self_d(double x,
   double local_coord;
 
   /* zero out output */
-  for(i = 0; i < INTERP_PTS; i++)
+  for(i = 0; i <= ORDER; i++)
     value[i] = 0.0;
 
   /* This section - starting with the assignment to alpha is replicated
@@ -720,18 +938,18 @@ void nmmtl_interval_self_d(double x,
   {
     local_coord = point * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*del->xpts[i];
       Y += shape[i]*del->ypts[i];
     }
 
-    nmmtl_jacobian_d(local_coord,del,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,del->xpts,del->ypts);
 
     dx1 = x - X;
     dy1 = y - Y;
@@ -744,7 +962,7 @@ void nmmtl_interval_self_d(double x,
     Greens_Function = ( dx1*normalx + dy1*normaly ) / ( d1*d1 ) -
       ( dx2*normalx + dy2*normaly ) / ( d2*d2 );
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -763,18 +981,18 @@ void nmmtl_interval_self_d(double x,
   {
     local_coord = point + (1.0 - point) * Legendre_root_i[Legendre_counter];
 
-    nmmtl_shape(local_coord,shape);
+    nmmtl_shape_order<ORDER>(local_coord,shape);
 
     /* interpolate x,y coordinate using no_edge shape function */
     X = 0.0;
     Y = 0.0;
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       X += shape[i]*del->xpts[i];
       Y += shape[i]*del->ypts[i];
     }
 
-    nmmtl_jacobian_d(local_coord,del,&Jacobian);
+    Jacobian = nmmtl_jacobian_order<ORDER>(local_coord,del->xpts,del->ypts);
 
     dx1 = x - X;
     dy1 = y - Y;
@@ -787,7 +1005,7 @@ void nmmtl_interval_self_d(double x,
     Greens_Function = ( dx1*normalx + dy1*normaly ) / ( d1*d1 ) -
       ( dx2*normalx + dy2*normaly ) / ( d2*d2 );
 
-    for(i=0;i < INTERP_PTS;i++)
+    for(i=0;i <= ORDER;i++)
     {
       value[i] += Legendre_weight_i[Legendre_counter] * shape[i] *
   Greens_Function * Jacobian * alpha;
@@ -795,3 +1013,196 @@ void nmmtl_interval_self_d(double x,
 
   } /* for all Legendre roots */
 }
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_interval_sources_c()
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Gives the integration points nmmtl_interval_c uses over a conductor
+  element, each with the charge the element carries there for a solved
+  charge distribution: the Legendre weight times the Jacobian times the
+  charge density interpolated with the (edge) shape functions.  The sum
+  over the points of charge times the Green's Function is then the sum
+  over the nodes of the element of value times the charge density, as
+  the matrix equation has it, without working the shape functions out
+  again for each field point.
+
+  FORMAL PARAMETERS:
+
+  CELEMENTS_P cel,      - conductor element
+  double *sigma_vector  - charge density at each node
+  double *X,            - out: x of each integration point
+  double *Y,            - out: y of each integration point
+  double *charge        - out: charge at each integration point
+
+  RETURN VALUE:
+
+  the number of integration points, Legendre_root_i_max
+
+  CALLING SEQUENCE:
+
+  sources += nmmtl_interval_sources_c(cel,sigma_vector,X + sources,
+                                      Y + sources,charge + sources);
+
+  */
+
+int nmmtl_interval_sources_c(CELEMENTS_P cel,
+                             double *sigma_vector,
+                             double *X,
+                             double *Y,
+                             double *charge)
+{
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    return(nmmtl_interval_sources_c_order<1>(cel,sigma_vector,X,Y,charge));
+  case 3:
+    return(nmmtl_interval_sources_c_order<3>(cel,sigma_vector,X,Y,charge));
+  default:
+    return(nmmtl_interval_sources_c_order<2>(cel,sigma_vector,X,Y,charge));
+  }
+}
+
+template <int ORDER>
+static int nmmtl_interval_sources_c_order(CELEMENTS_P cel,
+                                          double *sigma_vector,
+                                          double *X,
+                                          double *Y,
+                                          double *charge)
+{
+  int i;
+  int Legendre_counter;
+  double shape[ORDER + 1];
+  double Jacobian;
+  double sigma;
+  double nu0;
+
+  nmmtl_shape_table<ORDER,Legendre_root_i_max> const &table =
+    nmmtl_shape_table_i<ORDER>();
+
+  for(Legendre_counter = 0; Legendre_counter < Legendre_root_i_max;
+      Legendre_counter++)
+  {
+    for(i=0;i <= ORDER;i++)
+      shape[i] = table.shape[Legendre_counter][i];
+
+    /* interpolate x,y coordinate using no_edge shape function */
+    X[Legendre_counter] = 0.0;
+    Y[Legendre_counter] = 0.0;
+    for(i=0;i <= ORDER;i++)
+    {
+      X[Legendre_counter] += shape[i]*cel->xpts[i];
+      Y[Legendre_counter] += shape[i]*cel->ypts[i];
+    }
+
+    Jacobian = nmmtl_jacobian_order<ORDER>(table.derivative[Legendre_counter],
+                                           cel->xpts,cel->ypts);
+
+    /* if an edge element - recalculate shape using edge effects */
+
+    if(cel->edge[0] || cel->edge[1])
+    {
+      nu0 = cel->edge[0] ? cel->nu[0] : 0;
+      nmmtl_shape_c_edge(Legendre_root_i[Legendre_counter],shape,cel,nu0);
+    }
+
+    sigma = 0.0;
+    for(i=0;i <= ORDER;i++)
+      sigma += shape[i] * sigma_vector[cel->node[i]];
+
+    charge[Legendre_counter] = Legendre_weight_i[Legendre_counter] *
+      sigma * Jacobian;
+  } /* for all Legendre roots */
+
+  return(Legendre_root_i_max);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_interval_sources_d()
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Gives the integration points nmmtl_interval_d uses over a dielectric
+  element, each with the charge the element carries there for a solved
+  charge distribution.  See nmmtl_interval_sources_c.
+
+  FORMAL PARAMETERS:
+
+  DELEMENTS_P del,      - dielectric element
+  double *sigma_vector  - charge density at each node
+  double *X,            - out: x of each integration point
+  double *Y,            - out: y of each integration point
+  double *charge        - out: charge at each integration point
+
+  RETURN VALUE:
+
+  the number of integration points, Legendre_root_i_max
+
+  CALLING SEQUENCE:
+
+  sources += nmmtl_interval_sources_d(del,sigma_vector,X + sources,
+                                      Y + sources,charge + sources);
+
+  */
+
+int nmmtl_interval_sources_d(DELEMENTS_P del,
+                             double *sigma_vector,
+                             double *X,
+                             double *Y,
+                             double *charge)
+{
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    return(nmmtl_interval_sources_d_order<1>(del,sigma_vector,X,Y,charge));
+  case 3:
+    return(nmmtl_interval_sources_d_order<3>(del,sigma_vector,X,Y,charge));
+  default:
+    return(nmmtl_interval_sources_d_order<2>(del,sigma_vector,X,Y,charge));
+  }
+}
+
+template <int ORDER>
+static int nmmtl_interval_sources_d_order(DELEMENTS_P del,
+                                          double *sigma_vector,
+                                          double *X,
+                                          double *Y,
+                                          double *charge)
+{
+  int i;
+  int Legendre_counter;
+  double Jacobian;
+  double sigma;
+
+  nmmtl_shape_table<ORDER,Legendre_root_i_max> const &table =
+    nmmtl_shape_table_i<ORDER>();
+
+  for(Legendre_counter = 0; Legendre_counter < Legendre_root_i_max;
+      Legendre_counter++)
+  {
+    X[Legendre_counter] = 0.0;
+    Y[Legendre_counter] = 0.0;
+    sigma = 0.0;
+    for(i=0;i <= ORDER;i++)
+    {
+      X[Legendre_counter] += table.shape[Legendre_counter][i]*del->xpts[i];
+      Y[Legendre_counter] += table.shape[Legendre_counter][i]*del->ypts[i];
+      sigma += table.shape[Legendre_counter][i] * sigma_vector[del->node[i]];
+    }
+
+    Jacobian = nmmtl_jacobian_order<ORDER>(table.derivative[Legendre_counter],
+                                           del->xpts,del->ypts);
+
+    charge[Legendre_counter] = Legendre_weight_i[Legendre_counter] *
+      sigma * Jacobian;
+  } /* for all Legendre roots */
+
+  return(Legendre_root_i_max);
+}
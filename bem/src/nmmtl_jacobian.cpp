@@ -28,6 +28,7 @@
  */
 
 #include "nmmtl.h"
+#include "nmmtl_shape.h"
 
 /*
  *******************************************************************
@@ -160,7 +161,8 @@ void nmmtl_jacobian_c(double local, CELEMENTS_P cel, double *Jacobian) {
   This then gets brokken down into a series of basis functions
   and a sum over the basis functions - at node points.
 
-  number of nodes per element is one more than basis_order.
+  number of nodes per element is one more than basis_order, which is
+  ELEMENT_ORDER; the functions themselves are in nmmtl_shape.h.
 
   To calculate the derivative of the basis function, there will be
   ( 1 + basis order ) basis functions.
@@ -202,49 +204,23 @@ void nmmtl_jacobian_c(double local, CELEMENTS_P cel, double *Jacobian) {
   */
 
 static void nmmtl_jacobian(double local, double xpts[], double ypts[], double *Jacobian) {
-  double delta_x,delta_y,L1,L2;
-  double derivative[INTERP_PTS];
-  int i;
-
-  /* short cuts, values of L1 and L2 at the point local */
-  L1 = 1.0 - local;
-  L2 = local;
-
   /* calculate the derivative of the basis function, there will be
-     ( 1 + basis order ) basis functions. */
-
-  /* - hard code the basis order = 2, here are some others for reference
-
-     if(basis_order .eq. 1) then
-
-     derivative[0] = -1.
-     derivative[1] = 1.
-
-     if(basis_order .eq. 3) then
-
-     derivative[0] = -0.5*( 27.*L1*L1 - 18.*L1 + 2. )
-     derivative[1] =  4.5*( L1*(3.*L1 - 1.) - L2*(6.*L1 - 1.) )
-     derivative[2] = -4.5*( L2*(3.*L2 - 1.) - L1*(6.*L2 - 1.) )
-     derivative[3] =  0.5*( 27.*L2*L2 - 18.*L2 + 2. )
-
-     */
-
-  derivative[0] = -4.*L1 + 1.0;
-  derivative[1] = 4.*( L1 - L2 );
-  derivative[2] = 4.*L2 - 1.0;
-
-  /* clear deltas */
-  delta_x = 0.;
-  delta_y = 0.;
-
-  /* sum up the global coordinate times the derivative for each of the
-     nodal points.  Ref Jackson notes, eqns 21a and 21b. */
-  for(i=0;i < INTERP_PTS;i++) {
-    delta_x = delta_x + derivative[i]*xpts[i];
-    delta_y = delta_y + derivative[i]*ypts[i];
+     ( 1 + basis order ) basis functions, and sum up the global
+     coordinate times the derivative for each of the nodal points.  Ref
+     Jackson notes, eqns 21a and 21b.  The Jacobian is the linear
+     displacement - square root of sum of squares of delta_x and
+     delta_y */
+
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    *Jacobian = nmmtl_jacobian_order<1>(local,xpts,ypts);
+    break;
+  case 3:
+    *Jacobian = nmmtl_jacobian_order<3>(local,xpts,ypts);
+    break;
+  default:
+    *Jacobian = nmmtl_jacobian_order<2>(local,xpts,ypts);
+    break;
   }
-
-  /* Jacobian is linear displacement - square root of sum of squares of
-     delta_x and delta_y */
-  *Jacobian = sqrt(delta_x*delta_x + delta_y*delta_y);
 }
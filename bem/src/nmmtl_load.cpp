@@ -66,7 +66,7 @@ void nmmtl_load(double *potential_vector,
   int i;
   double shape[INTERP_PTS];
   double Jacobian;
-  CELEMENTS_P cel;
+  CELEMENTS_P cel,cel_end;
   double nu0;
   //float nu1;
 
@@ -78,13 +78,14 @@ void nmmtl_load(double *potential_vector,
   /* assume the potential_vector is already zeroed */
 
   cel = conductor_data[conductor_number].elements;
-  while (cel != NULL) {
+  cel_end = cel + conductor_data[conductor_number].number_elements;
+  while(cel < cel_end) {
     for (Legendre_counter = 0; Legendre_counter < Legendre_root_l_max; Legendre_counter++) {
-      if (cel->edge[0] != NULL || cel->edge[1] != NULL) {
+      if (cel->edge[0] || cel->edge[1]) {
   /* if given edge is really an edge, set the true value of nu,
      otherwise, don't really care */
-  nu0 = cel->edge[0] ? cel->edge[0]->nu : 0;
-  //nu1 = cel->edge[1] ? cel->edge[1]->nu : 0;
+  nu0 = cel->edge[0] ? cel->nu[0] : 0;
+  //nu1 = cel->edge[1] ? cel->nu[1] : 0;
   //nmmtl_shape_c_edge(Legendre_root_l[Legendre_counter],shape,cel,nu0,nu1);
   nmmtl_shape_c_edge(Legendre_root_l[Legendre_counter],shape,cel,nu0);
       } else {
@@ -93,7 +94,7 @@ void nmmtl_load(double *potential_vector,
 
       nmmtl_jacobian_c(Legendre_root_l[Legendre_counter],cel,&Jacobian);
 
-      for(i=0; i < INTERP_PTS; i++) {
+      for(i=0; i < ELEMENT_PTS; i++) {
 #ifdef BEM3_VARIANT
   potential_vector[cel->node[i]] +=
     coef * Legendre_weight_a[Legendre_counter] * shape[i] * Jacobian;
@@ -104,7 +105,7 @@ void nmmtl_load(double *potential_vector,
 #endif
       }
     }
-    cel = cel->next;
+    cel++;
   }
 }
 
@@ -147,7 +148,7 @@ void nmmtl_load_free_space(double *potential_vector,
   int i;
   double shape[INTERP_PTS];
   double Jacobian;
-  CELEMENTS_P cel;
+  CELEMENTS_P cel,cel_end;
   double nu0;
   //float nu1;
 
@@ -159,17 +160,18 @@ void nmmtl_load_free_space(double *potential_vector,
   /* assume the potential_vector is already zeroed */
 
   cel = conductor_data[conductor_number].elements;
-  while(cel != NULL)
+  cel_end = cel + conductor_data[conductor_number].number_elements;
+  while(cel < cel_end)
   {
     for(Legendre_counter = 0; Legendre_counter < Legendre_root_l_max;
   Legendre_counter++)
     {
-      if(cel->edge[0] != NULL || cel->edge[1] != NULL)
+      if(cel->edge[0] || cel->edge[1])
       {
   /* if given edge is really an edge, set the true value of nu,
      otherwise, don't really care */
-  nu0 = cel->edge[0] ? cel->edge[0]->free_space_nu : 0;
-  //nu1 = cel->edge[1] ? cel->edge[1]->free_space_nu : 0;
+  nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+  //nu1 = cel->edge[1] ? cel->free_space_nu[1] : 0;
   //nmmtl_shape_c_edge(Legendre_root_l[Legendre_counter],shape,cel,nu0,nu1);
   nmmtl_shape_c_edge(Legendre_root_l[Legendre_counter],shape,cel,nu0);
       }
@@ -178,7 +180,7 @@ void nmmtl_load_free_space(double *potential_vector,
 
       nmmtl_jacobian_c(Legendre_root_l[Legendre_counter],cel,&Jacobian);
 
-      for(i=0; i < INTERP_PTS; i++)
+      for(i=0; i < ELEMENT_PTS; i++)
       {
 #ifdef BEM3_VARIANT
   potential_vector[cel->node[i]] +=
@@ -190,7 +192,7 @@ void nmmtl_load_free_space(double *potential_vector,
 #endif
       }
     }
-    cel = cel->next;
+    cel++;
   }
 }
 
@@ -31,6 +31,16 @@
  **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
  *******************************************************************
  */
+
+/* the sub segments of the second list which share an at value, chained
+   in list order */
+
+typedef struct die_subseg_bucket
+{
+  double at;
+  struct dielectric_sub_segments *head;
+} DIE_SUBSEG_BUCKET, *DIE_SUBSEG_BUCKET_P;
+
 /*
  *******************************************************************
  **  MACRO DEFINITIONS
@@ -51,6 +61,22 @@
  **  FUNCTION DECLARATIONS
  *******************************************************************
  */
+
+static int nmmtl_die_subseg_bucket_sort(struct dielectric_sub_segments *seg,
+                                        DIE_SUBSEG_BUCKET_P *buckets,
+                                        int *number_buckets,
+                                        int *number_groups);
+
+static struct dielectric_sub_segments **
+nmmtl_die_subseg_bucket_find(DIE_SUBSEG_BUCKET_P buckets,
+                             int number_buckets, double at);
+
+static void nmmtl_die_subseg_bucket_unsort(DIE_SUBSEG_BUCKET_P buckets,
+                                           int number_buckets,
+                                           int number_groups,
+                                           struct dielectric_sub_segments **seg);
+
+static int nmmtl_die_subseg_compare(const void *a, const void *b);
 /*
  *******************************************************************
  **  FUNCTION DEFINITIONS
@@ -72,6 +98,12 @@
   value, whereas seg2 subsegments are the anti-normal side and set
   epsilonminus.  A loop of traversing the seg1 list with a nested loop
   of traversing the seg2 list is the basic structure.
+
+  Only sub segments at the same place can pair up, so the seg2 list is
+  sorted once into buckets by at, and each seg1 sub segment only scans
+  its own bucket, in the same order it would meet them on the list.
+  The left-over seg2 sub segments are put back in list order before
+  the gaps get filled.
   
   
   FORMAL PARAMETERS:
@@ -123,6 +155,13 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
   int olp_status;
   unsigned char restart_2; /* a flag to indicate if list 2 should checked */
   /* from the beginning again */
+  DIE_SUBSEG_BUCKET_P buckets;
+  int number_buckets, number_groups;
+  struct dielectric_sub_segments **head2; /* bucket of list1 in list 2 */
+  
+  if(nmmtl_die_subseg_bucket_sort(*seg2,&buckets,&number_buckets,
+                                  &number_groups) != SUCCESS)
+    return(FAIL);
   
   list1 = *seg1;
   prev1 = NULL;
@@ -139,7 +178,8 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
 	    list1->start,list1->end);
 #endif	
     
-    list2 = *seg2;
+    head2 = nmmtl_die_subseg_bucket_find(buckets,number_buckets,list1->at);
+    list2 = head2 != NULL ? *head2 : NULL;
     prev2 = NULL;
     while(list1 != NULL && list2 != NULL)
     {
@@ -158,7 +198,11 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
       olp_status = nmmtl_overlap_parallel_seg(list1,list2,&overlap_left,
 					      &overlap_right,&left_overhang,
 					      &right_overhang);
-      if(olp_status == 2) return(FAIL);
+      if(olp_status == 2)
+      {
+        free(buckets);
+        return(FAIL);
+      }
       if(olp_status == 1)
       {
 	
@@ -198,7 +242,11 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
 	
 	status = nmmtl_new_die_seg(dielectric_segments,list1,list2,orientation,
 				   *segment_number,overlap_left,overlap_right);
-	if(status != SUCCESS) return(status);
+	if(status != SUCCESS)
+	{
+	  free(buckets);
+	  return(status);
+	}
 	*segment_number += 1;
 	
 	
@@ -286,6 +334,7 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
 	  new_sub_segment->start = overlap_right; 
 	  new_sub_segment->end = list2->end;
 	  new_sub_segment->epsilon = list2->epsilon;
+	  new_sub_segment->group = list2->group;
 	  new_sub_segment->divisions = (int)(0.99 + list2->divisions *
 	    (list2->end - overlap_right)/(list2->end - list2->start));
 	  /* modify old one to be new left sub segment */
@@ -330,7 +379,7 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
 	  {
 	    prev2 = list2;
 	    list2 = list2->next;
-	    *seg2 = list2;
+	    *head2 = list2;
 	    free(prev2);
 	    prev2 = NULL;
 	  }
@@ -350,7 +399,11 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
 #ifdef DIAG_MERGE_DIE
 	printf("restarting list2\n");	  
 #endif	
-	list2 = *seg2;
+	/* which, having moved on from a used up one, may be elsewhere */
+	if(list1 != NULL)
+	  head2 = nmmtl_die_subseg_bucket_find(buckets,number_buckets,
+					       list1->at);
+	list2 = head2 != NULL ? *head2 : NULL;
 	prev2 = NULL;
       }
       
@@ -366,8 +419,235 @@ int nmmtl_merge_die_subseg(int orientation,int *segment_number,
     if(list1 != NULL) list1 = list1->next;
   }
   
+  nmmtl_die_subseg_bucket_unsort(buckets,number_buckets,number_groups,seg2);
+  free(buckets);
+  
   status = nmmtl_fill_die_gaps(orientation,segment_number,top_stack,seg1,seg2,
 			       dielectric_segments);
   
   return(SUCCESS);
 }
+
+
+/*
+  
+  FUNCTION NAME:  nmmtl_die_subseg_bucket_sort
+  
+  
+  FUNCTIONAL DESCRIPTION:
+  
+  Number the sub segments of a list as groups in list order, sort them
+  on at, with ties kept in list order, and chain each run with the same
+  at into a bucket.  Pieces later split off a sub segment are inserted
+  behind it in its bucket and take its group.
+  
+  FORMAL PARAMETERS:
+  
+  struct dielectric_sub_segments *seg
+  - the list, may be empty, is taken apart into the buckets
+  
+  DIE_SUBSEG_BUCKET_P *buckets, int *number_buckets
+  - output: the buckets, sorted on at, free when done
+  
+  int *number_groups
+  - output: how many sub segments were on the list
+  
+  RETURN VALUE:
+  
+  SUCCESS, FAIL if out of memory
+  
+  CALLING SEQUENCE:
+  
+  status = nmmtl_die_subseg_bucket_sort(*seg2,&buckets,&number_buckets,
+  &number_groups);
+  
+  */
+
+static int nmmtl_die_subseg_bucket_sort(struct dielectric_sub_segments *seg,
+                                        DIE_SUBSEG_BUCKET_P *buckets,
+                                        int *number_buckets,
+                                        int *number_groups)
+{
+  struct dielectric_sub_segments **sorted;
+  struct dielectric_sub_segments *list;
+  int number = 0;
+  int i;
+  
+  for(list = seg; list != NULL; list = list->next) number++;
+  
+  sorted = (struct dielectric_sub_segments **)
+    malloc(sizeof(struct dielectric_sub_segments *) * (size_t)(number + 1));
+  *buckets = (DIE_SUBSEG_BUCKET_P)
+    malloc(sizeof(DIE_SUBSEG_BUCKET) * (size_t)(number + 1));
+  if(sorted == NULL || *buckets == NULL)
+  {
+    free(sorted);
+    free(*buckets);
+    *buckets = NULL;
+    return(FAIL);
+  }
+  
+  for(i = 0, list = seg; list != NULL; i++, list = list->next)
+  {
+    list->group = i;
+    sorted[i] = list;
+  }
+  
+  qsort(sorted,(size_t)number,sizeof(struct dielectric_sub_segments *),
+        nmmtl_die_subseg_compare);
+  
+  *number_buckets = 0;
+  for(i = 0; i < number; i++)
+  {
+    if(i == 0 || sorted[i]->at != sorted[i-1]->at)
+    {
+      (*buckets)[*number_buckets].at = sorted[i]->at;
+      (*buckets)[*number_buckets].head = sorted[i];
+      (*number_buckets)++;
+    }
+    else
+      sorted[i-1]->next = sorted[i];
+    sorted[i]->next = NULL;
+  }
+  
+  *number_groups = number;
+  free(sorted);
+  return(SUCCESS);
+}
+
+
+/*
+  
+  FUNCTION NAME:  nmmtl_die_subseg_bucket_find
+  
+  
+  FUNCTIONAL DESCRIPTION:
+  
+  Binary search the buckets for the one at a given place.
+  
+  FORMAL PARAMETERS:
+  
+  DIE_SUBSEG_BUCKET_P buckets, int number_buckets
+  - the buckets, sorted on at
+  
+  double at
+  - where
+  
+  RETURN VALUE:
+  
+  pointer to the head of the bucket's chain, NULL if there is none there
+  
+  CALLING SEQUENCE:
+  
+  head2 = nmmtl_die_subseg_bucket_find(buckets,number_buckets,list1->at);
+  
+  */
+
+static struct dielectric_sub_segments **
+nmmtl_die_subseg_bucket_find(DIE_SUBSEG_BUCKET_P buckets,
+                             int number_buckets, double at)
+{
+  int first = 0, last = number_buckets, middle;
+  
+  while(first < last)
+  {
+    middle = (first + last) / 2;
+    if(buckets[middle].at < at) first = middle + 1;
+    else last = middle;
+  }
+  
+  if(first < number_buckets && buckets[first].at == at)
+    return(&buckets[first].head);
+  return(NULL);
+}
+
+
+/*
+  
+  FUNCTION NAME:  nmmtl_die_subseg_bucket_unsort
+  
+  
+  FUNCTIONAL DESCRIPTION:
+  
+  Link the sub segments left in the buckets back into one list, in the
+  order they would have had on it: by group, and within a group in the
+  order of its bucket.  The pieces of a group always sit next to each
+  other in their bucket.
+  
+  FORMAL PARAMETERS:
+  
+  DIE_SUBSEG_BUCKET_P buckets, int number_buckets
+  - the buckets
+  
+  int number_groups
+  - how many groups were numbered
+  
+  struct dielectric_sub_segments **seg
+  - output: the list
+  
+  RETURN VALUE:
+  
+  None
+  
+  CALLING SEQUENCE:
+  
+  nmmtl_die_subseg_bucket_unsort(buckets,number_buckets,number_groups,seg2);
+  
+  */
+
+static void nmmtl_die_subseg_bucket_unsort(DIE_SUBSEG_BUCKET_P buckets,
+                                           int number_buckets,
+                                           int number_groups,
+                                           struct dielectric_sub_segments **seg)
+{
+  struct dielectric_sub_segments **first;
+  struct dielectric_sub_segments *list, *next;
+  int b, g;
+  
+  /* where each group starts */
+  first = (struct dielectric_sub_segments **)
+    calloc((size_t)(number_groups + 1),sizeof(struct dielectric_sub_segments *));
+  for(b = 0; b < number_buckets; b++)
+  {
+    for(list = buckets[b].head, g = -1; list != NULL; list = list->next)
+    {
+      if(list->group != g) first[list->group] = list;
+      g = list->group;
+    }
+  }
+  
+  for(g = 0; g < number_groups; g++)
+  {
+    for(list = first[g]; list != NULL && list->group == g; list = next)
+    {
+      next = list->next;
+      *seg = list;
+      seg = &list->next;
+    }
+  }
+  *seg = NULL;
+  
+  free(first);
+}
+
+
+/*
+  
+  FUNCTION NAME:  nmmtl_die_subseg_compare
+  
+  
+  FUNCTIONAL DESCRIPTION:
+  
+  qsort comparison of two sub segments by at, then by group.
+  
+  */
+
+static int nmmtl_die_subseg_compare(const void *a, const void *b)
+{
+  struct dielectric_sub_segments *sa = *(struct dielectric_sub_segments **)a;
+  struct dielectric_sub_segments *sb = *(struct dielectric_sub_segments **)b;
+  
+  if(sa->at < sb->at) return(-1);
+  if(sa->at > sb->at) return(1);
+  return(sa->group - sb->group);
+}
@@ -0,0 +1,276 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_mixed_mode_pairs, which finds the differential pairs
+  among the signals, and nmmtl_mixed_mode_calculate, which gives their
+  differential and common mode impedances and velocities from the full
+  matrices of one solve, every other signal being held at zero.
+
+  A pair i, j driven with differential voltage Vd = Vi - Vj and current
+  Id = (Ii - Ij)/2, and common mode voltage Vc = (Vi + Vj)/2 and current
+  Ic = Ii + Ij, sees
+
+    Ldd = Lii - Lij - Lji + Ljj       Cdd = (Cii - Cij - Cji + Cjj)/4
+    Lcc = (Lii + Lij + Lji + Ljj)/4   Ccc = Cii + Cij + Cji + Cjj
+
+  so that Zdiff = sqrt(Ldd/Cdd) and vdiff = 1/sqrt(Ldd Cdd), and the
+  same for the common mode.  For a symmetric pair Zdiff is twice the
+  odd mode impedance and Zcomm half the even mode impedance.  The
+  coupling between the two modes of an asymmetric pair is left out.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_mixed_mode_stem(const char *name, int *polarity);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_mixed_mode_pairs
+
+  FUNCTIONAL DESCRIPTION:
+
+  Turns the pairs of signal names the cross section gives into pairs of
+  signal indices, warning of names that are not signals.  With no names
+  given the pairs are found from the conductor names, like ground wires
+  are: signals whose conductor names differ only in ending with P and
+  with N (or p and n, or + and -) are paired, the first signal of one
+  with the first of the other and so on, so "RectangleConductors dP
+  -number 16" and "RectangleConductors dN -number 16" make 16 pairs.
+
+  FORMAL PARAMETERS:
+
+  struct contour *signals       - the signals
+  int number_names              - how many pairs of names were given
+  char (*names)[2][SIZE_SIG_NAME] - the pairs of names
+  int (*pairs)[2]               - out: the pairs of signal indices, room
+                                  for number_names of them or half the
+                                  number of signals, whichever is more
+
+  RETURN VALUE:
+
+  the number of pairs
+
+  CALLING SEQUENCE:
+
+  number_pairs = nmmtl_mixed_mode_pairs(signals,number_names,names,pairs);
+
+  */
+
+int nmmtl_mixed_mode_pairs(struct contour *signals,
+                           int number_names,
+                           char (*names)[2][SIZE_SIG_NAME],
+                           int (*pairs)[2])
+{
+  struct contour *sig_line1, *sig_line2;
+  int number_pairs = 0;
+  int n, side, i, j, k, stem1, stem2, polarity1, polarity2;
+  int *paired;
+
+  /* - - - - - - - - - - - - - - Pairs given by name - - - - - - - - - - - */
+
+  for(n = 0; n < number_names; n++)
+  {
+    for(side = 0; side < 2; side++)
+    {
+      for(sig_line1 = signals, i = 0; sig_line1 != NULL;
+          sig_line1 = sig_line1->next, i++)
+        if(strcmp(sig_line1->name,names[n][side]) == 0) break;
+      if(sig_line1 == NULL)
+      {
+        printf("Warning: differential pair signal %s not found\n",
+               names[n][side]);
+        break;
+      }
+      pairs[number_pairs][side] = i;
+    }
+    if(side == 2) number_pairs++;
+  }
+  if(number_names > 0) return(number_pairs);
+
+  /* - - - - - - - - - - - - - Pairs found by naming - - - - - - - - - - - */
+
+  for(sig_line1 = signals, n = 0; sig_line1 != NULL;
+      sig_line1 = sig_line1->next, n++);
+  paired = (int *)calloc((size_t)n,sizeof(int));
+
+  /* the k-th positive signal of a conductor goes with the k-th negative
+     signal of the conductor whose name has the same stem */
+  for(sig_line1 = signals, i = 0; sig_line1 != NULL;
+      sig_line1 = sig_line1->next, i++)
+  {
+    stem1 = nmmtl_mixed_mode_stem(sig_line1->name,&polarity1);
+    if(polarity1 != 1 || paired[i]) continue;
+
+    /* which of the positive signals of its conductor this one is */
+    k = 0;
+    for(sig_line2 = signals, j = 0; j < i; sig_line2 = sig_line2->next, j++)
+    {
+      stem2 = nmmtl_mixed_mode_stem(sig_line2->name,&polarity2);
+      if(polarity2 == 1 && stem2 == stem1 &&
+         strncmp(sig_line1->name,sig_line2->name,(size_t)stem1 + 1) == 0)
+        k++;
+    }
+
+    for(sig_line2 = signals, j = 0; sig_line2 != NULL;
+        sig_line2 = sig_line2->next, j++)
+    {
+      stem2 = nmmtl_mixed_mode_stem(sig_line2->name,&polarity2);
+      if(polarity2 != -1 || stem2 != stem1 ||
+         strncmp(sig_line1->name,sig_line2->name,(size_t)stem1) != 0)
+        continue;
+      if(k-- > 0) continue;
+      if(!paired[j])
+      {
+        pairs[number_pairs][0] = i;
+        pairs[number_pairs][1] = j;
+        number_pairs++;
+        paired[i] = paired[j] = TRUE;
+      }
+      break;
+    }
+  }
+
+  free(paired);
+  return(number_pairs);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_mixed_mode_stem
+
+  FUNCTIONAL DESCRIPTION:
+
+  Find the conductor name a signal name was made from, the conductor
+  name being followed by the type of conductor and the signal number,
+  and whether it ends in a polarity.
+
+  FORMAL PARAMETERS:
+
+  const char *name    - the signal name
+  int *polarity       - out: 1 if the conductor name ends in P, p or +,
+                        -1 if in N, n or -, 0 otherwise
+
+  RETURN VALUE:
+
+  the length of the conductor name without the polarity
+
+  CALLING SEQUENCE:
+
+  stem = nmmtl_mixed_mode_stem(name,&polarity);
+
+  */
+
+static int nmmtl_mixed_mode_stem(const char *name, int *polarity)
+{
+  int length = (int)strlen(name);
+
+  while(length > 0 && name[length-1] >= '0' && name[length-1] <= '9')
+    length--;
+  /* the type of conductor, then the polarity */
+  length -= 2;
+
+  *polarity = 0;
+  if(length < 0) return(0);
+  if(strchr("Pp+",name[length]) != NULL) *polarity = 1;
+  else if(strchr("Nn-",name[length]) != NULL) *polarity = -1;
+  return(length);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_mixed_mode_calculate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Calculates the differential and common mode impedances and velocities
+  of each pair.
+
+  FORMAL PARAMETERS:
+
+  int number_pairs                  - how many pairs
+  int (*pairs)[2]                   - the signal indices of each
+  double **electrostatic_induction  - [B] matrix of all the signals
+  double **inductance               - [L] matrix of all the signals
+  double *differential_impedance    - out: Zdiff of each pair, ohms
+  double *common_impedance          - out: Zcomm of each pair, ohms
+  double *differential_velocity     - out: meters/second
+  double *common_velocity           - out: meters/second
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_mixed_mode_calculate(number_pairs,pairs,electrostatic_induction,
+                             inductance,differential_impedance,
+                             common_impedance,differential_velocity,
+                             common_velocity);
+
+  */
+
+void nmmtl_mixed_mode_calculate(int number_pairs,
+                                int (*pairs)[2],
+                                double **electrostatic_induction,
+                                double **inductance,
+                                double *differential_impedance,
+                                double *common_impedance,
+                                double *differential_velocity,
+                                double *common_velocity)
+{
+  int p, i, j;
+  double l_dd, c_dd, l_cc, c_cc;
+
+  for(p = 0; p < number_pairs; p++)
+  {
+    i = pairs[p][0];
+    j = pairs[p][1];
+
+    l_dd = inductance[i][i] - inductance[i][j] - inductance[j][i] +
+      inductance[j][j];
+    c_dd = 0.25 * (electrostatic_induction[i][i] -
+                   electrostatic_induction[i][j] -
+                   electrostatic_induction[j][i] +
+                   electrostatic_induction[j][j]);
+    l_cc = 0.25 * (inductance[i][i] + inductance[i][j] + inductance[j][i] +
+                   inductance[j][j]);
+    c_cc = electrostatic_induction[i][i] + electrostatic_induction[i][j] +
+      electrostatic_induction[j][i] + electrostatic_induction[j][j];
+
+    differential_impedance[p] = sqrt(l_dd / c_dd);
+    differential_velocity[p] = 1.0 / sqrt(l_dd * c_dd);
+    common_impedance[p] = sqrt(l_cc / c_cc);
+    common_velocity[p] = 1.0 / sqrt(l_cc * c_cc);
+  }
+}
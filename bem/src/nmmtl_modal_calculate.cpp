@@ -0,0 +1,397 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_modal_calculate, which decomposes the lines into their
+  propagation modes for any number of signals.
+
+  The modes are the eigenvectors of L C, with eigenvalues 1/v^2.  L C is
+  not symmetric, but with the Cholesky factor C = G G^T it is similar to
+  the symmetric G^T L G:
+
+    L C = inv(G^T) (G^T L G) G^T
+
+  so the eigenvalues are real and the symmetric problem is solved by the
+  Jacobi method.  Its eigenvectors Q give the voltage modes inv(G^T) Q
+  and the current modes G Q, the eigenvectors of C L.  C is the same at
+  every point of a sweep, so it is factored once.
+
+  With losses, the attenuation of each mode is taken to first order from
+  the modal resistance and conductance, Ti^T R Ti and Tv^T G Tv:
+
+    alpha = (R_m/Z_m + G_m Z_m)/2
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_modal_jacobi(int order, double **matrix, double *eigenvalues,
+                              double **eigenvectors);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_modal_calculate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Finds the propagation modes at each point of a sweep.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter            - number of signals
+  double **electrostatic_induction - [B], the capacitance matrix
+  int number_points                - points of the sweep
+  double ***inductance             - [L] at each point
+  double ***resistance             - [R] at each point, or NULL when
+                                     lossless
+  double ***conductance            - [G] at each point, or NULL
+  MODES_P modes                    - out: the modes at each point,
+                                     allocated by the caller, the
+                                     matrices with dim2
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the capacitance matrix is not positive definite or
+  the eigenvalues would not converge.
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_modal_calculate(conductor_counter,electrostatic_induction,
+                                 number_points,inductance,resistance,
+                                 conductance,modes);
+
+  */
+
+int nmmtl_modal_calculate(int conductor_counter,
+                          double **electrostatic_induction,
+                          int number_points,
+                          double ***inductance,
+                          double ***resistance,
+                          double ***conductance,
+                          MODES_P modes)
+{
+  int n = conductor_counter;
+  double **factor, **work, **symmetric, **eigenvectors, **gram, **rotation;
+  double *eigenvalues, *scale, *gram_values;
+  double sum, largest, swap, resistance_m, conductance_m;
+  int point, i, j, k, m, first, last;
+  int status = SUCCESS;
+
+  factor = (double **)dim2(n,n,sizeof(double));
+  work = (double **)dim2(n,n,sizeof(double));
+  symmetric = (double **)dim2(n,n,sizeof(double));
+  eigenvectors = (double **)dim2(n,n,sizeof(double));
+  gram = (double **)dim2(n,n,sizeof(double));
+  rotation = (double **)dim2(n,n,sizeof(double));
+  eigenvalues = (double *)malloc(sizeof(double) * (size_t)n);
+  scale = (double *)malloc(sizeof(double) * (size_t)n);
+  gram_values = (double *)malloc(sizeof(double) * (size_t)n);
+
+  /* - - - - - - - Cholesky factor of the capacitance, C = G G^T - - - - - - */
+
+  for(j = 0; j < n && status == SUCCESS; j++)
+  {
+    sum = electrostatic_induction[j][j];
+    for(k = 0; k < j; k++) sum -= factor[j][k] * factor[j][k];
+    if(sum <= 0.0)
+    {
+      printf("Modal analysis: the capacitance matrix is not positive definite\n");
+      status = FAIL;
+      break;
+    }
+    factor[j][j] = sqrt(sum);
+    for(i = j + 1; i < n; i++)
+    {
+      sum = electrostatic_induction[i][j];
+      for(k = 0; k < j; k++) sum -= factor[i][k] * factor[j][k];
+      factor[i][j] = sum / factor[j][j];
+    }
+  }
+
+  for(point = 0; point < number_points && status == SUCCESS; point++)
+  {
+    /* - - - - - - - - - - - The symmetric G^T L G - - - - - - - - - - - - */
+
+    for(i = 0; i < n; i++)
+      for(j = 0; j < n; j++)
+      {
+        sum = 0.0;
+        for(k = j; k < n; k++) sum += inductance[point][i][k] * factor[k][j];
+        work[i][j] = sum;
+      }
+    for(i = 0; i < n; i++)
+      for(j = 0; j < n; j++)
+      {
+        sum = 0.0;
+        for(k = i; k < n; k++) sum += factor[k][i] * work[k][j];
+        symmetric[i][j] = sum;
+      }
+    /* take out the asymmetry L has from the solution */
+    for(i = 0; i < n; i++)
+      for(j = 0; j < i; j++)
+        symmetric[i][j] = symmetric[j][i] =
+          0.5 * (symmetric[i][j] + symmetric[j][i]);
+
+    if(nmmtl_modal_jacobi(n,symmetric,eigenvalues,eigenvectors) != SUCCESS)
+    {
+      printf("Modal analysis: the eigenvalues did not converge\n");
+      status = FAIL;
+      break;
+    }
+
+    /* sort the modes by decreasing eigenvalue, increasing velocity */
+    for(m = 0; m < n; m++)
+    {
+      k = m;
+      for(j = m + 1; j < n; j++)
+        if(eigenvalues[j] > eigenvalues[k]) k = j;
+      if(k != m)
+      {
+        swap = eigenvalues[m];
+        eigenvalues[m] = eigenvalues[k];
+        eigenvalues[k] = swap;
+        for(i = 0; i < n; i++)
+        {
+          swap = eigenvectors[i][m];
+          eigenvectors[i][m] = eigenvectors[i][k];
+          eigenvectors[i][k] = swap;
+        }
+      }
+    }
+    if(eigenvalues[n-1] <= 0.0)
+    {
+      printf("Modal analysis: L C has an eigenvalue that is not positive\n");
+      status = FAIL;
+      break;
+    }
+
+    /* - - - - - - - - The voltage modes, inv(G^T) Q - - - - - - - - - - */
+
+    for(m = 0; m < n; m++)
+      for(i = n - 1; i >= 0; i--)
+      {
+        sum = eigenvectors[i][m];
+        for(k = i + 1; k < n; k++) sum -= factor[k][i] * work[k][m];
+        work[i][m] = sum / factor[i][i];
+      }
+
+    /* Within a set of modes of the same velocity any combination is a
+       mode too - in a homogeneous dielectric all of them are.  Pick the
+       combinations whose voltages are orthogonal, which are then the
+       eigenvectors of C, e.g. even and odd for a symmetric pair. */
+    for(first = 0; first < n; first = last)
+    {
+      for(last = first + 1; last < n &&
+            eigenvalues[first] - eigenvalues[last] <=
+            MODAL_DEGENERACY * eigenvalues[first]; last++);
+      if(last - first < 2) continue;
+
+      m = last - first;
+      for(i = 0; i < m; i++)
+        for(j = 0; j < m; j++)
+        {
+          sum = 0.0;
+          for(k = 0; k < n; k++) sum += work[k][first+i] * work[k][first+j];
+          gram[i][j] = sum;
+        }
+      if(nmmtl_modal_jacobi(m,gram,gram_values,rotation) != SUCCESS) continue;
+      for(k = 0; k < n; k++)
+      {
+        for(j = 0; j < m; j++)
+        {
+          scale[j] = 0.0;
+          gram_values[j] = 0.0;
+          for(i = 0; i < m; i++)
+          {
+            scale[j] += work[k][first+i] * rotation[i][j];
+            gram_values[j] += eigenvectors[k][first+i] * rotation[i][j];
+          }
+        }
+        for(j = 0; j < m; j++)
+        {
+          work[k][first+j] = scale[j];
+          eigenvectors[k][first+j] = gram_values[j];
+        }
+      }
+    }
+
+    /* - - - - - - - - - Scale the modes and their values - - - - - - - - - */
+
+    for(m = 0; m < n; m++)
+    {
+      sum = 0.0;
+      largest = 0.0;
+      for(i = 0; i < n; i++)
+      {
+        sum += work[i][m] * work[i][m];
+        if(fabs(work[i][m]) > fabs(largest)) largest = work[i][m];
+      }
+      scale[m] = sqrt(sum);
+
+      /* unit length, largest line voltage positive */
+      for(i = 0; i < n; i++)
+      {
+        modes[point].voltage[i][m] = work[i][m] / scale[m];
+        if(largest < 0.0)
+          modes[point].voltage[i][m] = -modes[point].voltage[i][m];
+      }
+
+      /* G Q, scaled to go with the voltage */
+      for(i = 0; i < n; i++)
+      {
+        sum = 0.0;
+        for(k = 0; k <= i; k++) sum += factor[i][k] * eigenvectors[k][m];
+        modes[point].current[i][m] = largest < 0.0 ?
+          -sum * scale[m] : sum * scale[m];
+      }
+
+      modes[point].velocity[m] = 1.0 / sqrt(eigenvalues[m]);
+      modes[point].impedance[m] = scale[m] * scale[m] * sqrt(eigenvalues[m]);
+
+      /* first order attenuation, nepers per meter */
+      modes[point].attenuation[m] = 0.0;
+      if(resistance != NULL && conductance != NULL)
+      {
+        resistance_m = 0.0;
+        conductance_m = 0.0;
+        for(i = 0; i < n; i++)
+          for(j = 0; j < n; j++)
+          {
+            resistance_m += modes[point].current[i][m] *
+              resistance[point][i][j] * modes[point].current[j][m];
+            conductance_m += modes[point].voltage[i][m] *
+              conductance[point][i][j] * modes[point].voltage[j][m];
+          }
+        modes[point].attenuation[m] =
+          0.5 * (resistance_m / modes[point].impedance[m] +
+                 conductance_m * modes[point].impedance[m]);
+      }
+    }
+  }
+
+  free2((void **)factor);
+  free2((void **)work);
+  free2((void **)symmetric);
+  free2((void **)eigenvectors);
+  free2((void **)gram);
+  free2((void **)rotation);
+  free(eigenvalues);
+  free(scale);
+  free(gram_values);
+
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_modal_jacobi
+
+  FUNCTIONAL DESCRIPTION:
+
+  Eigenvalues and eigenvectors of a real symmetric matrix by the cyclic
+  Jacobi method: plane rotations zero each off diagonal element in turn
+  until they are all negligible.
+
+  FORMAL PARAMETERS:
+
+  int order             - of the matrix
+  double **matrix       - the matrix, destroyed
+  double *eigenvalues   - out: the eigenvalues
+  double **eigenvectors - out: column i is the eigenvector of eigenvalue i
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if MODAL_JACOBI_SWEEPS did not do it
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_modal_jacobi(order,matrix,eigenvalues,eigenvectors);
+
+  */
+
+static int nmmtl_modal_jacobi(int order, double **matrix, double *eigenvalues,
+                              double **eigenvectors)
+{
+  int sweep, p, q, i;
+  double off, diagonal, theta, t, c, s, tau, a_ip, a_iq, v_ip, v_iq;
+
+  for(p = 0; p < order; p++)
+    for(q = 0; q < order; q++)
+      eigenvectors[p][q] = p == q ? 1.0 : 0.0;
+
+  for(sweep = 0; sweep < MODAL_JACOBI_SWEEPS; sweep++)
+  {
+    off = 0.0;
+    diagonal = 0.0;
+    for(p = 0; p < order; p++)
+    {
+      diagonal += matrix[p][p] * matrix[p][p];
+      for(q = p + 1; q < order; q++) off += matrix[p][q] * matrix[p][q];
+    }
+    if(off <= 1.0e-30 * diagonal) break;
+
+    for(p = 0; p < order - 1; p++)
+    {
+      for(q = p + 1; q < order; q++)
+      {
+        if(matrix[p][q] == 0.0) continue;
+
+        /* the rotation that zeroes matrix[p][q] */
+        theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+        t = (theta >= 0.0 ? 1.0 : -1.0) /
+          (fabs(theta) + sqrt(theta * theta + 1.0));
+        c = 1.0 / sqrt(t * t + 1.0);
+        s = t * c;
+        tau = s / (1.0 + c);
+
+        matrix[p][p] -= t * matrix[p][q];
+        matrix[q][q] += t * matrix[p][q];
+        matrix[p][q] = matrix[q][p] = 0.0;
+        for(i = 0; i < order; i++)
+        {
+          if(i != p && i != q)
+          {
+            a_ip = matrix[i][p];
+            a_iq = matrix[i][q];
+            matrix[i][p] = matrix[p][i] = a_ip - s * (a_iq + tau * a_ip);
+            matrix[i][q] = matrix[q][i] = a_iq + s * (a_ip - tau * a_iq);
+          }
+          v_ip = eigenvectors[i][p];
+          v_iq = eigenvectors[i][q];
+          eigenvectors[i][p] = v_ip - s * (v_iq + tau * v_ip);
+          eigenvectors[i][q] = v_iq + s * (v_ip - tau * v_iq);
+        }
+      }
+    }
+  }
+
+  for(p = 0; p < order; p++) eigenvalues[p] = matrix[p][p];
+
+  return(sweep < MODAL_JACOBI_SWEEPS ? SUCCESS : FAIL);
+}
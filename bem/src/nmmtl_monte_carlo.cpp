@@ -0,0 +1,819 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_monte_carlo, the "mmtl_bem --monte-carlo" mode, and the
+  static functions which it calls.  Dimensions and material constants of
+  the objects of a .xsctn file are varied at random, each with a normal
+  or uniform distribution about the value the file gives it, and the
+  cross section is solved for each sample to give the distributions of
+  the characteristic impedances, the propagation velocities and the
+  crosstalk.
+
+  The file is read once; each worker thread keeps its own copy of the
+  cross section, sets the varied values of a sample into it and expands
+  it again.  The samples are shared out among the threads as they become
+  free, and the random values of a sample depend only on the seed and the
+  sample number, so a run is reproduced whatever the number of threads.
+  The edge singularity (nu) solutions found for one sample are reused by
+  the others from the nu cache of nmmtl_find_nu.  Nothing else can be
+  kept from one sample to the next, as the mesh is made from the
+  geometry.
+
+  The running means of the impedances are written as the samples come
+  in, every MONTE_CARLO_REPORT samples, and the statistics and histograms
+  of all the results at the end.  The solver's progress messages go to
+  stderr, as in the --serve mode.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+#include "electro_prototype.h"
+
+#include <float.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+#define MONTE_CARLO_NORMAL 0
+#define MONTE_CARLO_UNIFORM 1
+
+/* one varied value: the object and field, and its distribution */
+typedef struct monte_carlo_parameter
+{
+  const char *object_name;
+  const char *option;
+  int object;                 /* index into the objects */
+  size_t offset;              /* of the field in XSCTN_OBJECT */
+  int trapezoid_width;        /* -width of a trapezoid moves both */
+  double top_width_offset;    /* top less bottom width of the trapezoid */
+  int length;                 /* a dimension, which must stay positive */
+  double nominal;
+  int distribution;
+  double spread;              /* standard deviation, or half width */
+} MONTE_CARLO_PARAMETER, *MONTE_CARLO_PARAMETER_P;
+
+/* the run, shared by the worker threads */
+typedef struct monte_carlo
+{
+  const char *filespec;
+  char *text;
+  size_t length;
+  unsigned long seed;
+  int samples;
+  int number_parameters;
+  MONTE_CARLO_PARAMETER_P parameters;
+  int num_signals;
+  char (*names)[SIZE_SIG_NAME];
+  int number_quantities;      /* Z0, v per signal, fxt, bxt per pair */
+  double *values;             /* number_quantities per sample */
+  char *solved;               /* per sample */
+  pthread_mutex_t lock;
+  int next;                   /* the next sample to take */
+  int done, failed;
+  double *sum, *sum_squares;  /* of the impedances so far */
+  MESH_SETTINGS settings;     /* how each sample is meshed */
+  FILE *out;
+} MONTE_CARLO, *MONTE_CARLO_P;
+
+/* the varied options; -width of a trapezoid is its bottom width */
+typedef struct monte_carlo_option
+{
+  const char *name;
+  size_t offset;
+  int length;
+} MONTE_CARLO_OPTION;
+
+/*
+ *******************************************************************
+ **  GLOBALS
+ *******************************************************************
+ */
+
+static const MONTE_CARLO_OPTION monte_carlo_options[] =
+{
+  { "-thickness",    offsetof(XSCTN_OBJECT,height),       TRUE },
+  { "-height",       offsetof(XSCTN_OBJECT,height),       TRUE },
+  { "-width",        offsetof(XSCTN_OBJECT,width),        TRUE },
+  { "-topWidth",     offsetof(XSCTN_OBJECT,top_width),    TRUE },
+  { "-bottomWidth",  offsetof(XSCTN_OBJECT,bottom_width), TRUE },
+  { "-diameter",     offsetof(XSCTN_OBJECT,diameter),     TRUE },
+  { "-pitch",        offsetof(XSCTN_OBJECT,pitch),        TRUE },
+  { "-xOffset",      offsetof(XSCTN_OBJECT,x_offset),     FALSE },
+  { "-yOffset",      offsetof(XSCTN_OBJECT,y_offset),     FALSE },
+  { "-permittivity", offsetof(XSCTN_OBJECT,permittivity), TRUE },
+  { "-lossTangent",  offsetof(XSCTN_OBJECT,loss_tangent), FALSE }
+};
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_monte_carlo_parameter(MMTL_XSCTN_P xsctn, char **words,
+                                       MONTE_CARLO_PARAMETER_P parameter);
+static void *nmmtl_monte_carlo_worker(void *arg);
+static int nmmtl_monte_carlo_sample(MONTE_CARLO_P run, MMTL_XSCTN_P xsctn,
+                                    int sample, double *values);
+static double nmmtl_monte_carlo_random(uint64_t *state);
+static void nmmtl_monte_carlo_report(MONTE_CARLO_P run);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo
+
+  FUNCTIONAL DESCRIPTION:
+
+  Solve samples of a cross section with values varied at random and
+  report the distributions of the results.
+
+  FORMAL PARAMETERS:
+
+  char *filename              - base name of the .xsctn file
+  int samples                 - how many samples
+  unsigned long seed          - of the random values
+  int workers                 - threads, one per cpu if less than one
+  int number_parameters       - how many values are varied
+  char **words                - four for each: the object name, the
+                                option (-width, -thickness,
+                                -permittivity ...), normal or uniform,
+                                and the standard deviation or half width,
+                                in meters for a dimension, or with a %
+                                sign relative to the value
+  MESH_SETTINGS_P settings    - how each sample is meshed
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the file cannot be read, a parameter is not there
+  or no sample could be solved
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_monte_carlo(filename,samples,seed,workers,
+                             number_parameters,words,&settings);
+
+  */
+
+int nmmtl_monte_carlo(char *filename,
+                      int samples,
+                      unsigned long seed,
+                      int workers,
+                      int number_parameters,
+                      char **words,
+                      MESH_SETTINGS_P settings)
+{
+  MONTE_CARLO run;
+  MMTL_XSCTN_P xsctn = NULL;
+  char filespec[1024];
+  FILE *file;
+  long length;
+  int status = FAIL;
+  int out_fd, i, p;
+  int cntr_seg, pln_seg, gnd_planes, num_grounds;
+  double coupling, risetime, conductivity, half_minimum_dimension;
+  double top_ground_plane_thickness, bottom_ground_plane_thickness;
+  struct dielectric *dielectrics = NULL;
+  struct contour *signals = NULL, *groundwires = NULL, *sig;
+  pthread_t *threads;
+
+  memset(&run,0,sizeof(run));
+  run.filespec = filespec;
+  run.seed = seed;
+  run.samples = samples;
+  run.number_parameters = number_parameters;
+  run.settings = *settings;
+
+  /* set the unit tables up now, before there are threads to race */
+  setunits();
+
+  /* keep the real stdout for the statistics, send the chatter of the
+     reads and solves, and any errors, to stderr */
+  fflush(stdout);
+  if((out_fd = dup(STDOUT_FILENO)) < 0) return(FAIL);
+  dup2(STDERR_FILENO,STDOUT_FILENO);
+  if((run.out = fdopen(out_fd,"w")) == NULL)
+  {
+    close(out_fd);
+    return(FAIL);
+  }
+
+  /* - - - - - - - - - - - Read the cross section once - - - - - - - - - - */
+
+  snprintf(filespec,sizeof(filespec),"%s.xsctn",filename);
+  if((file = fopen(filespec,"r")) == NULL)
+  {
+    printf("Error: cannot open the cross-section file %s\n",filespec);
+    fclose(run.out);
+    return(FAIL);
+  }
+  if(fseek(file,0,SEEK_END) == 0 && (length = ftell(file)) >= 0 &&
+     fseek(file,0,SEEK_SET) == 0 &&
+     (run.text = (char *)malloc((size_t)length + 1)) != NULL &&
+     fread(run.text,1,(size_t)length,file) == (size_t)length &&
+     (xsctn = mmtl_xsctn_create()) != NULL)
+  {
+    run.length = (size_t)length;
+    status = nmmtl_xsctn_read(xsctn,run.text,run.length,filespec);
+  }
+  fclose(file);
+  if(status == SUCCESS)
+    status = nmmtl_xsctn_expand(xsctn,&cntr_seg,&pln_seg,&coupling,
+                                &risetime,&conductivity,
+                                &half_minimum_dimension,&gnd_planes,
+                                &top_ground_plane_thickness,
+                                &bottom_ground_plane_thickness,&dielectrics,
+                                &signals,&groundwires,&run.num_signals,
+                                &num_grounds);
+  if(status != SUCCESS || run.num_signals < 1)
+  {
+    printf("Error: cannot read the cross-section file %s\n",filespec);
+    nmmtl_free_dielectrics(dielectrics);
+    nmmtl_free_contours(signals);
+    nmmtl_free_contours(groundwires);
+    mmtl_xsctn_free(xsctn);
+    free(run.text);
+    fclose(run.out);
+    return(FAIL);
+  }
+
+  /* - - - - - - - - - - - - - Find the parameters - - - - - - - - - - - - */
+
+  run.parameters = (MONTE_CARLO_PARAMETER_P)
+    calloc((size_t)number_parameters,sizeof(MONTE_CARLO_PARAMETER));
+  for(p = 0; p < number_parameters; p++)
+    if(nmmtl_monte_carlo_parameter(xsctn,&words[4 * p],
+                                   &run.parameters[p]) != SUCCESS) break;
+  mmtl_xsctn_free(xsctn);
+  nmmtl_free_dielectrics(dielectrics);
+  nmmtl_free_contours(groundwires);
+  if(p < number_parameters || samples < 1)
+  {
+    nmmtl_free_contours(signals);
+    free(run.parameters);
+    free(run.text);
+    fclose(run.out);
+    return(FAIL);
+  }
+
+  /* - - - - - - - - - - - - - Set up the results - - - - - - - - - - - - - */
+
+  run.names = (char (*)[SIZE_SIG_NAME])
+    malloc(sizeof(char[SIZE_SIG_NAME]) * (size_t)run.num_signals);
+  for(sig = signals, i = 0; sig != NULL; sig = sig->next, i++)
+    strcpy(run.names[i],sig->name);
+  nmmtl_free_contours(signals);
+
+  run.number_quantities = run.num_signals * (run.num_signals + 1);
+  run.values = (double *)malloc(sizeof(double) * (size_t)samples *
+                                (size_t)run.number_quantities);
+  run.solved = (char *)calloc((size_t)samples,sizeof(char));
+  run.sum = (double *)calloc((size_t)run.num_signals,sizeof(double));
+  run.sum_squares = (double *)calloc((size_t)run.num_signals,sizeof(double));
+  if(run.values == NULL || run.solved == NULL || run.sum == NULL ||
+     run.sum_squares == NULL)
+  {
+    printf("Error: out of memory for %d samples\n",samples);
+    status = FAIL;
+  }
+
+  /* - - - - - - - - - - - - - Solve the samples - - - - - - - - - - - - - */
+
+  if(status == SUCCESS)
+  {
+    if(workers < 1) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(workers < 1) workers = 1;
+    if(workers > samples) workers = samples;
+
+    fprintf(run.out,"Monte Carlo: %d samples of %s, seed %lu, "
+            "%d workers\n",samples,filespec,seed,workers);
+    fflush(run.out);
+
+    pthread_mutex_init(&run.lock,NULL);
+    threads = (pthread_t *)malloc(sizeof(pthread_t) * (size_t)workers);
+    for(i = 0; i < workers; i++)
+      pthread_create(&threads[i],NULL,nmmtl_monte_carlo_worker,&run);
+    for(i = 0; i < workers; i++)
+      pthread_join(threads[i],NULL);
+    free(threads);
+    pthread_mutex_destroy(&run.lock);
+
+    nmmtl_monte_carlo_report(&run);
+    status = run.done > run.failed ? SUCCESS : FAIL;
+  }
+  fclose(run.out);
+
+  free(run.parameters);
+  free(run.text);
+  free(run.names);
+  free(run.values);
+  free(run.solved);
+  free(run.sum);
+  free(run.sum_squares);
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo_parameter
+
+  FUNCTIONAL DESCRIPTION:
+
+  Find the object and field a varied value is in, and read its
+  distribution.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn                - the cross section as read
+  char **words                      - object name, option, distribution
+                                      and spread
+  MONTE_CARLO_PARAMETER_P parameter - out: the parameter
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL with a message if it is not there
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_monte_carlo_parameter(xsctn,words,parameter);
+
+  */
+
+static int nmmtl_monte_carlo_parameter(MMTL_XSCTN_P xsctn, char **words,
+                                       MONTE_CARLO_PARAMETER_P parameter)
+{
+  XSCTN_OBJECT_P object = NULL;
+  char *end;
+  int o;
+  size_t k;
+
+  parameter->object_name = words[0];
+  parameter->option = words[1];
+
+  for(o = 0; o < xsctn->number_objects; o++)
+  {
+    if(xsctn->objects[o].name != NULL &&
+       strcmp(xsctn->objects[o].name,words[0]) == 0)
+    {
+      object = &xsctn->objects[o];
+      parameter->object = o;
+      break;
+    }
+  }
+  if(object == NULL)
+  {
+    printf("Error: no object %s\n",words[0]);
+    return(FAIL);
+  }
+
+  for(k = 0; k < sizeof(monte_carlo_options) / sizeof(monte_carlo_options[0]);
+      k++)
+    if(strcmp(monte_carlo_options[k].name,words[1]) == 0) break;
+  if(k == sizeof(monte_carlo_options) / sizeof(monte_carlo_options[0]))
+  {
+    printf("Error: %s cannot be varied\n",words[1]);
+    return(FAIL);
+  }
+  parameter->offset = monte_carlo_options[k].offset;
+  parameter->length = monte_carlo_options[k].length;
+  if(strcmp(words[1],"-width") == 0 && object->kind == XSCTN_CONDUCTORS &&
+     object->type == 'T')
+  {
+    parameter->offset = offsetof(XSCTN_OBJECT,bottom_width);
+    parameter->top_width_offset = object->top_width - object->bottom_width;
+    parameter->trapezoid_width = TRUE;
+  }
+  parameter->nominal = *(double *)((char *)object + parameter->offset);
+
+  if(strcmp(words[2],"normal") == 0)
+    parameter->distribution = MONTE_CARLO_NORMAL;
+  else if(strcmp(words[2],"uniform") == 0)
+    parameter->distribution = MONTE_CARLO_UNIFORM;
+  else
+  {
+    printf("Error: the distribution of %s %s must be normal or uniform\n",
+           words[0],words[1]);
+    return(FAIL);
+  }
+
+  parameter->spread = strtod(words[3],&end);
+  if(end == words[3] || parameter->spread < 0.0 ||
+     (*end != '\0' && strcmp(end,"%") != 0))
+  {
+    printf("Error: bad spread %s for %s %s\n",words[3],words[0],words[1]);
+    return(FAIL);
+  }
+  if(*end == '%') parameter->spread *= 0.01 * fabs(parameter->nominal);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo_worker
+
+  FUNCTIONAL DESCRIPTION:
+
+  A worker thread: reads its own copy of the cross section, then takes
+  samples to solve until there are none left, storing the results and
+  adding them to the running sums.
+
+  FORMAL PARAMETERS:
+
+  void *arg   - the MONTE_CARLO run
+
+  RETURN VALUE:
+
+  NULL
+
+  CALLING SEQUENCE:
+
+  pthread_create(&thread,NULL,nmmtl_monte_carlo_worker,&run);
+
+  */
+
+static void *nmmtl_monte_carlo_worker(void *arg)
+{
+  MONTE_CARLO_P run = (MONTE_CARLO_P)arg;
+  MMTL_XSCTN_P xsctn;
+  double *values;
+  int sample, status, i;
+
+  xsctn = mmtl_xsctn_create();
+  values = (double *)malloc(sizeof(double) * (size_t)run->number_quantities);
+  if(xsctn == NULL || values == NULL ||
+     nmmtl_xsctn_read(xsctn,run->text,run->length,run->filespec) != SUCCESS)
+  {
+    mmtl_xsctn_free(xsctn);
+    free(values);
+    return(NULL);
+  }
+
+  for(;;)
+  {
+    pthread_mutex_lock(&run->lock);
+    sample = run->next < run->samples ? run->next++ : -1;
+    pthread_mutex_unlock(&run->lock);
+    if(sample < 0) break;
+
+    status = nmmtl_monte_carlo_sample(run,xsctn,sample,values);
+
+    pthread_mutex_lock(&run->lock);
+    run->done++;
+    if(status == SUCCESS)
+    {
+      memcpy(&run->values[(size_t)sample * (size_t)run->number_quantities],
+             values,sizeof(double) * (size_t)run->number_quantities);
+      run->solved[sample] = TRUE;
+      for(i = 0; i < run->num_signals; i++)
+      {
+        run->sum[i] += values[i];
+        run->sum_squares[i] += values[i] * values[i];
+      }
+    }
+    else
+      run->failed++;
+
+    /* the running means as the samples come in */
+    if(run->done % MONTE_CARLO_REPORT == 0 && run->done > run->failed)
+    {
+      fprintf(run->out,"Monte Carlo: %d of %d samples",
+              run->done,run->samples);
+      if(run->failed > 0) fprintf(run->out," (%d failed)",run->failed);
+      fprintf(run->out,"\n");
+      for(i = 0; i < run->num_signals; i++)
+      {
+        double n = (double)(run->done - run->failed);
+        double mean = run->sum[i] / n;
+        double variance = run->sum_squares[i] / n - mean * mean;
+        fprintf(run->out,"  Z0 ::%s mean= %g std= %g\n",run->names[i],
+                mean,variance > 0.0 ? sqrt(variance) : 0.0);
+      }
+      fflush(run->out);
+    }
+    pthread_mutex_unlock(&run->lock);
+  }
+
+  mmtl_xsctn_free(xsctn);
+  free(values);
+  return(NULL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo_sample
+
+  FUNCTIONAL DESCRIPTION:
+
+  Draw the values of one sample, solve the cross section with them and
+  give its impedances, velocities and crosstalk.
+
+  FORMAL PARAMETERS:
+
+  MONTE_CARLO_P run       - the run
+  MMTL_XSCTN_P xsctn      - the thread's copy of the cross section
+  int sample              - which sample
+  double *values          - out: Z0 and v of each signal, then the
+                            forward and backward crosstalk of each pair
+                            of signals i < j
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the values make no sense or the solve fails
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_monte_carlo_sample(run,xsctn,sample,values);
+
+  */
+
+static int nmmtl_monte_carlo_sample(MONTE_CARLO_P run, MMTL_XSCTN_P xsctn,
+                                    int sample, double *values)
+{
+  MONTE_CARLO_PARAMETER_P parameter;
+  XSCTN_OBJECT_P object;
+  int cntr_seg, pln_seg, gnd_planes, num_signals = 0, num_grounds = 0;
+  double coupling, risetime, conductivity, half_minimum_dimension;
+  double top_ground_plane_thickness, bottom_ground_plane_thickness;
+  struct dielectric *dielectrics = NULL;
+  struct contour *signals = NULL, *groundwires = NULL;
+  double **electrostatic_induction = NULL, **inductance = NULL;
+  double **forward_xtk = NULL, **backward_xtk = NULL;
+  double *characteristic_impedance = NULL, *propagation_velocity = NULL;
+  double *equivalent_dielectric = NULL;
+  double *field, u1, u2, widest;
+  uint64_t state;
+  int status = SUCCESS, p, i, j, k;
+
+  /* - - - - - - - - - - - - - Draw the values - - - - - - - - - - - - - - */
+
+  state = (uint64_t)run->seed * 0x9e3779b97f4a7c15ULL + (uint64_t)sample;
+  for(p = 0; p < run->number_parameters; p++)
+  {
+    parameter = &run->parameters[p];
+    object = &xsctn->objects[parameter->object];
+    field = (double *)((char *)object + parameter->offset);
+
+    u1 = nmmtl_monte_carlo_random(&state);
+    u2 = nmmtl_monte_carlo_random(&state);
+    if(parameter->distribution == MONTE_CARLO_NORMAL)
+      *field = parameter->nominal + parameter->spread *
+        sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+    else
+      *field = parameter->nominal + parameter->spread * (2.0 * u1 - 1.0);
+
+    if(parameter->trapezoid_width)
+    {
+      object->top_width = *field + parameter->top_width_offset;
+      if(!(object->top_width > 0.0)) status = FAIL;
+    }
+    if(parameter->length && !(*field > 0.0)) status = FAIL;
+  }
+
+  /* conductors of a set must not overlap */
+  for(p = 0; p < run->number_parameters; p++)
+  {
+    object = &xsctn->objects[run->parameters[p].object];
+    if(object->kind != XSCTN_CONDUCTORS || object->number < 2) continue;
+    widest = object->type == 'R' ? object->width :
+      object->type == 'C' ? object->diameter :
+      object->top_width > object->bottom_width ?
+      object->top_width : object->bottom_width;
+    if(object->pitch <= widest) status = FAIL;
+  }
+  if(status != SUCCESS) return(FAIL);
+
+  /* - - - - - - - - - - - - - - - - Solve - - - - - - - - - - - - - - - - */
+
+  status = nmmtl_xsctn_expand(xsctn,&cntr_seg,&pln_seg,&coupling,&risetime,
+                              &conductivity,&half_minimum_dimension,
+                              &gnd_planes,&top_ground_plane_thickness,
+                              &bottom_ground_plane_thickness,&dielectrics,
+                              &signals,&groundwires,&num_signals,
+                              &num_grounds);
+  if(status == SUCCESS && num_signals != run->num_signals) status = FAIL;
+
+  if(status == SUCCESS)
+  {
+    electrostatic_induction =
+      (double **)dim2(num_signals,num_signals,sizeof(double));
+    inductance = (double **)dim2(num_signals,num_signals,sizeof(double));
+    forward_xtk = (double **)dim2(num_signals,num_signals,sizeof(double));
+    backward_xtk = (double **)dim2(num_signals,num_signals,sizeof(double));
+    characteristic_impedance =
+      (double *)malloc(sizeof(double) * (size_t)num_signals);
+    propagation_velocity =
+      (double *)malloc(sizeof(double) * (size_t)num_signals);
+    equivalent_dielectric =
+      (double *)calloc((size_t)num_signals,sizeof(double));
+
+    status = nmmtl_qsp_calculate(dielectrics,signals,groundwires,gnd_planes,
+                                 half_minimum_dimension,cntr_seg,pln_seg,
+                                 coupling,risetime,electrostatic_induction,
+                                 inductance,characteristic_impedance,
+                                 propagation_velocity,equivalent_dielectric,
+                                 (FILE *)NULL,(FILE *)NULL,
+                                 (SKIN_EFFECT_P)NULL,(SENSITIVITY_P)NULL,
+                                 &run->settings);
+  }
+
+  if(status == SUCCESS)
+    status = nmmtl_xtk_calculate(num_signals,signals,electrostatic_induction,
+                                 inductance,coupling,risetime,
+                                 propagation_velocity,forward_xtk,
+                                 backward_xtk,(FILE *)NULL,(FILE *)NULL);
+
+  if(status == SUCCESS)
+  {
+    k = 0;
+    for(i = 0; i < num_signals; i++) values[k++] = characteristic_impedance[i];
+    for(i = 0; i < num_signals; i++) values[k++] = propagation_velocity[i];
+    for(i = 0; i < num_signals; i++)
+      for(j = i + 1; j < num_signals; j++)
+      {
+        values[k++] = forward_xtk[i][j];
+        values[k++] = backward_xtk[i][j];
+      }
+
+    /* nearly touching conductors can leave the solve meaningless */
+    for(i = 0; i < k; i++)
+      if(!(fabs(values[i]) < DBL_MAX)) status = FAIL;
+  }
+
+  if(electrostatic_induction != NULL)
+    free2((void **)electrostatic_induction);
+  if(inductance != NULL) free2((void **)inductance);
+  if(forward_xtk != NULL) free2((void **)forward_xtk);
+  if(backward_xtk != NULL) free2((void **)backward_xtk);
+  free(characteristic_impedance);
+  free(propagation_velocity);
+  free(equivalent_dielectric);
+  nmmtl_free_dielectrics(dielectrics);
+  nmmtl_free_contours(signals);
+  nmmtl_free_contours(groundwires);
+
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo_random
+
+  FUNCTIONAL DESCRIPTION:
+
+  The next of a sequence of random numbers (splitmix64), uniform on the
+  open interval (0,1).
+
+  FORMAL PARAMETERS:
+
+  uint64_t *state     - in and out: the state of the sequence
+
+  RETURN VALUE:
+
+  the random number
+
+  CALLING SEQUENCE:
+
+  u = nmmtl_monte_carlo_random(&state);
+
+  */
+
+static double nmmtl_monte_carlo_random(uint64_t *state)
+{
+  uint64_t z;
+
+  z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+
+  /* the top 53 bits, and half a step so it is never 0 */
+  return(((double)(z >> 11) + 0.5) / 9007199254740992.0);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_monte_carlo_report
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the mean, standard deviation, least and greatest value and
+  histogram of MONTE_CARLO_BINS bins of each result over the samples
+  solved.
+
+  FORMAL PARAMETERS:
+
+  MONTE_CARLO_P run   - the run
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_monte_carlo_report(run);
+
+  */
+
+static void nmmtl_monte_carlo_report(MONTE_CARLO_P run)
+{
+  int q, s, i, j, b, n;
+  int count[MONTE_CARLO_BINS];
+  double value, sum, sum_squares, mean, variance, lowest, highest, width;
+  char label[2 * SIZE_SIG_NAME + 32];
+
+  n = run->done - run->failed;
+  fprintf(run->out,"\nMonte Carlo: %d samples solved, %d failed\n",
+          n,run->failed);
+  if(n < 1) return;
+
+  for(q = 0; q < run->number_quantities; q++)
+  {
+    /* - - - - - - - - - - - - - - - The label - - - - - - - - - - - - - - */
+
+    if(q < run->num_signals)
+      sprintf(label,"Z0 ::%s (Ohms)",run->names[q]);
+    else if(q < 2 * run->num_signals)
+      sprintf(label,"v ::%s (meters/second)",
+              run->names[q - run->num_signals]);
+    else
+    {
+      /* the pair i < j the quantity is of */
+      b = (q - 2 * run->num_signals) / 2;
+      for(i = 0; b >= run->num_signals - 1 - i; i++)
+        b -= run->num_signals - 1 - i;
+      j = i + 1 + b;
+      sprintf(label,"%s ::%s , ::%s",(q - 2 * run->num_signals) % 2 == 0 ?
+              "Forward Crosstalk" : "Backward Crosstalk",
+              run->names[i],run->names[j]);
+    }
+
+    /* - - - - - - - - - - - - - - The statistics - - - - - - - - - - - - - */
+
+    sum = sum_squares = 0.0;
+    lowest = DBL_MAX;
+    highest = -DBL_MAX;
+    for(s = 0; s < run->samples; s++)
+    {
+      if(!run->solved[s]) continue;
+      value = run->values[(size_t)s * (size_t)run->number_quantities + q];
+      sum += value;
+      sum_squares += value * value;
+      if(value < lowest) lowest = value;
+      if(value > highest) highest = value;
+    }
+    mean = sum / n;
+    variance = n > 1 ? (sum_squares - sum * mean) / (n - 1) : 0.0;
+
+    fprintf(run->out,"\n%s:\n",label);
+    fprintf(run->out,"mean= %15.7e std= %15.7e min= %15.7e max= %15.7e\n",
+            mean,variance > 0.0 ? sqrt(variance) : 0.0,lowest,highest);
+
+    /* - - - - - - - - - - - - - - - The histogram - - - - - - - - - - - - - */
+
+    for(b = 0; b < MONTE_CARLO_BINS; b++) count[b] = 0;
+    width = (highest - lowest) / MONTE_CARLO_BINS;
+    for(s = 0; s < run->samples; s++)
+    {
+      if(!run->solved[s]) continue;
+      value = run->values[(size_t)s * (size_t)run->number_quantities + q];
+      b = width > 0.0 ? (int)((value - lowest) / width) : 0;
+      if(b >= MONTE_CARLO_BINS) b = MONTE_CARLO_BINS - 1;
+      count[b]++;
+    }
+    for(b = 0; b < MONTE_CARLO_BINS; b++)
+      fprintf(run->out,"[ %15.7e , %15.7e )= %d\n",lowest + b * width,
+              lowest + (b + 1) * width,count[b]);
+  }
+}
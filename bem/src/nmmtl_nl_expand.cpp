@@ -61,30 +61,30 @@
   float normaly,                   - y element of normal vector (normalx is zero)
   double y,                         - y value for elements to be generated
   unsigned int *node_point_counter - counting all node points
-  DELEMENTS_P *element_p           - last pointer in linked list of all elements
+  ELEMENT_STORE_P element_store    - store the elements are added to
   int *number_elements             - global counter of number of elements generated
   unsigned int common_node         - this node point is in common with the linear part
 
   RETURN VALUE:
 
-    None
+    SUCCESS, FAIL if out of memory
 
   */
 
-void nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsilonplus,
+int nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsilonplus,
                      double epsilonminus, double normaly, double y,
                      unsigned int *node_point_counter,
-                     DELEMENTS_P *element_p, int *number_elements,
+                     ELEMENT_STORE_P element_store, int *number_elements,
                      unsigned int common_node)
 {
 
   DELEMENTS_P element;
   unsigned int npcntr;
+  int end = INTERP_ORDER;
   double xincr,xhalfincr,x;
   int first_element;
-  extern double NON_LINEARITY_FACTOR;
+  extern thread_local double NON_LINEARITY_FACTOR;
   npcntr = *node_point_counter;
-  element = *element_p;
 
   xincr = incr_start;
   x = xstart;
@@ -108,11 +108,8 @@ void nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsil
     xhalfincr = xincr/2;
     (*number_elements)++;
 
-    element->next = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-    element = element->next;
-
-    /* terminate the list for now */
-    element->next = NULL;
+    element = nmmtl_element_store_add_d(element_store);
+    if(element == NULL) return(FAIL);
 
     /* the global coordinates at the various nodes */
     element->xpts[0] = x;
@@ -146,12 +143,13 @@ void nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsil
     }
     else element->node[0] = npcntr++;
 
-    /* middle node */
-    element->node[1] = npcntr++;
+    /* interior nodes */
+    end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                                 &npcntr);
 
     /* last node - don't advance, since this point is in common with
        the next element generated */
-    element->node[2] = npcntr;
+    element->node[end] = npcntr;
 
     xincr *= NON_LINEARITY_FACTOR;
 
@@ -161,11 +159,8 @@ void nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsil
   /* last element gets handled specially */
   (*number_elements)++;
 
-  element->next = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-  element = element->next;
-
-  /* terminate the list */
-  element->next = NULL;
+  element = nmmtl_element_store_add_d(element_store);
+  if(element == NULL) return(FAIL);
 
   /* the global coordinates at the various nodes */
   element->xpts[0] = x;
@@ -197,17 +192,16 @@ void nmmtl_nl_expand(double xstart, double xend, double incr_start, double epsil
   }
   else element->node[0] = npcntr++;
 
-  /* middle node */
-  element->node[1] = npcntr++;
+  /* interior nodes */
+  end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                               &npcntr);
 
   /* this is the last element, we advance npcntr since we don't want the
      next element to share a node with this one */
-  element->node[2] = npcntr++;
+  element->node[end] = npcntr++;
 
   /* return the value of the node point counter after it has been used */
   *node_point_counter = npcntr;
 
-  /* return the value of the element pointer after it has been used */
-  *element_p = element;
-
+  return(SUCCESS);
 }
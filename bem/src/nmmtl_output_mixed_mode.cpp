@@ -0,0 +1,88 @@
+/***************************************************************************\
+ *                                                                         *
+ *   ROUTINE NAME NMMTL_OUTPUT_MIXED_MODE                                  *
+ *                                                                         *
+ *   ABSTRACT                                                              *
+ *  Write the differential and common mode impedances and velocities of    *
+ *  the differential pairs to output.                                      *
+ *                                                                         *
+ *   CALLING FORMAT                                                        *
+ *  nmmtl_output_mixed_mode(output_fp, number_pairs, pairs,                *
+ *      differential_impedance, common_impedance, differential_velocity,   *
+ *      common_velocity, signals);                                         *
+ *                                                                         *
+ *   RETURN VALUE                                                          *
+ *                                                                         *
+ *   INPUT PARAMETERS                                                      *
+ *  FILE *output_fp;                output file ptr                        *
+ *  int number_pairs;               how many pairs                         *
+ *  int (*pairs)[2];                the signal indices of each             *
+ *  double *differential_impedance; Zdiff of each pair                     *
+ *  double *common_impedance;       Zcomm of each pair                     *
+ *  double *differential_velocity;  of each pair                           *
+ *  double *common_velocity;        of each pair                           *
+ *  struct contour *signals;        signal line info (names)               *
+ *                                                                         *
+ *   OUTPUT PARAMETERS                                                     *
+ *                                                                         *
+ *   CREATION DATE  18-OCT-2026                                            *
+ *                                                                         *
+ \***************************************************************************/
+
+#include "nmmtl.h"
+
+static void nmmtl_output_mixed_mode_values(FILE *output_fp,
+                                           const char *format,
+                                           int number_pairs,
+                                           int (*pairs)[2],
+                                           double *values,
+                                           struct contour *signals);
+
+void nmmtl_output_mixed_mode(FILE *output_fp, int number_pairs,
+                             int (*pairs)[2],
+                             double *differential_impedance,
+                             double *common_impedance,
+                             double *differential_velocity,
+                             double *common_velocity,
+                             struct contour *signals)
+{
+  fprintf(output_fp, "\nDifferential Impedance (Ohms):\n");
+  nmmtl_output_mixed_mode_values(output_fp, "%g", number_pairs, pairs,
+                                 differential_impedance, signals);
+
+  fprintf(output_fp, "\nCommon Mode Impedance (Ohms):\n");
+  nmmtl_output_mixed_mode_values(output_fp, "%g", number_pairs, pairs,
+                                 common_impedance, signals);
+
+  fprintf(output_fp, "\nDifferential Propagation Velocity (meters/second):\n");
+  nmmtl_output_mixed_mode_values(output_fp, "%15.7e", number_pairs, pairs,
+                                 differential_velocity, signals);
+
+  fprintf(output_fp, "\nCommon Mode Propagation Velocity (meters/second):\n");
+  nmmtl_output_mixed_mode_values(output_fp, "%15.7e", number_pairs, pairs,
+                                 common_velocity, signals);
+}
+
+static void nmmtl_output_mixed_mode_values(FILE *output_fp,
+                                           const char *format,
+                                           int number_pairs,
+                                           int (*pairs)[2],
+                                           double *values,
+                                           struct contour *signals)
+{
+  struct contour *sig_line1, *sig_line2;    /* signal ptrs */
+  int p,i;            /* array indices */
+
+  for (p = 0; p < number_pairs; p++)
+  {
+    for (sig_line1 = signals, i = 0; i < pairs[p][0];
+         sig_line1 = sig_line1->next, i++);
+    for (sig_line2 = signals, i = 0; i < pairs[p][1];
+         sig_line2 = sig_line2->next, i++);
+
+    fprintf(output_fp, "For Pair ::%s , ::%s= ",
+            sig_line1->name, sig_line2->name);
+    fprintf(output_fp, format, values[p]);
+    fprintf(output_fp, "\n");
+  }
+}
@@ -0,0 +1,103 @@
+/***************************************************************************\
+ *                                                                         *
+ *   ROUTINE NAME NMMTL_OUTPUT_MODAL                                       *
+ *                                                                         *
+ *   ABSTRACT                                                              *
+ *  Write the propagation modes of the lines to output: the velocity,     *
+ *  impedance and attenuation of each mode and its voltage and current     *
+ *  vectors.                                                               *
+ *                                                                         *
+ *   CALLING FORMAT                                                        *
+ *  nmmtl_output_modal(output_fp, frequency, number_conductors, modes,     *
+ *      signals);                                                          *
+ *                                                                         *
+ *   RETURN VALUE                                                          *
+ *                                                                         *
+ *   INPUT PARAMETERS                                                      *
+ *  FILE *output_fp;          output file ptr                              *
+ *  double frequency;         Hz, 0 for the lossless modes                 *
+ *  int number_conductors;    number of signals                            *
+ *  MODES_P modes;            the modes                                    *
+ *  struct contour *signals;  signal line info (names)                     *
+ *                                                                         *
+ *   OUTPUT PARAMETERS                                                     *
+ *                                                                         *
+ *   CREATION DATE  18-OCT-2026                                            *
+ *                                                                         *
+ \***************************************************************************/
+
+#include "nmmtl.h"
+
+static void nmmtl_output_modal_heading(FILE *output_fp, const char *title,
+                                       double frequency);
+static void nmmtl_output_modal_vectors(FILE *output_fp, const char *symbol,
+                                       int number_conductors,
+                                       double **vectors,
+                                       struct contour *signals);
+
+void nmmtl_output_modal(FILE *output_fp, double frequency,
+                        int number_conductors, MODES_P modes,
+                        struct contour *signals)
+{
+  int m;
+
+  nmmtl_output_modal_heading(output_fp, "Modal Propagation Velocity",
+                             frequency);
+  fprintf(output_fp, " (meters/second):\n");
+  for (m = 0; m < number_conductors; m++)
+    fprintf(output_fp, "For Mode %d= %15.7e\n", m + 1, modes->velocity[m]);
+
+  nmmtl_output_modal_heading(output_fp, "Modal Characteristic Impedance",
+                             frequency);
+  fprintf(output_fp, " (Ohms):\n");
+  for (m = 0; m < number_conductors; m++)
+    fprintf(output_fp, "For Mode %d= %g\n", m + 1, modes->impedance[m]);
+
+  if (frequency > 0.0)
+  {
+    nmmtl_output_modal_heading(output_fp, "Modal Attenuation", frequency);
+    fprintf(output_fp, " (Nepers/Meter):\n");
+    for (m = 0; m < number_conductors; m++)
+      fprintf(output_fp, "For Mode %d= %15.7e\n", m + 1,
+              modes->attenuation[m]);
+  }
+
+  nmmtl_output_modal_heading(output_fp, "Modal Voltage Vectors", frequency);
+  fprintf(output_fp, ":\nTv(Signal , Mode)\n");
+  nmmtl_output_modal_vectors(output_fp, "Tv", number_conductors,
+                             modes->voltage, signals);
+
+  nmmtl_output_modal_heading(output_fp, "Modal Current Vectors", frequency);
+  fprintf(output_fp, ":\nTi(Signal , Mode)\n");
+  nmmtl_output_modal_vectors(output_fp, "Ti", number_conductors,
+                             modes->current, signals);
+}
+
+static void nmmtl_output_modal_heading(FILE *output_fp, const char *title,
+                                       double frequency)
+{
+  if (frequency > 0.0)
+    fprintf(output_fp, "\n%s at %g Hz", title, frequency);
+  else
+    fprintf(output_fp, "\n%s", title);
+}
+
+static void nmmtl_output_modal_vectors(FILE *output_fp, const char *symbol,
+                                       int number_conductors,
+                                       double **vectors,
+                                       struct contour *signals)
+{
+  struct contour *sig_line1;    /* signal ptr */
+  int i,m;            /* array indices */
+
+  for (sig_line1 = signals, i = 0;
+       sig_line1 != NULL;
+       sig_line1 = sig_line1->next, i++)
+  {
+    for (m = 0; m < number_conductors; m++)
+    {
+      fprintf(output_fp, "%s( ::%s , %d )= %15.7e\n",
+              symbol, sig_line1->name, m + 1, vectors[i][m]);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+/***************************************************************************\
+ *                                                                         *
+ *   ROUTINE NAME NMMTL_OUTPUT_RLGC                                        *
+ *                                                                         *
+ *   ABSTRACT                                                              *
+ *  Write the Resistance, Inductance and Conductance matrices at a         *
+ *  frequency to output.                                                   *
+ *                                                                         *
+ *   CALLING FORMAT                                                        *
+ *  nmmtl_output_rlgc(output_fp, frequency, resistance, inductance,        *
+ *      conductance, signals);                                             *
+ *                                                                         *
+ *   RETURN VALUE                                                          *
+ *                                                                         *
+ *   INPUT PARAMETERS                                                      *
+ *  FILE *output_fp;        output file ptr                                *
+ *  double frequency;       Hz                                             *
+ *  double **resistance;    [R] matrix at the frequency                    *
+ *  double **inductance;    [L] matrix at the frequency                    *
+ *  double **conductance;   [G] matrix at the frequency                    *
+ *  struct contour *signals;  signal line info (names)                     *
+ *                                                                         *
+ *   OUTPUT PARAMETERS                                                     *
+ *                                                                         *
+ *   CREATION DATE  18-OCT-2026                                            *
+ *                                                                         *
+ \***************************************************************************/
+
+#include "nmmtl.h"
+
+static void nmmtl_output_rlgc_matrix(FILE *output_fp, const char *symbol,
+                                     double **matrix,
+                                     struct contour *signals);
+
+void nmmtl_output_rlgc(FILE *output_fp, double frequency,
+                       double **resistance, double **inductance,
+                       double **conductance, struct contour *signals)
+{
+  fprintf(output_fp, "\nMutual and Self Resistance at %g Hz:\n", frequency);
+  fprintf(output_fp, "R(Active Signal , Passive Signal) Ohms/Meter\n");
+  nmmtl_output_rlgc_matrix(output_fp, "R", resistance, signals);
+
+  fprintf(output_fp, "\nMutual and Self Inductance at %g Hz:\n", frequency);
+  fprintf(output_fp, "L(Active Signal , Passive Signal) Henrys/Meter\n");
+  nmmtl_output_rlgc_matrix(output_fp, "L", inductance, signals);
+
+  fprintf(output_fp, "\nMutual and Self Conductance at %g Hz:\n", frequency);
+  fprintf(output_fp, "G(Active Signal , Passive Signal) Siemens/Meter\n");
+  nmmtl_output_rlgc_matrix(output_fp, "G", conductance, signals);
+}
+
+static void nmmtl_output_rlgc_matrix(FILE *output_fp, const char *symbol,
+                                     double **matrix,
+                                     struct contour *signals)
+{
+  struct contour *sig_line1, *sig_line2;    /* signal ptrs */
+  int i,j;            /* array indices */
+
+  for (sig_line1 = signals, i = 0;
+       sig_line1 != NULL;
+       sig_line1 = sig_line1->next, i++)
+  {
+    for (sig_line2 = signals, j = 0;
+         sig_line2 != NULL;
+         sig_line2 = sig_line2->next, j++)
+    {
+      fprintf(output_fp, "%s( ::%s , ::%s )= %15.7e\n",
+              symbol, sig_line1->name, sig_line2->name, matrix[i][j]);
+    }
+  }
+}
@@ -0,0 +1,103 @@
+/***************************************************************************\
+ *                                                                         *
+ *   ROUTINE NAME NMMTL_OUTPUT_SENSITIVITY                                 *
+ *                                                                         *
+ *   ABSTRACT                                                              *
+ *  Write the derivatives of the electrostatic induction and inductance    *
+ *  matrices with respect to each parameter of the cross section to        *
+ *  output.                                                                *
+ *                                                                         *
+ *   CALLING FORMAT                                                        *
+ *  nmmtl_output_sensitivity(output_fp, number_conductors, sensitivity,    *
+ *      signals);                                                          *
+ *                                                                         *
+ *   RETURN VALUE                                                          *
+ *                                                                         *
+ *   INPUT PARAMETERS                                                      *
+ *  FILE *output_fp;            output file ptr                            *
+ *  int number_conductors;      number of signals                          *
+ *  SENSITIVITY_P sensitivity;  the parameters and derivatives             *
+ *  struct contour *signals;    signal line info (names)                   *
+ *                                                                         *
+ *   OUTPUT PARAMETERS                                                     *
+ *                                                                         *
+ *   CREATION DATE  18-OCT-2026                                            *
+ *                                                                         *
+ \***************************************************************************/
+
+#include "nmmtl.h"
+
+static void nmmtl_output_sensitivity_matrix(FILE *output_fp,
+                                            const char *symbol,
+                                            double **derivative,
+                                            struct contour *signals);
+
+void nmmtl_output_sensitivity(FILE *output_fp, int number_conductors,
+                              SENSITIVITY_P sensitivity,
+                              struct contour *signals)
+{
+  SENSITIVITY_PARAMETER_P parameter;
+  char title[SIZE_SIG_NAME + 64];
+  const char *units;
+  int p;
+
+  if (number_conductors < 1) return;
+
+  for (p = 0; p < sensitivity->number_parameters; p++)
+  {
+    parameter = &sensitivity->parameters[p];
+    switch (parameter->kind)
+    {
+    case SENSITIVITY_PERMITTIVITY:
+      sprintf(title, "the Relative Permittivity %g", parameter->value);
+      units = "";
+      break;
+    case SENSITIVITY_THICKNESS:
+      sprintf(title, "the Thickness of Layer %d (%g meters)",
+              parameter->layer, parameter->value);
+      units = " per Meter";
+      break;
+    default:
+      sprintf(title, "the Width of ::%s (%g meters)",
+              parameter->name, parameter->value);
+      units = " per Meter";
+      break;
+    }
+
+    fprintf(output_fp,
+            "\nSensitivity of the Electrostatic Induction to %s\n", title);
+    fprintf(output_fp, "(Farads/Meter%s):\n", units);
+    nmmtl_output_sensitivity_matrix(output_fp, "dB",
+                                    sensitivity->induction[p], signals);
+
+    /* the inductance does not see the dielectrics */
+    if (parameter->kind == SENSITIVITY_PERMITTIVITY) continue;
+
+    fprintf(output_fp, "\nSensitivity of the Inductance to %s\n", title);
+    fprintf(output_fp, "(Henrys/Meter%s):\n", units);
+    nmmtl_output_sensitivity_matrix(output_fp, "dL",
+                                    sensitivity->inductance[p], signals);
+  }
+}
+
+static void nmmtl_output_sensitivity_matrix(FILE *output_fp,
+                                            const char *symbol,
+                                            double **derivative,
+                                            struct contour *signals)
+{
+  struct contour *sig_line1, *sig_line2;    /* signal ptrs */
+  int i,j;            /* array indices */
+
+  for (sig_line1 = signals, i = 0;
+       sig_line1 != NULL;
+       sig_line1 = sig_line1->next, i++)
+  {
+    for (sig_line2 = signals, j = 0;
+         sig_line2 != NULL;
+         sig_line2 = sig_line2->next, j++)
+    {
+      fprintf(output_fp, "%s( ::%s , ::%s )= %15.7e\n",
+              symbol, sig_line1->name, sig_line2->name, derivative[i][j]);
+    }
+  }
+}
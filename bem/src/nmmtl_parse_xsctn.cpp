@@ -18,32 +18,111 @@ COPYRIGHT:          Copyright (C) 1986-92 by Mayo Foundation. All rights reserve
 #include "electro_prototype.h"
 
 #include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 /*
  *******************************************************************
- **  FUNCTION DEFINITIONS
+ **  PREPROCESSOR CONSTANTS
  *******************************************************************
  */
 
-//---------------------------------------------------------------------
-// parseVal: parse the line from the file to get the portion containing
-//           the value.
-//---------------------------------------------------------------------
-void parseVal (char *line, int flg, char *tmp) {
-  if (flg)
-    sscanf (line, "%*s %s", tmp);
-  else
-    sscanf (line, "%*s %*s %s", tmp);
-
-  // Remove (optional) surrounding quotes from value
-  if ( tmp[0] == '\"' )
-    tmp[0] = ' ';
-  if ( tmp[strlen(tmp)-1] == '\"' )
-    tmp[strlen(tmp)-1] = '\0';
-  else if ( tmp[strlen(tmp)-2] == '\"' )
-    tmp[strlen(tmp)-2] = '\0';
-}
+/* most words in one command: a keyword, a name and option/value pairs */
+#define XSCTN_MAX_WORDS 64
+
+/* longest value, with any default units appended */
+#define XSCTN_VALUE_SIZE 100
+
+/* kinds of option values */
+#define XSCTN_LENGTH 0
+#define XSCTN_CONDUCTIVITY 1
+#define XSCTN_NUMBER 2
+#define XSCTN_INTEGER 3
+
+
+/*
+ *******************************************************************
+ **  STRUCTURES AND TYPEDEFS
+ *******************************************************************
+ */
+
+/* position in the .xsctn text being read */
+typedef struct xsctn_scanner
+{
+  const char *next, *end;
+  int line;
+} XSCTN_SCANNER, *XSCTN_SCANNER_P;
+
+/* a word of a command, pointing into the text */
+typedef struct xsctn_word
+{
+  const char *text;
+  size_t length;
+} XSCTN_WORD, *XSCTN_WORD_P;
+
+/* an object option and the XSCTN_OBJECT field its value goes to */
+typedef struct xsctn_option
+{
+  const char *option;
+  int kind;
+  size_t offset;
+} XSCTN_OPTION;
+
+
+/*
+ *******************************************************************
+ **  GLOBALS
+ *******************************************************************
+ */
+
+/* options of the object commands; -thickness of a layer is kept in
+   height.  Anything not listed (-permeability, say) is ignored. */
+static const XSCTN_OPTION xsctn_options[] =
+{
+  { "-thickness",    XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,height) },
+  { "-height",       XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,height) },
+  { "-width",        XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,width) },
+  { "-topWidth",     XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,top_width) },
+  { "-bottomWidth",  XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,bottom_width) },
+  { "-diameter",     XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,diameter) },
+  { "-xOffset",      XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,x_offset) },
+  { "-yOffset",      XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,y_offset) },
+  { "-pitch",        XSCTN_LENGTH,       offsetof(XSCTN_OBJECT,pitch) },
+  { "-conductivity", XSCTN_CONDUCTIVITY, offsetof(XSCTN_OBJECT,conductivity) },
+  { "-permittivity", XSCTN_NUMBER,       offsetof(XSCTN_OBJECT,permittivity) },
+  { "-lossTangent",  XSCTN_NUMBER,       offsetof(XSCTN_OBJECT,loss_tangent) },
+  { "-number",       XSCTN_INTEGER,      offsetof(XSCTN_OBJECT,number) }
+};
+
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_xsctn_command(XSCTN_SCANNER_P scanner, XSCTN_WORD_P words,
+                               int *line);
+
+static int nmmtl_xsctn_word_is(XSCTN_WORD_P word, const char *keyword);
+
+static int nmmtl_xsctn_value(XSCTN_WORD_P word, const char *default_units,
+                             char *value);
+
+static int nmmtl_xsctn_option(XSCTN_WORD_P option, XSCTN_WORD_P word,
+                              const char *default_units,
+                              XSCTN_OBJECT_P spec);
+
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
 
 
 /*
@@ -95,7 +174,8 @@ void parseVal (char *line, int flg, char *tmp) {
 
  INPUTS:
 
- input file: node.graphic
+ input file: filename.xsctn, mapped into memory and read by
+ nmmtl_parse_xsctn_buffer
 
  OUTPUTS:
 
@@ -114,10 +194,13 @@ void parseVal (char *line, int flg, char *tmp) {
  num_signals : number of signal conductors
  num_grounds : number of ground conductors (including upper plane)
  units : the user-specified or default units for measurement
+ number_frequencies : how many frequencies the file asks for results at
+ frequencies : the frequencies in Hz, MMTL_MAX_FREQUENCIES of them
+ number_pairs : how many differential pairs the file names
+ pairs : the names of the two signals of each, MMTL_MAX_PAIRS of them
 
  FUNCTIONS CALLED:
- in_string, header_c, mcms_access, mcms_deaccess,
- get_error, filescan, get_node, get_design_dir
+ nmmtl_parse_xsctn_buffer
 
 
  RETURN VALUE:
@@ -130,7 +213,7 @@ int nmmtl_parse_xsctn(char *filename,
       int *pln_seg,
       double *coupling,
       double *risetime,
-      double *conductivity, //FIXME: unused argument
+      double *conductivity,
       double *half_minimum_dimension,
       int *gnd_planes,
       double *top_ground_plane_thickness,
@@ -140,840 +223,744 @@ int nmmtl_parse_xsctn(char *filename,
       struct contour **groundwires,
       int *num_signals,
       int *num_grounds,
-      int *units) {
-  char meters[] = "meters";
-  char seconds[] = "seconds";
-  char siemensPmeter[] = "siemens/meter";
-
-  char line[GPGE_MAX];    /* input GPGE graphic file lines */
-  char msg[80];     /* custom string error messages */
-  struct dielectric *d_temp;  /* temps for manipulating lists */
-                                /* to create, update lists */
-  struct contour *c_temp,*c_prev;
-  int status; /* function return status */
-  NETLIST_REC *netlist;
-  double offset = 1.0e20; /* find offset of top of bottom ground plane */
-                                /* initialize to some big number */
-
-  double highest_dielectric = -1.0e20; /* the level of the top of the highest */
-                                      /* dielectric, initialized to some very*/
-                                      /* unlikely number. */
-  double minimum_dimension = DBL_MAX;
-
-  int upper_ground_planes = 0;  /* keep count of drawn ground planes */
-  int lower_ground_planes = 0;
-  double ground_x_min = DBL_MAX, ground_x_max = DBL_MIN;
-
+      int *units,
+      int *number_frequencies,
+      double *frequencies,
+      int *number_pairs,
+      char (*pairs)[2][SIZE_SIG_NAME]) {
   char fullfilespec[1024];
-  double totWidth = 0;
-
-  /* initialize the parameters set by icon attributes */
-  *cntr_seg = 0;
-  *pln_seg  = 0;
-  *coupling = 0.;
-  *risetime = 0.;
-
-  //
-  // Establish a default CONDUCTIVITY if the user specified no value.
-  //
-  *conductivity = DEFAULT_CONDUCTIVITY;
-  *gnd_planes = 0;
-  *top_ground_plane_thickness = 0.;
-  *bottom_ground_plane_thickness = 0.;
-  *units = UNITS_NO_UNITS;
-
-  netlist = (NETLIST_REC *)calloc(1,sizeof(NETLIST_REC));
-  netlist->exists = FALSE;
+  struct stat file_status;
+  const char *text = "";
+  void *mapping = MAP_FAILED;
+  size_t length = 0;
+  int fd;
+  int status;
 
   // now try to open the file
-  sprintf(fullfilespec, "%s.xsctn", filename);
+  snprintf(fullfilespec, sizeof(fullfilespec), "%s.xsctn", filename);
 
-  FILE *inpf;
+  // Loss-tangent only used for the conductance in R, L and G.
+  if (!(OUTPUT_PRODUCTS & OUTPUT_RLGC))
+    printf ("Warning: lossTangent not used in this simulation!\n");
 
-  // Loss-tangent not used for the calculations.
-  printf ("Warning: lossTangent not used in this simulation!\n");
-
-  if (!(inpf = fopen(fullfilespec, "r"))) {
+  if ((fd = open(fullfilespec, O_RDONLY)) < 0) {
     printf ("Error: cannot open the cross-section file %s\n", fullfilespec);
     return (FAIL);
   }
 
-  double dbl;
-  char tmp[100];
-  char defaultUnits[20];
-  double arg1;
-  char arg2[30];
-  int tmp_cntr_seg;
-  int tmp_pln_seg;
-
-  while (true) {
-    if (fgets(line, GPGE_MAX, inpf) == NULL) {
-      printf ("*** EOF incountered -- incomplete input file %s\n", fullfilespec);
-      return FAIL;
+  // map the whole file, an empty one cannot be mapped and is left to the
+  // parser to complain about
+  if (fstat(fd, &file_status) == 0 && file_status.st_size > 0) {
+    length = (size_t)file_status.st_size;
+    mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      printf ("Error: cannot read the cross-section file %s\n", fullfilespec);
+      close (fd);
+      return (FAIL);
     }
-    // skip comment
-    if (line[0] == '#')
-      continue;
+    text = (const char *)mapping;
+  }
+  close (fd);
+
+  status = nmmtl_parse_xsctn_buffer(text, length, fullfilespec, cntr_seg,
+                                    pln_seg, coupling, risetime, conductivity,
+                                    half_minimum_dimension, gnd_planes,
+                                    top_ground_plane_thickness,
+                                    bottom_ground_plane_thickness,
+                                    dielectrics, signals, groundwires,
+                                    num_signals, num_grounds, units,
+                                    number_frequencies, frequencies,
+                                    number_pairs, pairs);
+
+  if (mapping != MAP_FAILED)
+    munmap (mapping, length);
+  return (status);
+}
 
-    // skip for reasons of sanity, line too short to carry relevant information
-    if (strlen(line) < 3)
-      continue;
 
-    // skip specification of required packages
-    if (strstr(line, "ackage") != NULL)
-      continue;
+/*
+ FUNCTION NAME:  nmmtl_parse_xsctn_buffer()
 
-    // beginning of geometry section -- exit loop
-    if ((! strncmp(line, "Gro", 3))
-    ||  (! strncmp(line, "Die", 3))
-    ||  (! strncmp(line, "Rec", 3))
-    ||  (! strncmp(line, "Cir", 3))
-    ||  (! strncmp(line, "Tra", 3)))
-      break;
+ FUNCTIONAL DESCRIPTION:
 
-    //cannot see the use for the following lines.. commenting them for the time being
-    //// skip indented "set ..." lines
-    //if (strncmp(line, "set", 3)) {
-      //continue;
-    //}
-
-    if (strstr(line, "couplingLen") != NULL) {
-      parseVal(line, 0, tmp);
-      if ((sscanf (tmp, "%lf%s", &arg1, arg2)) < 2)
-        strcat(tmp, "meters");
-      conversion(tmp, meters, dbl);
-      *coupling = dbl;
-      printf ("Input CouplingLength = %lf\n", dbl);
-    }
-    if (strstr(line, "riseTime") != NULL) {
-      parseVal (line, 0, tmp);
-      if ((sscanf(tmp, "%lf%s", &arg1, arg2)) < 2) {
-        strcat(tmp, "ps");
-        conversion(tmp, seconds, dbl);
-        *risetime = dbl;
-      } else {
-        conversion (tmp, seconds, dbl);
-        *risetime = dbl;
-      }
-      printf("Input RiseTime = %lf\n", *risetime);
-    }
-    if (strstr (line, "defaultLeng") != NULL) {
-      sscanf(line, "%*s %*s %*c%s", tmp);
-      tmp[strlen(tmp)-1] = '\0';
-      strcpy(defaultUnits, tmp);
-      printf("Input Default Units: %s\n", defaultUnits);
-    }
+ The body of nmmtl_parse_xsctn: read a cross section in .xsctn format
+ from memory, such as the mapped file or a request to the --serve
+ daemon.  The text is read into an in-memory cross section by
+ nmmtl_xsctn_read, which is then expanded into the lists.
 
-    if (strstr(line, "CSEG") != NULL) {
-      sscanf(line, "%*s %*s %d", &tmp_cntr_seg);
-    }
-    if (strstr(line, "DSEG") != NULL) {
-      sscanf(line, "%*s %*s %d", &tmp_pln_seg);
-    }
-  }
+ FORMAL PARAMETERS:
 
-  // assign segment counters to corresponding return values
-  if (*cntr_seg < 1)
-    *cntr_seg = tmp_cntr_seg;
+ INPUTS:
 
-  if (*pln_seg < 1)
-    *pln_seg = tmp_pln_seg;
+ text : the .xsctn text, need not be terminated
+ length : its length
+ source_name : name of the text for messages
 
-  // Establish a default RISETIME if riseTime is set to zero.
-  if (*risetime == 0) {
-    *risetime = DEFAULT_RISETIME * 1.0e-12;
-    printf ("Assign a default value of %g to risetime\n", *risetime);
-  }
+ OUTPUTS:
 
-  // Establish a default COUPLING if the coupling-length is set to zero.
-  // Note here that units input will default to units of mils when the user
-  // specifies none.
-  if (*coupling == 0) {
-    /* make the assignment in terms of meters, first, using default in inches*/
-    *coupling = DEFAULT_COUPLING;
-    *coupling *= INCHES_TO_METERS;
-    /* warn about using default values in user's selected units */
-    sprintf(msg, "WARN: Default=%g mils used\n", (float)((*coupling) / MILS_TO_METERS));
-    printf ("%s\n", msg);
-  } else {
-    printf ("CouplingLength = %g\n", *coupling);
-  }
+ as for nmmtl_parse_xsctn
 
-  /* assign in user's units */
-  *top_ground_plane_thickness = DEFAULT_GND_THICK / MILS_TO_METERS;
-  *bottom_ground_plane_thickness = DEFAULT_GND_THICK / MILS_TO_METERS;
-
-  double thickness;
-  double yCoord = 0.0;
-
-  while (true) {
-    if (strstr (line, "oundPlane") != NULL) {
-      if (++(*gnd_planes) > 2) {
-        /* count ground planes */
-        printf ("* Warning: There are %d groundplanes in the design...reset to 2\n",
-          *gnd_planes);
-        printf ("***************************************************************\n");
-        *gnd_planes = 2;  /* keep it at 2 */
-      }
-    //    yCoord += DEFAULT_GND_THICK;
-    }
-    //--------------------------------------------------------------------------------
-    // Is this a dielectric definition?
-    //--------------------------------------------------------------------------------
-    else if (strstr (line, "lectricLayer") != NULL) {
-      if (*gnd_planes == 0) {
-        printf ("* ERROR: There must be a bottom ground plane!\n");
-        return (FAIL);
-      }
-      //-----------------------------------------------------
-      // Create the dielectric structure.
-      // d_temp.x0  - left x coordinate of the rectangle
-      // d_temp.y0  - lower y coordinate of the rectangle
-      // d_temp.x1  - right x coordinate of the rectangle
-      // d_temp.y1  - upper y coordinate of the rectangle
-      //------------------------------------------------
-      d_temp = (struct dielectric *)malloc(sizeof(struct dielectric));
-      d_temp->next = NULL;
-      d_temp->constant = 1.0;   // Default to 1.0 if no -permittivity attribute in the file..
-      d_temp->tangent = 0.0;    // Default to 0 since this is not used in calculations.
-      d_temp->x0 = d_temp->x1 = 0;
-      //-----------------------------------------------------
-      // Process this dielectric until a line is read without the "\" character.
-      //-----------------------------------------------------
-      while (true) {
-        //-----------------------------------------------
-        // Thickness of the dielectric
-        //-----------------------------------------------
-        if (strstr (line, "-thickness") != NULL) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, thickness);
-          d_temp->y0 = yCoord;
-          yCoord += thickness;
-          d_temp->y1 = yCoord;
-
-          /* insert dielectric onto plain list */
-          d_temp->next = *dielectrics;
-          *dielectrics = d_temp;
-
-          /* keep track of the highest dielectric - to find ground plane */
-          if(d_temp->y1 > highest_dielectric) highest_dielectric = d_temp->y1;
-
-          /* keep track of the lowest dielectric - to offset to y=0 */
-          if(d_temp->y0 < offset) offset = d_temp->y0;
-
-          /* keep track of smallest dimension */
-          if(thickness < minimum_dimension)
-            minimum_dimension = thickness;
-        }
+ RETURN VALUE:
 
-        //-----------------------------------------------
-        // Thickness of the dielectric
-        //-----------------------------------------------
-        if ( strstr (line, "-permittivity") != NULL )
-          sscanf (line, "%*s %lf", &d_temp->constant);
+ SUCCESS, FAIL
 
-        //-----------------------------------------------
-        // End of this dielectric definition
-        //-----------------------------------------------
-        if ( (strrchr (line, '\\')) == 0 ) {
+ */
+int nmmtl_parse_xsctn_buffer(const char *text,
+      size_t length,
+      const char *source_name,
+      int *cntr_seg,
+      int *pln_seg,
+      double *coupling,
+      double *risetime,
+      double *conductivity,
+      double *half_minimum_dimension,
+      int *gnd_planes,
+      double *top_ground_plane_thickness,
+      double *bottom_ground_plane_thickness,
+      struct dielectric **dielectrics,
+      struct contour **signals,
+      struct contour **groundwires,
+      int *num_signals,
+      int *num_grounds,
+      int *units,
+      int *number_frequencies,
+      double *frequencies,
+      int *number_pairs,
+      char (*pairs)[2][SIZE_SIG_NAME]) {
+  MMTL_XSCTN_P xsctn;
+  int status;
+  int w;
+
+  *dielectrics = NULL;
+  *signals = NULL;
+  *groundwires = NULL;
+  *num_signals = 0;
+  *num_grounds = 0;
+  *units = UNITS_NO_UNITS;
+  *number_frequencies = 0;
+  *number_pairs = 0;
+
+  if ((xsctn = mmtl_xsctn_create()) == NULL)
+    return (FAIL);
+
+  status = nmmtl_xsctn_read(xsctn, text, length, source_name);
+  if (status == SUCCESS && xsctn->number_objects == 0) {
+    printf ("*** EOF incountered -- incomplete input file %s\n", source_name);
+    status = FAIL;
+  }
+
+  if (status == SUCCESS) {
+    // Establish a default RISETIME if riseTime is set to zero.
+    if (xsctn->risetime == 0)
+      printf ("Assign a default value of %g to risetime\n",
+              DEFAULT_RISETIME * 1.0e-12);
+
+    // Establish a default COUPLING if the coupling-length is set to zero.
+    if (xsctn->coupling == 0)
+      printf ("WARN: Default=%g mils used\n\n",
+              (float)(DEFAULT_COUPLING * INCHES_TO_METERS / MILS_TO_METERS));
+    else if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("CouplingLength = %g\n", xsctn->coupling);
+
+    status = nmmtl_xsctn_expand(xsctn, cntr_seg, pln_seg, coupling,
+                                risetime, conductivity,
+                                half_minimum_dimension, gnd_planes,
+                                top_ground_plane_thickness,
+                                bottom_ground_plane_thickness,
+                                dielectrics, signals, groundwires,
+                                num_signals, num_grounds);
+
+    // The loss tangents only give the conductance at some frequency.
+    *number_frequencies = xsctn->number_frequencies;
+    memcpy (frequencies, xsctn->frequencies,
+            sizeof(double) * (size_t)xsctn->number_frequencies);
+    *number_pairs = xsctn->number_pairs;
+    memcpy (pairs, xsctn->pairs,
+            sizeof(xsctn->pairs[0]) * (size_t)xsctn->number_pairs);
+    if (xsctn->number_frequencies == 0 && (OUTPUT_PRODUCTS & OUTPUT_RLGC)) {
+      for (w = 0; w < xsctn->number_objects; w++)
+        if (xsctn->objects[w].loss_tangent != 0.0) {
+          printf ("Warning: lossTangent not used without a frequency!\n");
           break;
         }
+    }
+  }
 
-        if ( fgets (line, GPGE_MAX, inpf) == NULL ) {
-          printf ("*** EOF incountered -- imcomplete input file %s\n", fullfilespec);
-          return 0;
-        }
-      }
+  mmtl_xsctn_free (xsctn);
+  return (status);
+}
+
+
+/*
+ FUNCTION NAME:  mmtl_xsctn_read()
+
+ FUNCTIONAL DESCRIPTION:
+
+ Library entry point to nmmtl_xsctn_read: add the contents of .xsctn
+ text to a cross section.
+
+ FORMAL PARAMETERS:
+
+ xsctn : the cross section
+ text : the .xsctn text, need not be terminated
+ length : its length
+
+ RETURN VALUE:
+
+ MMTL_SUCCESS, MMTL_FAIL
+
+ */
+int mmtl_xsctn_read(MMTL_XSCTN_P xsctn, const char *text, size_t length) {
+  if (xsctn == NULL || text == NULL)
+    return (MMTL_FAIL);
+  if (nmmtl_xsctn_read(xsctn, text, length, "buffer") != SUCCESS)
+    return (MMTL_FAIL);
+  return (MMTL_SUCCESS);
+}
+
+
+/*
+ FUNCTION NAME:  nmmtl_xsctn_read()
+
+ FUNCTIONAL DESCRIPTION:
+
+ Read .xsctn text in a single pass, one command at a time, straight
+ into the object array of an in-memory cross section.  The header
+ variables (couplingLength, riseTime, frequency, defaultLengthUnits,
+ CSEG and DSEG) are set with "set"; every other command adds one
+ object, its
+ options collected by nmmtl_xsctn_option.  Conductor and dielectric sets
+ keep their -number and -pitch; nothing is expanded until
+ nmmtl_xsctn_expand.
+
+ Dimensions without units are in defaultLengthUnits, mils until it is
+ set, a couplingLength without units is in meters and a riseTime in
+ picoseconds.  The frequency may be a list, in Hz unless it has units,
+ at each of which the conductance is calculated.  differentialPairs is a
+ list of pairs of signal names, the pairs separated by commas.
+ GroundPlane options are ignored, as are commands and options which
+ have no meaning for the field solver.
+
+ FORMAL PARAMETERS:
+
+ xsctn : the cross section to add to
+ text : the .xsctn text, need not be terminated
+ length : its length
+ source_name : name of the text for messages
+
+ RETURN VALUE:
+
+ SUCCESS, FAIL
+
+ */
+int nmmtl_xsctn_read(MMTL_XSCTN_P xsctn,
+      const char *text,
+      size_t length,
+      const char *source_name) {
+  XSCTN_SCANNER scanner;
+  XSCTN_WORD words[XSCTN_MAX_WORDS];
+  XSCTN_OBJECT spec;
+  char value[XSCTN_VALUE_SIZE];
+  char default_units[XSCTN_VALUE_SIZE];
+  char name[XSCTN_VALUE_SIZE];
+  XSCTN_WORD variable;
+  int number_words;
+  int line;
+  int status;
+  int w;
+  double dbl;
+
+  scanner.next = text;
+  scanner.end = text + length;
+  scanner.line = 1;
+  strcpy (default_units, "mils");
+
+  while ((number_words = nmmtl_xsctn_command(&scanner, words, &line)) != 0) {
+    if (number_words < 0) {
+      printf ("*** Error: %s line %d: command too long\n", source_name, line);
+      return (FAIL);
     }
 
+    // skip specification of required packages
+    if (nmmtl_xsctn_word_is(&words[0], "package"))
+      continue;
+
     //-----------------------------------------------------
-    // Is this a rectangle dielectric?
+    // Header variable, namespace qualifiers are dropped
     //-----------------------------------------------------
-    else if ( strstr (line, "ctangleDielec") != NULL ) {
-      double width, height, xOffset, yOffset, pitch;
-      int indx, number;
-
-            //-----------------------------------------------------
-      // Create the dielectric structure.
-      // d_temp.x0  - left x coordinate of the rectangle
-      // d_temp.y0  - lower y coordinate of the rectangle
-      // d_temp.x1  - right x coordinate of the rectangle
-      // d_temp.y1  - upper y coordinate of the rectangle
-      //------------------------------------------------
-      d_temp = (struct dielectric *)malloc(sizeof(struct dielectric));
-      d_temp->next = NULL;
-      d_temp->constant = 1.0;   // Default to 1.0 if no -permittivity attribute in the file..
-      d_temp->tangent = 0.0;    // Default to 0 since this is not used in calculations.
-
-      // Set the default number of RectangleDielectric to 1
-      number = 1;
-      while (true) {
-        if ( strstr (line, "-height") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, height);
+    if (nmmtl_xsctn_word_is(&words[0], "set")) {
+      if (number_words != 3)
+        continue;
+      variable = words[1];
+      for (w = (int)variable.length - 2; w >= 0; w--) {
+        if (variable.text[w] == ':' && variable.text[w+1] == ':') {
+          variable.text += w + 2;
+          variable.length -= (size_t)w + 2;
+          break;
         }
+      }
 
-        //-----------------------------------------------
-        // Width of each rectangular conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-width") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, width);
+      status = SUCCESS;
+      if (nmmtl_xsctn_word_is(&variable, "couplingLength")) {
+        status = nmmtl_xsctn_value(&words[2], "meters", value);
+        if (status == SUCCESS)
+          status = conversion (value, (char *)"meters", dbl);
+        if (status == SUCCESS) {
+          xsctn->coupling = dbl;
+          if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+            printf ("Input CouplingLength = %lf\n", dbl);
         }
-
-        //-----------------------------------------------
-        // Permittivity of the dielectric
-        //-----------------------------------------------
-        if ( strstr (line, "-permittivity") != NULL )
-          sscanf (line, "%*s %lf", &d_temp->constant);
-
-        //-----------------------------------------------
-        // Number of conductors to the set
-        //-----------------------------------------------
-        if ( strstr (line, "-number") != NULL )
-          sscanf (line, "%*s %d", &number);
-
-        //-----------------------------------------------
-        // X-offset for placing the first conductor in the set
-        //-----------------------------------------------
-        if ( strstr (line, "-xOff") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, xOffset);
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "riseTime")) {
+        status = nmmtl_xsctn_value(&words[2], "ps", value);
+        if (status == SUCCESS)
+          status = conversion (value, (char *)"seconds", dbl);
+        if (status == SUCCESS) {
+          xsctn->risetime = dbl;
+          if (OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+            printf ("Input RiseTime = %lf\n", dbl);
         }
-
-        //-----------------------------------------------
-        // Y-offset for placing the first conductor in the set
-        //-----------------------------------------------
-        if ( strstr (line, "-yOff") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, yOffset);
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "defaultLengthUnits")) {
+        status = nmmtl_xsctn_value(&words[2], "", default_units);
+        if (status == SUCCESS && (OUTPUT_PRODUCTS & OUTPUT_PROGRESS))
+          printf ("Input Default Units: %s\n", default_units);
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "frequency")) {
+        // a list of frequencies, in Hz unless they have units
+        XSCTN_WORD frequency;
+        const char *end = words[2].text + words[2].length;
+        xsctn->number_frequencies = 0;
+        frequency.text = words[2].text;
+        while (status == SUCCESS) {
+          while (frequency.text < end &&
+                 (*frequency.text == ' ' || *frequency.text == '\t' ||
+                  *frequency.text == ','))
+            frequency.text++;
+          if (frequency.text == end)
+            break;
+          frequency.length = 0;
+          while (frequency.text + frequency.length < end &&
+                 strchr (" \t,", frequency.text[frequency.length]) == NULL)
+            frequency.length++;
+          status = nmmtl_xsctn_value(&frequency, "Hz", value);
+          if (status == SUCCESS)
+            status = conversion (value, (char *)"hertz", dbl);
+          if (status == SUCCESS && (dbl <= 0.0 ||
+              xsctn->number_frequencies == MMTL_MAX_FREQUENCIES))
+            status = FAIL;
+          if (status == SUCCESS) {
+            xsctn->frequencies[xsctn->number_frequencies++] = dbl;
+            if ((OUTPUT_PRODUCTS & OUTPUT_PROGRESS) &&
+                (OUTPUT_PRODUCTS & OUTPUT_RLGC))
+              printf ("Input Frequency = %g\n", dbl);
+          }
+          frequency.text += frequency.length;
         }
-
-        //-----------------------------------------------
-        // Spacing for the conductor set
-        //-----------------------------------------------
-        if ( strstr (line, "-pitch") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, pitch);
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "differentialPairs")) {
+        // pairs of signal names, the pairs separated by commas
+        XSCTN_WORD signal;
+        const char *end = words[2].text + words[2].length;
+        int half = 0;
+        xsctn->number_pairs = 0;
+        signal.text = words[2].text;
+        while (status == SUCCESS) {
+          while (signal.text < end &&
+                 (*signal.text == ' ' || *signal.text == '\t'))
+            signal.text++;
+          if (signal.text < end && *signal.text == ',') {
+            // a pair ends, with both its names
+            if (half != 0)
+              status = FAIL;
+            signal.text++;
+            continue;
+          }
+          if (signal.text == end)
+            break;
+          signal.length = 0;
+          while (signal.text + signal.length < end &&
+                 strchr (" \t,", signal.text[signal.length]) == NULL)
+            signal.length++;
+          if (signal.length >= SIZE_SIG_NAME ||
+              (half == 0 && xsctn->number_pairs == MMTL_MAX_PAIRS))
+            status = FAIL;
+          if (status == SUCCESS) {
+            memcpy (xsctn->pairs[xsctn->number_pairs][half], signal.text,
+                    signal.length);
+            xsctn->pairs[xsctn->number_pairs][half][signal.length] = '\0';
+            if (half == 1)
+              xsctn->number_pairs++;
+            half = 1 - half;
+          }
+          signal.text += signal.length;
         }
+        if (half != 0)
+          status = FAIL;
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "CSEG")) {
+        status = nmmtl_xsctn_value(&words[2], "", value);
+        if (status == SUCCESS)
+          xsctn->cntr_seg = atoi (value);
+      }
+      else if (nmmtl_xsctn_word_is(&variable, "DSEG")) {
+        status = nmmtl_xsctn_value(&words[2], "", value);
+        if (status == SUCCESS)
+          xsctn->pln_seg = atoi (value);
+      }
 
-        //-----------------------------------------------
-        // End of this dielectric definition
-        //-----------------------------------------------
-        if ( (strrchr (line, '\\')) == 0 ) {
-          break;
-        }
+      if (status != SUCCESS) {
+        printf ("*** Error: %s line %d: bad value %.*s for %.*s\n",
+                source_name, line, (int)words[2].length, words[2].text,
+                (int)words[1].length, words[1].text);
+        return (FAIL);
+      }
+      continue;
+    }
 
+    name[0] = '\0';
+    if (nmmtl_xsctn_word_is(&words[0], "GroundPlane")) {
+      status = mmtl_xsctn_add_ground_plane(xsctn);
+    }
+    else if (nmmtl_xsctn_word_is(&words[0], "DielectricLayer") ||
+             nmmtl_xsctn_word_is(&words[0], "RectangleDielectric") ||
+             nmmtl_xsctn_word_is(&words[0], "RectangleConductors") ||
+             nmmtl_xsctn_word_is(&words[0], "TrapezoidConductors") ||
+             nmmtl_xsctn_word_is(&words[0], "CircleConductors")) {
 
-        if ( fgets (line, GPGE_MAX, inpf) == NULL ) {
-          printf ("*** EOF incountered -- imcomplete input file %s\n", fullfilespec);
-          return 0;
+      //-----------------------------------------------------
+      // Collect the options, words[1] is the name of the object
+      //-----------------------------------------------------
+      if (number_words < 2 || words[1].length >= sizeof(name)) {
+        printf ("*** Error: %s line %d: bad name for %.*s\n", source_name,
+                line, (int)words[0].length, words[0].text);
+        return (FAIL);
+      }
+      memcpy (name, words[1].text, words[1].length);
+      name[words[1].length] = '\0';
+
+      memset (&spec, 0, sizeof(spec));
+      spec.permittivity = 1.0;  // default if no -permittivity attribute
+      spec.number = 1;          // default number in a set
+
+      for (w = 2; w < number_words; w += 2) {
+        if (w + 1 == number_words) {
+          printf ("*** Error: %s line %d: no value for %.*s\n", source_name,
+                  line, (int)words[w].length, words[w].text);
+          return (FAIL);
+        }
+        if (nmmtl_xsctn_option(&words[w], &words[w+1], default_units,
+                               &spec) != SUCCESS) {
+          printf ("*** Error: %s line %d: bad value %.*s for %.*s\n",
+                  source_name, line,
+                  (int)words[w+1].length, words[w+1].text,
+                  (int)words[w].length, words[w].text);
+          return (FAIL);
         }
       }
 
-      double cx = xOffset;
-      for ( indx = 0; indx < number; ++indx ) {
-        //-----------------------------------------------
-        // d_temp.x0  - left x coordinate of the rectangle
-        // d_temp.y0  - lower y coordinate of the rectangle
-        // d_temp.x1  - right x coordinate of the rectangle
-        // d_temp.y1  - upper y coordinate of the rectangle
-        //------------------------------------------------
-        d_temp->x0 = xOffset;
-        d_temp->x1 = d_temp->x0 + width;
-        d_temp->y0 = yCoord;
-        d_temp->y1 = yCoord + height;
-
-        /* insert dielectric onto plain list */
-        d_temp->next = *dielectrics;
-        *dielectrics = d_temp;
-
-        /* keep track of the highest dielectric - to find ground plane */
-        if(d_temp->y1 > highest_dielectric) highest_dielectric = d_temp->y1;
-
-        /* keep track of the lowest dielectric - to offset to y=0 */
-        if(d_temp->y0 < offset) offset = d_temp->y0;
-
-        /* keep track of smallest dimension */
-        if(height < minimum_dimension)
-          minimum_dimension = height;
-
-        cx += pitch;
+      if (nmmtl_xsctn_word_is(&words[0], "DielectricLayer"))
+        status = mmtl_xsctn_add_dielectric_layer(xsctn, spec.height,
+                                                 spec.permittivity,
+                                                 spec.loss_tangent);
+      else if (nmmtl_xsctn_word_is(&words[0], "RectangleDielectric"))
+        status = mmtl_xsctn_add_rectangle_dielectric(xsctn, spec.width,
+                                                     spec.height,
+                                                     spec.permittivity,
+                                                     spec.loss_tangent,
+                                                     spec.x_offset,
+                                                     spec.number,
+                                                     spec.pitch);
+      else if (nmmtl_xsctn_word_is(&words[0], "RectangleConductors"))
+        status = mmtl_xsctn_add_rectangle_conductors(xsctn, name,
+                                                     spec.width,
+                                                     spec.height,
+                                                     spec.x_offset,
+                                                     spec.y_offset,
+                                                     spec.number,
+                                                     spec.pitch,
+                                                     spec.conductivity);
+      else if (nmmtl_xsctn_word_is(&words[0], "TrapezoidConductors"))
+        status = mmtl_xsctn_add_trapezoid_conductors(xsctn, name,
+                                                     spec.bottom_width,
+                                                     spec.top_width,
+                                                     spec.height,
+                                                     spec.x_offset,
+                                                     spec.y_offset,
+                                                     spec.number,
+                                                     spec.pitch,
+                                                     spec.conductivity);
+      else
+        status = mmtl_xsctn_add_circle_conductors(xsctn, name,
+                                                  spec.diameter,
+                                                  spec.x_offset,
+                                                  spec.y_offset,
+                                                  spec.number,
+                                                  spec.pitch,
+                                                  spec.conductivity);
+
+      // dielectrics keep their names too, so that they can be found
+      if (status == SUCCESS &&
+          xsctn->objects[xsctn->number_objects - 1].name == NULL) {
+        char *name_copy = (char *)nmmtl_xsctn_arena_alloc(xsctn,
+                                                          strlen(name) + 1);
+        if (name_copy == NULL) return (FAIL);
+        strcpy(name_copy, name);
+        xsctn->objects[xsctn->number_objects - 1].name = name_copy;
       }
     }
-    //-----------------------------------------------------
-    // Is this a conductor definition?
-    //-----------------------------------------------------
-    else if ( strstr (line, "Conductors") != NULL ) {
-      // initialize all values with "-1" to cause failure on expected use
-      double width = -1.;
-      double botWidth = -1.;
-      double topWidth = -1.;
-      double height   = -1.;
-      double xOffset  = -1.;
-      double yOffset  = -1.;
-      double pitch    = -1.;
-      double diameter   = -1.;
-      double tmp_cond2  = -1.;
-      int indx      = -1;
-      int number    = -1;
-      int primitive = -1;
-      int type      = -1;
-      char name[500];
-
-      // Name of the conductor
-      sscanf (line, "%*s %s", name);
-
-      // Type of conductor
-      if ( strstr (line, "RectangleCon") != NULL )
-        type = primitive = RECTANGLE;
-      else if ( strstr (line, "TrapezoidCon") != NULL )
-        {
-          primitive = POLYGON;
-          type = 'T';
-        }
-      else if ( strstr (line, "CircleCon") != NULL )
-        {
-          primitive = CIRCLE;
-          type = 'C';
-        }
-      // Set the default number of conductors to 1
-      number = 1;
-      while ( 1 ) {
-        //-----------------------------------------------
-        // Conductivity of conductor set
-        //-----------------------------------------------
-        if ( strstr (line, "-conductivity") != NULL ) {
-          parseVal (line, 1, tmp);
-          conversion (tmp, siemensPmeter, tmp_cond2);
-        }
+    else {
+      printf ("Warning: %s line %d: %.*s ignored\n", source_name, line,
+              (int)words[0].length, words[0].text);
+      continue;
+    }
 
-        //-----------------------------------------------
-        // Width of each rectangular conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-width") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, width);
-        }
+    if (status != SUCCESS) {
+      printf ("*** Error: %s line %d: incomplete %.*s %s\n", source_name,
+              line, (int)words[0].length, words[0].text, name);
+      return (FAIL);
+    }
+  }
 
-        //-----------------------------------------------
-        // Top width of each trapezoidal conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-topWidth") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, topWidth);
-        }
+  return (SUCCESS);
+}
 
-        //-----------------------------------------------
-        // Bottom width of each trapezoidal conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-bottomWidth") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, botWidth);
-        }
 
-        //-----------------------------------------------
-        // Height of each rectangular or trapezoidal conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-height") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, height);
-        }
+/*
+ FUNCTION NAME:  nmmtl_xsctn_command()
 
-        //-----------------------------------------------
-        // Diameter of each circular conductor
-        //-----------------------------------------------
-        if ( strstr (line, "-diameter") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, diameter);
-        }
+ FUNCTIONAL DESCRIPTION:
 
-        //-----------------------------------------------
-        // Number of conductors to the set
-        //-----------------------------------------------
-        if ( strstr (line, "-number") != NULL )
-          sscanf (line, "%*s %d", &number);
-
-        //-----------------------------------------------
-        // X-offset for placing the first conductor in the set
-        //-----------------------------------------------
-        if ( strstr (line, "-xOff") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, xOffset);
-        }
+ Split the next command of .xsctn text into words, Tcl fashion: words
+ are separated by blanks, a command ends at a newline or ';' that is not
+ escaped with '\', a "#" in place of a command starts a comment, and
+ "..." or {...} group blanks into a word (the quotes or braces are not
+ part of it).  Words point into the text; nothing is copied.
 
-        //-----------------------------------------------
-        // Y-offset for placing the first conductor in the set
-        //-----------------------------------------------
-        if ( strstr (line, "-yOff") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, yOffset);
-        }
+ FORMAL PARAMETERS:
 
-        //-----------------------------------------------
-        // Spacing for the conductor set
-        //-----------------------------------------------
-        if ( strstr (line, "-pitch") != NULL ) {
-          parseVal (line, 1, tmp);
-          if ( (sscanf (tmp, "%lf%s", &arg1, arg2)) < 2 )
-            strcat (tmp, defaultUnits);
-          conversion (tmp, meters, pitch);
-        }
+ scanner : position in the text, advanced past the command
+ words : output: XSCTN_MAX_WORDS entries for the words
+ line : output: line the command starts on
 
-        //-----------------------------------------------
-        // Break is this is the end of the conductor definition
-        //-----------------------------------------------
-        if ( (strrchr (line, '\\')) == 0 )
-    ///       if ( line[strlen(line)-2] != '\\' )
-          break;
-        if ( fgets (line, GPGE_MAX, inpf) == NULL ) {
-          printf ("*** EOF incountered -- imcomplete input file %s\n", fullfilespec);
-          return 0;
-        }
+ RETURN VALUE:
 
-        if ( strlen(line) < 1 )
-          continue;
-      }
+ number of words, 0 at the end of the text, -1 if the command has more
+ than XSCTN_MAX_WORDS words
 
-      double cx = xOffset;
-      double cy = yCoord + yOffset;
-      // initialize "tw" and "length" values that will most likely lead to
-      // obvious failure, if used unexpectedly
-      double tw     = -1.;
-      double length = -1.;
+ */
+static int nmmtl_xsctn_command(XSCTN_SCANNER_P scanner, XSCTN_WORD_P words,
+                               int *line) {
+  const char *p = scanner->next;
+  const char *end = scanner->end;
+  const char *start;
+  int number_words = 0;
+  int depth;
+  char quote;
+
+  *line = scanner->line;
+
+  while (p < end) {
+    // blanks, and escaped newlines which continue the command
+    if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\f' || *p == '\v') {
+      p++;
+      continue;
+    }
+    if (*p == '\\' && p + 1 < end && (p[1] == '\n' || p[1] == '\r')) {
+      p++;
+      if (*p == '\r' && p + 1 < end && p[1] == '\n') p++;
+      p++;
+      scanner->line++;
+      continue;
+    }
 
-      //-----------------------------------------------------
-      // Caculate the total width of the conductor set.
-      // Check for the minimum width of the conductor.
-      //-----------------------------------------------------
-      switch ( primitive ) {
-      case RECTANGLE:
-        tw = xOffset + (number - 1) * pitch + width;
-        if ( width < minimum_dimension )
-          minimum_dimension = width;
-        if ( height < minimum_dimension )
-          minimum_dimension = height;
-        break;
-      case POLYGON:
-        width = botWidth;
-        if ( topWidth > width )
-          width = topWidth;
-        tw = xOffset + (number - 1) * pitch + width;
-        width *= 0.5;
-        if(topWidth < minimum_dimension)
-          minimum_dimension = topWidth;
-        if(botWidth < minimum_dimension)
-          minimum_dimension = botWidth;
+    // end of a command
+    if (*p == '\n' || *p == ';') {
+      if (*p++ == '\n')
+        scanner->line++;
+      if (number_words > 0)
         break;
-      case CIRCLE:
-        tw = xOffset + (number - 1) * pitch + diameter;
-        if ( diameter < minimum_dimension )
-          minimum_dimension = diameter;
-        break;
-      }
-      if ( tw > totWidth ) {
-        totWidth = tw;
-        printf ("Total width: %g\n", totWidth);
-      }
+      *line = scanner->line;
+      continue;
+    }
 
-      for ( indx = 0; indx < number; ++indx ) {
-        c_temp = (struct contour *)malloc(sizeof(struct contour));
-        c_temp->next = NULL;
-        c_temp->points = NULL;
-        c_temp->name[0] = '\0';
-        c_temp->x0 = cx;
-        c_temp->y0 = cy;
-        switch ( primitive ) {
-        case RECTANGLE:
-          //-----------------------------------------------
-          // c_temp.x0  - left x coordinate of the rectangle
-          // c_temp.y0  - lower y coordinate of the rectangle
-          // c_temp.x1  - right x coordinate of the rectangle
-          // c_temp.y1  - upper y coordinate of the rectangle
-          //------------------------------------------------
-          c_temp->x1 = cx + width;
-          c_temp->y1 = cy + height;
-          break;
-        case CIRCLE:
-          //-----------------------------------------------
-          // c_temp.x0  - center x point of the circle
-          // c_temp.y0  - center y point of the circle
-          // c_temp.x1  - radius of the circle
-          //------------------------------------------------
-          c_temp->x0 += diameter * 0.5;
-          c_temp->y0 += diameter * 0.5;
-          c_temp->x1 = diameter * 0.5;
-          c_temp->y1 = 0;
+    // comment
+    if (number_words == 0 && *p == '#') {
+      while (p < end && *p != '\n')
+        p++;
+      continue;
+    }
+
+    if (number_words == XSCTN_MAX_WORDS) {
+      // skip the rest of the command and report it
+      while (p < end && *p != '\n')
+        p++;
+      scanner->next = p;
+      return (-1);
+    }
+
+    if (*p == '"' || *p == '{') {
+      quote = *p == '"' ? '"' : '}';
+      depth = 1;
+      start = ++p;
+      while (p < end) {
+        if (*p == '\n')
+          scanner->line++;
+        if (*p == '\\' && p + 1 < end)
+          p++;
+        else if (quote == '}' && *p == '{')
+          depth++;
+        else if (*p == quote && --depth == 0)
           break;
-        case POLYGON:
-          //-----------------------------------------------
-          // c_temp.x0  - lengh of the line segments of the polygon
-          // c_temp.y0  - lower y coordinate of the polygon
-          // c_temp.x1  - 0
-          // c_temp.y1  - upper y coordinate of the rectangle
-          //------------------------------------------------
-          struct polypoints *pt, *ppt;
+        p++;
+      }
+      words[number_words].text = start;
+      words[number_words].length = (size_t)(p - start);
+      if (p < end)
+        p++;
+    }
+    else {
+      start = p;
+      while (p < end && *p != ' ' && *p != '\t' && *p != '\r' &&
+             *p != '\n' && *p != ';' &&
+             !(*p == '\\' && p + 1 < end && (p[1] == '\n' || p[1] == '\r')))
+        p++;
+      words[number_words].text = start;
+      words[number_words].length = (size_t)(p - start);
+    }
+    number_words++;
+  }
 
-          c_temp->x0 = 0.0;
-          c_temp->x1 = 0.0;
-          c_temp->y1 = cy + height;
+  scanner->next = p;
+  return (number_words);
+}
 
-          //------------------------------------------------
-          // Create the line-segments that define the polygon.
-          //------------------------------------------------
-          c_temp->points = pt = (struct polypoints *)malloc(sizeof(struct polypoints));
-          pt->x = cx + width - botWidth * 0.5;
-          pt->y = cy;
 
-          pt->next = ppt = (struct polypoints *)malloc(sizeof(struct polypoints));
-          ppt->x = cx + width - topWidth * 0.5;
-          ppt->y = cy + height;
+/*
+ FUNCTION NAME:  nmmtl_xsctn_word_is()
 
-          length = sqrt(pow(fabs(ppt->x - pt->x), 2.0) +
-            pow(fabs(ppt->y - pt->y), 2.0));
+ FUNCTIONAL DESCRIPTION:
 
-          /* add segment length to perimeter */
-          c_temp->x0 += length;
+ Compare a word against a keyword.
 
-          /* keep track of smallest dimension */
-          if(length < minimum_dimension)
-            minimum_dimension = length;
+ FORMAL PARAMETERS:
 
-          ppt->next = pt = (struct polypoints *)malloc(sizeof(struct polypoints));
-          pt->x = cx + width + topWidth * 0.5;
-          pt->y = cy + height;
+ word : the word
+ keyword : null terminated keyword
 
-          length = sqrt(pow(fabs(ppt->x - pt->x), 2.0) +
-            pow(fabs(ppt->y - pt->y), 2.0));
+ RETURN VALUE:
 
-          /* add segment length to perimeter */
-          c_temp->x0 += length;
+ TRUE if they are the same
 
-          /* keep track of smallest dimension */
-          if(length < minimum_dimension)
-            minimum_dimension = length;
+ */
+static int nmmtl_xsctn_word_is(XSCTN_WORD_P word, const char *keyword) {
+  return (strlen(keyword) == word->length &&
+          memcmp(word->text, keyword, word->length) == 0);
+}
 
-          pt->next = ppt = (struct polypoints *)malloc(sizeof(struct polypoints));
-          ppt->x = cx + width + botWidth * 0.5;
-          ppt->y = cy;
 
-          length = sqrt(pow(fabs(ppt->x - pt->x), 2.0) +
-            pow(fabs(ppt->y - pt->y), 2.0));
+/*
+ FUNCTION NAME:  nmmtl_xsctn_value()
 
-          /* add segment length to perimeter */
-          c_temp->x0 += length;
+ FUNCTIONAL DESCRIPTION:
 
-          /* keep track of smallest dimension */
-          if(length < minimum_dimension)
-            minimum_dimension = length;
+ Copy a word into a null terminated value for conversion(), appending
+ the given units when the word is a bare number.
 
-          ppt->next = pt = (struct polypoints *)malloc(sizeof(struct polypoints));
-          pt->x = cx + width - botWidth * 0.5;
-          pt->y = cy;
+ FORMAL PARAMETERS:
 
-          length = sqrt(pow(fabs(ppt->x - pt->x), 2.0) +
-            pow(fabs(ppt->y - pt->y), 2.0));
+ word : the word
+ default_units : units for a bare number, may be ""
+ value : output: XSCTN_VALUE_SIZE characters
 
-          /* add segment length to perimeter */
-          c_temp->x0 += length;
+ RETURN VALUE:
 
-          /* keep track of smallest dimension */
-          if(length < minimum_dimension)
-            minimum_dimension = length;
+ SUCCESS, FAIL if the word is too long
 
-          pt->next = NULL;
-          break;
-        default:
-          printf ("***** Should never get here!!! Invalid primitive type!! *****\n");
-        }
+ */
+static int nmmtl_xsctn_value(XSCTN_WORD_P word, const char *default_units,
+                             char *value) {
+  char *rest;
 
-        // RECTANGLE, POLYGON, or CIRCLE
-        c_temp->primitive = primitive;
-
-        //----------------------------------------------------
-        // Check if this is a conductor that should be defined as a ground wire.
-        //----------------------------------------------------
-        if (strncmp(name, "gr", 2)) {
-          c_temp->conductivity = tmp_cond2;
-          c_temp->next = *signals;
-          *signals = c_temp;
-          sprintf(c_temp->name, "%s%c%d", name, type, *num_signals);
-          (*num_signals)++;
-          printf("Conductivity %s = %g siemens/meter\n",
-                 c_temp->name,
-                 c_temp->conductivity);
-        } else {
-          c_temp->next = *groundwires;
-          c_temp->conductivity = 0.;
-          c_temp->name[0] = '\0';
-          *groundwires = c_temp;
-          (*num_grounds)++;
-        }
-        cx += pitch;
-      }
-    }
-    if ( fgets (line, GPGE_MAX, inpf) == NULL )
-      break;
+  if (word->length + strlen(default_units) >= XSCTN_VALUE_SIZE)
+    return (FAIL);
 
-    if ( strlen(line) < 1 )
-      continue;
-  }
+  memcpy (value, word->text, word->length);
+  value[word->length] = '\0';
 
-  d_temp = *dielectrics;
-  while ( d_temp != NULL ) {
-    if ( d_temp->x0 == 0 && d_temp->x1 == 0 ) {
-      d_temp->x0 = -totWidth;
-      d_temp->x1 = d_temp->x0 + 3.0 * totWidth;
-    }
-    d_temp = d_temp->next;
-  }
+  // anything after the number is taken to be units
+  strtod (value, &rest);
+  while (*rest == ' ' || *rest == '\t')
+    rest++;
+  if (*rest == '\0')
+    strcat (value, default_units);
 
-  /* Offset all y dimensions to make top of bottom ground plane at */
-  /* y=0.0 */
+  return (SUCCESS);
+}
 
-  if (offset != 0.0) {
-    status = nmmtl_set_offset(offset, *dielectrics, *signals, *groundwires);
-    if (status != SUCCESS) {
-      printf("ERROR in nmmtl_set_offset: Cannot set offset\n");
-      exit(FAIL);
-    }
-  }
-  highest_dielectric -= offset;
-
-  /* now, check to see if ground planes were really specified by */
-  /* drawing rectanges.  If so, the bottom ground plane will be */
-  /* now at y=0, since the offset operation was completed. */
-
-  /* ordinarily there should be one of each, but the following code */
-  /* is extra robust, just in case there are more. */
-
-  if (*gnd_planes == 0 && *groundwires != NULL) {
-    /* loop and take off all elements on groundwire list which */
-    /* would qualify as lower ground planes.  If there is more */
-    /* than one, so warn the user. */
-
-    c_prev = NULL;
-    c_temp = *groundwires;
-    while(c_temp != NULL) {
-      if(c_temp->primitive == 'R') {
-        if(c_temp->y1 == 0.0) {
-          lower_ground_planes++;
-          if(lower_ground_planes > 1) {
-            printf ("**** Too many lower groundplanes...reset to 1\n");
-          }
-          *gnd_planes = 1;
-          (*num_grounds)--;
-
-          /* save fullest extent of x dimensions of ground plane */
-          if(ground_x_min > c_temp->x0) ground_x_min = c_temp->x0;
-          if(ground_x_max < c_temp->x1) ground_x_max = c_temp->x1;
-
-          /* record ground plane thickness */
-          *bottom_ground_plane_thickness = c_temp->y1 - c_temp->y0;
-
-          if(c_prev == NULL) {
-            /* remove first item from the list */
-            *groundwires = c_temp->next;
-            free(c_temp);
-            c_temp = *groundwires;
-          } else {
-            /* remove from list */
-            c_prev->next = c_temp->next;
-            free(c_temp);
-            c_temp = c_prev->next;
-          }
-        } else {
-          c_prev = c_temp; c_temp = c_temp->next;
-        }
-      } else {
-        c_prev = c_temp; c_temp = c_temp->next;
-      }
-    }
-  }
 
+/*
+ FUNCTION NAME:  nmmtl_xsctn_option()
+
+ FUNCTIONAL DESCRIPTION:
 
-  /* Now try to find an upper ground plane - its x dimensions must */
-  /* match exactly */
+ Convert the value of one object option and store it in the matching
+ field of spec, as listed in xsctn_options.  Options not in the list are
+ ignored.
 
-  if(*gnd_planes == 1 && *groundwires != NULL) {
-    /* loop and take off all elements on groundwire list which */
-    /* would qualify as an upper ground planes.  If there is more */
-    /* than one, so warn the user. */
+ FORMAL PARAMETERS:
 
-    c_prev = NULL;
-    c_temp = *groundwires;
-    while(c_temp != NULL) {
-      if(c_temp->primitive == 'R') {
-        if (c_temp->y0 == highest_dielectric &&
-        ground_x_min == c_temp->x0 && ground_x_max == c_temp->x1 ) {
-          (*num_grounds)--;
+ option : the option word, such as -width
+ word : its value
+ default_units : units for bare dimensions
+ spec : the object being collected
 
-          upper_ground_planes++;
-          if(upper_ground_planes > 1)
-          {
-            printf ("**** Too many upper groundplanes...reset to 2\n");
-          }
-          *gnd_planes = 2;
-
-          /* record ground plane thickness */
-          *top_ground_plane_thickness = c_temp->y1 - c_temp->y0;
-
-          /* remove from the list of groundwires */
-          if(c_prev == NULL) {
-            /* remove first item from the list */
-            *groundwires = c_temp->next;
-            free(c_temp);
-            c_temp = *groundwires;
-          } else {
-            /* remove from list */
-            c_prev->next = c_temp->next;
-            free(c_temp);
-            c_temp = c_prev->next;
-          }
-        } else {
-          c_prev = c_temp; c_temp = c_temp->next;
-        }
-      } else {
-        c_prev = c_temp; c_temp = c_temp->next;
-      }
-    }
-  }
+ RETURN VALUE:
 
-  /* warning to the user if bottom ground plane is missing - it
-     will go on and assume one exists, below the lowest dielectric layer */
-  if(*gnd_planes < 1) {
-    printf ("* Warning: There isn't a groundplane\n");
-  }
+ SUCCESS, FAIL if the value cannot be converted
+
+ */
+static int nmmtl_xsctn_option(XSCTN_WORD_P option, XSCTN_WORD_P word,
+                              const char *default_units,
+                              XSCTN_OBJECT_P spec) {
+  char value[XSCTN_VALUE_SIZE];
+  char *field;
+  double dbl;
+  size_t i;
 
-  *half_minimum_dimension = .5 * minimum_dimension;
+  for (i = 0; i < sizeof(xsctn_options) / sizeof(xsctn_options[0]); i++) {
+    if (nmmtl_xsctn_word_is(option, xsctn_options[i].option))
+      break;
+  }
+  if (i == sizeof(xsctn_options) / sizeof(xsctn_options[0]))
+    return (SUCCESS);
+
+  field = (char *)spec + xsctn_options[i].offset;
+
+  switch (xsctn_options[i].kind) {
+  case XSCTN_LENGTH:
+    if (nmmtl_xsctn_value(word, default_units, value) != SUCCESS ||
+        conversion (value, (char *)"meters", dbl) != SUCCESS)
+      return (FAIL);
+    *(double *)field = dbl;
+    break;
+  case XSCTN_CONDUCTIVITY:
+    if (nmmtl_xsctn_value(word, "siemens/meter", value) != SUCCESS ||
+        conversion (value, (char *)"siemens/meter", dbl) != SUCCESS)
+      return (FAIL);
+    *(double *)field = dbl;
+    break;
+  case XSCTN_NUMBER:
+    if (nmmtl_xsctn_value(word, "", value) != SUCCESS)
+      return (FAIL);
+    *(double *)field = atof (value);
+    break;
+  case XSCTN_INTEGER:
+    if (nmmtl_xsctn_value(word, "", value) != SUCCESS)
+      return (FAIL);
+    *(int *)field = atoi (value);
+    break;
+  }
 
-  /* all done, return status of close_files */
-  fclose (inpf);
   return (SUCCESS);
 }
@@ -0,0 +1,822 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Writes the field plot data of a solve on a thread of its own, so that
+  formatting it and writing it to the plot file overlap with the solves
+  of the next conductors, and the binary form of the plot file.
+
+  nmmtl_plot_writer_start starts the writer thread for one mesh;
+  nmmtl_plot_writer_queue hands it a copy of the charge distribution of
+  each conductor as it is solved, and nmmtl_plot_writer_finish waits for
+  it to write them all.  The mesh must not be freed before then.  In the
+  text form the writer calls nmmtl_write_plot_data.
+
+  The binary form (OUTPUT_PLOT_BINARY) is a sequence of records, each a
+  four character tag, a 64 bit byte count and that many bytes, with
+  integers and doubles as the machine holds them:
+
+  "NMPL"  version (int 1), 0x01020304 (int, to tell the byte order),
+          display units (int, a UNITS_* constant), ground planes (int),
+          lower and top ground plane thickness (doubles)
+  "EXTN"  upper, lower, right and left extent (doubles)
+  "CONT"  number of contours (int), then for each its role (int: 0
+          signal, 1 ground, 2 dielectric), shape (int: 'C' circle or 'P'
+          polygon) and number of points (int), then the radius and origin
+          of a circle (3 doubles) or the x,y of the points of a polygon
+  "MESH"  number of elements (int), nodes per element (int), number of
+          nodes (int), then in columns: the conductor of each element
+          (ints, -1 for a dielectric element), the nodes of each element
+          (ints), their x and their y (doubles), the edge flags at the
+          two ends of each element (ints) and the edge nu (doubles, 0 where
+          it is not an edge)
+  "SOLN"  active line name (SIZE_SIG_NAME characters), number of nodes
+          (int), then the charge at each node (doubles)
+
+  EXTN, CONT and MESH are written once for each mesh solved, then one
+  SOLN for each conductor.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* a record being put together before it is written */
+typedef struct plot_record
+{
+  char *data;
+  size_t length;
+  size_t allocated;
+} PLOT_RECORD, *PLOT_RECORD_P;
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void *nmmtl_plot_writer_thread(void *arg);
+static void nmmtl_plot_writer_write(PLOT_WRITER_P writer,
+                                    PLOT_SOLUTION_P solution);
+static void nmmtl_plot_mesh(PLOT_WRITER_P writer);
+static void nmmtl_plot_add(PLOT_RECORD_P record, const void *data,
+                           size_t length);
+static void nmmtl_plot_add_int(PLOT_RECORD_P record, int value);
+static void nmmtl_plot_add_double(PLOT_RECORD_P record, double value);
+static void nmmtl_plot_contour(PLOT_RECORD_P record, int role,
+                               struct contour *conductor);
+static void nmmtl_plot_write(FILE *file, const char *tag,
+                             PLOT_RECORD_P record);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_start
+
+  FUNCTIONAL DESCRIPTION:
+
+  Start the thread which writes the plot data of a mesh.  In the binary
+  form it writes the MESH record first.
+
+  FORMAL PARAMETERS:
+
+  FILE *file                        - the plot file
+  int binary                        - TRUE for the binary form
+  int conductor_counter             - how many signals
+  ELEMENT_STORE_P element_store     - the elements of the mesh
+  CONDUCTOR_DATA_P conductor_data   - and of each conductor
+  int node_point_counter            - number of nodes
+
+  RETURN VALUE:
+
+  the writer, or NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  writer = nmmtl_plot_writer_start(plotFile,binary,conductor_counter,
+                                   element_store,conductor_data,
+                                   node_point_counter);
+
+  */
+
+PLOT_WRITER_P nmmtl_plot_writer_start(FILE *file,
+                                      int binary,
+                                      int conductor_counter,
+                                      ELEMENT_STORE_P element_store,
+                                      CONDUCTOR_DATA_P conductor_data,
+                                      int node_point_counter)
+{
+  PLOT_WRITER_P writer;
+
+  writer = (PLOT_WRITER_P)calloc(1,sizeof(PLOT_WRITER));
+  if(writer == NULL) return(NULL);
+
+  writer->file = file;
+  writer->binary = binary;
+  writer->conductor_counter = conductor_counter;
+  writer->element_store = element_store;
+  writer->conductor_data = conductor_data;
+  writer->node_point_counter = node_point_counter;
+  writer->element_order = ELEMENT_ORDER;
+  pthread_mutex_init(&writer->lock,NULL);
+  pthread_cond_init(&writer->ready,NULL);
+
+  /* without a thread, the data is written as it is queued */
+  writer->threaded = pthread_create(&writer->thread,NULL,
+                                    nmmtl_plot_writer_thread,writer) == 0;
+  if(!writer->threaded && binary) nmmtl_plot_mesh(writer);
+
+  return(writer);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_queue
+
+  FUNCTIONAL DESCRIPTION:
+
+  Hand the writer the charge distribution of a conductor.  It keeps a
+  copy, so the caller can go on to the next conductor with sigma_vector.
+
+  FORMAL PARAMETERS:
+
+  PLOT_WRITER_P writer    - from nmmtl_plot_writer_start
+  CONTOURS_P signal       - the active signal
+  double *sigma_vector    - the charge at each node
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_writer_queue(writer,activeLine,sigma_vector);
+
+  */
+
+void nmmtl_plot_writer_queue(PLOT_WRITER_P writer,
+                             CONTOURS_P signal,
+                             double *sigma_vector)
+{
+  PLOT_SOLUTION solution;
+  PLOT_SOLUTION_P queued;
+
+  if(writer == NULL) return;
+
+  queued = (PLOT_SOLUTION_P)malloc(sizeof(PLOT_SOLUTION));
+  if(queued != NULL)
+    queued->sigma_vector = (double *)malloc(sizeof(double) *
+                                            (size_t)writer->node_point_counter);
+
+  /* short of memory, or of a thread, write it now */
+  if(!writer->threaded || queued == NULL || queued->sigma_vector == NULL)
+  {
+    if(queued != NULL)
+    {
+      free(queued->sigma_vector);
+      free(queued);
+    }
+    if(writer->threaded) nmmtl_plot_writer_drain(writer);
+    solution.signal = signal;
+    solution.sigma_vector = sigma_vector;
+    nmmtl_plot_writer_write(writer,&solution);
+    return;
+  }
+
+  queued->signal = signal;
+  memcpy(queued->sigma_vector,sigma_vector,
+         sizeof(double) * (size_t)writer->node_point_counter);
+  queued->next = NULL;
+
+  pthread_mutex_lock(&writer->lock);
+  if(writer->last != NULL) writer->last->next = queued;
+  else writer->first = queued;
+  writer->last = queued;
+  pthread_cond_broadcast(&writer->ready);
+  pthread_mutex_unlock(&writer->lock);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_drain
+
+  FUNCTIONAL DESCRIPTION:
+
+  Wait until the writer has written everything queued so far.
+
+  FORMAL PARAMETERS:
+
+  PLOT_WRITER_P writer    - from nmmtl_plot_writer_start
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_writer_drain(writer);
+
+  */
+
+void nmmtl_plot_writer_drain(PLOT_WRITER_P writer)
+{
+  if(writer == NULL || !writer->threaded) return;
+
+  pthread_mutex_lock(&writer->lock);
+  while(writer->first != NULL || writer->writing)
+    pthread_cond_wait(&writer->ready,&writer->lock);
+  pthread_mutex_unlock(&writer->lock);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_finish
+
+  FUNCTIONAL DESCRIPTION:
+
+  Wait for the writer to write everything queued, stop its thread and
+  free it.  After this the mesh may be freed.
+
+  FORMAL PARAMETERS:
+
+  PLOT_WRITER_P writer    - from nmmtl_plot_writer_start, or NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_writer_finish(writer);
+
+  */
+
+void nmmtl_plot_writer_finish(PLOT_WRITER_P writer)
+{
+  if(writer == NULL) return;
+
+  if(writer->threaded)
+  {
+    pthread_mutex_lock(&writer->lock);
+    writer->finished = TRUE;
+    pthread_cond_broadcast(&writer->ready);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread,NULL);
+  }
+
+  pthread_cond_destroy(&writer->ready);
+  pthread_mutex_destroy(&writer->lock);
+  free(writer);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_thread
+
+  FUNCTIONAL DESCRIPTION:
+
+  The writer thread: writes the charge distributions as they are
+  queued, until it is finished and there are no more.
+
+  FORMAL PARAMETERS:
+
+  void *arg   - the PLOT_WRITER
+
+  RETURN VALUE:
+
+  NULL
+
+  CALLING SEQUENCE:
+
+  pthread_create(&writer->thread,NULL,nmmtl_plot_writer_thread,writer);
+
+  */
+
+static void *nmmtl_plot_writer_thread(void *arg)
+{
+  PLOT_WRITER_P writer = (PLOT_WRITER_P)arg;
+  PLOT_SOLUTION_P solution;
+
+  /* the elements have as many nodes as the solving thread's do */
+  ELEMENT_ORDER = writer->element_order;
+
+  if(writer->binary) nmmtl_plot_mesh(writer);
+
+  pthread_mutex_lock(&writer->lock);
+  for(;;)
+  {
+    while(writer->first == NULL && !writer->finished)
+      pthread_cond_wait(&writer->ready,&writer->lock);
+    if(writer->first == NULL) break;
+
+    solution = writer->first;
+    writer->first = solution->next;
+    if(writer->first == NULL) writer->last = NULL;
+    writer->writing = TRUE;
+    pthread_mutex_unlock(&writer->lock);
+
+    nmmtl_plot_writer_write(writer,solution);
+    free(solution->sigma_vector);
+    free(solution);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->writing = FALSE;
+    pthread_cond_broadcast(&writer->ready);
+  }
+  pthread_mutex_unlock(&writer->lock);
+
+  fflush(writer->file);
+  return(NULL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_writer_write
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the plot data of one conductor, as text or a SOLN record.
+
+  FORMAL PARAMETERS:
+
+  PLOT_WRITER_P writer        - the writer
+  PLOT_SOLUTION_P solution    - the active signal and its charges
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_writer_write(writer,solution);
+
+  */
+
+static void nmmtl_plot_writer_write(PLOT_WRITER_P writer,
+                                    PLOT_SOLUTION_P solution)
+{
+  PLOT_RECORD record = { NULL, 0, 0 };
+  char name[SIZE_SIG_NAME];
+
+  if(!writer->binary)
+  {
+    nmmtl_write_plot_data(solution->signal,writer->conductor_counter,
+                          writer->element_store,writer->conductor_data,
+                          solution->sigma_vector,writer->file);
+    return;
+  }
+
+  memset(name,0,sizeof(name));
+  memcpy(name,solution->signal->name,
+         strnlen(solution->signal->name,sizeof(name) - 1));
+  nmmtl_plot_add(&record,name,sizeof(name));
+  nmmtl_plot_add_int(&record,writer->node_point_counter);
+  nmmtl_plot_add(&record,solution->sigma_vector,
+                 sizeof(double) * (size_t)writer->node_point_counter);
+  nmmtl_plot_write(writer->file,"SOLN",&record);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_mesh
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the MESH record: the elements of the mesh, in columns.
+
+  FORMAL PARAMETERS:
+
+  PLOT_WRITER_P writer    - the writer
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_mesh(writer);
+
+  */
+
+static void nmmtl_plot_mesh(PLOT_WRITER_P writer)
+{
+  PLOT_RECORD record = { NULL, 0, 0 };
+  CELEMENTS_P cel, cel_end;
+  DELEMENTS_P die, die_end;
+  int cond_num, number_elements, column, i;
+
+  number_elements = writer->element_store->number_delements;
+  for(cond_num = 0; cond_num <= writer->conductor_counter; cond_num++)
+    number_elements += writer->conductor_data[cond_num].number_elements;
+
+  nmmtl_plot_add_int(&record,number_elements);
+  nmmtl_plot_add_int(&record,ELEMENT_PTS);
+  nmmtl_plot_add_int(&record,writer->node_point_counter);
+
+  /* the conductor elements in the order nmmtl_write_plot_data gives
+     them, then the dielectric ones, a column at a time */
+  for(column = 0; column < 6; column++)
+  {
+    for(cond_num = 0; cond_num <= writer->conductor_counter; cond_num++)
+    {
+      cel = writer->conductor_data[cond_num].elements;
+      cel_end = cel + writer->conductor_data[cond_num].number_elements;
+      for(; cel < cel_end; cel++)
+      {
+        switch(column)
+        {
+        case 0:
+          nmmtl_plot_add_int(&record,cond_num);
+          break;
+        case 1:
+          for(i = 0; i < ELEMENT_PTS; i++)
+            nmmtl_plot_add_int(&record,cel->node[i]);
+          break;
+        case 2:
+          nmmtl_plot_add(&record,cel->xpts,sizeof(double) * (size_t)ELEMENT_PTS);
+          break;
+        case 3:
+          nmmtl_plot_add(&record,cel->ypts,sizeof(double) * (size_t)ELEMENT_PTS);
+          break;
+        case 4:
+          nmmtl_plot_add(&record,cel->edge,sizeof(cel->edge));
+          break;
+        default:
+          for(i = 0; i < 2; i++)
+            nmmtl_plot_add_double(&record,cel->edge[i] ? cel->nu[i] : 0.0);
+          break;
+        }
+      }
+    }
+
+    die = writer->element_store->delements;
+    die_end = die + writer->element_store->number_delements;
+    for(; die < die_end; die++)
+    {
+      switch(column)
+      {
+      case 0:
+        nmmtl_plot_add_int(&record,-1);
+        break;
+      case 1:
+        for(i = 0; i < ELEMENT_PTS; i++)
+          nmmtl_plot_add_int(&record,die->node[i]);
+        break;
+      case 2:
+        nmmtl_plot_add(&record,die->xpts,sizeof(double) * (size_t)ELEMENT_PTS);
+        break;
+      case 3:
+        nmmtl_plot_add(&record,die->ypts,sizeof(double) * (size_t)ELEMENT_PTS);
+        break;
+      case 4:
+        nmmtl_plot_add_int(&record,FALSE);
+        nmmtl_plot_add_int(&record,FALSE);
+        break;
+      default:
+        nmmtl_plot_add_double(&record,0.0);
+        nmmtl_plot_add_double(&record,0.0);
+        break;
+      }
+    }
+  }
+
+  nmmtl_plot_write(writer->file,"MESH",&record);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_binary_header
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the NMPL record which starts a binary plot file: the binary
+  counterpart of plotFileInitialization.
+
+  FORMAL PARAMETERS:
+
+  FILE *plotFile                        - the plot file
+  int units                             - display units, UNITS_*
+  int gnd_planes                        - number of ground planes
+  double top_ground_plane_thickness
+  double bottom_ground_plane_thickness
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_binary_header(plotFile,units,gnd_planes,
+                           top_ground_plane_thickness,
+                           bottom_ground_plane_thickness);
+
+  */
+
+void nmmtl_plot_binary_header(FILE *plotFile,
+                              int units,
+                              int gnd_planes,
+                              double top_ground_plane_thickness,
+                              double bottom_ground_plane_thickness)
+{
+  PLOT_RECORD record = { NULL, 0, 0 };
+
+  nmmtl_plot_add_int(&record,1);
+  nmmtl_plot_add_int(&record,0x01020304);
+  nmmtl_plot_add_int(&record,units);
+  nmmtl_plot_add_int(&record,gnd_planes);
+  nmmtl_plot_add_double(&record,bottom_ground_plane_thickness);
+  nmmtl_plot_add_double(&record,top_ground_plane_thickness);
+  nmmtl_plot_write(plotFile,"NMPL",&record);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_binary_geometry
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write the EXTN and CONT records of a mesh: the extents of the cross
+  section and the signal, ground and dielectric contours.
+
+  FORMAL PARAMETERS:
+
+  FILE *plotFile                    - the plot file
+  double upper, lower, right, left  - the extents
+  struct contour *signals           - the signals
+  struct contour *groundwires       - the ground wires
+  struct dielectric *dielectrics    - the dielectrics
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_binary_geometry(plotFile,upper,lower,right,left,signals,
+                             groundwires,dielectrics);
+
+  */
+
+void nmmtl_plot_binary_geometry(FILE *plotFile,
+                                double upper,
+                                double lower,
+                                double right,
+                                double left,
+                                struct contour *signals,
+                                struct contour *groundwires,
+                                struct dielectric *dielectrics)
+{
+  PLOT_RECORD record = { NULL, 0, 0 };
+  struct contour *conductor;
+  struct dielectric *die;
+  int number;
+
+  nmmtl_plot_add_double(&record,upper);
+  nmmtl_plot_add_double(&record,lower);
+  nmmtl_plot_add_double(&record,right);
+  nmmtl_plot_add_double(&record,left);
+  nmmtl_plot_write(plotFile,"EXTN",&record);
+
+  number = 0;
+  for(conductor = signals; conductor != NULL; conductor = conductor->next)
+    number++;
+  for(conductor = groundwires; conductor != NULL; conductor = conductor->next)
+    number++;
+  for(die = dielectrics; die != NULL; die = die->next)
+    number++;
+  nmmtl_plot_add_int(&record,number);
+
+  for(conductor = signals; conductor != NULL; conductor = conductor->next)
+    nmmtl_plot_contour(&record,0,conductor);
+  for(conductor = groundwires; conductor != NULL; conductor = conductor->next)
+    nmmtl_plot_contour(&record,1,conductor);
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    nmmtl_plot_add_int(&record,2);
+    nmmtl_plot_add_int(&record,'P');
+    nmmtl_plot_add_int(&record,4);
+    nmmtl_plot_add_double(&record,die->x0);
+    nmmtl_plot_add_double(&record,die->y0);
+    nmmtl_plot_add_double(&record,die->x0);
+    nmmtl_plot_add_double(&record,die->y1);
+    nmmtl_plot_add_double(&record,die->x1);
+    nmmtl_plot_add_double(&record,die->y1);
+    nmmtl_plot_add_double(&record,die->x1);
+    nmmtl_plot_add_double(&record,die->y0);
+  }
+  nmmtl_plot_write(plotFile,"CONT",&record);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_contour
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a signal or ground contour to a CONT record, as the text plot file
+  gives it: a circle, a rectangle as a polygon of 4 points, or a polygon.
+
+  FORMAL PARAMETERS:
+
+  PLOT_RECORD_P record        - the record
+  int role                    - 0 signal, 1 ground
+  struct contour *conductor   - the contour
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_contour(&record,role,conductor);
+
+  */
+
+static void nmmtl_plot_contour(PLOT_RECORD_P record, int role,
+                               struct contour *conductor)
+{
+  struct polypoints *point;
+  int number;
+
+  nmmtl_plot_add_int(record,role);
+  switch(conductor->primitive)
+  {
+  case 'A':
+    nmmtl_plot_add_int(record,'C');
+    nmmtl_plot_add_int(record,0);
+    nmmtl_plot_add_double(record,conductor->x1);
+    nmmtl_plot_add_double(record,conductor->x0);
+    nmmtl_plot_add_double(record,conductor->y0);
+    break;
+  case 'R':
+    nmmtl_plot_add_int(record,'P');
+    nmmtl_plot_add_int(record,4);
+    nmmtl_plot_add_double(record,conductor->x0);
+    nmmtl_plot_add_double(record,conductor->y0);
+    nmmtl_plot_add_double(record,conductor->x0);
+    nmmtl_plot_add_double(record,conductor->y1);
+    nmmtl_plot_add_double(record,conductor->x1);
+    nmmtl_plot_add_double(record,conductor->y1);
+    nmmtl_plot_add_double(record,conductor->x1);
+    nmmtl_plot_add_double(record,conductor->y0);
+    break;
+  default:
+    number = 0;
+    for(point = conductor->points; point != NULL; point = point->next)
+      number++;
+    nmmtl_plot_add_int(record,'P');
+    nmmtl_plot_add_int(record,number);
+    for(point = conductor->points; point != NULL; point = point->next)
+    {
+      nmmtl_plot_add_double(record,point->x);
+      nmmtl_plot_add_double(record,point->y);
+    }
+    break;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_add
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add bytes to a record, growing it as needed.  If memory runs out the
+  record is dropped, and nmmtl_plot_write writes nothing for it.
+
+  FORMAL PARAMETERS:
+
+  PLOT_RECORD_P record    - the record
+  const void *data        - the bytes
+  size_t length           - how many
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_add(&record,data,length);
+
+  */
+
+static void nmmtl_plot_add(PLOT_RECORD_P record, const void *data,
+                           size_t length)
+{
+  size_t allocated;
+  char *grown;
+
+  if(record->allocated == (size_t)-1) return;
+
+  if(record->length + length > record->allocated)
+  {
+    allocated = record->allocated > 0 ? 2 * record->allocated : 256;
+    while(allocated < record->length + length) allocated *= 2;
+    grown = (char *)realloc(record->data,allocated);
+    if(grown == NULL)
+    {
+      free(record->data);
+      record->data = NULL;
+      record->allocated = (size_t)-1;
+      return;
+    }
+    record->data = grown;
+    record->allocated = allocated;
+  }
+
+  memcpy(record->data + record->length,data,length);
+  record->length += length;
+}
+
+static void nmmtl_plot_add_int(PLOT_RECORD_P record, int value)
+{
+  int32_t v = (int32_t)value;
+  nmmtl_plot_add(record,&v,sizeof(v));
+}
+
+static void nmmtl_plot_add_double(PLOT_RECORD_P record, double value)
+{
+  nmmtl_plot_add(record,&value,sizeof(value));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_plot_write
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write a record, its tag and byte count first, and empty it for reuse.
+
+  FORMAL PARAMETERS:
+
+  FILE *file              - the plot file
+  const char *tag         - four characters
+  PLOT_RECORD_P record    - the record
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_plot_write(file,"SOLN",&record);
+
+  */
+
+static void nmmtl_plot_write(FILE *file, const char *tag,
+                             PLOT_RECORD_P record)
+{
+  int64_t length;
+
+  if(record->allocated != (size_t)-1)
+  {
+    length = (int64_t)record->length;
+    fwrite(tag,1,4,file);
+    fwrite(&length,sizeof(length),1,file);
+    if(record->length > 0) fwrite(record->data,1,record->length,file);
+  }
+  else
+    printf("Warning: out of memory for the %s record of the plot file\n",tag);
+
+  free(record->data);
+  record->data = NULL;
+  record->length = 0;
+  record->allocated = 0;
+}
@@ -24,6 +24,7 @@
  *******************************************************************
  */
 
+#include <string.h>
 #include "nmmtl.h"
 
 /*
@@ -31,9 +32,12 @@
  **  GLOBALS
  *******************************************************************
  */
-extern FILE *plotFile;
+extern thread_local FILE *plotFile;
 
-double NON_LINEARITY_FACTOR;
+thread_local double NON_LINEARITY_FACTOR;
+thread_local double CORNER_GRADING_FACTOR;
+thread_local double PLANE_GRADING_FACTOR;
+thread_local int ELEMENT_ORDER = INTERP_ORDER;
 
 /*
  *******************************************************************
@@ -54,6 +58,11 @@ double NON_LINEARITY_FACTOR;
   data, the function returns the capacitance and inductance matricies and
   the propagation velocity and charactistic impedance arrays.
 
+  With a refinement tolerance in the settings, the mesh is refined
+  automatically until the results settle - see nmmtl_qsp_refine.cpp.
+  With a number of extrapolation levels instead, the results are
+  extrapolated from several meshes - see nmmtl_qsp_extrapolate.cpp.
+
   FORMAL PARAMETERS:
 
   1) electrostatic_induction, inductance, propagation_velocity, and
@@ -85,6 +94,15 @@ double NON_LINEARITY_FACTOR;
   double *equivalent_dielectric,
   FILE *output_file1, *output_file2
 
+  in and out:
+
+  SKIN_EFFECT_P skin_effect - the conductivities in, the resistance at
+                              1 Hz out; NULL if not wanted
+  SENSITIVITY_P sensitivity - the parameters in, the derivatives of the
+                              matrices out; NULL if not wanted
+  MESH_SETTINGS_P settings  - element order, refinement, extrapolation
+                              and grading, see nmmtl_mesh_settings_default
+
   RETURN VALUE:
 
   returns a status of FAIL or SUCCESS, or other failure status.
@@ -110,7 +128,102 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
             double *propagation_velocity,
             double *equivalent_dielectric,
             FILE *output_file1,
-            FILE *output_file2) {
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings) {
+  /* automatic mesh refinement, if the settings give the relative change
+     in the results at which it stops */
+  if(settings->refine > 0.0)
+    return(nmmtl_qsp_refine(dielectrics,signals,groundwires,gnd_planes,
+                            half_minimum_dimension,cntr_seg,pln_seg,
+                            coupling,risetime,electrostatic_induction,
+                            inductance,characteristic_impedance,
+                            propagation_velocity,equivalent_dielectric,
+                            output_file1,output_file2,skin_effect,
+                            sensitivity,settings));
+
+  /* or the results extrapolated from 2 or 3 meshes solved in parallel,
+     with 1, 1.5 and 2 times the divisions */
+  if(settings->extrapolate >= 2 &&
+     settings->extrapolate <= EXTRAPOLATE_MAX_LEVELS)
+    return(nmmtl_qsp_extrapolate(dielectrics,signals,groundwires,gnd_planes,
+                                 half_minimum_dimension,cntr_seg,pln_seg,
+                                 coupling,risetime,electrostatic_induction,
+                                 inductance,characteristic_impedance,
+                                 propagation_velocity,equivalent_dielectric,
+                                 output_file1,output_file2,skin_effect,
+                                 sensitivity,settings));
+
+  return(nmmtl_qsp_solve_mesh(dielectrics,signals,groundwires,gnd_planes,
+                              half_minimum_dimension,cntr_seg,pln_seg,
+                              coupling,risetime,(MESH_REFINEMENT_P)NULL,
+                              electrostatic_induction,inductance,
+                              characteristic_impedance,
+                              propagation_velocity,equivalent_dielectric,
+                              output_file1,output_file2,
+                              (MESH_ERROR_P)NULL,skin_effect,sensitivity,
+                              settings));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_qsp_solve_mesh
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Meshes the cross section and solves it once: the body of
+  nmmtl_qsp_calculate, which nmmtl_qsp_refine and nmmtl_qsp_extrapolate
+  also call for each mesh they solve.
+
+  FORMAL PARAMETERS:
+
+  As for nmmtl_qsp_calculate, and:
+
+  MESH_REFINEMENT_P refinement - scale factors for the divisions of the
+                                 segments, NULL to use them as they are
+  MESH_ERROR_P mesh_error      - out: the mesh error estimates, with
+                                 conductor allocated and zeroed by the
+                                 caller; NULL if not wanted
+  SKIN_EFFECT_P skin_effect    - as for nmmtl_qsp_calculate
+  SENSITIVITY_P sensitivity    - as for nmmtl_qsp_calculate
+  MESH_SETTINGS_P settings     - as for nmmtl_qsp_calculate, only the
+                                 element order and grading are used
+
+  RETURN VALUE:
+
+  returns a status of FAIL or SUCCESS, or other failure status.
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_qsp_solve_mesh(...,refinement,...,mesh_error,skin_effect,
+                                sensitivity,settings);
+
+  */
+
+int nmmtl_qsp_solve_mesh(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            MESH_REFINEMENT_P refinement,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            MESH_ERROR_P mesh_error,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings) {
   /* local variables */
   int status;
   DIELECTRIC_SEGMENTS_P dielectric_segments = NULL;
@@ -122,9 +235,9 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
   double right_of_gnd_planes;
   int conductor_counter = 0;       /* start at one, zero is ground */
   CONDUCTOR_DATA_P conductor_data;
-  DELEMENTS_P die_elements = NULL;
-  SORTED_GND_DIE_LIST_P lower_sorted_gdl;
-  SORTED_GND_DIE_LIST_P upper_sorted_gdl;
+  ELEMENT_STORE element_store;
+  SORTED_GND_DIE_LIST_P lower_sorted_gdl = NULL;
+  SORTED_GND_DIE_LIST_P upper_sorted_gdl = NULL;
   unsigned int node_point_counter = 0;
   unsigned int highest_conductor_node = 0;
   FILE *dump_file = NULL;
@@ -169,6 +282,15 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
   }
   *****/
 
+  memset(&element_store,0,sizeof(ELEMENT_STORE));
+
+  /* the order of interpolation on the elements: 1 (linear), 2
+     (quadratic) or 3 (cubic).  Elements of higher order reach the same
+     accuracy with fewer of them.  Anything else gets the default. */
+  ELEMENT_ORDER = settings->element_order;
+  if(ELEMENT_ORDER < 1 || ELEMENT_ORDER > MAX_INTERP_ORDER)
+    ELEMENT_ORDER = INTERP_ORDER;
+
   /* don't need to go through the steps of making elements if we are
      reading them from a file */
 
@@ -178,7 +300,7 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
           &coupling,&risetime,
           (CONTOURS_P *)NULL,(int *)NULL,
           &conductor_counter,&conductor_data,
-          &die_elements,&node_point_counter,
+          &element_store,&node_point_counter,
           &highest_conductor_node) != SUCCESS) return(FAIL);
 
   }
@@ -200,7 +322,7 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
     extent_data.right_cs_extent = right_of_gnd_planes;
 
     /* ---------------- write out extent data to the plot file ------------- */
-    if (plotFile != NULL) {
+    if (plotFile != NULL && !(OUTPUT_PRODUCTS & OUTPUT_PLOT_BINARY)) {
       fprintf(plotFile,"Upper Extent: %e\n",  bottom_of_top_plane);
       fprintf(plotFile,"Lower Extent: %e\n",  top_of_bottom_plane);
       fprintf(plotFile,"Right Extent: %e\n",  right_of_gnd_planes);
@@ -347,10 +469,30 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
      (int)extent_data.expand_right);
 #endif
 
+    /* grade the elements along conductor sides toward corners: each
+       element is this factor larger than the one before it, moving away
+       from the corner.  1, or anything less, leaves the sides evenly
+       divided. */
+    CORNER_GRADING_FACTOR = settings->corner_grading > 1.0 ?
+      settings->corner_grading : 1.0;
+
+    /* and likewise for the upper ground plane, away from the region
+       under the conductors */
+    PLANE_GRADING_FACTOR = settings->plane_grading > 1.0 ?
+      settings->plane_grading : 1.0;
+
+    /* - - - - - - - -  Apply any mesh refinement  - - - - - - - - - */
+    if(refinement != NULL)
+    {
+      nmmtl_refine_segments(refinement,conductor_ls,conductor_cs,
+                            dielectric_segments);
+      pln_seg = nmmtl_refine_divisions(pln_seg,refinement->conductor[0]);
+    }
+
     /* - - - - - - - -  Generate the Elements  - - - - - - - - - */
     status = nmmtl_generate_elements(conductor_counter,
              &conductor_data,
-             &die_elements,
+             &element_store,
              &node_point_counter,
              &highest_conductor_node,
              conductor_ls,conductor_cs,
@@ -360,11 +502,27 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
              bottom_of_top_plane,
              left_of_gnd_planes,right_of_gnd_planes,
              &extent_data);
+
+    /* the segments have all been turned into elements now */
+    nmmtl_free_segments(conductor_ls,conductor_cs,dielectric_segments);
+    nmmtl_free_sorted_list(lower_sorted_gdl);
+    nmmtl_free_sorted_list(upper_sorted_gdl);
+
     if(status != SUCCESS) return(status);
   }
 
+  if(mesh_error != NULL) mesh_error->nodes = node_point_counter;
+
   /* ---------------- write out contour data to the plot file ------------- */
-  if (plotFile != NULL) {
+  if (plotFile != NULL && (OUTPUT_PRODUCTS & OUTPUT_PLOT_BINARY)) {
+    /* there are no extents without the ground planes */
+    if (!retrieval_file)
+      nmmtl_plot_binary_geometry(plotFile,bottom_of_top_plane,
+                                 top_of_bottom_plane,right_of_gnd_planes,
+                                 left_of_gnd_planes,signals,groundwires,
+                                 dielectrics);
+  }
+  else if (plotFile != NULL) {
     struct contour *conductor;
     struct dielectric *dieDieDie;
     conductor = signals;
@@ -464,18 +622,54 @@ int nmmtl_qsp_calculate(struct dielectric *dielectrics,
   if (dump_file) {
     nmmtl_dump(dump_file, cntr_seg, pln_seg, coupling,risetime,
          signals, conductor_counter, conductor_data,
-         die_elements, node_point_counter,
+         &element_store, node_point_counter,
          highest_conductor_node);
   } else {
     /* - - - - - - - -  Do the kernel calculations  - - - - - - - - - */
-    status = nmmtl_qsp_kernel(conductor_counter, conductor_data, die_elements,
+    status = nmmtl_qsp_kernel(conductor_counter, conductor_data, &element_store,
             node_point_counter, highest_conductor_node,
             half_minimum_dimension,
             electrostatic_induction,
             inductance,characteristic_impedance,
             propagation_velocity,equivalent_dielectric,
             output_file1,output_file2,
-            signals);
+            signals,mesh_error,skin_effect,sensitivity);
   }
+
+  nmmtl_free_elements(conductor_data,&element_store);
+
   return(status);
 }
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_mesh_settings_default
+
+  FUNCTIONAL DESCRIPTION:
+
+  Fill in the default mesh settings: elements of order INTERP_ORDER, a
+  single solve on the mesh CSEG and DSEG give and no grading.
+
+  FORMAL PARAMETERS:
+
+  MESH_SETTINGS_P settings - out: the settings
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_mesh_settings_default(&settings);
+
+  */
+
+void nmmtl_mesh_settings_default(MESH_SETTINGS_P settings)
+{
+  settings->element_order = INTERP_ORDER;
+  settings->refine = 0.0;
+  settings->extrapolate = 0;
+  settings->corner_grading = DEFAULT_CORNER_GRADING;
+  settings->plane_grading = DEFAULT_PLANE_GRADING;
+}
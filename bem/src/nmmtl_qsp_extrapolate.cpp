@@ -0,0 +1,553 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_qsp_extrapolate, which solves a cross section on two or
+  three meshes at once, each on its own thread, with 1, 1.5 and 2 times
+  the divisions CSEG and DSEG give, and applies Richardson extrapolation
+  to the electrostatic induction and inductance matrices.
+
+  The error in a result on a mesh of element size h is taken to go as
+  h^p.  With three meshes, p is estimated from how the diagonal terms
+  converge; with two it is taken as EXTRAPOLATE_ORDER.  The difference
+  between the extrapolated results and those of the finest mesh is
+  reported as the estimated discretisation error of the finest mesh.
+  The skin effect and the sensitivities are those of the finest mesh.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include <pthread.h>
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* the cross section, as passed to nmmtl_qsp_extrapolate */
+typedef struct extrapolate_job
+{
+  struct dielectric *dielectrics;
+  struct contour *signals;
+  struct contour *groundwires;
+  int gnd_planes;
+  double half_minimum_dimension;
+  int cntr_seg, pln_seg;
+  double coupling, risetime;
+  MESH_SETTINGS_P settings;
+  int conductor_counter;
+} EXTRAPOLATE_JOB, *EXTRAPOLATE_JOB_P;
+
+/* one mesh, its thread and its results */
+typedef struct extrapolate_level
+{
+  EXTRAPOLATE_JOB_P job;
+  MESH_REFINEMENT refinement;
+  FILE *plot;
+  FIELD_GRID_P field_grid;
+  SKIN_EFFECT_P skin_effect;
+  SENSITIVITY_P sensitivity;
+  double **electrostatic_induction;
+  double **inductance;
+  double *characteristic_impedance;
+  double *propagation_velocity;
+  double *equivalent_dielectric;
+  int status;
+  pthread_t thread;
+  int started;
+} EXTRAPOLATE_LEVEL, *EXTRAPOLATE_LEVEL_P;
+
+/*
+ *******************************************************************
+ **  GLOBALS
+ *******************************************************************
+ */
+
+extern thread_local FILE *plotFile;
+extern thread_local FIELD_GRID_P fieldGrid;
+
+/* how many times the divisions CSEG and DSEG give, for each mesh */
+static const double extrapolate_scale[EXTRAPOLATE_MAX_LEVELS] =
+  { 1.0, 1.5, 2.0 };
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void *nmmtl_extrapolate_level(void *arg);
+static double nmmtl_extrapolate_ratio(double order);
+static double nmmtl_extrapolate_order(int levels, double **finest,
+                                      double **middle, double **coarsest,
+                                      int conductor_counter, int *estimated);
+static double nmmtl_extrapolate_matrix(int levels, double order,
+                                       EXTRAPOLATE_LEVEL_P level,
+                                       double **extrapolated,
+                                       int inductance,
+                                       int conductor_counter);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_qsp_extrapolate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Calculates the quasi-static parameters as nmmtl_qsp_calculate does,
+  from two or three meshes solved in parallel and extrapolated.  The
+  report gives the extrapolated matrices, the estimated error of the
+  finest mesh in place of the asymmetry ratios, and the characteristic
+  impedance and propagation velocity from the extrapolated matrices.
+  The field plot data, the field grid and the skin effect resistance are
+  those of the finest mesh.
+
+  FORMAL PARAMETERS:
+
+  As for nmmtl_qsp_calculate, whose settings give how many meshes, 2
+  or 3.
+
+  RETURN VALUE:
+
+  returns a status of FAIL or SUCCESS, or other failure status.
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_qsp_extrapolate(...,settings);
+
+  */
+
+int nmmtl_qsp_extrapolate(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings)
+{
+  int levels = settings->extrapolate;
+  EXTRAPOLATE_JOB job;
+  EXTRAPOLATE_LEVEL level[EXTRAPOLATE_MAX_LEVELS];
+  CONTOURS_P contour;
+  double **cap_abs_diel = NULL;
+  double order_b, order_l, error_b, error_l;
+  int estimated_b, estimated_l;
+  int status = SUCCESS;
+  int int_status;
+  int i, k;
+  FILE *output_file[2];
+
+  job.dielectrics = dielectrics;
+  job.signals = signals;
+  job.groundwires = groundwires;
+  job.gnd_planes = gnd_planes;
+  job.half_minimum_dimension = half_minimum_dimension;
+  job.cntr_seg = cntr_seg;
+  job.pln_seg = pln_seg;
+  job.coupling = coupling;
+  job.risetime = risetime;
+  job.settings = settings;
+  job.conductor_counter = 0;
+  for(contour = signals; contour != NULL; contour = contour->next)
+    job.conductor_counter++;
+
+  /* set up the meshes, the finest last, which is the one that gets the
+     plot file and the field grid */
+  for(k = 0; k < levels; k++)
+  {
+    level[k].job = &job;
+    level[k].refinement.conductor =
+      (double *)malloc(sizeof(double) * (size_t)(job.conductor_counter + 1));
+    level[k].plot = k == levels - 1 ? plotFile : NULL;
+    level[k].field_grid = k == levels - 1 ? fieldGrid : NULL;
+    level[k].skin_effect = k == levels - 1 ? skin_effect : NULL;
+    level[k].sensitivity = k == levels - 1 ? sensitivity : NULL;
+    level[k].electrostatic_induction =
+      (double **)dim2(job.conductor_counter,job.conductor_counter,
+                      sizeof(double));
+    level[k].inductance =
+      (double **)dim2(job.conductor_counter,job.conductor_counter,
+                      sizeof(double));
+    level[k].characteristic_impedance =
+      (double *)malloc(sizeof(double) * (size_t)job.conductor_counter);
+    level[k].propagation_velocity =
+      (double *)malloc(sizeof(double) * (size_t)job.conductor_counter);
+    level[k].equivalent_dielectric =
+      (double *)calloc((size_t)job.conductor_counter,sizeof(double));
+    level[k].status = FAIL;
+    level[k].started = FALSE;
+
+    if(level[k].refinement.conductor == NULL ||
+       level[k].electrostatic_induction == NULL ||
+       level[k].inductance == NULL ||
+       level[k].characteristic_impedance == NULL ||
+       level[k].propagation_velocity == NULL ||
+       level[k].equivalent_dielectric == NULL)
+      status = FAIL;
+    else
+    {
+      for(i = 0; i <= job.conductor_counter; i++)
+        level[k].refinement.conductor[i] = extrapolate_scale[k];
+      level[k].refinement.dielectric = extrapolate_scale[k];
+    }
+  }
+
+  if(status != SUCCESS)
+    printf("Out of memory for mesh extrapolation\n");
+  else
+  {
+    /* the coarser meshes each get a thread, the finest is solved on this
+       one; any mesh whose thread cannot be started is solved here too */
+    for(k = 0; k < levels - 1; k++)
+      level[k].started =
+        pthread_create(&level[k].thread,NULL,nmmtl_extrapolate_level,
+                       &level[k]) == 0;
+    nmmtl_extrapolate_level(&level[levels - 1]);
+    for(k = 0; k < levels - 1; k++)
+    {
+      if(level[k].started) pthread_join(level[k].thread,NULL);
+      else nmmtl_extrapolate_level(&level[k]);
+    }
+
+    for(k = 0; k < levels; k++)
+      if(level[k].status != SUCCESS) status = level[k].status;
+  }
+
+  if(status == SUCCESS)
+  {
+    order_b = nmmtl_extrapolate_order(levels,
+                                      level[levels-1].electrostatic_induction,
+                                      level[levels-2].electrostatic_induction,
+                                      level[0].electrostatic_induction,
+                                      job.conductor_counter,&estimated_b);
+    order_l = nmmtl_extrapolate_order(levels,level[levels-1].inductance,
+                                      level[levels-2].inductance,
+                                      level[0].inductance,
+                                      job.conductor_counter,&estimated_l);
+    error_b = nmmtl_extrapolate_matrix(levels,order_b,level,
+                                       electrostatic_induction,FALSE,
+                                       job.conductor_counter);
+    error_l = nmmtl_extrapolate_matrix(levels,order_l,level,inductance,TRUE,
+                                       job.conductor_counter);
+
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf("Richardson extrapolation from %d meshes: estimated error %g (B), %g (L)\n",
+             levels,error_b,error_l);
+
+    output_file[0] = output_file1;
+    output_file[1] = output_file2;
+    for(i = 0; i < 2; i++)
+    {
+      if(output_file[i] == NULL || !(OUTPUT_PRODUCTS & OUTPUT_CL)) continue;
+      nmmtl_output_matrices(output_file[i],electrostatic_induction,
+                            inductance,signals);
+      fputs("\nRichardson Extrapolation:\n\n",output_file[i]);
+      fprintf(output_file[i],
+              "  Extrapolated from meshes with %s times the divisions.\n",
+              levels == 2 ? "1 and 1.5" : "1, 1.5 and 2");
+      fputs("  Estimated discretisation error of the finest mesh:\n",
+            output_file[i]);
+      fprintf(output_file[i],
+              "     %f%% electrostatic induction (order %.2f%s),\n",
+              error_b*100.,order_b,estimated_b ? "" : ", assumed");
+      fprintf(output_file[i],
+              "     %f%% inductance (order %.2f%s).\n",
+              error_l*100.,order_l,estimated_l ? "" : ", assumed");
+    }
+
+    /* the capacitance in the absence of dielectrics, which the
+       inductance matrix is the scaled inverse of */
+    cap_abs_diel = (double **)dim2(job.conductor_counter,job.conductor_counter,
+                                   sizeof(double));
+    invert_matrix(&job.conductor_counter,inductance[0],cap_abs_diel[0],
+                  &job.conductor_counter,&job.conductor_counter,&int_status);
+    if(int_status != SUCCESS) status = FAIL;
+    else if(OUTPUT_PRODUCTS & (OUTPUT_Z0 | OUTPUT_XTK))
+    {
+      for(i = 0; i < job.conductor_counter; i++)
+        for(k = 0; k < job.conductor_counter; k++)
+          cap_abs_diel[i][k] *= C_SQUARED_INVERTED;
+
+      status = nmmtl_charimp_propvel_calculate(job.conductor_counter,signals,
+                                               electrostatic_induction,
+                                               inductance,cap_abs_diel,
+                                               characteristic_impedance,
+                                               propagation_velocity,
+                                               equivalent_dielectric,
+                                               OUTPUT_PRODUCTS & OUTPUT_Z0 ?
+                                               output_file1 : (FILE *)NULL,
+                                               OUTPUT_PRODUCTS & OUTPUT_Z0 ?
+                                               output_file2 : (FILE *)NULL);
+    }
+    free2((void **)cap_abs_diel);
+  }
+
+  for(k = 0; k < levels; k++)
+  {
+    free(level[k].refinement.conductor);
+    if(level[k].electrostatic_induction != NULL)
+      free2((void **)level[k].electrostatic_induction);
+    if(level[k].inductance != NULL) free2((void **)level[k].inductance);
+    free(level[k].characteristic_impedance);
+    free(level[k].propagation_velocity);
+    free(level[k].equivalent_dielectric);
+  }
+
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_extrapolate_level
+
+  FUNCTIONAL DESCRIPTION:
+
+  Body of a mesh's thread: set up the thread's copy of the run's
+  settings and solve the cross section on the mesh, with no report.
+
+  FORMAL PARAMETERS:
+
+  void *arg   - the EXTRAPOLATE_LEVEL
+
+  RETURN VALUE:
+
+  NULL
+
+  */
+
+static void *nmmtl_extrapolate_level(void *arg)
+{
+  EXTRAPOLATE_LEVEL_P level = (EXTRAPOLATE_LEVEL_P)arg;
+  EXTRAPOLATE_JOB_P job = level->job;
+  FILE *saved_plot = plotFile;
+  FIELD_GRID_P saved_grid = fieldGrid;
+
+  plotFile = level->plot;
+  fieldGrid = level->field_grid;
+
+  level->status =
+    nmmtl_qsp_solve_mesh(job->dielectrics,job->signals,job->groundwires,
+                         job->gnd_planes,job->half_minimum_dimension,
+                         job->cntr_seg,job->pln_seg,job->coupling,
+                         job->risetime,&level->refinement,
+                         level->electrostatic_induction,level->inductance,
+                         level->characteristic_impedance,
+                         level->propagation_velocity,
+                         level->equivalent_dielectric,
+                         (FILE *)NULL,(FILE *)NULL,(MESH_ERROR_P)NULL,
+                         level->skin_effect,level->sensitivity,
+                         job->settings);
+
+  plotFile = saved_plot;
+  fieldGrid = saved_grid;
+  return(NULL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_extrapolate_order
+
+  FUNCTIONAL DESCRIPTION:
+
+  Estimates the order p at which the results converge from the sums of
+  the diagonal terms on three meshes.  With element sizes h1 > h2 > h3,
+  the ratio of the successive differences, (T1 - T2)/(T2 - T3), is
+  (h1^p - h2^p)/(h2^p - h3^p), which grows with p, so p is found by
+  bisection.  Falls back to EXTRAPOLATE_ORDER with only two meshes, or
+  if the results are not converging steadily.
+
+  FORMAL PARAMETERS:
+
+  int levels             - number of meshes
+  double **finest        - results on the finest mesh
+  double **middle        - results on the next finest
+  double **coarsest      - results on the coarsest
+  int conductor_counter  - order of the matrices
+  int *estimated         - out: TRUE if estimated, FALSE if assumed
+
+  RETURN VALUE:
+
+  the order
+
+  CALLING SEQUENCE:
+
+  order = nmmtl_extrapolate_order(levels,finest,middle,coarsest,
+                                  conductor_counter,&estimated);
+
+  */
+
+static double nmmtl_extrapolate_order(int levels, double **finest,
+                                      double **middle, double **coarsest,
+                                      int conductor_counter, int *estimated)
+{
+  double t1 = 0.0, t2 = 0.0, t3 = 0.0;
+  double ratio, low, high, order;
+  int i, iteration;
+
+  *estimated = FALSE;
+  if(levels < 3) return(EXTRAPOLATE_ORDER);
+
+  for(i = 0; i < conductor_counter; i++)
+  {
+    t1 += coarsest[i][i];
+    t2 += middle[i][i];
+    t3 += finest[i][i];
+  }
+  if(t2 == t3 || (t1 - t2) * (t2 - t3) <= 0.0) return(EXTRAPOLATE_ORDER);
+  ratio = (t1 - t2) / (t2 - t3);
+
+  low = EXTRAPOLATE_MIN_ORDER;
+  high = EXTRAPOLATE_MAX_ORDER;
+  if(ratio <= nmmtl_extrapolate_ratio(low) ||
+     ratio >= nmmtl_extrapolate_ratio(high))
+    return(EXTRAPOLATE_ORDER);
+
+  order = 0.5 * (low + high);
+  for(iteration = 0; iteration < 60; iteration++)
+  {
+    order = 0.5 * (low + high);
+    if(nmmtl_extrapolate_ratio(order) < ratio) low = order;
+    else high = order;
+  }
+
+  *estimated = TRUE;
+  return(order);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_extrapolate_ratio
+
+  FUNCTIONAL DESCRIPTION:
+
+  The ratio of the successive differences between the results on the
+  three meshes, (h1^p - h2^p)/(h2^p - h3^p), for an order p.
+
+  FORMAL PARAMETERS:
+
+  double order - the order p
+
+  RETURN VALUE:
+
+  the ratio
+
+  CALLING SEQUENCE:
+
+  ratio = nmmtl_extrapolate_ratio(order);
+
+  */
+
+static double nmmtl_extrapolate_ratio(double order)
+{
+  double h1 = pow(1.0 / extrapolate_scale[0],order);
+  double h2 = pow(1.0 / extrapolate_scale[1],order);
+  double h3 = pow(1.0 / extrapolate_scale[2],order);
+
+  return((h1 - h2) / (h2 - h3));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_extrapolate_matrix
+
+  FUNCTIONAL DESCRIPTION:
+
+  Extrapolates one matrix of results from the two finest meshes:
+
+    Q = Q3 + (Q3 - Q2)/((h2/h3)^p - 1)
+
+  and returns the largest difference between it and the finest mesh's
+  results, relative to the largest extrapolated diagonal term.
+
+  FORMAL PARAMETERS:
+
+  int levels                - number of meshes
+  double order              - the order p
+  EXTRAPOLATE_LEVEL_P level - the meshes
+  double **extrapolated     - out: the extrapolated matrix
+  int inductance            - TRUE for inductance, FALSE for
+                              electrostatic induction
+  int conductor_counter     - order of the matrices
+
+  RETURN VALUE:
+
+  the estimated relative error of the finest mesh
+
+  CALLING SEQUENCE:
+
+  error = nmmtl_extrapolate_matrix(levels,order,level,extrapolated,
+                                   FALSE,conductor_counter);
+
+  */
+
+static double nmmtl_extrapolate_matrix(int levels, double order,
+                                       EXTRAPOLATE_LEVEL_P level,
+                                       double **extrapolated,
+                                       int inductance,
+                                       int conductor_counter)
+{
+  double **finest, **middle;
+  double factor, largest = 0.0, error = 0.0, difference;
+  int i, j;
+
+  finest = inductance ? level[levels-1].inductance :
+    level[levels-1].electrostatic_induction;
+  middle = inductance ? level[levels-2].inductance :
+    level[levels-2].electrostatic_induction;
+
+  factor = 1.0 / (pow(extrapolate_scale[levels-1] /
+                      extrapolate_scale[levels-2],order) - 1.0);
+
+  for(i = 0; i < conductor_counter; i++)
+    for(j = 0; j < conductor_counter; j++)
+      extrapolated[i][j] = finest[i][j] +
+        (finest[i][j] - middle[i][j]) * factor;
+
+  for(i = 0; i < conductor_counter; i++)
+    if(fabs(extrapolated[i][i]) > largest) largest = fabs(extrapolated[i][i]);
+  if(largest == 0.0) return(0.0);
+
+  for(i = 0; i < conductor_counter; i++)
+    for(j = 0; j < conductor_counter; j++)
+    {
+      difference = fabs(extrapolated[i][j] - finest[i][j]);
+      if(difference > error) error = difference;
+    }
+
+  return(error / largest);
+}
@@ -23,6 +23,7 @@
  **  INCLUDE FILES
  *******************************************************************
  */
+#include <string.h>
 #include "nmmtl.h"
 
 /*
@@ -39,24 +40,17 @@
  *******************************************************************
  */
 
-FILE *plotFile=NULL;
+/* each thread solving a cross section has its own, so only the one
+   that opened it writes to it */
+thread_local FILE *plotFile=NULL;
 
-const double INFINITE_SLOPE = DBL_MAX;
+/* and likewise the grid the potential and field are evaluated on */
+thread_local FIELD_GRID_P fieldGrid=NULL;
 
-/*
- *******************************************************************
- **  FUNCTION DECLARATIONS
- *******************************************************************
- */
+/* what the run computes and writes, the same for every thread */
+int OUTPUT_PRODUCTS = OUTPUT_DEFAULT;
 
-void nmmtl_write_plot_data(
-         CONTOURS_P signal,
-         int conductor_counter,
-         DELEMENTS_P die_elements,
-         CONDUCTOR_DATA_P conductor_data,
-         double *sigma_vector,
-         FILE *outputFile
-       );
+const double INFINITE_SLOPE = DBL_MAX;
 
 /*
  *******************************************************************
@@ -77,7 +71,7 @@ void nmmtl_write_plot_data(
 
   int conductor_counter,               - number of conductors
   CONDUCTOR_DATA_P conductor_data,     - conductor elements organized by cond.
-  DELEMENTS_P die_elements,            - all the die elements
+  ELEMENT_STORE_P element_store,       - all the elements
   unsigned int node_point_counter,     - total number of node points
   unsigned int highest_conductor_node, - highest node number for conductors
   double length_scale,                 - a scale factor based on element length
@@ -88,6 +82,13 @@ void nmmtl_write_plot_data(
   float *equivalent_dielectric,        - out: results
   FILE *output_file1, *output_file2);  - file pointers to print results to.
   CONTOURS_P signals                   - list of signal data including names
+  MESH_ERROR_P mesh_error              - out: mesh error estimates for
+                                         refinement, NULL if not wanted
+  SKIN_EFFECT_P skin_effect            - in and out: see nmmtl_skin_effect,
+                                         NULL if not wanted
+  SENSITIVITY_P sensitivity            - in and out: see
+                                         nmmtl_sensitivity_calculate, NULL
+                                         if not wanted
 
   RETURN VALUE:
 
@@ -95,19 +96,19 @@ void nmmtl_write_plot_data(
 
   CALLING SEQUENCE:
 
-  nmmtl_qsp_kernel(conductor_counter,conductor_data,die_elements,
+  nmmtl_qsp_kernel(conductor_counter,conductor_data,element_store,
   node_point_counter,highest_conductor_node,
   length_scale,electrostatic_induction,
   inductance,characteristic_impedance,
   propagation_velocity,equivalent_dielectric,
   output_file1,output_file2,
-  signals);
+  signals,mesh_error,skin_effect,sensitivity);
 
   */
 
 int nmmtl_qsp_kernel(int conductor_counter,
          CONDUCTOR_DATA_P conductor_data,
-         DELEMENTS_P die_elements,
+         ELEMENT_STORE_P element_store,
          unsigned int node_point_counter,
          unsigned int highest_conductor_node,
          double length_scale,
@@ -118,7 +119,10 @@ int nmmtl_qsp_kernel(int conductor_counter,
          double *equivalent_dielectric,
          FILE *output_file1,
          FILE *output_file2,
-         CONTOURS_P signals) {
+         CONTOURS_P signals,
+         MESH_ERROR_P mesh_error,
+         SKIN_EFFECT_P skin_effect,
+         SENSITIVITY_P sensitivity) {
 
   int ic, jc;
   int *ipvt;
@@ -134,11 +138,16 @@ int nmmtl_qsp_kernel(int conductor_counter,
   unsigned int i;
   unsigned int j;
   double **electrostatic_induction_free_space;
+  double **free_space_sigma = NULL;
+  double **free_space_matrix = NULL;
+  int *free_space_ipvt = NULL;
+  double **sigma = NULL;
   char msg[256];
   char asmsg1[512],asmsg2[512]; /* strings for asymmetry messages */
   double error,error_sum,error_max;
   unsigned int error_count;
   CONTOURS_P activeLine;
+  PLOT_WRITER_P plot_writer = NULL;
 
   /* - - - - - - - -  Allocate the matricies and vectors  - - - - - - - - - */
 
@@ -170,14 +179,15 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
      */
 
-  printf("Calculate LHS (assemble) matrix in free space\n");
+  if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    printf("Calculate LHS (assemble) matrix in free space\n");
 
   nmmtl_assemble_free_space(conductor_counter, conductor_data, assemble_matrix);
 
 #ifdef TRANSPOSE_ASSEMBLE
   for(i = 0; i<conductor_counter; i++) {
     for(j = i+1; j<conductor_counter; j++) {
-      static double temp;
+      double temp;
       temp = assemble_matrix[i][j];
       assemble_matrix[i][j] = assemble_matrix[j][i];
       assemble_matrix[j][i] = temp;
@@ -279,15 +289,25 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
 
 
+  /* the skin effect and the sensitivities need the charge distributions
+     for all of the conductors at once */
+  if(skin_effect != NULL || sensitivity != NULL)
+    free_space_sigma = (double **) dim2(conductor_counter, matrix_order,
+                                        sizeof(double));
+
   /* do for each conductor being charged */
 
   for (ic = 1; ic <= conductor_counter; ++ic) {
     /* Calculate RHS of matrix equation */
-    sprintf(msg,"calculate RHS (load) matrix for conductor %d\n",ic);
-    printf ("%s", msg);
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    {
+      sprintf(msg,"calculate RHS (load) matrix for conductor %d\n",ic);
+      printf ("%s", msg);
+    }
     nmmtl_load_free_space(potential_vector, ic, conductor_data);
 
-    printf ("Solve system of equations\n");
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("Solve system of equations\n");
 
 #ifdef IMSL_LU_ROUTE
 
@@ -344,12 +364,17 @@ int nmmtl_qsp_kernel(int conductor_counter,
     /* integrate charge density to get total charge */
     /* charge is same as capacitance - since V=1 volt to output file. */
 
-    printf ("Integrate charge density\n");
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("Integrate charge density\n");
 
     nmmtl_charge_free_space(sigma_vector,conductor_counter,
           conductor_data,
           electrostatic_induction_free_space[ic-1]);
 
+    if(free_space_sigma != NULL)
+      memcpy(free_space_sigma[ic-1],sigma_vector,
+             sizeof(double) * (size_t)matrix_order);
+
     /* zero out RHS vector for ic-th conductor */
     nmmtl_unload(potential_vector,ic,conductor_data);
 
@@ -450,6 +475,16 @@ int nmmtl_qsp_kernel(int conductor_counter,
     for (jc = 0; jc < conductor_counter; ++jc)
       inductance[jc][ic] *= C_SQUARED_INVERTED;
 
+  /* the resistance due to the skin effect, from the current distribution
+     the free space charge distribution gives */
+  if(free_space_sigma != NULL)
+  {
+    if(skin_effect != NULL)
+      nmmtl_skin_effect(conductor_counter,conductor_data,free_space_sigma,
+                        inductance,skin_effect);
+    if(sensitivity == NULL) free2((void **)free_space_sigma);
+  }
+
   /* Now compute the maximum and average relative error */
 
   error_max = 0.0;
@@ -468,6 +503,8 @@ int nmmtl_qsp_kernel(int conductor_counter,
     }
   }
 
+  if(mesh_error != NULL) mesh_error->inductance_asymmetry = error_max;
+
   if(error_count > 0)
   {
     if(error_max > 0.01)
@@ -480,7 +517,8 @@ int nmmtl_qsp_kernel(int conductor_counter,
   Try adjusting CSEG and DSEG attributes.)\n\
 **********",
         error_max*100.,error_sum*100./error_count);
-      printf ("%s", asmsg1);
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf ("%s", asmsg1);
     }
     else
     {
@@ -488,7 +526,8 @@ int nmmtl_qsp_kernel(int conductor_counter,
         "  Asymmetry ratio for inductance matrix:\n\
      %f%% (max), %f%% (average)\n",
         error_max*100.,error_sum*100./error_count);
-      printf ("%s", asmsg1);
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf ("%s", asmsg1);
     }
   }
 
@@ -506,21 +545,37 @@ int nmmtl_qsp_kernel(int conductor_counter,
      Amn, LHS of matrix equation
      */
 
+  /* the sensitivities need the factored free space system once the
+     dielectric one has taken its place */
+  if(sensitivity != NULL)
+  {
+    free_space_matrix = (double **) dim2(matrix_order, matrix_order,
+                                         sizeof(double));
+    for (i = 0; i <= highest_conductor_node;i++)
+      memcpy(free_space_matrix[i],assemble_matrix[i],
+             sizeof(double) * (size_t)matrix_order);
+    free_space_ipvt = ipvt;
+    ipvt = NULL;
+    sigma = (double **) dim2(conductor_counter, node_point_counter,
+                             sizeof(double));
+  }
+
   /* zero out portion of the matrix that was used above */
 
   for (i = 0; i <= highest_conductor_node;i++)
     for (j=0;j <= highest_conductor_node;j++)
       assemble_matrix[i][j] = 0.;
 
-  printf("Calculate LHS (assemble) matrix in dielectric\n");
+  if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    printf("Calculate LHS (assemble) matrix in dielectric\n");
 
-  nmmtl_assemble(conductor_counter,conductor_data,die_elements,
+  nmmtl_assemble(conductor_counter,conductor_data,element_store,
      length_scale,assemble_matrix);
 
 #ifdef TRANSPOSE_ASSEMBLE
   for(i = 0; i < node_point_counter; i++) {
     for(j = i+1; j < node_point_counter; j++) {
-      static double temp;
+      double temp;
       temp = assemble_matrix[i][j];
       assemble_matrix[i][j] = assemble_matrix[j][i];
       assemble_matrix[j][i] = temp;
@@ -552,7 +607,9 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
 #elif NSWC_LU_ROUTE
 
-  /* allocate vector for pivoting info to keep */
+  /* allocate vector for pivoting info to keep - the one from the free
+     space solution was for a smaller matrix */
+  free(ipvt);
   ipvt = (int *)calloc(node_point_counter,sizeof(int));
 
   /* call NSWC routine (via wrapper) to compute LU factorization of
@@ -616,6 +673,15 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
 #endif /* #elif NSWC_LU_ROUTE */
 
+  /* if the main opened the plotFile, the plot data of each conductor is
+     written on a thread of its own while the next ones are solved */
+  if (plotFile != NULL)
+    plot_writer = nmmtl_plot_writer_start(plotFile,
+                                          (OUTPUT_PRODUCTS &
+                                           OUTPUT_PLOT_BINARY) != 0,
+                                          conductor_counter,element_store,
+                                          conductor_data,node_point_counter);
+
   /* do for each conductor being charged */
 
   for (activeLine = signals,ic = 1;
@@ -625,13 +691,16 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
     /* Calculate RHS of matrix equation */
 
-    sprintf(msg,"calculate RHS (load) matrix for conductor %d\n",ic);
-
-    printf ("%s", msg);
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+    {
+      sprintf(msg,"calculate RHS (load) matrix for conductor %d\n",ic);
+      printf ("%s", msg);
+    }
 
     nmmtl_load(potential_vector, ic, conductor_data);
 
-    printf ("Solve system of equations\n");
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("Solve system of equations\n");
 
 #ifdef IMSL_LU_ROUTE
 
@@ -682,35 +751,72 @@ int nmmtl_qsp_kernel(int conductor_counter,
 
     // int_status will always be returned as SUCCESS, but check in case
     // someone changes this.
-    if(int_status != SUCCESS) return(FAIL);  /* translate to int */
+    if(int_status != SUCCESS)
+    {
+      nmmtl_plot_writer_finish(plot_writer);
+      return(FAIL);  /* translate to int */
+    }
 
 #endif /* #elif NSWC_LU_ROUTE */
 
     /* integrate charge density to get total charge */
     /* write charge - same as capacitance - since V=1 volt to output file. */
 
-    printf ("Integrate charge density\n");
+    if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf ("Integrate charge density\n");
 
     nmmtl_charge(sigma_vector,conductor_counter,
      conductor_data,electrostatic_induction[ic-1]);
 
+    if(sigma != NULL)
+      memcpy(sigma[ic-1],sigma_vector,
+             sizeof(double) * (size_t)node_point_counter);
+
+    /* see how well the mesh resolves this charge distribution */
+    if(mesh_error != NULL)
+      nmmtl_mesh_error(sigma_vector,conductor_counter,conductor_data,
+                       element_store,mesh_error);
+
     /* if the main opened the plotFile, then write out the plot data */
-    if (plotFile != NULL) {
-      nmmtl_write_plot_data(
-                activeLine,
-                conductor_counter,
-                die_elements,
-                conductor_data,
-                sigma_vector,
-                plotFile
-              );
-      }
+    if (plot_writer != NULL)
+      nmmtl_plot_writer_queue(plot_writer,activeLine,sigma_vector);
+
+    /* and the potential and field on the grid, if there is one */
+    if (fieldGrid != NULL)
+      nmmtl_field_grid_evaluate(fieldGrid,activeLine,conductor_counter,
+                                conductor_data,element_store,sigma_vector);
 
     /* zero out RHS vector for ic-th conductor */
     nmmtl_unload(potential_vector,ic,conductor_data);
 
   }     /* end loop for each conductor */
 
+  /* the plot data is written from the elements, which the caller frees */
+  nmmtl_plot_writer_finish(plot_writer);
+
+  /* the derivatives of B and L, from the factored systems */
+  if(sensitivity != NULL)
+  {
+    status = nmmtl_sensitivity_calculate(conductor_counter,conductor_data,
+                                         element_store,node_point_counter,
+                                         highest_conductor_node,length_scale,
+                                         assemble_matrix,ipvt,sigma,
+                                         free_space_matrix,free_space_ipvt,
+                                         free_space_sigma,inductance,
+                                         sensitivity);
+    free2((void **)free_space_matrix);
+    free(free_space_ipvt);
+    free2((void **)free_space_sigma);
+    free2((void **)sigma);
+    if(status != SUCCESS) return(status);
+  }
+
+  /* done with the linear system */
+  free2((void **)assemble_matrix);
+  free(sigma_vector);
+  free(potential_vector);
+  free(ipvt);
+
 
   /* Now compute the maximum and average relative error */
 
@@ -731,6 +837,8 @@ int nmmtl_qsp_kernel(int conductor_counter,
     }
   }
 
+  if(mesh_error != NULL) mesh_error->induction_asymmetry = error_max;
+
   if(error_count > 0)
   {
     if(error_max > 0.01)
@@ -744,7 +852,8 @@ int nmmtl_qsp_kernel(int conductor_counter,
   Try adjusting CSEG and DSEG attributes.)\n\
 **********",
         error_max*100.,error_sum*100./error_count);
-      printf ("%s", asmsg2);
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf ("%s", asmsg2);
 
     }
     else
@@ -753,14 +862,15 @@ int nmmtl_qsp_kernel(int conductor_counter,
         "  Asymmetry ratio for electrostatic induction matrix:\n\
      %f%% (max), %f%% (average).\n",
         error_max*100.,error_sum*100./error_count);
-      printf ("%s", asmsg2);
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf ("%s", asmsg2);
     }
   }
 
 
   /* - - - - - - - -  Output the matricies 'n stuff - - - - - - - - - */
 
-  if(output_file1 != NULL)
+  if(output_file1 != NULL && (OUTPUT_PRODUCTS & OUTPUT_CL))
   {
     nmmtl_output_matrices(output_file1,
         electrostatic_induction,
@@ -777,7 +887,7 @@ int nmmtl_qsp_kernel(int conductor_counter,
     }
   }
 
-  if(output_file2 != NULL)
+  if(output_file2 != NULL && (OUTPUT_PRODUCTS & OUTPUT_CL))
   {
     nmmtl_output_matrices(output_file2,
         electrostatic_induction,
@@ -795,19 +905,22 @@ int nmmtl_qsp_kernel(int conductor_counter,
   }
 
   /* NOW: calculate the characteristic impedance and the propagation
-     velocity */
-  status = nmmtl_charimp_propvel_calculate(conductor_counter,
-             signals,
-             electrostatic_induction,
-             inductance,
-             electrostatic_induction_free_space,
-             characteristic_impedance,
-             propagation_velocity,
-             equivalent_dielectric,
-             output_file1,
-             output_file2);
-
-  if(status != SUCCESS) return(status);
+     velocity, which the crosstalk needs too */
+  if(OUTPUT_PRODUCTS & (OUTPUT_Z0 | OUTPUT_XTK))
+  {
+    status = nmmtl_charimp_propvel_calculate(conductor_counter,
+               signals,
+               electrostatic_induction,
+               inductance,
+               electrostatic_induction_free_space,
+               characteristic_impedance,
+               propagation_velocity,
+               equivalent_dielectric,
+               OUTPUT_PRODUCTS & OUTPUT_Z0 ? output_file1 : (FILE *)NULL,
+               OUTPUT_PRODUCTS & OUTPUT_Z0 ? output_file2 : (FILE *)NULL);
+
+    if(status != SUCCESS) return(status);
+  }
 
   /* Don't need to save this - since it is not returned */
   free2((void **)electrostatic_induction_free_space);
@@ -0,0 +1,661 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the automatic mesh refinement.  nmmtl_qsp_refine solves a
+  cross section on the mesh CSEG and DSEG give, then estimates where the
+  mesh is too coarse and solves it again with more elements there, until
+  the electrostatic induction and inductance matrices change by less
+  than a tolerance from one pass to the next.
+
+  A small change after refining only some regions says little about
+  the others, so it is not taken as convergence on its own: the next
+  pass refines every region, and only if the results then change by
+  less than the tolerance too have they settled.
+
+  The regions refined are each conductor, the ground (wires and planes
+  together) and the dielectric-dielectric interfaces.  A region is
+  refined when the charge on it is poorly resolved - the charge density
+  jumps between neighbouring elements - or when the asymmetry of the
+  results points at it: an asymmetric inductance matrix comes from the
+  free space solution, which has only conductor elements, while an
+  asymmetric electrostatic induction matrix on top of a symmetric
+  inductance matrix points at the dielectric and ground elements.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include <string.h>
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  GLOBALS
+ *******************************************************************
+ */
+
+extern thread_local FILE *plotFile;
+extern thread_local FIELD_GRID_P fieldGrid;
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static double nmmtl_element_sigma(double *sigma_vector, int *node);
+static double nmmtl_element_length(double *xpts, double *ypts);
+static double nmmtl_refine_change(int conductor_counter, double **current,
+                                  double **previous);
+static int nmmtl_refine_mesh(int conductor_counter,
+                             MESH_REFINEMENT_P refinement,
+                             MESH_ERROR_P mesh_error, double tolerance,
+                             int everywhere);
+static FILE *nmmtl_refine_keep(FILE *pass_file, FILE *output_file);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_qsp_refine
+
+  FUNCTIONAL DESCRIPTION:
+
+  Calculates the quasi-static parameters as nmmtl_qsp_calculate does,
+  refining the mesh automatically.  Each pass writes its report, plot
+  data and field grid to scratch files, and only those of the last pass are copied to
+  the real ones, so the output is as if that mesh had been asked for.
+
+  FORMAL PARAMETERS:
+
+  As for nmmtl_qsp_calculate, whose settings give the tolerance: the
+  largest change in the electrostatic induction and inductance matrices
+  from one pass to the next, relative to their largest diagonal terms,
+  at which the results are taken to have settled.
+
+  RETURN VALUE:
+
+  returns a status of FAIL or SUCCESS, or other failure status.
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_qsp_refine(...,settings);
+
+  */
+
+int nmmtl_qsp_refine(struct dielectric *dielectrics,
+            struct contour  *signals,
+            struct contour  *groundwires,
+            int gnd_planes,
+            double half_minimum_dimension,
+            int cntr_seg,
+            int pln_seg,
+            double coupling,
+            double risetime,
+            double **electrostatic_induction,
+            double **inductance,
+            double *characteristic_impedance,
+            double *propagation_velocity,
+            double *equivalent_dielectric,
+            FILE *output_file1,
+            FILE *output_file2,
+            SKIN_EFFECT_P skin_effect,
+            SENSITIVITY_P sensitivity,
+            MESH_SETTINGS_P settings)
+{
+  double tolerance = settings->refine;
+  int status = FAIL;
+  int conductor_counter = 0;
+  int pass, i, converged = FALSE;
+  int uniform = FALSE;   /* the last pass refined every region */
+  int confirm = FALSE;   /* so must the next one */
+  CONTOURS_P contour;
+  MESH_REFINEMENT refinement;
+  MESH_ERROR mesh_error;
+  double **previous_induction, **previous_inductance;
+  double change = 0.0, change_l;
+  FILE *saved_plot = plotFile;
+  FILE *pass_file1 = NULL, *pass_file2 = NULL, *pass_plot = NULL;
+  FIELD_GRID_P saved_grid = fieldGrid;
+  FIELD_GRID pass_grid;
+
+  for(contour = signals; contour != NULL; contour = contour->next)
+    conductor_counter++;
+
+  refinement.conductor =
+    (double *)malloc(sizeof(double) * (size_t)(conductor_counter + 1));
+  mesh_error.conductor =
+    (double *)malloc(sizeof(double) * (size_t)(conductor_counter + 1));
+  previous_induction = (double **)dim2(conductor_counter,conductor_counter,
+                                       sizeof(double));
+  previous_inductance = (double **)dim2(conductor_counter,conductor_counter,
+                                        sizeof(double));
+  if(refinement.conductor == NULL || mesh_error.conductor == NULL ||
+     previous_induction == NULL || previous_inductance == NULL)
+  {
+    printf("Out of memory for mesh refinement\n");
+    free(refinement.conductor);
+    free(mesh_error.conductor);
+    if(previous_induction != NULL) free2((void **)previous_induction);
+    if(previous_inductance != NULL) free2((void **)previous_inductance);
+    return(FAIL);
+  }
+
+  /* the field grid of a pass is the real one, but for its file */
+  if(saved_grid != NULL) pass_grid = *saved_grid;
+  pass_grid.file = NULL;
+
+  for(i = 0; i <= conductor_counter; i++)
+    refinement.conductor[i] = 1.0;
+  refinement.dielectric = 1.0;
+
+  for(pass = 1; ; pass++)
+  {
+    /* the last pass's scratch files are not wanted any more */
+    if(pass_file1 != NULL) fclose(pass_file1);
+    if(pass_file2 != NULL) fclose(pass_file2);
+    if(pass_plot != NULL) fclose(pass_plot);
+    if(pass_grid.file != NULL) fclose(pass_grid.file);
+    pass_file1 = output_file1 != NULL ? tmpfile() : NULL;
+    pass_file2 = output_file2 != NULL ? tmpfile() : NULL;
+    pass_plot = saved_plot != NULL ? tmpfile() : NULL;
+    pass_grid.file = saved_grid != NULL ? tmpfile() : NULL;
+    if((output_file1 != NULL && pass_file1 == NULL) ||
+       (output_file2 != NULL && pass_file2 == NULL) ||
+       (saved_plot != NULL && pass_plot == NULL) ||
+       (saved_grid != NULL && pass_grid.file == NULL))
+    {
+      printf("Cannot open scratch files for mesh refinement\n");
+      status = FAIL;
+      break;
+    }
+
+    for(i = 0; i <= conductor_counter; i++) mesh_error.conductor[i] = 0.0;
+    mesh_error.dielectric = 0.0;
+    mesh_error.inductance_asymmetry = 0.0;
+    mesh_error.induction_asymmetry = 0.0;
+    mesh_error.nodes = 0;
+
+    plotFile = pass_plot;
+    fieldGrid = saved_grid != NULL ? &pass_grid : NULL;
+    status = nmmtl_qsp_solve_mesh(dielectrics,signals,groundwires,gnd_planes,
+                                  half_minimum_dimension,cntr_seg,pln_seg,
+                                  coupling,risetime,&refinement,
+                                  electrostatic_induction,inductance,
+                                  characteristic_impedance,
+                                  propagation_velocity,equivalent_dielectric,
+                                  pass_file1,pass_file2,&mesh_error,
+                                  skin_effect,sensitivity,settings);
+    plotFile = saved_plot;
+    fieldGrid = saved_grid;
+    if(status != SUCCESS) break;
+
+    if(pass > 1)
+    {
+      change = nmmtl_refine_change(conductor_counter,electrostatic_induction,
+                                   previous_induction);
+      change_l = nmmtl_refine_change(conductor_counter,inductance,
+                                     previous_inductance);
+      if(change_l > change) change = change_l;
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf("Mesh refinement pass %d: %u nodes, results changed by %g%s\n",
+               pass,mesh_error.nodes,change,
+               uniform ? ", refined everywhere" : "");
+      if(change < tolerance && uniform)
+      {
+        converged = TRUE;
+        break;
+      }
+      confirm = change < tolerance;
+    }
+    else if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+      printf("Mesh refinement pass %d: %u nodes\n",pass,mesh_error.nodes);
+
+    if(pass >= REFINE_MAX_PASSES || mesh_error.nodes >= REFINE_MAX_NODES)
+      break;
+
+    for(i = 0; i < conductor_counter; i++)
+    {
+      memcpy(previous_induction[i],electrostatic_induction[i],
+             sizeof(double) * (size_t)conductor_counter);
+      memcpy(previous_inductance[i],inductance[i],
+             sizeof(double) * (size_t)conductor_counter);
+    }
+
+    uniform = nmmtl_refine_mesh(conductor_counter,&refinement,&mesh_error,
+                                tolerance,confirm);
+  }
+
+  if(status == SUCCESS)
+  {
+    if(converged)
+    {
+      if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        printf("Mesh refinement converged after %d passes\n",pass);
+    }
+    else
+      printf("Mesh refinement stopped after %d passes, short of the tolerance %g - results changed by %g\n",
+             pass,tolerance,change);
+
+    pass_file1 = nmmtl_refine_keep(pass_file1,output_file1);
+    pass_file2 = nmmtl_refine_keep(pass_file2,output_file2);
+    pass_plot = nmmtl_refine_keep(pass_plot,saved_plot);
+    if(saved_grid != NULL)
+      pass_grid.file = nmmtl_refine_keep(pass_grid.file,saved_grid->file);
+  }
+
+  if(pass_file1 != NULL) fclose(pass_file1);
+  if(pass_file2 != NULL) fclose(pass_file2);
+  if(pass_plot != NULL) fclose(pass_plot);
+  if(pass_grid.file != NULL) fclose(pass_grid.file);
+  free(refinement.conductor);
+  free(mesh_error.conductor);
+  free2((void **)previous_induction);
+  free2((void **)previous_inductance);
+
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_refine_divisions
+
+  FUNCTIONAL DESCRIPTION:
+
+  Scales the number of divisions of a segment by a refinement factor,
+  rounding up as the segmentation does, and never going below two
+  divisions where there were two or more, nor below one.
+
+  FORMAL PARAMETERS:
+
+  int divisions  - divisions of the segment
+  double factor  - refinement factor
+
+  RETURN VALUE:
+
+  the refined number of divisions
+
+  CALLING SEQUENCE:
+
+  segment->divisions = nmmtl_refine_divisions(segment->divisions,factor);
+
+  */
+
+int nmmtl_refine_divisions(int divisions, double factor)
+{
+  int refined, minimum;
+
+  refined = (int)(.99 + divisions * factor);
+  minimum = divisions < 2 ? 1 : 2;
+  return(refined < minimum ? minimum : refined);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_refine_segments
+
+  FUNCTIONAL DESCRIPTION:
+
+  Applies the refinement factors to the divisions of the conductor and
+  dielectric segments, before they are turned into elements.
+
+  FORMAL PARAMETERS:
+
+  MESH_REFINEMENT_P refinement              - the factors
+  LINE_SEGMENTS_P conductor_ls              - conductor line segments
+  CIRCLE_SEGMENTS_P conductor_cs            - conductor circle segments
+  DIELECTRIC_SEGMENTS_P dielectric_segments - dielectric segments
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_refine_segments(refinement,conductor_ls,conductor_cs,
+                        dielectric_segments);
+
+  */
+
+void nmmtl_refine_segments(MESH_REFINEMENT_P refinement,
+                           LINE_SEGMENTS_P conductor_ls,
+                           CIRCLE_SEGMENTS_P conductor_cs,
+                           DIELECTRIC_SEGMENTS_P dielectric_segments)
+{
+  for(; conductor_ls != NULL; conductor_ls = conductor_ls->next)
+    conductor_ls->divisions =
+      nmmtl_refine_divisions(conductor_ls->divisions,
+                             refinement->conductor[conductor_ls->conductor]);
+
+  for(; conductor_cs != NULL; conductor_cs = conductor_cs->next)
+    conductor_cs->divisions =
+      nmmtl_refine_divisions(conductor_cs->divisions,
+                             refinement->conductor[conductor_cs->conductor]);
+
+  for(; dielectric_segments != NULL;
+      dielectric_segments = dielectric_segments->next)
+    dielectric_segments->divisions =
+      nmmtl_refine_divisions(dielectric_segments->divisions,
+                             refinement->dielectric);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_mesh_error
+
+  FUNCTIONAL DESCRIPTION:
+
+  Estimates how well the mesh resolves one solution's charge
+  distribution.  For each pair of neighbouring elements - ones which
+  share a node - the jump between their average charge densities,
+  times their average length, is taken as a fraction of the total
+  charge on the conductors, and the largest over each region is kept
+  in mesh_error if it beats what is there.
+
+  FORMAL PARAMETERS:
+
+  double *sigma_vector             - the charge density at the nodes
+  int conductor_counter            - number of conductors
+  CONDUCTOR_DATA_P conductor_data  - the conductor elements
+  ELEMENT_STORE_P element_store    - all the elements
+  MESH_ERROR_P mesh_error          - in/out: the estimates
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_mesh_error(sigma_vector,conductor_counter,conductor_data,
+                   element_store,mesh_error);
+
+  */
+
+void nmmtl_mesh_error(double *sigma_vector,
+                      int conductor_counter,
+                      CONDUCTOR_DATA_P conductor_data,
+                      ELEMENT_STORE_P element_store,
+                      MESH_ERROR_P mesh_error)
+{
+  int cond_num, i, j, number;
+  double charge = 0.0, jump;
+  CELEMENTS_P cel;
+  DELEMENTS_P del;
+
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+  {
+    cel = conductor_data[cond_num].elements;
+    for(i = 0; i < conductor_data[cond_num].number_elements; i++)
+      charge += fabs(nmmtl_element_sigma(sigma_vector,cel[i].node)) *
+        nmmtl_element_length(cel[i].xpts,cel[i].ypts);
+  }
+  if(charge == 0.0) return;
+
+  /* the elements of a contour go round it in order, so the last may
+     meet the first */
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+  {
+    cel = conductor_data[cond_num].elements;
+    number = conductor_data[cond_num].number_elements;
+    for(i = 0; i < number && number > 1; i++)
+    {
+      j = i + 1 < number ? i + 1 : 0;
+      if(cel[i].node[ELEMENT_ORDER] != cel[j].node[0]) continue;
+      jump = fabs(nmmtl_element_sigma(sigma_vector,cel[i].node) -
+                  nmmtl_element_sigma(sigma_vector,cel[j].node)) * 0.5 *
+        (nmmtl_element_length(cel[i].xpts,cel[i].ypts) +
+         nmmtl_element_length(cel[j].xpts,cel[j].ypts)) / charge;
+      if(jump > mesh_error->conductor[cond_num])
+        mesh_error->conductor[cond_num] = jump;
+    }
+  }
+
+  del = element_store->delements;
+  for(i = 0; i + 1 < element_store->number_delements; i++)
+  {
+    if(del[i].node[ELEMENT_ORDER] != del[i+1].node[0]) continue;
+    jump = fabs(nmmtl_element_sigma(sigma_vector,del[i].node) -
+                nmmtl_element_sigma(sigma_vector,del[i+1].node)) * 0.5 *
+      (nmmtl_element_length(del[i].xpts,del[i].ypts) +
+       nmmtl_element_length(del[i+1].xpts,del[i+1].ypts)) / charge;
+    if(jump > mesh_error->dielectric) mesh_error->dielectric = jump;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_sigma
+
+  FUNCTIONAL DESCRIPTION:
+
+  The average of the charge density at the nodes of an element.
+
+  FORMAL PARAMETERS:
+
+  double *sigma_vector - the charge density at the nodes
+  int *node            - the element's nodes
+
+  RETURN VALUE:
+
+  the average
+
+  CALLING SEQUENCE:
+
+  sigma = nmmtl_element_sigma(sigma_vector,cel->node);
+
+  */
+
+static double nmmtl_element_sigma(double *sigma_vector, int *node)
+{
+  double sum = 0.0;
+  int i;
+
+  for(i = 0; i < ELEMENT_PTS; i++) sum += sigma_vector[node[i]];
+  return(sum / ELEMENT_PTS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_length
+
+  FUNCTIONAL DESCRIPTION:
+
+  The distance between the ends of an element - near enough its length
+  for estimating errors.
+
+  FORMAL PARAMETERS:
+
+  double *xpts, *ypts - the element's node points
+
+  RETURN VALUE:
+
+  the length
+
+  CALLING SEQUENCE:
+
+  length = nmmtl_element_length(cel->xpts,cel->ypts);
+
+  */
+
+static double nmmtl_element_length(double *xpts, double *ypts)
+{
+  double dx = xpts[ELEMENT_ORDER] - xpts[0];
+  double dy = ypts[ELEMENT_ORDER] - ypts[0];
+  return(sqrt(dx*dx + dy*dy));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_refine_change
+
+  FUNCTIONAL DESCRIPTION:
+
+  The largest change in a matrix of results from one pass to the next,
+  relative to the largest diagonal term, so that small coupling terms
+  do not hold up convergence.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter - order of the matrices
+  double **current      - this pass's results
+  double **previous     - the last pass's results
+
+  RETURN VALUE:
+
+  the relative change
+
+  CALLING SEQUENCE:
+
+  change = nmmtl_refine_change(conductor_counter,inductance,previous);
+
+  */
+
+static double nmmtl_refine_change(int conductor_counter, double **current,
+                                  double **previous)
+{
+  double largest = 0.0, change = 0.0, difference;
+  int i, j;
+
+  for(i = 0; i < conductor_counter; i++)
+    if(fabs(previous[i][i]) > largest) largest = fabs(previous[i][i]);
+  if(largest == 0.0) return(0.0);
+
+  for(i = 0; i < conductor_counter; i++)
+    for(j = 0; j < conductor_counter; j++)
+    {
+      difference = fabs(current[i][j] - previous[i][j]);
+      if(difference > change) change = difference;
+    }
+
+  return(change / largest);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_refine_mesh
+
+  FUNCTIONAL DESCRIPTION:
+
+  Decides from the mesh error estimates which regions to refine for the
+  next pass, and scales up their refinement factors.  A region is
+  refined if its charge jump is within REFINE_FRACTION of the largest,
+  or if an asymmetry ratio over the tolerance points at it, as
+  described at the top of this module - or always, when a small change
+  is to be confirmed.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter        - number of conductors
+  MESH_REFINEMENT_P refinement - in/out: the factors
+  MESH_ERROR_P mesh_error      - the estimates from the last pass
+  double tolerance             - the refinement tolerance
+  int everywhere               - TRUE to refine every region
+
+  RETURN VALUE:
+
+  TRUE if every region was refined
+
+  CALLING SEQUENCE:
+
+  uniform = nmmtl_refine_mesh(conductor_counter,refinement,mesh_error,
+                              tolerance,everywhere);
+
+  */
+
+static int nmmtl_refine_mesh(int conductor_counter,
+                             MESH_REFINEMENT_P refinement,
+                             MESH_ERROR_P mesh_error, double tolerance,
+                             int everywhere)
+{
+  double threshold;
+  int conductors, dielectric;
+  int i, uniform = TRUE;
+
+  threshold = mesh_error->dielectric;
+  for(i = 0; i <= conductor_counter; i++)
+    if(mesh_error->conductor[i] > threshold)
+      threshold = mesh_error->conductor[i];
+  threshold *= REFINE_FRACTION;
+
+  conductors = mesh_error->inductance_asymmetry > tolerance;
+  dielectric = !conductors && mesh_error->induction_asymmetry > tolerance;
+
+  for(i = 0; i <= conductor_counter; i++)
+    if(everywhere || mesh_error->conductor[i] >= threshold ||
+       (i > 0 && conductors) || (i == 0 && dielectric))
+      refinement->conductor[i] *= REFINE_STEP;
+    else
+      uniform = FALSE;
+
+  if(everywhere || mesh_error->dielectric >= threshold || dielectric)
+    refinement->dielectric *= REFINE_STEP;
+  else
+    uniform = FALSE;
+
+  return(uniform);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_refine_keep
+
+  FUNCTIONAL DESCRIPTION:
+
+  Copies what the last pass wrote to a scratch file onto the real file,
+  then closes the scratch file.
+
+  FORMAL PARAMETERS:
+
+  FILE *pass_file   - scratch file, may be NULL
+  FILE *output_file - real file, may be NULL
+
+  RETURN VALUE:
+
+  NULL, for the caller's pointer to the scratch file
+
+  CALLING SEQUENCE:
+
+  pass_file = nmmtl_refine_keep(pass_file,output_file);
+
+  */
+
+static FILE *nmmtl_refine_keep(FILE *pass_file, FILE *output_file)
+{
+  char buffer[BUFSIZ];
+  size_t length;
+
+  if(pass_file == NULL) return(NULL);
+
+  if(output_file != NULL)
+  {
+    rewind(pass_file);
+    while((length = fread(buffer,1,sizeof(buffer),pass_file)) > 0)
+      fwrite(buffer,1,length,output_file);
+  }
+  fclose(pass_file);
+  return(NULL);
+}
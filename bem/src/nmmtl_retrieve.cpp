@@ -31,6 +31,8 @@
  *    nmmtl_retrieve
  * FUNCTIONAL DESCRIPTION:
  *    Retrieve data from a dump file of conductor and dielectric elements.
+ *    The elements are read with ELEMENT_PTS nodes each, so the file must
+ *    have been dumped with the same element order.
  * FORMAL PARAMETERS:
  *    FILE *retrieve_file                - where to write dumpy things to.
  *    int *cntr_seg,                     - cseg parameter
@@ -40,13 +42,16 @@
  *    struct contour **psignals          - signals data structure
  *    int *pconductor_counter,           - how many conductors (gnd not included)
  *    CONDUCTOR_DATA_P *pconductor_data, - array of data on conductors
- *    DELEMENTS_P *pdie_elements         - list of dielectric elements
+ *    ELEMENT_STORE_P element_store      - all the elements, zeroed to start
  *    unsigned int *pnode_point_counter           - highest node number
  *    unsigned int *phighest_conductor_node       - highest node for a conductor
  * RETURN VALUE:
  *    SUCCESS, or FAIL
  * CALLING SEQUENCE:
- *    status = nmmtl_retrieve(retrieve_file,conductor_counter,cd,*die_elements);
+ *    status = nmmtl_retrieve(retrieve_file,&cntr_seg,&pln_seg,&coupling,
+ *                            &risetime,NULL,NULL,&conductor_counter,
+ *                            &conductor_data,&element_store,
+ *                            &node_point_counter,&highest_conductor_node);
 */
 
 int nmmtl_retrieve(FILE *retrieve_file,
@@ -58,7 +63,7 @@ int nmmtl_retrieve(FILE *retrieve_file,
              int *sig_cnt,
              int *pconductor_counter,
              CONDUCTOR_DATA_P *pconductor_data,
-             DELEMENTS_P *pdie_elements,
+             ELEMENT_STORE_P element_store,
              unsigned int *pnode_point_counter,
              unsigned int *phighest_conductor_node) {
   CELEMENTS_P ce = NULL;
@@ -66,7 +71,7 @@ int nmmtl_retrieve(FILE *retrieve_file,
   char line[256];
   CONTOURS_P sigs = NULL;
   CONDUCTOR_DATA_P conductor_data;
-  DELEMENTS_P die_elements = NULL;
+  DELEMENTS_P de;
   int temp[2];
   double ftemp[2];
 
@@ -100,6 +105,7 @@ int nmmtl_retrieve(FILE *retrieve_file,
 
       strcpy(sigs->name,line+1);
       sigs->next = NULL;
+      sigs->block = NULL;
       i++;
       if(fgets(line,255,retrieve_file) == NULL) return(FAIL);
     }
@@ -131,25 +137,11 @@ int nmmtl_retrieve(FILE *retrieve_file,
         &conductor_data[cntr].node_start,
         &conductor_data[cntr].node_end) != 2) return(FAIL);
 
-    conductor_data[cntr].elements = NULL;
     if(fgets(line,255,retrieve_file) == NULL) return(FAIL);
     while(line[0] != '.')
     {
-      if(conductor_data[cntr].elements == NULL)
-      {
-  ce = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  conductor_data[cntr].elements = ce;
-      }
-      else
-      {
-
-  ce->next = (CELEMENTS_P)malloc(sizeof(CELEMENTS));
-  ce = ce->next;
-      }
-
-      ce->next = NULL;
-      ce->edge[0] = NULL;
-      ce->edge[1] = NULL;
+      ce = nmmtl_element_store_add_c(element_store,cntr);
+      if(ce == NULL) return(FAIL);
 
       sscanf(line,"%lf %d %d",&ce->epsilon,&edge0,&edge1);
 
@@ -163,9 +155,9 @@ int nmmtl_retrieve(FILE *retrieve_file,
       i++;
 
       if (edge0) {
-        ce->edge[0] = (EDGEDATA_P)malloc(sizeof(EDGEDATA));
-        sscanf(&line[i],"%lf %lf",&ce->edge[0]->nu,
-               &ce->edge[0]->free_space_nu);
+        ce->edge[0] = TRUE;
+        sscanf(&line[i],"%lf %lf",&ce->nu[0],
+               &ce->free_space_nu[0]);
         /* skip these two fields */
         while(line[i] != ' ') i++;
         i++;
@@ -173,17 +165,16 @@ int nmmtl_retrieve(FILE *retrieve_file,
         i++;
       }
       if (edge1) {
-
-        ce->edge[1] = (EDGEDATA_P)malloc(sizeof(EDGEDATA));
-        sscanf(&line[i],"%lf %lf",&ce->edge[1]->nu,
-               &ce->edge[1]->free_space_nu);
+        ce->edge[1] = TRUE;
+        sscanf(&line[i],"%lf %lf",&ce->nu[1],
+               &ce->free_space_nu[1]);
         /* skip these two fields */
         while(line[i] != ' ') i++;
         i++;
         while(line[i] != ' ') i++;
         i++;
       }
-      for(i = 0; i < 3; i++) {
+      for(i = 0; i < ELEMENT_PTS; i++) {
         if (fscanf(retrieve_file, "%d %lf %lf\n", &ce->node[i],
                                                 &ce->xpts[i],
                                                 &ce->ypts[i]) != 3) {
@@ -198,31 +189,28 @@ int nmmtl_retrieve(FILE *retrieve_file,
   if (fgets(line,255,retrieve_file) == NULL)
     return(FAIL);
   while (line[0] != '.') {
-    if (*pdie_elements == NULL) {
-      die_elements = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-      *pdie_elements = die_elements;
-    } else {
-      die_elements->next = (DELEMENTS_P)malloc(sizeof(DELEMENTS));
-      die_elements = die_elements->next;
-    }
+    de = nmmtl_element_store_add_d(element_store);
+    if(de == NULL) return(FAIL);
 
-    die_elements->next = NULL;
     if(sscanf(line,
               "%lf %lf %lf %lf\n",
-              &die_elements->epsilonplus,
-              &die_elements->epsilonminus,
-              &die_elements->normalx,
-              &die_elements->normaly) != 4) {
+              &de->epsilonplus,
+              &de->epsilonminus,
+              &de->normalx,
+              &de->normaly) != 4) {
       return(FAIL);
     }
 
-    for(i = 0; i < 3; i++) {
-      fscanf(retrieve_file,"%d %lf %lf\n", &die_elements->node[i],
-                                           &die_elements->xpts[i],
-                                           &die_elements->ypts[i]);
+    for(i = 0; i < ELEMENT_PTS; i++) {
+      fscanf(retrieve_file,"%d %lf %lf\n", &de->node[i],
+                                           &de->xpts[i],
+                                           &de->ypts[i]);
     }
     if(fgets(line, 255, retrieve_file) == NULL)
       return(FAIL);
   }
-  return(SUCCESS);
+
+  /* gather the elements of each conductor together */
+  return(nmmtl_element_store_finish(element_store,*pconductor_counter,
+                                    conductor_data));
 }
@@ -0,0 +1,87 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_rlgc_calculate, which gives the resistance, inductance
+  and conductance matrices at a frequency.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_rlgc_calculate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Scales the frequency independent results to a frequency f.  The skin
+  effect resistance goes as sqrt(f) and adds R/w of internal inductance
+  to the external inductance, the dielectric conductance goes as f.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter        - order of the matrices
+  double frequency             - f, Hz
+  double **inductance          - the external inductance
+  double **skin_resistance     - the skin effect resistance at 1 Hz
+                                 (see nmmtl_skin_effect)
+  double **conductance         - G/w (see nmmtl_conductance_calculate)
+  double **resistance_f        - out: R at f
+  double **inductance_f        - out: L at f
+  double **conductance_f       - out: G at f
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_rlgc_calculate(conductor_counter,frequency,inductance,
+                       skin_resistance,conductance,
+                       resistance_f,inductance_f,conductance_f);
+
+  */
+
+void nmmtl_rlgc_calculate(int conductor_counter,
+                          double frequency,
+                          double **inductance,
+                          double **skin_resistance,
+                          double **conductance,
+                          double **resistance_f,
+                          double **inductance_f,
+                          double **conductance_f)
+{
+  double omega = 2.0 * PI * frequency;
+  double root = sqrt(frequency);
+  int i, j;
+
+  for(i = 0; i < conductor_counter; i++)
+  {
+    for(j = 0; j < conductor_counter; j++)
+    {
+      resistance_f[i][j] = root * skin_resistance[i][j];
+      inductance_f[i][j] = inductance[i][j] + resistance_f[i][j] / omega;
+      conductance_f[i][j] = omega * conductance[i][j];
+    }
+  }
+}
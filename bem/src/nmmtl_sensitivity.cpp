@@ -0,0 +1,1067 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_sensitivity_parameters, which declares what the
+  electrostatic induction B and the inductance L are to be
+  differentiated with respect to, nmmtl_sensitivity_calculate, which
+  the kernel calls to find the derivatives, and nmmtl_sensitivity_free.
+
+  The parameters are the relative permittivity of each dielectric, the
+  thickness of each dielectric layer and the width of each signal
+  conductor of rectangles or polygons.
+
+  The derivatives are found by the adjoint method, reusing the LU
+  factors and charge distributions of the forward solve.  If A sigma_j
+  = b_j is the system for conductor j at one volt and B[j][i] = w_i
+  sigma_j the charge on conductor i, then with the adjoint A' lambda_i
+  = w_i
+
+    dB[j][i]/dp = dw_i/dp sigma_j + lambda_i (db_j/dp - dA/dp sigma_j)
+
+  which takes one transposed solve per conductor, whatever the number
+  of parameters.  The mesh and its numbering stay as they are.  A and
+  w_i are linear in the permittivities of the elements, and b_j does
+  not depend on them, so for a permittivity dA/dp and dw_i/dp are the
+  dielectric part of the assembly and the charge integrals with each
+  permittivity replaced by its rate of change.  For a geometric
+  parameter dA/dp, db_j/dp and dw_i/dp are central differences with the
+  element points moved by a displacement that is piecewise linear in x
+  or y, so that the mesh deforms with the geometry.  The edge exponents
+  nu are held at their forward values.  The same is done
+  with the free space system for the derivatives of L, which do not
+  depend on the permittivities:
+
+    dL/dp = -L dC0/dp L / C_SQUARED_INVERTED
+
+  The conductance is found the same way, as the derivative of B along
+  the loss parameter nmmtl_conductance_parameters sets up.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void nmmtl_sensitivity_extent(struct contour *contour,
+                                     double *xmin, double *xmax,
+                                     double *ymin, double *ymax);
+static int nmmtl_sensitivity_thickness(struct dielectric *layer,
+                                       struct contour *signals,
+                                       struct contour *groundwires,
+                                       SENSITIVITY_PARAMETER_P parameter);
+static int nmmtl_sensitivity_width(struct contour *signal,
+                                   struct dielectric *dielectrics,
+                                   struct contour *signals,
+                                   struct contour *groundwires,
+                                   SENSITIVITY_PARAMETER_P parameter);
+static double nmmtl_sensitivity_displacement(SENSITIVITY_PARAMETER_P
+                                             parameter,
+                                             double coordinate,
+                                             double *slope);
+static double nmmtl_sensitivity_tangent(SENSITIVITY_PARAMETER_P parameter,
+                                        double epsilon);
+static void nmmtl_sensitivity_rate(SENSITIVITY_PARAMETER_P parameter,
+                                   ELEMENT_STORE_P element_store);
+static void nmmtl_sensitivity_perturb(SENSITIVITY_PARAMETER_P parameter,
+                                      double step,
+                                      ELEMENT_STORE_P element_store);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_parameters
+
+  FUNCTIONAL DESCRIPTION:
+
+  Declares the parameters of a cross section and allocates the
+  derivatives: one permittivity parameter for each different relative
+  permittivity, one thickness parameter for each layer (a dielectric as
+  wide as the cross section) and one width parameter for each signal
+  conductor of rectangles or polygons that can be widened without
+  deforming anything else.  The displacement of a thickness goes from
+  zero at the bottom of the layer to one at its top across the parts of
+  the layer not taken up by conductors, which keep their shape.  That of
+  a width goes from -1/2 to 1/2 across the conductor and back to zero
+  at the nearest conductor or dielectric side to the left and right.
+
+  FORMAL PARAMETERS:
+
+  struct dielectric *dielectrics  - the dielectrics
+  struct contour *signals         - the signals
+  struct contour *groundwires     - the ground wires
+  int conductor_counter           - the number of signals
+  SENSITIVITY_P sensitivity       - out: the parameters, and the matrices
+                                    for the derivatives
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_sensitivity_parameters(dielectrics,signals,groundwires,
+                                        conductor_counter,&sensitivity);
+
+  */
+
+int nmmtl_sensitivity_parameters(struct dielectric *dielectrics,
+                                 struct contour *signals,
+                                 struct contour *groundwires,
+                                 int conductor_counter,
+                                 SENSITIVITY_P sensitivity)
+{
+  struct dielectric *die, *other;
+  struct contour *sig;
+  SENSITIVITY_PARAMETER_P parameter;
+  double xmin = 0.0, xmax = 0.0;
+  int number = conductor_counter, layer = 0, p;
+
+  memset(sensitivity,0,sizeof(SENSITIVITY));
+
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    number += 2;
+    if(die == dielectrics || die->x0 < xmin) xmin = die->x0;
+    if(die == dielectrics || die->x1 > xmax) xmax = die->x1;
+  }
+
+  sensitivity->parameters = (SENSITIVITY_PARAMETER_P)
+    calloc((size_t)number,sizeof(SENSITIVITY_PARAMETER));
+  if(sensitivity->parameters == NULL) return(FAIL);
+
+  /* - - - - - - - - - - - - - - - Permittivities - - - - - - - - - - - - - */
+
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    for(other = dielectrics; other != die; other = other->next)
+      if(other->constant == die->constant) break;
+    if(other != die) continue;
+
+    parameter = &sensitivity->parameters[sensitivity->number_parameters++];
+    parameter->kind = SENSITIVITY_PERMITTIVITY;
+    parameter->value = die->constant;
+  }
+
+  /* - - - - - - - - - - - - - - Layer thicknesses - - - - - - - - - - - - - */
+
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    if(die->x0 > xmin || die->x1 < xmax) continue;
+    layer++;
+    parameter = &sensitivity->parameters[sensitivity->number_parameters];
+    parameter->layer = layer;
+    if(nmmtl_sensitivity_thickness(die,signals,groundwires,parameter) !=
+       SUCCESS) break;
+    if(parameter->number_knots > 0) sensitivity->number_parameters++;
+  }
+
+  /* - - - - - - - - - - - - - - - Signal widths - - - - - - - - - - - - - - */
+
+  for(sig = signals; die == NULL && sig != NULL; sig = sig->next)
+  {
+    if(sig->primitive == CIRCLE) continue;
+    parameter = &sensitivity->parameters[sensitivity->number_parameters];
+    if(nmmtl_sensitivity_width(sig,dielectrics,signals,groundwires,
+                               parameter) != SUCCESS) break;
+    if(parameter->number_knots > 0) sensitivity->number_parameters++;
+    else
+      printf("Sensitivity: the width of %s cannot be changed without "
+             "changing another conductor or dielectric\n",sig->name);
+  }
+
+  /* - - - - - - - - - - - - - - - The derivatives - - - - - - - - - - - - - */
+
+  if(die == NULL && sig == NULL)
+  {
+    sensitivity->induction = (double ***)
+      calloc((size_t)sensitivity->number_parameters,sizeof(double **));
+    sensitivity->inductance = (double ***)
+      calloc((size_t)sensitivity->number_parameters,sizeof(double **));
+    for(p = 0; sensitivity->induction != NULL &&
+          sensitivity->inductance != NULL &&
+          p < sensitivity->number_parameters; p++)
+    {
+      sensitivity->induction[p] =
+        (double **)dim2(conductor_counter,conductor_counter,sizeof(double));
+      sensitivity->inductance[p] =
+        (double **)dim2(conductor_counter,conductor_counter,sizeof(double));
+      if(sensitivity->induction[p] == NULL ||
+         sensitivity->inductance[p] == NULL) break;
+    }
+    if(p == sensitivity->number_parameters) return(SUCCESS);
+  }
+
+  nmmtl_sensitivity_free(sensitivity);
+  return(FAIL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_extent
+
+  FUNCTIONAL DESCRIPTION:
+
+  The bounding box of a conductor.
+
+  FORMAL PARAMETERS:
+
+  struct contour *contour     - the conductor
+  double *xmin,*xmax          - out: its extent in x
+  double *ymin,*ymax          - out: and in y
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_sensitivity_extent(contour,&xmin,&xmax,&ymin,&ymax);
+
+  */
+
+static void nmmtl_sensitivity_extent(struct contour *contour,
+                                     double *xmin, double *xmax,
+                                     double *ymin, double *ymax)
+{
+  POLYPOINTS_P point;
+
+  switch(contour->primitive)
+  {
+  case CIRCLE:
+    /* the centre and the radius */
+    *xmin = contour->x0 - contour->x1;
+    *xmax = contour->x0 + contour->x1;
+    *ymin = contour->y0 - contour->x1;
+    *ymax = contour->y0 + contour->x1;
+    break;
+  case POLYGON:
+    *xmin = *xmax = contour->points != NULL ? contour->points->x : 0.0;
+    for(point = contour->points; point != NULL; point = point->next)
+    {
+      if(point->x < *xmin) *xmin = point->x;
+      if(point->x > *xmax) *xmax = point->x;
+    }
+    *ymin = contour->y0;
+    *ymax = contour->y1;
+    break;
+  default:
+    *xmin = contour->x0;
+    *xmax = contour->x1;
+    *ymin = contour->y0;
+    *ymax = contour->y1;
+    break;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_thickness
+
+  FUNCTIONAL DESCRIPTION:
+
+  Sets up the displacement for the thickness of a layer: zero below it,
+  one above it, and in between rising across the parts of the layer
+  that no conductor reaches into.  Leaves the parameter without knots
+  if conductors fill the layer.
+
+  FORMAL PARAMETERS:
+
+  struct dielectric *layer            - the layer
+  struct contour *signals             - the signals
+  struct contour *groundwires         - the ground wires
+  SENSITIVITY_PARAMETER_P parameter   - out: the parameter
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_sensitivity_thickness(layer,signals,groundwires,
+                                       parameter);
+
+  */
+
+static int nmmtl_sensitivity_thickness(struct dielectric *layer,
+                                       struct contour *signals,
+                                       struct contour *groundwires,
+                                       SENSITIVITY_PARAMETER_P parameter)
+{
+  struct contour *list, *contour;
+  double xmin, xmax, ymin, ymax;
+  double bottom, top, free_length;
+  int number = 0, k;
+
+  parameter->kind = SENSITIVITY_THICKNESS;
+  parameter->value = layer->y1 - layer->y0;
+  parameter->number_knots = 0;
+
+  for(list = signals; list != NULL;
+      list = list == signals ? groundwires : NULL)
+    for(contour = list; contour != NULL; contour = contour->next)
+      number++;
+
+  parameter->knots = (double (*)[2])malloc(sizeof(double[2]) *
+                                           (size_t)(2 * number + 4));
+  if(parameter->knots == NULL) return(FAIL);
+
+  /* walk up the layer, from the bottom to the next conductor that
+     reaches into it, over that conductor and on */
+  bottom = layer->y0;
+  free_length = 0.0;
+  parameter->knots[parameter->number_knots][0] = bottom;
+  parameter->knots[parameter->number_knots++][1] = 0.0;
+  while(bottom < layer->y1)
+  {
+    top = layer->y1;
+    for(list = signals; list != NULL;
+        list = list == signals ? groundwires : NULL)
+      for(contour = list; contour != NULL; contour = contour->next)
+      {
+        nmmtl_sensitivity_extent(contour,&xmin,&xmax,&ymin,&ymax);
+        if(ymax > bottom && ymin < top)
+          top = ymin > bottom ? ymin : bottom;
+      }
+    free_length += top - bottom;
+    parameter->knots[parameter->number_knots][0] = top;
+    parameter->knots[parameter->number_knots++][1] = free_length;
+
+    /* and over the conductors from there */
+    bottom = top;
+    for(k = 1; k > 0; )
+    {
+      k = 0;
+      for(list = signals; list != NULL;
+          list = list == signals ? groundwires : NULL)
+        for(contour = list; contour != NULL; contour = contour->next)
+        {
+          nmmtl_sensitivity_extent(contour,&xmin,&xmax,&ymin,&ymax);
+          if(ymin <= bottom && ymax > bottom && bottom < layer->y1)
+          {
+            bottom = ymax < layer->y1 ? ymax : layer->y1;
+            k = 1;
+          }
+        }
+    }
+    if(bottom > top)
+    {
+      parameter->knots[parameter->number_knots][0] = bottom;
+      parameter->knots[parameter->number_knots++][1] = free_length;
+    }
+  }
+
+  if(!(free_length > 0.0))
+  {
+    free(parameter->knots);
+    parameter->knots = NULL;
+    parameter->number_knots = 0;
+    return(SUCCESS);
+  }
+
+  for(k = 0; k < parameter->number_knots; k++)
+    parameter->knots[k][1] /= free_length;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_width
+
+  FUNCTIONAL DESCRIPTION:
+
+  Sets up the displacement for the width of a signal: -1/2 to 1/2 across
+  it, and back to zero at the nearest side of another conductor or of a
+  dielectric, or a conductor width away.  Leaves the parameter without
+  knots if a conductor or a dielectric side lies above or below it, which
+  would be deformed as well.
+
+  FORMAL PARAMETERS:
+
+  struct contour *signal              - the signal
+  struct dielectric *dielectrics      - the dielectrics
+  struct contour *signals             - the signals
+  struct contour *groundwires         - the ground wires
+  SENSITIVITY_PARAMETER_P parameter   - out: the parameter
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_sensitivity_width(signal,dielectrics,signals,
+                                   groundwires,parameter);
+
+  */
+
+static int nmmtl_sensitivity_width(struct contour *signal,
+                                   struct dielectric *dielectrics,
+                                   struct contour *signals,
+                                   struct contour *groundwires,
+                                   SENSITIVITY_PARAMETER_P parameter)
+{
+  struct contour *list, *contour;
+  struct dielectric *die;
+  double left, right, xmin, xmax, ymin, ymax, tolerance, side;
+  double xmin_die = 0.0, xmax_die = 0.0;
+  int s;
+
+  nmmtl_sensitivity_extent(signal,&left,&right,&ymin,&ymax);
+  parameter->kind = SENSITIVITY_WIDTH;
+  strcpy(parameter->name,signal->name);
+  parameter->value = right - left;
+  parameter->number_knots = 0;
+  tolerance = 1.0e-9 * parameter->value;
+
+  /* how far the displacement reaches to either side */
+  xmin = left - parameter->value;
+  xmax = right + parameter->value;
+
+  for(list = signals; list != NULL;
+      list = list == signals ? groundwires : NULL)
+    for(contour = list; contour != NULL; contour = contour->next)
+    {
+      if(contour == signal) continue;
+      nmmtl_sensitivity_extent(contour,&side,&xmax_die,&ymin,&ymax);
+      if(side < right + tolerance && xmax_die > left - tolerance)
+        return(SUCCESS);
+      if(xmax_die <= left && xmax_die > xmin) xmin = xmax_die;
+      if(side >= right && side < xmax) xmax = side;
+    }
+
+  /* the sides of dielectrics narrower than the cross section, those at
+     the sides of the conductor moving with them */
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    if(die == dielectrics || die->x0 < xmin_die) xmin_die = die->x0;
+    if(die == dielectrics || die->x1 > xmax_die) xmax_die = die->x1;
+  }
+  for(die = dielectrics; die != NULL; die = die->next)
+  {
+    for(s = 0; s < 2; s++)
+    {
+      side = s == 0 ? die->x0 : die->x1;
+      if(side <= xmin_die || side >= xmax_die ||
+         fabs(side - left) <= tolerance || fabs(side - right) <= tolerance)
+        continue;
+      if(side > left && side < right) return(SUCCESS);
+      if(side < left && side > xmin) xmin = side;
+      if(side > right && side < xmax) xmax = side;
+    }
+  }
+
+  parameter->knots = (double (*)[2])malloc(sizeof(double[2]) * 4);
+  if(parameter->knots == NULL) return(FAIL);
+  parameter->knots[0][0] = xmin;
+  parameter->knots[0][1] = 0.0;
+  parameter->knots[1][0] = left;
+  parameter->knots[1][1] = -0.5;
+  parameter->knots[2][0] = right;
+  parameter->knots[2][1] = 0.5;
+  parameter->knots[3][0] = xmax;
+  parameter->knots[3][1] = 0.0;
+  parameter->number_knots = 4;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_displacement
+
+  FUNCTIONAL DESCRIPTION:
+
+  The displacement of a geometric parameter at a coordinate, per meter
+  of change in the parameter, and its slope.
+
+  FORMAL PARAMETERS:
+
+  SENSITIVITY_PARAMETER_P parameter - the parameter
+  double coordinate                 - x for a width, y for a thickness
+  double *slope                     - out: d displacement / d coordinate
+
+  RETURN VALUE:
+
+  the displacement
+
+  CALLING SEQUENCE:
+
+  displacement = nmmtl_sensitivity_displacement(parameter,coordinate,
+                                                &slope);
+
+  */
+
+static double nmmtl_sensitivity_displacement(SENSITIVITY_PARAMETER_P
+                                             parameter,
+                                             double coordinate,
+                                             double *slope)
+{
+  double (*knots)[2] = parameter->knots;
+  int k, last = parameter->number_knots - 1;
+
+  *slope = 0.0;
+  if(coordinate <= knots[0][0]) return(knots[0][1]);
+  if(coordinate >= knots[last][0]) return(knots[last][1]);
+
+  for(k = 0; k < last; k++)
+    if(coordinate < knots[k+1][0]) break;
+
+  *slope = (knots[k+1][1] - knots[k][1]) / (knots[k+1][0] - knots[k][0]);
+  return(knots[k][1] + *slope * (coordinate - knots[k][0]));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_tangent
+
+  FUNCTIONAL DESCRIPTION:
+
+  The loss tangent of a relative permittivity, from the knots of the
+  loss parameter; zero for one no dielectric has, such as that of the
+  air.
+
+  FORMAL PARAMETERS:
+
+  SENSITIVITY_PARAMETER_P parameter - the loss parameter
+  double epsilon                    - the relative permittivity
+
+  RETURN VALUE:
+
+  the loss tangent
+
+  CALLING SEQUENCE:
+
+  tangent = nmmtl_sensitivity_tangent(parameter,epsilon);
+
+  */
+
+static double nmmtl_sensitivity_tangent(SENSITIVITY_PARAMETER_P parameter,
+                                        double epsilon)
+{
+  int k;
+
+  for(k = 0; k < parameter->number_knots; k++)
+    if(parameter->knots[k][0] == epsilon) return(parameter->knots[k][1]);
+  return(0.0);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_rate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Replaces the permittivity of every element side by its rate of change
+  with a permittivity or loss parameter: one for the sides with that
+  permittivity and zero for the others, or the permittivity times its
+  loss tangent.
+
+  FORMAL PARAMETERS:
+
+  SENSITIVITY_PARAMETER_P parameter - the parameter
+  ELEMENT_STORE_P element_store     - the elements, changed in place
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_sensitivity_rate(parameter,element_store);
+
+  */
+
+static void nmmtl_sensitivity_rate(SENSITIVITY_PARAMETER_P parameter,
+                                   ELEMENT_STORE_P element_store)
+{
+  CELEMENTS_P cel, cel_end;
+  DELEMENTS_P del, del_end;
+
+  cel = element_store->celements;
+  cel_end = cel + element_store->number_celements;
+  del = element_store->delements;
+  del_end = del + element_store->number_delements;
+
+  if(parameter->kind == SENSITIVITY_PERMITTIVITY)
+  {
+    for(; cel < cel_end; cel++)
+      cel->epsilon = cel->epsilon == parameter->value ? 1.0 : 0.0;
+    for(; del < del_end; del++)
+    {
+      del->epsilonplus = del->epsilonplus == parameter->value ? 1.0 : 0.0;
+      del->epsilonminus = del->epsilonminus == parameter->value ? 1.0 : 0.0;
+    }
+    return;
+  }
+
+  for(; cel < cel_end; cel++)
+    cel->epsilon *= nmmtl_sensitivity_tangent(parameter,cel->epsilon);
+  for(; del < del_end; del++)
+  {
+    del->epsilonplus *= nmmtl_sensitivity_tangent(parameter,
+                                                  del->epsilonplus);
+    del->epsilonminus *= nmmtl_sensitivity_tangent(parameter,
+                                                   del->epsilonminus);
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_perturb
+
+  FUNCTIONAL DESCRIPTION:
+
+  Changes a geometric parameter of the elements by step: the
+  coordinates of every element point move by step times the
+  displacement, turning the normals of the dielectric elements with the
+  deformation.
+
+  FORMAL PARAMETERS:
+
+  SENSITIVITY_PARAMETER_P parameter - the parameter
+  double step                       - how far to change it
+  ELEMENT_STORE_P element_store     - the elements, changed in place
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_sensitivity_perturb(parameter,step,element_store);
+
+  */
+
+static void nmmtl_sensitivity_perturb(SENSITIVITY_PARAMETER_P parameter,
+                                      double step,
+                                      ELEMENT_STORE_P element_store)
+{
+  CELEMENTS_P cel, cel_end;
+  DELEMENTS_P del, del_end;
+  double *coordinate, *normal, slope, length;
+  int i;
+
+  cel = element_store->celements;
+  cel_end = cel + element_store->number_celements;
+  del = element_store->delements;
+  del_end = del + element_store->number_delements;
+
+  for(; cel < cel_end; cel++)
+  {
+    coordinate = parameter->kind == SENSITIVITY_WIDTH ? cel->xpts : cel->ypts;
+    for(i = 0; i < ELEMENT_PTS; i++)
+      coordinate[i] += step *
+        nmmtl_sensitivity_displacement(parameter,coordinate[i],&slope);
+  }
+
+  for(; del < del_end; del++)
+  {
+    if(parameter->kind == SENSITIVITY_WIDTH)
+    {
+      coordinate = del->xpts;
+      normal = &del->normalx;
+    }
+    else
+    {
+      coordinate = del->ypts;
+      normal = &del->normaly;
+    }
+
+    /* a straight element stays straight, its normal component along the
+       stretch shrinking as the element does */
+    nmmtl_sensitivity_displacement(parameter,
+                                   0.5 * (coordinate[0] +
+                                          coordinate[ELEMENT_PTS-1]),
+                                   &slope);
+    *normal /= 1.0 + step * slope;
+    length = sqrt(del->normalx * del->normalx + del->normaly * del->normaly);
+    del->normalx /= length;
+    del->normaly /= length;
+
+    for(i = 0; i < ELEMENT_PTS; i++)
+      coordinate[i] += step *
+        nmmtl_sensitivity_displacement(parameter,coordinate[i],&slope);
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_calculate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Finds the derivatives of B and L with respect to each parameter, and
+  the conductance if it is asked for, from the factored systems and
+  charge distributions of the forward solve, as the module description
+  gives.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter               - number of conductors
+  CONDUCTOR_DATA_P conductor_data     - conductor elements by conductor
+  ELEMENT_STORE_P element_store       - all the elements, perturbed and
+                                        put back
+  unsigned int node_point_counter     - total number of node points
+  unsigned int highest_conductor_node - highest node number for conductors
+  double length_scale                 - as for nmmtl_assemble
+  double **assemble_matrix            - the factored system with the
+                                        dielectrics, node_point_counter
+                                        square
+  int *ipvt                           - its pivots
+  double **sigma                      - its solution for each conductor
+  double **free_space_matrix          - the factored free space system,
+                                        highest_conductor_node + 1 square
+  int *free_space_ipvt                - its pivots
+  double **free_space_sigma           - its solution for each conductor
+  double **inductance                 - [L] matrix
+  SENSITIVITY_P sensitivity           - the parameters, out: the
+                                        derivatives and the conductance
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_sensitivity_calculate(conductor_counter,conductor_data,
+                                       element_store,node_point_counter,
+                                       highest_conductor_node,length_scale,
+                                       assemble_matrix,ipvt,sigma,
+                                       free_space_matrix,free_space_ipvt,
+                                       free_space_sigma,inductance,
+                                       sensitivity);
+
+  */
+
+int nmmtl_sensitivity_calculate(int conductor_counter,
+                                CONDUCTOR_DATA_P conductor_data,
+                                ELEMENT_STORE_P element_store,
+                                unsigned int node_point_counter,
+                                unsigned int highest_conductor_node,
+                                double length_scale,
+                                double **assemble_matrix,
+                                int *ipvt,
+                                double **sigma,
+                                double **free_space_matrix,
+                                int *free_space_ipvt,
+                                double **free_space_sigma,
+                                double **inductance,
+                                SENSITIVITY_P sensitivity)
+{
+  int order = (int)node_point_counter;
+  int free_space_order = (int)highest_conductor_node + 1;
+  int n = conductor_counter;
+  int p, free_space, pass, size, i, j, k, r, c, int_status;
+  unsigned int node;
+  double **lambda, **free_space_lambda, **difference, **charge, **u;
+  double **derivative, *unit, h, sum;
+  double **induction_p, **inductance_p;
+  CELEMENTS_P saved_celements;
+  DELEMENTS_P saved_delements;
+  SENSITIVITY_PARAMETER_P parameter;
+
+  lambda = (double **)dim2(n,order,sizeof(double));
+  free_space_lambda = (double **)dim2(n,free_space_order,sizeof(double));
+  difference = (double **)dim2(order,order,sizeof(double));
+  charge = (double **)dim2(2 * n,n,sizeof(double));
+  u = (double **)dim2(n,order,sizeof(double));
+  derivative = (double **)dim2(n,n,sizeof(double));
+  unit = (double *)calloc((size_t)order,sizeof(double));
+  saved_celements = (CELEMENTS_P)
+    malloc(sizeof(CELEMENTS) * (size_t)element_store->number_celements + 1);
+  saved_delements = (DELEMENTS_P)
+    malloc(sizeof(DELEMENTS) * (size_t)element_store->number_delements + 1);
+  if(lambda == NULL || free_space_lambda == NULL || difference == NULL ||
+     charge == NULL || u == NULL || derivative == NULL || unit == NULL ||
+     saved_celements == NULL || saved_delements == NULL)
+  {
+    if(lambda != NULL) free2((void **)lambda);
+    if(free_space_lambda != NULL) free2((void **)free_space_lambda);
+    if(difference != NULL) free2((void **)difference);
+    if(charge != NULL) free2((void **)charge);
+    if(u != NULL) free2((void **)u);
+    if(derivative != NULL) free2((void **)derivative);
+    free(unit);
+    free(saved_celements);
+    free(saved_delements);
+    return(FAIL);
+  }
+
+  memcpy(saved_celements,element_store->celements,
+         sizeof(CELEMENTS) * (size_t)element_store->number_celements);
+  memcpy(saved_delements,element_store->delements,
+         sizeof(DELEMENTS) * (size_t)element_store->number_delements);
+
+  /* - - - - - - - - - - - - - - The adjoint solves - - - - - - - - - - - - */
+
+  /* the charge on each conductor is linear in the charge density at its
+     nodes: lambda[i] starts out as the weights w_i */
+  for(node = 0; node <= highest_conductor_node; node++)
+  {
+    unit[node] = 1.0;
+    nmmtl_charge(unit,n,conductor_data,charge[0]);
+    nmmtl_charge_free_space(unit,n,conductor_data,charge[1]);
+    for(i = 0; i < n; i++)
+    {
+      lambda[i][node] = charge[0][i];
+      free_space_lambda[i][node] = charge[1][i];
+    }
+    unit[node] = 0.0;
+  }
+
+  for(i = 0; i < n; i++)
+  {
+    lu_solve_transpose(&order,assemble_matrix[0],lambda[i],lambda[i],
+                       &order,ipvt,&int_status);
+    if(sensitivity->number_parameters > 0)
+      lu_solve_transpose(&free_space_order,free_space_matrix[0],
+                         free_space_lambda[i],free_space_lambda[i],
+                         &free_space_order,free_space_ipvt,&int_status);
+  }
+
+  /* - - - - - - - - - - - - - - - Each parameter - - - - - - - - - - - - - */
+
+  /* and after them the loss, whose derivative is the conductance */
+  for(p = 0; p <= sensitivity->number_parameters; p++)
+  {
+    if(p < sensitivity->number_parameters)
+    {
+      parameter = &sensitivity->parameters[p];
+      induction_p = sensitivity->induction[p];
+      inductance_p = sensitivity->inductance[p];
+      for(i = 0; i < n; i++)
+        for(j = 0; j < n; j++)
+          inductance_p[i][j] = 0.0;
+    }
+    else if(sensitivity->conductance != NULL)
+    {
+      parameter = &sensitivity->loss;
+      induction_p = sensitivity->conductance;
+      inductance_p = NULL;
+    }
+    else break;
+    h = SENSITIVITY_STEP * parameter->value;
+
+    /* with the dielectrics, then without for a geometric parameter */
+    for(free_space = 0;
+        free_space <= (parameter->kind == SENSITIVITY_THICKNESS ||
+                       parameter->kind == SENSITIVITY_WIDTH);
+        free_space++)
+    {
+      size = free_space ? free_space_order : order;
+      for(r = 0; r < size; r++)
+        for(c = 0; c < size; c++)
+          difference[r][c] = 0.0;
+
+      /* A and the charges are linear in the permittivities and the loads
+         do not depend on them, so with each permittivity replaced by its
+         rate of change the dielectric part of the assembly gives dA/dp,
+         and the charges dw/dp sigma_j: with difference -dA/dp and h one
+         half the sums below come out the same */
+      if(parameter->kind == SENSITIVITY_PERMITTIVITY ||
+         parameter->kind == SENSITIVITY_LOSS)
+      {
+        h = 0.5;
+        nmmtl_sensitivity_rate(parameter,element_store);
+        nmmtl_assemble_dielectric(n,conductor_data,element_store,
+                                  length_scale,difference);
+        for(r = 0; r < size; r++)
+          for(c = 0; c < size; c++)
+            difference[r][c] = -difference[r][c];
+        for(j = 0; j < n; j++)
+        {
+          nmmtl_charge(sigma[j],n,conductor_data,charge[j]);
+          for(i = 0; i < n; i++)
+            charge[n + j][i] = 0.0;
+        }
+        memcpy(element_store->celements,saved_celements,
+               sizeof(CELEMENTS) * (size_t)element_store->number_celements);
+        memcpy(element_store->delements,saved_delements,
+               sizeof(DELEMENTS) * (size_t)element_store->number_delements);
+      }
+
+      /* otherwise difference ends up as A(p - h) - A(p + h), and charge
+         holds the charges of each solution plus lambda times its load at
+         p + h and then p - h */
+      else for(pass = 0; pass < 2; pass++)
+      {
+        nmmtl_sensitivity_perturb(parameter,pass == 0 ? h : -h,
+                                  element_store);
+        if(pass == 1)
+          for(r = 0; r < size; r++)
+            for(c = 0; c < size; c++)
+              difference[r][c] = -difference[r][c];
+        if(free_space)
+        {
+          nmmtl_assemble_free_space(n,conductor_data,difference);
+          for(j = 0; j < n; j++)
+          {
+            nmmtl_charge_free_space(free_space_sigma[j],n,conductor_data,
+                                    charge[pass * n + j]);
+            nmmtl_load_free_space(unit,j + 1,conductor_data);
+            for(i = 0; i < n; i++)
+              for(c = 0; c < size; c++)
+                charge[pass * n + j][i] += free_space_lambda[i][c] * unit[c];
+            nmmtl_unload(unit,j + 1,conductor_data);
+          }
+        }
+        else
+        {
+          nmmtl_assemble(n,conductor_data,element_store,length_scale,
+                         difference);
+          for(j = 0; j < n; j++)
+          {
+            nmmtl_charge(sigma[j],n,conductor_data,charge[pass * n + j]);
+            nmmtl_load(unit,j + 1,conductor_data);
+            for(i = 0; i < n; i++)
+              for(c = 0; c < size; c++)
+                charge[pass * n + j][i] += lambda[i][c] * unit[c];
+            nmmtl_unload(unit,j + 1,conductor_data);
+          }
+        }
+        memcpy(element_store->celements,saved_celements,
+               sizeof(CELEMENTS) * (size_t)element_store->number_celements);
+        memcpy(element_store->delements,saved_delements,
+               sizeof(DELEMENTS) * (size_t)element_store->number_delements);
+      }
+
+      /* the solver sees the transpose of the assembled array, so
+         lambda' dA sigma is sigma' (difference lambda) / -2h */
+      for(i = 0; i < n; i++)
+        for(c = 0; c < size; c++)
+        {
+          sum = 0.0;
+          for(r = 0; r < size; r++)
+            sum += difference[c][r] *
+              (free_space ? free_space_lambda[i][r] : lambda[i][r]);
+          u[i][c] = sum;
+        }
+
+      for(j = 0; j < n; j++)
+        for(i = 0; i < n; i++)
+        {
+          sum = 0.0;
+          for(c = 0; c < size; c++)
+            sum += (free_space ? free_space_sigma[j][c] : sigma[j][c]) *
+              u[i][c];
+          derivative[j][i] = (charge[j][i] - charge[n + j][i] + sum) /
+            (2.0 * h);
+        }
+
+      if(!free_space)
+      {
+        for(j = 0; j < n; j++)
+          for(i = 0; i < n; i++)
+            induction_p[j][i] = derivative[j][i];
+        continue;
+      }
+
+      /* dL = -L dC0 L / C_SQUARED_INVERTED */
+      for(i = 0; i < n; i++)
+        for(j = 0; j < n; j++)
+        {
+          sum = 0.0;
+          for(k = 0; k < n; k++)
+            sum += derivative[i][k] * inductance[k][j];
+          u[i][j] = sum;
+        }
+      for(i = 0; i < n; i++)
+        for(j = 0; j < n; j++)
+        {
+          sum = 0.0;
+          for(k = 0; k < n; k++)
+            sum += inductance[i][k] * u[k][j];
+          inductance_p[i][j] = -sum / C_SQUARED_INVERTED;
+        }
+    }
+  }
+
+  free2((void **)lambda);
+  free2((void **)free_space_lambda);
+  free2((void **)difference);
+  free2((void **)charge);
+  free2((void **)u);
+  free2((void **)derivative);
+  free(unit);
+  free(saved_celements);
+  free(saved_delements);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sensitivity_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Frees what nmmtl_sensitivity_parameters and
+  nmmtl_conductance_parameters allocated.
+
+  FORMAL PARAMETERS:
+
+  SENSITIVITY_P sensitivity   - the sensitivity
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_sensitivity_free(&sensitivity);
+
+  */
+
+void nmmtl_sensitivity_free(SENSITIVITY_P sensitivity)
+{
+  int p;
+
+  free(sensitivity->loss.knots);
+  for(p = 0; p < sensitivity->number_parameters; p++)
+  {
+    if(sensitivity->parameters != NULL)
+      free(sensitivity->parameters[p].knots);
+    if(sensitivity->induction != NULL &&
+       sensitivity->induction[p] != NULL)
+      free2((void **)sensitivity->induction[p]);
+    if(sensitivity->inductance != NULL &&
+       sensitivity->inductance[p] != NULL)
+      free2((void **)sensitivity->inductance[p]);
+  }
+  free(sensitivity->parameters);
+  free(sensitivity->induction);
+  free(sensitivity->inductance);
+  memset(sensitivity,0,sizeof(SENSITIVITY));
+}
@@ -0,0 +1,556 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_serve, the long running "mmtl_bem --serve" mode, and the
+  static functions which it calls.  Cross sections in .xsctn format are
+  read from stdin or from clients of a Unix domain socket, and the results
+  are written back in a compact line oriented form.  The unit tables are
+  set up once, and the edge singularity (nu) solutions found for one cross
+  section are reused by the next.
+
+  PROTOCOL:
+
+  A request is the text of a .xsctn file followed by a line holding only
+  a period.  A client may send any number of requests on one connection.
+  Each request gets one response, ending with a line holding only a
+  period:
+
+  ok <n>
+  names <name 1> ... <name n>
+  B <n*n values>
+  L <n*n values>
+  Rdc <n*n values>
+  Z0 <n values>
+  v <n values>
+  er <n values>
+  fxt <n*n values>
+  bxt <n*n values>
+  pairs <2*p indices> \
+  Zdiff <p values>     |  the p differential pairs, if any, each the
+  Zcomm <p values>     |  indices of its positive and negative signal
+  vdiff <p values>     |  in the names
+  vcomm <p values>    /
+  vm <n values>       \
+  Zm <n values>        |  the modes of the lossless lines, if the
+  Tv <n*n values>      |  modal analysis succeeded
+  Ti <n*n values>     /
+  f <frequency>       \
+  R <n*n values>       |
+  Lf <n*n values>      |
+  G <n*n values>       |  for each frequency the cross section
+  vm <n values>        |  sets, if any, the modes if the modal
+  Zm <n values>        |  analysis succeeded
+  am <n values>        |
+  Tv <n*n values>      |
+  Ti <n*n values>     /
+  .
+
+  Matrices are in row major order, the row being the active signal.  On
+  failure the response is "error <reason>" followed by the period line.
+
+  A request longer than SERVE_MAX_REQUEST bytes is answered with "error
+  request too large", and a socket client that sends nothing for
+  SERVE_IDLE_SECONDS with "error timeout"; either way the connection is
+  then closed.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+#include "electro_prototype.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* accepted connections waiting for a worker */
+typedef struct serve_queue
+{
+  MESH_SETTINGS_P settings;
+  int *fds;
+  int size;
+  int head;
+  int count;
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+} SERVE_QUEUE, *SERVE_QUEUE_P;
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* connections that may wait for a worker, per worker */
+#define SERVE_BACKLOG_PER_WORKER 2
+
+/* initial size of the request buffer, grows as needed */
+#define SERVE_REQUEST_SIZE 8192
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static void nmmtl_serve_connection(FILE *in, FILE *out,
+                                   MESH_SETTINGS_P settings);
+static void nmmtl_serve_request(char *request, size_t length, FILE *out,
+                                MESH_SETTINGS_P settings);
+static void nmmtl_serve_values(FILE *out, const char *label,
+                               double *values, int count);
+static void *nmmtl_serve_worker(void *arg);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_serve
+
+  FUNCTIONAL DESCRIPTION:
+
+  Serve solve requests until end of input (stdin) or forever (socket).
+
+  With no socket path, requests are read from stdin and responses written
+  to stdout, one at a time.  The solver's progress messages are sent to
+  stderr instead so they do not mix with the responses.
+
+  With a socket path, a Unix domain socket is created there, replacing
+  any old one, and each client connection is handed to one of a fixed
+  pool of worker threads.  When all the workers are busy, up to
+  SERVE_BACKLOG_PER_WORKER connections per worker wait in a queue; after
+  that, new connections wait in the listen backlog.
+
+  FORMAL PARAMETERS:
+
+  const char *socket_path   - path of the socket, NULL for stdin/stdout
+  int workers               - size of the worker pool, < 1 for one per cpu
+  MESH_SETTINGS_P settings  - how every request is meshed
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the socket could not be set up
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_serve(socket_path,workers,&settings);
+
+  */
+
+int nmmtl_serve(const char *socket_path, int workers,
+                MESH_SETTINGS_P settings)
+{
+  SERVE_QUEUE queue;
+  pthread_t *threads;
+  struct sockaddr_un address;
+  int listen_fd, fd;
+  int out_fd;
+  int i;
+  FILE *out;
+
+  /* a client hanging up early must not take the daemon down */
+  signal(SIGPIPE, SIG_IGN);
+
+  /* set the unit tables up now, before there are threads to race */
+  setunits();
+
+  /* a served request answers only through its response; the banners,
+     listings, plot and dump files are for the command line */
+  OUTPUT_PRODUCTS &= ~(OUTPUT_PROGRESS | OUTPUT_PLOT | OUTPUT_PLOT_BINARY |
+                       OUTPUT_DUMP);
+
+  if(socket_path == NULL)
+  {
+    /* keep the real stdout for responses, send the chatter to stderr */
+    out_fd = dup(STDOUT_FILENO);
+    if(out_fd < 0) return(FAIL);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    out = fdopen(out_fd, "w");
+    nmmtl_serve_connection(stdin, out, settings);
+    fclose(out);
+    return(SUCCESS);
+  }
+
+  if(strlen(socket_path) >= sizeof(address.sun_path))
+  {
+    fprintf(stderr, "Error: socket path %s is too long\n", socket_path);
+    return(FAIL);
+  }
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listen_fd < 0)
+  {
+    perror("socket");
+    return(FAIL);
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socket_path);
+  unlink(socket_path);
+
+  if(bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+     listen(listen_fd, SOMAXCONN) < 0)
+  {
+    perror(socket_path);
+    close(listen_fd);
+    return(FAIL);
+  }
+
+  if(workers < 1) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if(workers < 1) workers = 1;
+
+  queue.settings = settings;
+  queue.size = workers * SERVE_BACKLOG_PER_WORKER;
+  queue.fds = (int *)malloc(queue.size * sizeof(int));
+  queue.head = 0;
+  queue.count = 0;
+  pthread_mutex_init(&queue.lock, NULL);
+  pthread_cond_init(&queue.not_empty, NULL);
+  pthread_cond_init(&queue.not_full, NULL);
+
+  threads = (pthread_t *)malloc(workers * sizeof(pthread_t));
+  for(i = 0; i < workers; i++)
+    pthread_create(&threads[i], NULL, nmmtl_serve_worker, &queue);
+
+  fprintf(stderr, "mmtl_bem: serving on %s with %d workers\n",
+          socket_path, workers);
+
+  while(1)
+  {
+    fd = accept(listen_fd, NULL, NULL);
+    if(fd < 0) continue;
+
+    pthread_mutex_lock(&queue.lock);
+    while(queue.count == queue.size)
+      pthread_cond_wait(&queue.not_full, &queue.lock);
+    queue.fds[(queue.head + queue.count) % queue.size] = fd;
+    queue.count++;
+    pthread_cond_signal(&queue.not_empty);
+    pthread_mutex_unlock(&queue.lock);
+  }
+
+  /* not reached - the daemon runs until it is killed */
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_serve_worker
+
+  FUNCTIONAL DESCRIPTION:
+
+  Body of a worker thread: take connections off the queue and serve each
+  until the client closes it.
+
+  FORMAL PARAMETERS:
+
+  void *arg   - the SERVE_QUEUE
+
+  RETURN VALUE:
+
+  None, never returns
+
+  */
+
+static void *nmmtl_serve_worker(void *arg)
+{
+  SERVE_QUEUE_P queue = (SERVE_QUEUE_P)arg;
+  struct timeval idle;
+  int fd;
+  FILE *in, *out;
+
+  while(1)
+  {
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0)
+      pthread_cond_wait(&queue->not_empty, &queue->lock);
+    fd = queue->fds[queue->head];
+    queue->head = (queue->head + 1) % queue->size;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+
+    /* a client that goes quiet must not hold the worker forever */
+    idle.tv_sec = SERVE_IDLE_SECONDS;
+    idle.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+
+    /* separate streams for each direction, each closes its own fd */
+    in = fdopen(fd, "r");
+    out = fdopen(dup(fd), "w");
+    if(in != NULL && out != NULL)
+      nmmtl_serve_connection(in, out, queue->settings);
+    if(out != NULL) fclose(out);
+    if(in != NULL) fclose(in);
+    else close(fd);
+  }
+
+  return(NULL);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_serve_connection
+
+  FUNCTIONAL DESCRIPTION:
+
+  Collect requests from a stream, up to each period line, and answer
+  them, until end of file.  An unterminated request at end of file is
+  dropped.  A request growing past SERVE_MAX_REQUEST, or a read timing
+  out (the workers set SO_RCVTIMEO on their sockets), is answered with
+  an error and ends the connection.
+
+  FORMAL PARAMETERS:
+
+  FILE *in                  - requests
+  FILE *out                 - responses
+  MESH_SETTINGS_P settings  - how the requests are meshed
+
+  RETURN VALUE:
+
+  None
+
+  */
+
+static void nmmtl_serve_connection(FILE *in, FILE *out,
+                                   MESH_SETTINGS_P settings)
+{
+  char line[GPGE_MAX];
+  char *request;
+  size_t length = 0, size = SERVE_REQUEST_SIZE, line_length;
+
+  request = (char *)malloc(size);
+
+  while(fgets(line, GPGE_MAX, in) != NULL)
+  {
+    if(line[0] == '.' && (line[1] == '\n' || line[1] == '\r' ||
+                          line[1] == '\0'))
+    {
+      nmmtl_serve_request(request, length, out, settings);
+      length = 0;
+      continue;
+    }
+
+    line_length = strlen(line);
+    if(length + line_length + 1 > SERVE_MAX_REQUEST)
+    {
+      fputs("error request too large\n.\n", out);
+      fflush(out);
+      break;
+    }
+    if(length + line_length + 1 > size)
+    {
+      while(length + line_length + 1 > size) size *= 2;
+      request = (char *)realloc(request, size);
+    }
+    memcpy(request + length, line, line_length);
+    length += line_length;
+  }
+
+  if(ferror(in) && (errno == EAGAIN || errno == EWOULDBLOCK))
+  {
+    fputs("error timeout\n.\n", out);
+    fflush(out);
+  }
+
+  free(request);
+
+  /* the matrix inversion workspace is kept per thread, let it go while
+     the worker waits for the next connection */
+  release_invert_matrix();
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_serve_request
+
+  FUNCTIONAL DESCRIPTION:
+
+  Parse one cross section, solve it and write the response.
+
+  FORMAL PARAMETERS:
+
+  char *request             - text of the .xsctn file, need not be
+                              terminated
+  size_t length             - its length
+  FILE *out                 - where the response goes
+  MESH_SETTINGS_P settings  - how it is meshed
+
+  RETURN VALUE:
+
+  None
+
+  */
+
+static void nmmtl_serve_request(char *request, size_t length, FILE *out,
+                                MESH_SETTINGS_P settings)
+{
+  int status;
+  int cntr_seg, pln_seg;
+  double coupling, risetime, conductivity;
+  double half_minimum_dimension = -1.0;
+  int gnd_planes;
+  double top_ground_plane_thickness, bottom_ground_plane_thickness;
+  struct dielectric *dielectrics = NULL;
+  struct contour *signals = NULL;
+  struct contour *groundwires = NULL;
+  int num_signals = 0, num_grounds = 0;
+  int units;
+  int number_frequencies;
+  double frequencies[MMTL_MAX_FREQUENCIES];
+  int number_pairs;
+  char pairs[MMTL_MAX_PAIRS][2][SIZE_SIG_NAME];
+  MMTL_RESULTS_P results = NULL;
+  int n, i;
+
+  if(length == 0)
+  {
+    fputs("error empty request\n.\n", out);
+    fflush(out);
+    return;
+  }
+
+  status = nmmtl_parse_xsctn_buffer(request, length, "request", &cntr_seg,
+                                    &pln_seg, &coupling, &risetime,
+                                    &conductivity, &half_minimum_dimension,
+                                    &gnd_planes, &top_ground_plane_thickness,
+                                    &bottom_ground_plane_thickness,
+                                    &dielectrics, &signals, &groundwires,
+                                    &num_signals, &num_grounds, &units,
+                                    &number_frequencies, frequencies,
+                                    &number_pairs, pairs);
+
+  if(status != SUCCESS)
+    fputs("error cannot parse cross section\n", out);
+  else if(num_signals < 1)
+    fputs("error no signal conductors\n", out);
+  else if(nmmtl_solve_lists(cntr_seg, pln_seg, coupling, risetime,
+                            conductivity, half_minimum_dimension,
+                            gnd_planes, dielectrics, signals, groundwires,
+                            num_signals, number_frequencies, frequencies,
+                            number_pairs, pairs, FALSE, settings,
+                            &results) != SUCCESS)
+    fputs("error solution failed\n", out);
+  else
+  {
+    n = results->num_signals;
+    fprintf(out, "ok %d\nnames", n);
+    for(i = 0; i < n; i++) fprintf(out, " %s", results->signal_names[i]);
+    putc('\n', out);
+    nmmtl_serve_values(out, "B", results->electrostatic_induction, n*n);
+    nmmtl_serve_values(out, "L", results->inductance, n*n);
+    nmmtl_serve_values(out, "Rdc", results->Rdc, n*n);
+    nmmtl_serve_values(out, "Z0", results->characteristic_impedance, n);
+    nmmtl_serve_values(out, "v", results->propagation_velocity, n);
+    nmmtl_serve_values(out, "er", results->equivalent_dielectric, n);
+    nmmtl_serve_values(out, "fxt", results->forward_xtk, n*n);
+    nmmtl_serve_values(out, "bxt", results->backward_xtk, n*n);
+    if(results->num_pairs > 0)
+    {
+      fputs("pairs", out);
+      for(i = 0; i < 2 * results->num_pairs; i++)
+        fprintf(out, " %d", results->pairs[i]);
+      putc('\n', out);
+      nmmtl_serve_values(out, "Zdiff", results->differential_impedance,
+                         results->num_pairs);
+      nmmtl_serve_values(out, "Zcomm", results->common_impedance,
+                         results->num_pairs);
+      nmmtl_serve_values(out, "vdiff", results->differential_velocity,
+                         results->num_pairs);
+      nmmtl_serve_values(out, "vcomm", results->common_velocity,
+                         results->num_pairs);
+    }
+    if(results->modal_velocity != NULL)
+    {
+      nmmtl_serve_values(out, "vm", results->modal_velocity, n);
+      nmmtl_serve_values(out, "Zm", results->modal_impedance, n);
+      nmmtl_serve_values(out, "Tv", results->voltage_modes, n*n);
+      nmmtl_serve_values(out, "Ti", results->current_modes, n*n);
+    }
+    for(i = 0; i < results->num_frequencies; i++)
+    {
+      nmmtl_serve_values(out, "f", &results->frequencies[i], 1);
+      nmmtl_serve_values(out, "R", &results->resistance[i*n*n], n*n);
+      nmmtl_serve_values(out, "Lf", &results->ac_inductance[i*n*n], n*n);
+      nmmtl_serve_values(out, "G", &results->conductance[i*n*n], n*n);
+      if(results->ac_modal_velocity == NULL) continue;
+      nmmtl_serve_values(out, "vm", &results->ac_modal_velocity[i*n], n);
+      nmmtl_serve_values(out, "Zm", &results->ac_modal_impedance[i*n], n);
+      nmmtl_serve_values(out, "am", &results->modal_attenuation[i*n], n);
+      nmmtl_serve_values(out, "Tv", &results->ac_voltage_modes[i*n*n], n*n);
+      nmmtl_serve_values(out, "Ti", &results->ac_current_modes[i*n*n], n*n);
+    }
+    mmtl_results_free(results);
+  }
+  fputs(".\n", out);
+  fflush(out);
+
+  nmmtl_free_dielectrics(dielectrics);
+  nmmtl_free_contours(signals);
+  nmmtl_free_contours(groundwires);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_serve_values
+
+  FUNCTIONAL DESCRIPTION:
+
+  Write one labelled line of values, with enough digits to round trip
+  single precision and then some.
+
+  FORMAL PARAMETERS:
+
+  FILE *out           - where to write
+  const char *label   - first word of the line
+  double *values      - the values
+  int count           - how many
+
+  RETURN VALUE:
+
+  None
+
+  */
+
+static void nmmtl_serve_values(FILE *out, const char *label,
+                               double *values, int count)
+{
+  int i;
+
+  fputs(label, out);
+  for(i = 0; i < count; i++) fprintf(out, " %.10g", values[i]);
+  putc('\n', out);
+}
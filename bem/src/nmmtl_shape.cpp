@@ -11,6 +11,11 @@
   to be considered.
   nmmtl_shape         -  for conductor elements in other cases and for
   dielectric elements all the time.
+  nmmtl_element_interior - lays out the interior nodes of a new element
+  for the order of interpolation in use.
+
+  Each is worked by a template on the order of interpolation, from
+  nmmtl_shape.h, chosen by ELEMENT_ORDER.
 
   AUTHOR(S):
 
@@ -30,14 +35,7 @@
  */
 
 #include "nmmtl.h"
-
-/* right now this module is hardcoded for 3 intepolation points.
-   Since I am lazy - put this in to remind you to change the code if the
-   number of interpolation points INTERP_PTS changes */
-
-#if INTERP_PTS != 3
-COMPILATION ERROR ERROR ---      INTERP_PTS != 3       --- ERROR ERROR
-#endif
+#include "nmmtl_shape.h"
 
 
   /*
@@ -65,6 +63,9 @@ COMPILATION ERROR ERROR ---      INTERP_PTS != 3       --- ERROR ERROR
    **  FUNCTION DECLARATIONS
    *******************************************************************
    */
+template <int ORDER>
+static void nmmtl_shape_c_edge_order(double point, double *shape,
+                                     CELEMENTS_P cel, double nu0);
   /*
    *******************************************************************
    **  FUNCTION DEFINITIONS
@@ -107,13 +108,30 @@ COMPILATION ERROR ERROR ---      INTERP_PTS != 3       --- ERROR ERROR
 
 //void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, float nu0, float nu1) {
 void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0) {
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_shape_c_edge_order<1>(point,shape,cel,nu0);
+    break;
+  case 3:
+    nmmtl_shape_c_edge_order<3>(point,shape,cel,nu0);
+    break;
+  default:
+    nmmtl_shape_c_edge_order<2>(point,shape,cel,nu0);
+    break;
+  }
+}
+
+template <int ORDER>
+static void nmmtl_shape_c_edge_order(double point, double *shape,
+                                     CELEMENTS_P cel, double nu0) {
   int i;
   double X,Y; /* interpolated points */
   double numerator,denominator;
   double deltax,deltay,factor;
 
   /* first get the ordinary shape function */
-  nmmtl_shape(point,shape);
+  nmmtl_shape_order<ORDER>(point,shape);
 
   /* then process the edge effects:
 
@@ -156,12 +174,16 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
      listed above are done twice with p0 and p2 switched the second
      time.
 
+     That is for quadratic elements.  For other orders every interior
+     node is treated as the middle one is, and the node at the [1] end
+     as p2 is.
+
      */
 
 
   /* Execute this section if the [0] end of the element is an edge */
 
-  if(cel->edge[0] != NULL)
+  if(cel->edge[0])
   {
 
     X = 0.0;
@@ -172,7 +194,7 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
 
     /* compute interpolation for x and y */
 
-    for(i = 0; i < INTERP_PTS; i++)
+    for(i = 0; i <= ORDER; i++)
     {
       X += shape[i] * cel->xpts[i];
       Y += shape[i] * cel->ypts[i];
@@ -206,7 +228,7 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
        The denominator is  pi - p0 except for i=0, where it is p2 - p0.
        */
 
-    /*   Hard code this loop expanded for three points ***
+    /*   The general form, for a quadratic element ***
      *
      *    for(i = 0; i < INTERP_PTS; i++)
      *    {
@@ -236,26 +258,28 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
      *
      *****/
 
-    /* i = 0 */
-    deltax = cel->xpts[2] - cel->xpts[0];
-    deltay = cel->ypts[2] - cel->ypts[0];
+    /* i = 0 and i = ORDER */
+    deltax = cel->xpts[ORDER] - cel->xpts[0];
+    deltay = cel->ypts[ORDER] - cel->ypts[0];
     denominator = sqrt(deltax*deltax + deltay*deltay);
     factor = pow( (numerator/denominator), (nu0 - 1.0) );
     shape[0] *= factor;
-    /* i = 2 */
-    shape[2] *= factor;
-    /* i = 1 */
-    deltax = cel->xpts[1] - cel->xpts[0];
-    deltay = cel->ypts[1] - cel->ypts[0];
-    denominator = sqrt(deltax*deltax + deltay*deltay);
-    shape[1] *= pow( (numerator/denominator), (nu0 - 1.0) );
+    shape[ORDER] *= factor;
+    /* the interior nodes */
+    for(i = 1; i < ORDER; i++)
+    {
+      deltax = cel->xpts[i] - cel->xpts[0];
+      deltay = cel->ypts[i] - cel->ypts[0];
+      denominator = sqrt(deltax*deltax + deltay*deltay);
+      shape[i] *= pow( (numerator/denominator), (nu0 - 1.0) );
+    }
 
 
   }
 
   /* Execute this section if the [1] end of the element is an edge */
 
-  if(cel->edge[1] != NULL)
+  if(cel->edge[1])
   {
 
     /* numerator is  p - p2.  First find p by interpolation.  We need to
@@ -265,7 +289,7 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
     X = 0.0;
     Y = 0.0;
 
-    for(i = 0; i < INTERP_PTS; i++)
+    for(i = 0; i <= ORDER; i++)
     {
       X += shape[i] * cel->xpts[i];
       Y += shape[i] * cel->ypts[i];
@@ -273,8 +297,8 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
 
     /* Now subtract the p2 value */
 
-    X -= cel->xpts[2];
-    Y -= cel->ypts[2];
+    X -= cel->xpts[ORDER];
+    Y -= cel->ypts[ORDER];
 
     /* now find the vector displacement */
 
@@ -299,7 +323,7 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
 
        The denominator is  pi - p2 except for i=2, where it is p0 - p2. */
 
-    /* Hard code this loop expanded for three points
+    /* The general form, for a quadratic element
      *
      *    for(i = 0; i < INTERP_PTS; i++)
      *    {
@@ -325,20 +349,22 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
      *    }
      *******/
 
-    /* i = 0 */
-    deltax = cel->xpts[0] - cel->xpts[2];
-    deltay = cel->ypts[0] - cel->ypts[2];
+    /* i = 0 and i = ORDER */
+    deltax = cel->xpts[0] - cel->xpts[ORDER];
+    deltay = cel->ypts[0] - cel->ypts[ORDER];
     denominator = sqrt(deltax*deltax + deltay*deltay);
     factor = pow( (numerator/denominator), (nu0 - 1.0) );
     shape[0] *= factor;
-    /* i = 2 */
-    shape[2] *= factor;
-    /* i = 1 */
-    deltax = cel->xpts[1] - cel->xpts[2];
-    deltay = cel->ypts[1] - cel->ypts[2];
-    denominator = sqrt(deltax*deltax + deltay*deltay);
-    // the following should contain nu1 not nu0
-    shape[1] *= pow( (numerator/denominator), (nu0 - 1.0) );
+    shape[ORDER] *= factor;
+    /* the interior nodes */
+    for(i = 1; i < ORDER; i++)
+    {
+      deltax = cel->xpts[i] - cel->xpts[ORDER];
+      deltay = cel->ypts[i] - cel->ypts[ORDER];
+      denominator = sqrt(deltax*deltax + deltay*deltay);
+      // the following should contain nu1 not nu0
+      shape[i] *= pow( (numerator/denominator), (nu0 - 1.0) );
+    }
 
   }
 }
@@ -359,6 +385,8 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
   nmmtl_shape_c_edge.
 
   This should be optimized in many cases to be a simple table lookup.
+  It is for the integration over elements in nmmtl_interval, which takes
+  its values from the tables in nmmtl_shape.h.
 
   (Notes from FORTRAN sample program follow - the order of the
   points have changed)
@@ -403,13 +431,6 @@ void nmmtl_shape_c_edge(double point, double *shape, CELEMENTS_P cel, double nu0
 
   */
 void nmmtl_shape(double point, double *shape) {
-  double L1,L2;
-
-  /* shortcuts for the L1 and L2 used in Lagrangian polynomials evaluated at
-     point x */
-  L1 = 1.0 - point;
-  L2 = point;
-
   /* Evaluate the Lagrangian polynomials here at the point. */
 
   /* - kept for posterity -
@@ -428,7 +449,84 @@ void nmmtl_shape(double point, double *shape) {
      end if
      */
 
-  shape[0] = L1*(2.0*L1-1.0);
-  shape[1] = 4.0*L1*L2;
-  shape[2] = L2*(2.0*L2-1.0);
+  switch(ELEMENT_ORDER)
+  {
+  case 1:
+    nmmtl_shape_order<1>(point,shape);
+    break;
+  case 3:
+    nmmtl_shape_order<3>(point,shape);
+    break;
+  default:
+    nmmtl_shape_order<2>(point,shape);
+    break;
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_element_interior
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  The element generators lay each element out as a quadratic one: its
+  start, middle and end points in [0], [1] and [2], with the middle on
+  the curve of the element.  This moves the end point to [ELEMENT_ORDER]
+  and places any interior points evenly along the quadratic through the
+  three, then numbers the interior nodes.  It is called just where a
+  generator would number the middle node; the end node is left for the
+  generator to set, at the index returned.
+
+  Quadratic elements are left as they are.
+
+  FORMAL PARAMETERS:
+
+  double *xpts,ypts                - element points, start, middle and end
+  int *node                        - element nodes, node[0] set
+  unsigned int *node_point_counter - next node number to use
+
+  RETURN VALUE:
+
+  index of the end node, ELEMENT_ORDER
+
+  CALLING SEQUENCE:
+
+  end = nmmtl_element_interior(element->xpts,element->ypts,element->node,
+                               &npcntr);
+
+  */
+
+int nmmtl_element_interior(double *xpts, double *ypts, int *node,
+                           unsigned int *node_point_counter) {
+  double x[INTERP_PTS],y[INTERP_PTS];
+  double m;
+  int i;
+
+  if(ELEMENT_ORDER != 2)
+  {
+    for(i = 1; i < ELEMENT_ORDER; i++)
+    {
+      m = (double)i/ELEMENT_ORDER;
+      x[i] = nmmtl_lagrange<2>::shape(0,m)*xpts[0] +
+        nmmtl_lagrange<2>::shape(1,m)*xpts[1] +
+        nmmtl_lagrange<2>::shape(2,m)*xpts[2];
+      y[i] = nmmtl_lagrange<2>::shape(0,m)*ypts[0] +
+        nmmtl_lagrange<2>::shape(1,m)*ypts[1] +
+        nmmtl_lagrange<2>::shape(2,m)*ypts[2];
+    }
+    xpts[ELEMENT_ORDER] = xpts[2];
+    ypts[ELEMENT_ORDER] = ypts[2];
+    for(i = 1; i < ELEMENT_ORDER; i++)
+    {
+      xpts[i] = x[i];
+      ypts[i] = y[i];
+    }
+  }
+
+  for(i = 1; i < ELEMENT_ORDER; i++)
+    node[i] = (int)(*node_point_counter)++;
+
+  return(ELEMENT_ORDER);
 }
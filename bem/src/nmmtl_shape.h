@@ -0,0 +1,179 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  The Lagrangian shape functions of the elements, for each order of
+  interpolation the solver supports, as templates on the order so that
+  the integration kernels can be compiled for each order with the loops
+  over the nodes of an element fixed in length.
+
+  The nodes of an element of order n are evenly spaced along it in local
+  coordinates, node k at m = k/n, so node 0 is the [0] end and node n the
+  [1] end.  The functions are those from the FORTRAN sample program noted
+  in nmmtl_shape.cpp, reordered to suit:
+
+  L1 = 1 - m, L2 = m
+
+  order 1:   L1, L2
+  order 2:   L1(2*L1 - 1), 4*L1*L2, L2(2*L2 - 1)
+  order 3:   0.5*L1(3*L1 - 1)(3*L1 - 2), 4.5*L1*L2(3*L1 - 1),
+             4.5*L2*L1(3*L2 - 1), 0.5*L2(3*L2 - 1)(3*L2 - 2)
+
+  The quadratic functions are evaluated exactly as they always have
+  been, so the default order gives the same results to the bit.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+#ifndef nmmtl_shape_h
+#define nmmtl_shape_h
+
+#include <cmath>
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* shape(node,m) and derivative(node,m) for an element of order ORDER */
+
+template <int ORDER> struct nmmtl_lagrange;
+
+template <> struct nmmtl_lagrange<1>
+{
+  static constexpr double shape(int node, double m)
+  {
+    return node == 0 ? 1.0 - m : m;
+  }
+  static constexpr double derivative(int node, double)
+  {
+    return node == 0 ? -1.0 : 1.0;
+  }
+};
+
+template <> struct nmmtl_lagrange<2>
+{
+  static constexpr double shape(int node, double m)
+  {
+    return node == 0 ? (1.0 - m)*(2.0*(1.0 - m)-1.0) :
+      node == 1 ? 4.0*(1.0 - m)*m :
+      m*(2.0*m-1.0);
+  }
+  static constexpr double derivative(int node, double m)
+  {
+    return node == 0 ? -4.*(1.0 - m) + 1.0 :
+      node == 1 ? 4.*( (1.0 - m) - m ) :
+      4.*m - 1.0;
+  }
+};
+
+template <> struct nmmtl_lagrange<3>
+{
+  static constexpr double shape(int node, double m)
+  {
+    return node == 0 ? 0.5*(1.0 - m)*(3.0*(1.0 - m)-1.0)*(3.0*(1.0 - m)-2.0) :
+      node == 1 ? 4.5*(1.0 - m)*m*(3.0*(1.0 - m)-1.0) :
+      node == 2 ? 4.5*m*(1.0 - m)*(3.0*m-1.0) :
+      0.5*m*(3.0*m-1.0)*(3.0*m-2.0);
+  }
+  static constexpr double derivative(int node, double m)
+  {
+    return node == 0 ? -0.5*( 27.*(1.0 - m)*(1.0 - m) - 18.*(1.0 - m) + 2. ) :
+      node == 1 ? 4.5*( (1.0 - m)*(3.*(1.0 - m) - 1.) - m*(6.*(1.0 - m) - 1.) ) :
+      node == 2 ? -4.5*( m*(3.*m - 1.) - (1.0 - m)*(6.*m - 1.) ) :
+      0.5*( 27.*m*m - 18.*m + 2. );
+  }
+};
+
+
+/* The shape functions and their derivatives at the roots of a Legendre
+   rule, worked out once rather than at every integration point.  C++11
+   will not fill an array in a constant expression, so the tables are
+   filled from the constexpr functions above the first time each is
+   used. */
+
+template <int ORDER, int ROOTS> struct nmmtl_shape_table
+{
+  double shape[ROOTS][ORDER + 1];
+  double derivative[ROOTS][ORDER + 1];
+
+  explicit nmmtl_shape_table(double const *roots)
+  {
+    int root, node;
+    for(root = 0; root < ROOTS; root++)
+      for(node = 0; node <= ORDER; node++)
+      {
+        shape[root][node] = nmmtl_lagrange<ORDER>::shape(node,roots[root]);
+        derivative[root][node] =
+          nmmtl_lagrange<ORDER>::derivative(node,roots[root]);
+      }
+  }
+};
+
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+/* the table for the rule used in nmmtl_interval */
+
+template <int ORDER>
+inline nmmtl_shape_table<ORDER,Legendre_root_i_max> const &
+nmmtl_shape_table_i()
+{
+  static nmmtl_shape_table<ORDER,Legendre_root_i_max> const
+    table(Legendre_root_i);
+  return(table);
+}
+
+/* the shape functions at an arbitrary point */
+
+template <int ORDER>
+inline void nmmtl_shape_order(double point, double *shape)
+{
+  int node;
+  for(node = 0; node <= ORDER; node++)
+    shape[node] = nmmtl_lagrange<ORDER>::shape(node,point);
+}
+
+/* the Jacobian of an element, given the derivatives of the shape
+   functions at the point - see nmmtl_jacobian.cpp */
+
+template <int ORDER>
+inline double nmmtl_jacobian_order(double const *derivative,
+                                   double const *xpts,
+                                   double const *ypts)
+{
+  double delta_x = 0., delta_y = 0.;
+  int node;
+  for(node = 0; node <= ORDER; node++)
+  {
+    delta_x = delta_x + derivative[node]*xpts[node];
+    delta_y = delta_y + derivative[node]*ypts[node];
+  }
+  return(sqrt(delta_x*delta_x + delta_y*delta_y));
+}
+
+/* and at an arbitrary point */
+
+template <int ORDER>
+inline double nmmtl_jacobian_order(double point,
+                                   double const *xpts,
+                                   double const *ypts)
+{
+  double derivative[ORDER + 1];
+  int node;
+  for(node = 0; node <= ORDER; node++)
+    derivative[node] = nmmtl_lagrange<ORDER>::derivative(node,point);
+  return(nmmtl_jacobian_order<ORDER>(derivative,xpts,ypts));
+}
+
+#endif
@@ -0,0 +1,323 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the function nmmtl_simplify_polygon, which thins out the
+  vertices of a polygon outline before it is broken into line segments.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* a vertex turning at least this much, and standing further than the
+   tolerance off the line between its neighbours, is a true corner and
+   is always kept */
+#define SIMPLIFY_CORNER_ANGLE (PI / 6.0)
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static double nmmtl_simplify_distance(const double *points, int p,
+                                      int a, int b);
+
+static void nmmtl_simplify_chain(const double *points, int number,
+                                 int a, int b, double tolerance,
+                                 int *stack, unsigned char *keep);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_simplify_polygon
+
+  FUNCTIONAL DESCRIPTION:
+
+  Choose the vertices of a closed polygon outline to keep, dropping
+  repeated points, collinear points and points which stray less than a
+  tolerance from the outline through the rest (Douglas-Peucker).
+
+  The true corners are found first and always kept: vertices turning at
+  least SIMPLIFY_CORNER_ANGLE, which are not just jitter, being further
+  than the tolerance from the side their neighbours would make.  The outline between each pair of neighbouring corners is
+  then reduced with Douglas-Peucker.  Without two corners, the first
+  vertex and the one furthest from it are used in their place.
+
+  The outline may or may not repeat its first point at the end; if it
+  does, the last point goes with the first one.  If fewer than three
+  vertices would be left, all of them are kept.
+
+  FORMAL PARAMETERS:
+
+  const double *points          - x,y pairs of the vertices
+  int number_points             - how many
+  double tolerance              - largest distance a dropped vertex may
+                                  be from the simplified outline
+  unsigned char *keep           - output: 1 for a vertex kept, 0 if not
+
+  RETURN VALUE:
+
+  number of vertices kept, not counting a repeated last point
+
+  CALLING SEQUENCE:
+
+  kept = nmmtl_simplify_polygon(object->points,object->number_points,
+                                tolerance,keep);
+
+  */
+
+int nmmtl_simplify_polygon(const double *points, int number_points,
+                           double tolerance, unsigned char *keep)
+{
+  int number = number_points;
+  int closed = 0;
+  int *anchors, *stack;
+  int number_anchors = 0;
+  int kept = 0;
+  int i, prev, next, far;
+  double dx0, dy0, dx1, dy1, distance, furthest;
+
+  if(number > 1 && points[0] == points[2*(number-1)] &&
+     points[1] == points[2*(number-1)+1])
+  {
+    closed = 1;
+    number--;
+  }
+
+  for(i = 0; i < number_points; i++) keep[i] = 1;
+  if(number < 4) return(number);
+
+  /* the stack holds up to two pairs of ends per level of subdivision */
+  anchors = (int *)malloc(sizeof(int) * (size_t)(5 * number + 4));
+  if(anchors == NULL) return(number);
+  stack = anchors + number;
+
+  /* repeated points go first, the last of a run is the one kept */
+  for(i = 0; i < number; i++)
+  {
+    next = (i + 1) % number;
+    if(points[2*i] == points[2*next] && points[2*i+1] == points[2*next+1])
+      keep[i] = 0;
+  }
+
+  /* the true corners */
+  for(i = 0; i < number; i++)
+  {
+    if(!keep[i]) continue;
+    for(prev = (i + number - 1) % number; !keep[prev] && prev != i;
+        prev = (prev + number - 1) % number);
+    for(next = (i + 1) % number; !keep[next] && next != i;
+        next = (next + 1) % number);
+    if(prev == i || next == i) continue;
+
+    if(nmmtl_simplify_distance(points,i,prev,next) <= tolerance) continue;
+
+    dx0 = points[2*i] - points[2*prev];
+    dy0 = points[2*i+1] - points[2*prev+1];
+    dx1 = points[2*next] - points[2*i];
+    dy1 = points[2*next+1] - points[2*i+1];
+    if(fabs(nmmtl_angle_of_intersection(dx0,dy0,dx1,dy1)) >=
+       SIMPLIFY_CORNER_ANGLE)
+      anchors[number_anchors++] = i;
+  }
+
+  if(number_anchors < 2)
+  {
+    if(number_anchors == 0)
+    {
+      for(i = 0; !keep[i]; i++);
+      anchors[number_anchors++] = i;
+    }
+
+    /* the vertex furthest from the one anchor */
+    far = anchors[0];
+    furthest = 0.0;
+    for(i = 0; i < number; i++)
+    {
+      if(!keep[i]) continue;
+      dx0 = points[2*i] - points[2*anchors[0]];
+      dy0 = points[2*i+1] - points[2*anchors[0]+1];
+      distance = dx0*dx0 + dy0*dy0;
+      if(distance > furthest)
+      {
+        furthest = distance;
+        far = i;
+      }
+    }
+    if(far < anchors[0])
+    {
+      anchors[1] = anchors[0];
+      anchors[0] = far;
+    }
+    else
+      anchors[1] = far;
+    number_anchors = 2;
+  }
+
+  /* reduce the outline between each pair of neighbouring anchors */
+  for(i = 0; i < number_anchors; i++)
+    nmmtl_simplify_chain(points,number,anchors[i],
+                         anchors[(i + 1) % number_anchors],
+                         tolerance,stack,keep);
+
+  for(i = 0; i < number; i++)
+    if(keep[i]) kept++;
+
+  if(kept < 3)
+  {
+    for(i = 0; i < number_points; i++) keep[i] = 1;
+    kept = number;
+  }
+  else if(closed)
+    keep[number] = keep[0];
+
+  free(anchors);
+  return(kept);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_simplify_chain
+
+  FUNCTIONAL DESCRIPTION:
+
+  Douglas-Peucker reduction of the vertices going around the outline
+  from anchor a to anchor b, both of which are kept: keep the vertex
+  furthest from the chord between the ends, if it is further than the
+  tolerance, and go on with the two halves.  Vertices already dropped
+  are skipped over.  Runs off an explicit stack, since traced outlines
+  can have thousands of vertices.
+
+  FORMAL PARAMETERS:
+
+  const double *points          - x,y pairs of the vertices
+  int number                    - how many, not counting a repeat
+  int a, b                      - the anchors at the ends
+  double tolerance              - as for nmmtl_simplify_polygon
+  int *stack                    - room for 4 * number + 4 entries
+  unsigned char *keep           - updated
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_simplify_chain(points,number,a,b,tolerance,stack,keep);
+
+  */
+
+static void nmmtl_simplify_chain(const double *points, int number,
+                                 int a, int b, double tolerance,
+                                 int *stack, unsigned char *keep)
+{
+  int depth = 0;
+  int p, far;
+  double distance, furthest;
+
+  stack[depth++] = a;
+  stack[depth++] = b;
+
+  while(depth > 0)
+  {
+    b = stack[--depth];
+    a = stack[--depth];
+
+    far = -1;
+    furthest = tolerance;
+    for(p = (a + 1) % number; p != b; p = (p + 1) % number)
+    {
+      if(!keep[p]) continue;
+      distance = nmmtl_simplify_distance(points,p,a,b);
+      if(distance > furthest)
+      {
+        furthest = distance;
+        far = p;
+      }
+    }
+
+    if(far < 0)
+    {
+      for(p = (a + 1) % number; p != b; p = (p + 1) % number)
+        keep[p] = 0;
+    }
+    else
+    {
+      stack[depth++] = a;
+      stack[depth++] = far;
+      stack[depth++] = far;
+      stack[depth++] = b;
+    }
+  }
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_simplify_distance
+
+  FUNCTIONAL DESCRIPTION:
+
+  Distance from vertex p to the side between vertices a and b.
+
+  FORMAL PARAMETERS:
+
+  const double *points          - x,y pairs of the vertices
+  int p                         - the vertex
+  int a, b                      - ends of the side
+
+  RETURN VALUE:
+
+  the distance
+
+  CALLING SEQUENCE:
+
+  distance = nmmtl_simplify_distance(points,p,a,b);
+
+  */
+
+static double nmmtl_simplify_distance(const double *points, int p,
+                                      int a, int b)
+{
+  double dx = points[2*b] - points[2*a];
+  double dy = points[2*b+1] - points[2*a+1];
+  double px = points[2*p] - points[2*a];
+  double py = points[2*p+1] - points[2*a+1];
+  double length2 = dx*dx + dy*dy;
+  double t;
+
+  if(length2 > 0.0)
+  {
+    t = (px*dx + py*dy) / length2;
+    if(t < 0.0) t = 0.0;
+    if(t > 1.0) t = 1.0;
+    px -= t * dx;
+    py -= t * dy;
+  }
+  return(sqrt(px*px + py*py));
+}
@@ -0,0 +1,256 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_skin_effect, which finds the resistance of the
+  conductors at frequencies high enough for the current to flow in a
+  thin layer at their surfaces, by the perturbational method.
+
+  At such frequencies the current on the surfaces is distributed like
+  the charge in free space: unit current on signal i flows with the
+  density J_i = sum over j of inv(B0)[i][j] sigma_j, sigma_j being the
+  free space charge distribution for unit potential on signal j, with
+  its return current on the ground.  The power lost in a surface
+  resistance Rs = sqrt(pi f mu0 / conductivity) then gives
+
+    R[i][k] = integral over the conductor surfaces of Rs J_i J_k
+
+  and the internal inductance is R/w.  The lower ground plane is not
+  meshed, being replaced by images; the current on it is that induced
+  by the charge on all of the elements, which makes its part of the
+  integral a double sum over pairs of integration points.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_skin_effect
+
+  FUNCTIONAL DESCRIPTION:
+
+  Integrates the products of the free space charge distributions over
+  the conductor surfaces, at the same Gauss-Legendre points
+  nmmtl_charge_free_space uses, and over the lower ground plane, and
+  turns them into the resistance matrix at 1 Hz.
+
+  FORMAL PARAMETERS:
+
+  int conductor_counter,             - how many conductors
+  CONDUCTOR_DATA_P conductor_data,   - array of data on conductors
+  double **free_space_sigma,         - the free space charge distribution
+                                       for unit potential on each conductor
+  double **inductance,               - the inductance matrix, mu0 eps0
+                                       inv(B0)
+  SKIN_EFFECT_P skin_effect          - conductivity in: of the ground (0),
+                                       which the lower ground plane gets
+                                       too, and of each conductor;
+                                       resistance out: at 1 Hz
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_skin_effect(conductor_counter,conductor_data,free_space_sigma,
+                    inductance,skin_effect);
+
+  */
+
+void nmmtl_skin_effect(int conductor_counter,
+                       CONDUCTOR_DATA_P conductor_data,
+                       double **free_space_sigma,
+                       double **inductance,
+                       SKIN_EFFECT_P skin_effect)
+{
+  int cond_num;
+  CELEMENTS_P cel,cel_end;
+  int Legendre_counter;
+  double Jacobian;
+  int i, j, k;
+  double shape[INTERP_PTS];
+  double nu0;
+  int number_points = 0, p, q;
+  double *x, *y, *weight, **density, **induced;
+  double **power, **current_map;
+  double surface_resistance, plane_resistance, sum, kernel;
+
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+    number_points += conductor_data[cond_num].number_elements *
+      Legendre_root_c_max;
+
+  x = (double *)malloc(sizeof(double) * (size_t)number_points);
+  y = (double *)malloc(sizeof(double) * (size_t)number_points);
+  weight = (double *)malloc(sizeof(double) * (size_t)number_points);
+  density = (double **)dim2(number_points,conductor_counter,sizeof(double));
+  induced = (double **)dim2(number_points,conductor_counter,sizeof(double));
+  power = (double **)dim2(conductor_counter,conductor_counter,sizeof(double));
+  current_map = (double **)dim2(conductor_counter,conductor_counter,
+                                sizeof(double));
+
+  /* - - - - - - The conductor surfaces, the ground's included - - - - - - */
+
+  /* the charge density of each distribution at each integration point,
+     and the weight of the point scaled by the surface resistance */
+  p = 0;
+  for(cond_num = 0; cond_num <= conductor_counter; cond_num++)
+  {
+    surface_resistance = sqrt(PI * MU_NAUGHT /
+                              skin_effect->conductivity[cond_num]);
+
+    cel = conductor_data[cond_num].elements;
+    cel_end = cel + conductor_data[cond_num].number_elements;
+    while(cel < cel_end)
+    {
+      for(Legendre_counter = 0; Legendre_counter < Legendre_root_c_max;
+          Legendre_counter++, p++)
+      {
+        nmmtl_shape(Legendre_root_c[Legendre_counter],shape);
+        x[p] = 0.0;
+        y[p] = 0.0;
+        for(i = 0; i < ELEMENT_PTS; i++)
+        {
+          x[p] += shape[i]*cel->xpts[i];
+          y[p] += shape[i]*cel->ypts[i];
+        }
+
+        if(cel->edge[0] || cel->edge[1])
+        {
+          nu0 = cel->edge[0] ? cel->free_space_nu[0] : 0;
+          nmmtl_shape_c_edge(Legendre_root_c[Legendre_counter],shape,cel,nu0);
+        }
+
+        nmmtl_jacobian_c(Legendre_root_c[Legendre_counter],cel,&Jacobian);
+        weight[p] = Legendre_weight_c[Legendre_counter] * Jacobian;
+
+        for(j = 0; j < conductor_counter; j++)
+        {
+          density[p][j] = 0.0;
+          for(i = 0; i < ELEMENT_PTS; i++)
+            density[p][j] += shape[i] * free_space_sigma[j][cel->node[i]];
+        }
+
+        for(j = 0; j < conductor_counter; j++)
+          for(k = 0; k < conductor_counter; k++)
+            power[j][k] += surface_resistance * weight[p] *
+              density[p][j] * density[p][k];
+      }
+      cel++;
+    }
+  }
+
+  /* - - - - - - - - - - - - The lower ground plane - - - - - - - - - - - - */
+
+  /* A line charge q at height h induces -q h/(pi((x-X)^2 + h^2)) on
+     the plane y = 0, and the integral along the plane of the product of
+     two of these is q q' (h + h')/(pi((X - X')^2 + (h + h')^2)). */
+  plane_resistance = sqrt(PI * MU_NAUGHT / skin_effect->conductivity[0]);
+
+  for(p = 0; p < number_points; p++)
+  {
+    for(q = 0; q < number_points; q++)
+    {
+      sum = y[p] + y[q];
+      kernel = weight[q] * sum /
+        (PI * ((x[p] - x[q]) * (x[p] - x[q]) + sum * sum));
+      for(k = 0; k < conductor_counter; k++)
+        induced[p][k] += kernel * density[q][k];
+    }
+  }
+
+  for(p = 0; p < number_points; p++)
+    for(j = 0; j < conductor_counter; j++)
+      for(k = 0; k < conductor_counter; k++)
+        power[j][k] += plane_resistance * weight[p] *
+          density[p][j] * induced[p][k];
+
+  /* - - - - - - - - - - From unit potentials to unit currents - - - - - - - */
+
+  /* inv(B0), whose row i gives the potentials that put unit charge on
+     conductor i and none on the others - in free space that is also the
+     current distribution for unit current */
+  for(i = 0; i < conductor_counter; i++)
+    for(j = 0; j < conductor_counter; j++)
+      current_map[i][j] = inductance[i][j] / C_SQUARED_INVERTED;
+
+  for(i = 0; i < conductor_counter; i++)
+  {
+    for(k = 0; k < conductor_counter; k++)
+    {
+      sum = 0.0;
+      for(j = 0; j < conductor_counter; j++)
+        for(q = 0; q < conductor_counter; q++)
+          sum += current_map[i][j] * power[j][q] * current_map[k][q];
+      skin_effect->resistance[i][k] = sum;
+    }
+  }
+
+  free(x);
+  free(y);
+  free(weight);
+  free2((void **)density);
+  free2((void **)induced);
+  free2((void **)power);
+  free2((void **)current_map);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_skin_effect_conductivity
+
+  FUNCTIONAL DESCRIPTION:
+
+  Fills in the conductivity of each conductor for nmmtl_skin_effect:
+  the ground, which is the ground planes and wires, gets the default
+  conductivity and each signal its own, or the default if it has none.
+
+  FORMAL PARAMETERS:
+
+  double conductivity            - default conductivity
+  CONTOURS_P signals             - the signals
+  double *conductor_conductivity - out: one more than there are signals
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  nmmtl_skin_effect_conductivity(conductivity,signals,
+                                 skin_effect.conductivity);
+
+  */
+
+void nmmtl_skin_effect_conductivity(double conductivity,
+                                    CONTOURS_P signals,
+                                    double *conductor_conductivity)
+{
+  int cond_num = 0;
+
+  conductor_conductivity[cond_num++] = conductivity;
+  for(; signals != NULL; signals = signals->next)
+    conductor_conductivity[cond_num++] = signals->conductivity != 0.0 ?
+      signals->conductivity : conductivity;
+}
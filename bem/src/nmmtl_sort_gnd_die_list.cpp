@@ -51,13 +51,21 @@
  **  FUNCTION DECLARATIONS
  *******************************************************************
  */
+
+static SORTED_GND_DIE_LIST_P nmmtl_sort_gnd_die_plane(GND_DIE_LIST_P gdl,
+                                                      int number_gdl,
+                                                      double left,
+                                                      double right);
+
+static int nmmtl_sorted_gdl_compare(const void *a, const void *b);
+
 /*
  *******************************************************************
  **  FUNCTION DEFINITIONS
  *******************************************************************
  */
 
-
+
 /*
 
   FUNCTION NAME:  nmmtl_sort_gnd_die_list
@@ -65,16 +73,17 @@
 
   FUNCTIONAL DESCRIPTION:
 
-  Produce a sorted list from the list of ground dielectric intersections
+  Produce sorted lists from the arrays of ground dielectric intersections
 
   FORMAL PARAMETERS:
 
-  GND_DIE_LIST_P lower_gdl_head,
-  - unsorted list of intersections
+  GND_DIE_LIST_P lower_gdl, int number_lower_gdl
+  - unsorted array of intersections and its length
   SORTED_GND_DIE_LIST_P *lower_sorted_gdl,
   - lists of ground plane-dielectric intersections created by this function
-  GND_DIE_LIST_P upper_gdl_head,
-  - unsorted list of intersections
+  GND_DIE_LIST_P upper_gdl, int number_upper_gdl
+  - unsorted array of intersections and its length, none if there is no
+    upper ground plane
   SORTED_GND_DIE_LIST_P *upper_sorted_gdl,
   - lists of ground plane-dielectric intersections created by this function
   double left, double right
@@ -86,54 +95,103 @@
 
   CALLING SEQUENCE:
 
-  nmmtl_sort_gnd_die_list(lower_gdl_head,lower_sorted_gdl,
-                          upper_gdl_head,upper_sorted_gdl,
+  nmmtl_sort_gnd_die_list(lower_gdl,number_lower_gdl,lower_sorted_gdl,
+                          upper_gdl,number_upper_gdl,upper_sorted_gdl,
         left_of_gnd_planes,
         right_of_gnd_planes);
 
   */
-void nmmtl_sort_gnd_die_list(GND_DIE_LIST_P lower_gdl_head,
+void nmmtl_sort_gnd_die_list(GND_DIE_LIST_P lower_gdl, int number_lower_gdl,
            SORTED_GND_DIE_LIST_P *lower_sorted_gdl,
-           GND_DIE_LIST_P upper_gdl_head,
+           GND_DIE_LIST_P upper_gdl, int number_upper_gdl,
            SORTED_GND_DIE_LIST_P *upper_sorted_gdl,
            double left, double right)
 {
+  *lower_sorted_gdl = nmmtl_sort_gnd_die_plane(lower_gdl,number_lower_gdl,
+                                               left,right);
+
+  /* upper ground plane if exists */
+  if(number_upper_gdl > 0)
+    *upper_sorted_gdl = nmmtl_sort_gnd_die_plane(upper_gdl,number_upper_gdl,
+                                                 left,right);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sort_gnd_die_plane
+
+
+  FUNCTIONAL DESCRIPTION:
+
+  Sort the intersections along one ground plane by their end point,
+  after trimming them to the plane and adding air where no dielectric
+  covers its ends.  Where two intersections end at the same point, only
+  the first one is kept.
+
+  The entries are laid out in one block, followed by their dielectric
+  constants in the order they were taken in, sorted once and then
+  linked up, so the whole list goes with a single free.
+
+  FORMAL PARAMETERS:
+
+  GND_DIE_LIST_P gdl            - unsorted intersections, may be empty
+  int number_gdl                - how many
+  double left, double right     - boundaries of ground planes
+
+  RETURN VALUE:
+
+  the sorted list, NULL if it is empty
+
+  CALLING SEQUENCE:
+
+  *lower_sorted_gdl = nmmtl_sort_gnd_die_plane(lower_gdl,number_lower_gdl,
+                                               left,right);
+
+  */
+
+static SORTED_GND_DIE_LIST_P nmmtl_sort_gnd_die_plane(GND_DIE_LIST_P gdl,
+                                                      int number_gdl,
+                                                      double left,
+                                                      double right)
+{
+  FLT_KEY_LIST_P entries;
+  double *epsilon;
   double minstart,maxend;
-  double *data;
-  GND_DIE_LIST_P discard;
+  int number = 0;
+  int i, kept;
 
-  *lower_sorted_gdl = NULL;
+  entries = (FLT_KEY_LIST_P)malloc((size_t)(number_gdl + 2) *
+                                   (sizeof(FLT_KEY_LIST) + sizeof(double)));
+  epsilon = (double *)(entries + number_gdl + 2);
 
-  if(lower_gdl_head != NULL)
+  if(number_gdl > 0)
   {
-    minstart = lower_gdl_head->start;
-    maxend = lower_gdl_head->end;
+    minstart = gdl[0].start;
+    maxend = gdl[0].end;
   }
   else
   {
-    /* no dielectric touches lower ground plane?  Try to fake air */
+    /* no dielectric touches the ground plane?  Try to fake air */
     minstart = right;
     maxend = right;
   }
 
-  while(lower_gdl_head != NULL)
+  for(i = 0; i < number_gdl; i++)
   {
     /* check if dielectric exceeds the ground plane - if so silently trim it */
-    if(left > lower_gdl_head->start) lower_gdl_head->start = left;
-    if(right < lower_gdl_head->end) lower_gdl_head->end = right;
+    if(left > gdl[i].start) gdl[i].start = left;
+    if(right < gdl[i].end) gdl[i].end = right;
 
     /* keep track of the full extent */
-    if(minstart > lower_gdl_head->start) minstart = lower_gdl_head->start;
-    if(maxend   < lower_gdl_head->end)   maxend = lower_gdl_head->end;
+    if(minstart > gdl[i].start) minstart = gdl[i].start;
+    if(maxend   < gdl[i].end)   maxend = gdl[i].end;
 
-    data = (double *)malloc(sizeof(double));
-    *data = lower_gdl_head->epsilon;
     /* sort by end point */
-    nmmtl_add_to_sorted_list(lower_sorted_gdl,lower_gdl_head->end,
-           (char *)data);
-    discard = lower_gdl_head;
-    lower_gdl_head = lower_gdl_head->next;
-    free(discard);
+    epsilon[number] = gdl[i].epsilon;
+    entries[number].key = gdl[i].end;
+    entries[number].data = (BIGPOINTER)&epsilon[number];
+    number++;
   }
 
   /* add in any air sections needed */
@@ -141,72 +199,63 @@ void nmmtl_sort_gnd_die_list(GND_DIE_LIST_P lower_gdl_head,
   /* piece missing on left - it will end at the lowest start */
   if(minstart > left)
   {
-    data = (double *)malloc(sizeof(double));
-    *data = AIR_CONSTANT;
-    /* sort by end point */
-    nmmtl_add_to_sorted_list(lower_sorted_gdl,minstart,
-           (char *)data);
+    epsilon[number] = AIR_CONSTANT;
+    entries[number].key = minstart;
+    entries[number].data = (BIGPOINTER)&epsilon[number];
+    number++;
   }
 
   /* piece missing on right - it will end at the right end */
   if(maxend < right)
   {
-    data = (double *)malloc(sizeof(double));
-    *data = AIR_CONSTANT;
-    /* sort by end point */
-    nmmtl_add_to_sorted_list(lower_sorted_gdl,right,
-           (char *)data);
+    epsilon[number] = AIR_CONSTANT;
+    entries[number].key = right;
+    entries[number].data = (BIGPOINTER)&epsilon[number];
+    number++;
   }
 
-  /* upper ground plane if exists */
-  if(upper_gdl_head != NULL)
+  if(number == 0)
+  {
+    free(entries);
+    return(NULL);
+  }
+
+  qsort(entries,(size_t)number,sizeof(FLT_KEY_LIST),nmmtl_sorted_gdl_compare);
+
+  /* drop repeated end points and link up what is left */
+  for(kept = 0, i = 1; i < number; i++)
   {
-    *upper_sorted_gdl = NULL;
-
-    minstart = upper_gdl_head->start;
-    maxend = upper_gdl_head->end;
-
-    while(upper_gdl_head != NULL)
-    {
-      /* check if dielectric exceeds the ground plane -
-   if so silently trim it */
-      if(left > upper_gdl_head->start) upper_gdl_head->start = left;
-      if(right < upper_gdl_head->end) upper_gdl_head->end = right;
-
-      /* keep track of the full extent */
-      if(minstart > upper_gdl_head->start) minstart = upper_gdl_head->start;
-      if(maxend   < upper_gdl_head->end)   maxend = upper_gdl_head->end;
-
-      data = (double *)malloc(sizeof(double));
-      *data = upper_gdl_head->epsilon;
-      /* sort by end point */
-      nmmtl_add_to_sorted_list(upper_sorted_gdl,upper_gdl_head->end,
-             (char *)data);
-      discard = upper_gdl_head;
-      upper_gdl_head = upper_gdl_head->next;
-      free(discard);
-    }
-
-    /* add in any air sections needed */
-
-    /* piece missing on left - it will end at the lowest start */
-    if(minstart > left)
-    {
-      data = (double *)malloc(sizeof(double));
-      *data = AIR_CONSTANT;
-      /* sort by end point */
-      nmmtl_add_to_sorted_list(upper_sorted_gdl,minstart,
-             (char *)data);
-    }
-
-    /* piece missing on right - it will end at the right end */
-    if(maxend < right)
-    {
-      data = (double *)malloc(sizeof(double));
-      *data = AIR_CONSTANT;
-      /* sort by end point */
-      nmmtl_add_to_sorted_list(upper_sorted_gdl,right,
-             (char *)data);
-    }
+    if(entries[i].key == entries[kept].key) continue;
+    kept++;
+    entries[kept] = entries[i];
   }
+  for(i = 0; i < kept; i++)
+    entries[i].next = &entries[i+1];
+  entries[kept].next = NULL;
+
+  return(entries);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_sorted_gdl_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  qsort comparison of two sorted list entries by key.  Ties go to the
+  entry taken in first, which is the one whose data comes first.
+
+  */
+
+static int nmmtl_sorted_gdl_compare(const void *a, const void *b)
+{
+  FLT_KEY_LIST_P ea = (FLT_KEY_LIST_P)a;
+  FLT_KEY_LIST_P eb = (FLT_KEY_LIST_P)b;
+
+  if(ea->key < eb->key) return(-1);
+  if(ea->key > eb->key) return(1);
+  if(ea->data < eb->data) return(-1);
+  if(ea->data > eb->data) return(1);
+  return(0);
 }
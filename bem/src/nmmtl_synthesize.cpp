@@ -0,0 +1,587 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains nmmtl_synthesize, the "mmtl_bem --synthesize" mode, and the
+  static functions which it calls.  One dimension of a conductor of a
+  .xsctn file, its width or pitch say, is adjusted until the
+  characteristic impedance of its signal, or the differential impedance
+  of its pair, is the target.
+
+  The file is read once into an in-memory cross section, which is
+  expanded again for each solve with the new dimension; the edge
+  singularity (nu) solutions found by one solve are reused by the next
+  from the nu cache of nmmtl_find_nu, and only B and L are calculated.
+  The mesh and the factored matrix cannot be kept from one solve to the
+  next, as the geometry changes with every step.
+
+  The impedance goes nearly linearly with the logarithm of a dimension,
+  so the search is made in the logarithm: secant steps, each at most a
+  factor of SYNTHESIS_MAX_STEP, until the target is bracketed, then
+  Brent's method.  A few solves usually do.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <float.h>
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* the dimension being adjusted and the impedance it is aimed at */
+typedef struct synthesis
+{
+  MMTL_XSCTN_P xsctn;
+  XSCTN_OBJECT_P object;
+  const char *parameter;      /* its option name */
+  double *dimension;          /* the field of object being adjusted */
+  double top_width_offset;    /* top less bottom width of a trapezoid,
+                                 kept as -width changes both */
+  int trapezoid_width;
+  int differential;           /* Zdiff if TRUE, else Z0 */
+  double target;
+  int solves;
+  double impedance;           /* of the last solve */
+} SYNTHESIS, *SYNTHESIS_P;
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static int nmmtl_synthesize_solve(SYNTHESIS_P synthesis, double x,
+                                  double *difference);
+static int nmmtl_synthesize_signal(XSCTN_OBJECT_P object, const char *name);
+static int nmmtl_synthesize_brent(SYNTHESIS_P synthesis, double a, double b,
+                                  double fa, double fb, double *root,
+                                  double *difference);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_synthesize
+
+  FUNCTIONAL DESCRIPTION:
+
+  Find the value of a dimension of a conductor that gives a target
+  impedance, starting from the value the file gives it, and report it.
+
+  FORMAL PARAMETERS:
+
+  char *filename            - base name of the .xsctn file
+  const char *conductor     - name of the conductor in the file
+  const char *parameter     - the dimension: -width, -topWidth,
+                              -bottomWidth, -height, -diameter or -pitch;
+                              -width of a trapezoid moves both widths
+  int differential          - TRUE for the differential impedance of the
+                              conductor's pair, FALSE for the
+                              characteristic impedance of its signal
+  double target             - the impedance wanted, ohms
+  MESH_SETTINGS_P settings  - how each solve meshes the cross section
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the file cannot be read, the dimension is not
+  there or the target is not reached in SYNTHESIS_MAX_SOLVES solves
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_synthesize(filename,conductor,parameter,differential,
+                            target,&settings);
+
+  */
+
+int nmmtl_synthesize(char *filename,
+                     const char *conductor,
+                     const char *parameter,
+                     int differential,
+                     double target,
+                     MESH_SETTINGS_P settings)
+{
+  SYNTHESIS synthesis;
+  char filespec[1024];
+  FILE *file;
+  char *text = NULL;
+  long length;
+  int status = FAIL;
+  int o, bracketed = FALSE;
+  double x0, x1, x2, f0, f1, f2, step;
+
+  memset(&synthesis,0,sizeof(synthesis));
+  synthesis.parameter = parameter;
+  synthesis.differential = differential;
+  synthesis.target = target;
+
+  /* - - - - - - - - - - - Read the cross section once - - - - - - - - - - */
+
+  snprintf(filespec,sizeof(filespec),"%s.xsctn",filename);
+  if((file = fopen(filespec,"r")) == NULL)
+  {
+    printf("Error: cannot open the cross-section file %s\n",filespec);
+    return(FAIL);
+  }
+  if(fseek(file,0,SEEK_END) == 0 && (length = ftell(file)) >= 0 &&
+     fseek(file,0,SEEK_SET) == 0 &&
+     (text = (char *)malloc((size_t)length + 1)) != NULL &&
+     fread(text,1,(size_t)length,file) == (size_t)length &&
+     (synthesis.xsctn = mmtl_xsctn_create()) != NULL)
+  {
+    synthesis.xsctn->settings = *settings;
+    status = nmmtl_xsctn_read(synthesis.xsctn,text,(size_t)length,filespec);
+  }
+  fclose(file);
+  free(text);
+  if(status != SUCCESS)
+  {
+    printf("Error: cannot read the cross-section file %s\n",filespec);
+    mmtl_xsctn_free(synthesis.xsctn);
+    return(FAIL);
+  }
+
+  /* - - - - - - - - - - - - - Find the dimension - - - - - - - - - - - - - */
+
+  for(o = 0; o < synthesis.xsctn->number_objects; o++)
+  {
+    if(synthesis.xsctn->objects[o].kind == XSCTN_CONDUCTORS &&
+       synthesis.xsctn->objects[o].name != NULL &&
+       strcmp(synthesis.xsctn->objects[o].name,conductor) == 0)
+    {
+      synthesis.object = &synthesis.xsctn->objects[o];
+      break;
+    }
+  }
+  if(synthesis.object == NULL)
+    printf("Error: no conductor %s in %s\n",conductor,filespec);
+  else if(strcmp(parameter,"-width") == 0)
+  {
+    if(synthesis.object->type == 'T')
+    {
+      synthesis.dimension = &synthesis.object->bottom_width;
+      synthesis.top_width_offset =
+        synthesis.object->top_width - synthesis.object->bottom_width;
+      synthesis.trapezoid_width = TRUE;
+    }
+    else if(synthesis.object->type == 'R')
+      synthesis.dimension = &synthesis.object->width;
+  }
+  else if(strcmp(parameter,"-topWidth") == 0 && synthesis.object->type == 'T')
+    synthesis.dimension = &synthesis.object->top_width;
+  else if(strcmp(parameter,"-bottomWidth") == 0 &&
+          synthesis.object->type == 'T')
+    synthesis.dimension = &synthesis.object->bottom_width;
+  else if(strcmp(parameter,"-height") == 0 && synthesis.object->type != 'C')
+    synthesis.dimension = &synthesis.object->height;
+  else if(strcmp(parameter,"-diameter") == 0 &&
+          synthesis.object->type == 'C')
+    synthesis.dimension = &synthesis.object->diameter;
+  else if(strcmp(parameter,"-pitch") == 0 && synthesis.object->number > 1)
+    synthesis.dimension = &synthesis.object->pitch;
+
+  if(synthesis.object != NULL && synthesis.dimension == NULL)
+    printf("Error: conductor %s has no %s to adjust\n",conductor,parameter);
+  else if(synthesis.dimension != NULL && !(*synthesis.dimension > 0.0))
+  {
+    printf("Error: %s of conductor %s must start out positive\n",
+           parameter,conductor);
+    synthesis.dimension = NULL;
+  }
+  if(synthesis.dimension == NULL)
+  {
+    mmtl_xsctn_free(synthesis.xsctn);
+    return(FAIL);
+  }
+
+  /* - - - - - - - - - - Secant steps until bracketed - - - - - - - - - - - */
+
+  x0 = log(*synthesis.dimension);
+  status = nmmtl_synthesize_solve(&synthesis,x0,&f0);
+  x1 = x0;
+  f1 = f0;
+  step = SYNTHESIS_FIRST_STEP;
+
+  while(status == SUCCESS && fabs(f1) > SYNTHESIS_TOLERANCE * target)
+  {
+    if(x1 == x0 || f1 == f0)
+      x2 = x1 + step;
+    else
+    {
+      /* the secant, no further than SYNTHESIS_MAX_STEP */
+      x2 = x1 - f1 * (x1 - x0) / (f1 - f0);
+      if(x2 > x1 + log(SYNTHESIS_MAX_STEP)) x2 = x1 + log(SYNTHESIS_MAX_STEP);
+      if(x2 < x1 - log(SYNTHESIS_MAX_STEP)) x2 = x1 - log(SYNTHESIS_MAX_STEP);
+    }
+
+    /* a dimension that makes no sense (conductors overlapping) is
+       stepped back from */
+    while((status = nmmtl_synthesize_solve(&synthesis,x2,&f2)) == FAIL &&
+          synthesis.solves < SYNTHESIS_MAX_SOLVES &&
+          fabs(x2 - x1) > SYNTHESIS_TOLERANCE)
+      x2 = 0.5 * (x1 + x2);
+    if(status != SUCCESS) break;
+
+    if((f2 < 0.0) != (f1 < 0.0))
+    {
+      bracketed = TRUE;
+      break;
+    }
+    x0 = x1;
+    f0 = f1;
+    x1 = x2;
+    f1 = f2;
+    if(synthesis.solves >= SYNTHESIS_MAX_SOLVES) status = FAIL;
+  }
+
+  /* - - - - - - - - - - - Brent's method once bracketed - - - - - - - - - */
+
+  if(status == SUCCESS && bracketed)
+    status = nmmtl_synthesize_brent(&synthesis,x1,x2,f1,f2,&x1,&f1);
+
+  if(status == SUCCESS)
+  {
+    printf("\nSynthesis: %s %s = %15.7e meters gives %s = %g Ohms "
+           "in %d solves\n", conductor, parameter, exp(x1),
+           differential ? "Zdiff" : "Z0", target + f1,
+           synthesis.solves);
+  }
+  else
+    printf("\nSynthesis: %s %s did not reach %g Ohms in %d solves\n",
+           conductor, parameter, target, synthesis.solves);
+
+  mmtl_xsctn_free(synthesis.xsctn);
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_synthesize_solve
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the dimension to exp(x), solve the cross section for B and L and
+  find how far the impedance is from the target.
+
+  FORMAL PARAMETERS:
+
+  SYNTHESIS_P synthesis   - the synthesis
+  double x                - the logarithm of the dimension, meters
+  double *difference      - out: impedance less target, ohms
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the dimension makes no sense or the solve fails
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_synthesize_solve(synthesis,x,&difference);
+
+  */
+
+static int nmmtl_synthesize_solve(SYNTHESIS_P synthesis, double x,
+                                  double *difference)
+{
+  XSCTN_OBJECT_P object = synthesis->object;
+  int cntr_seg, pln_seg, gnd_planes, num_signals = 0, num_grounds = 0;
+  double coupling, risetime, conductivity, half_minimum_dimension;
+  double top_ground_plane_thickness, bottom_ground_plane_thickness;
+  struct dielectric *dielectrics = NULL;
+  struct contour *signals = NULL, *groundwires = NULL, *sig;
+  double **electrostatic_induction = NULL, **inductance = NULL;
+  double *characteristic_impedance = NULL, *propagation_velocity = NULL;
+  double *equivalent_dielectric = NULL;
+  int (*pairs)[2] = NULL;
+  double zdiff, zcomm, vdiff, vcomm;
+  int status, number_pairs, p, i, first = -1, second = -1;
+
+  synthesis->solves++;
+  *synthesis->dimension = exp(x);
+  if(synthesis->trapezoid_width)
+    object->top_width = object->bottom_width + synthesis->top_width_offset;
+
+  /* conductors of a set must not overlap */
+  if(object->top_width < 0.0 ||
+     (object->number > 1 &&
+      object->pitch <= (object->type == 'R' ? object->width :
+                        object->type == 'C' ? object->diameter :
+                        object->top_width > object->bottom_width ?
+                        object->top_width : object->bottom_width)))
+    return(FAIL);
+
+  status = nmmtl_xsctn_expand(synthesis->xsctn,&cntr_seg,&pln_seg,&coupling,
+                              &risetime,&conductivity,&half_minimum_dimension,
+                              &gnd_planes,&top_ground_plane_thickness,
+                              &bottom_ground_plane_thickness,&dielectrics,
+                              &signals,&groundwires,&num_signals,
+                              &num_grounds);
+
+  /* the signals of the conductor, the last in the list being its first */
+  for(sig = signals, i = 0; status == SUCCESS && sig != NULL;
+      sig = sig->next, i++)
+  {
+    if(nmmtl_synthesize_signal(object,sig->name))
+    {
+      second = first;
+      first = i;
+    }
+  }
+
+  if(status == SUCCESS && first < 0) status = FAIL;
+
+  if(status == SUCCESS)
+  {
+    electrostatic_induction =
+      (double **)dim2(num_signals,num_signals,sizeof(double));
+    inductance = (double **)dim2(num_signals,num_signals,sizeof(double));
+    characteristic_impedance =
+      (double *)malloc(sizeof(double) * (size_t)num_signals);
+    propagation_velocity =
+      (double *)malloc(sizeof(double) * (size_t)num_signals);
+    equivalent_dielectric =
+      (double *)calloc((size_t)num_signals,sizeof(double));
+
+    status = nmmtl_qsp_calculate(dielectrics,signals,groundwires,gnd_planes,
+                                 half_minimum_dimension,cntr_seg,pln_seg,
+                                 coupling,risetime,electrostatic_induction,
+                                 inductance,characteristic_impedance,
+                                 propagation_velocity,equivalent_dielectric,
+                                 (FILE *)NULL,(FILE *)NULL,
+                                 (SKIN_EFFECT_P)NULL,(SENSITIVITY_P)NULL,
+                                 &synthesis->xsctn->settings);
+  }
+
+  if(status == SUCCESS && synthesis->differential)
+  {
+    /* the first pair the conductor is in, else its first two signals */
+    pairs = (int (*)[2])malloc(sizeof(int[2]) *
+                               (size_t)(synthesis->xsctn->number_pairs +
+                                        num_signals / 2));
+    number_pairs = nmmtl_mixed_mode_pairs(signals,
+                                          synthesis->xsctn->number_pairs,
+                                          synthesis->xsctn->pairs,pairs);
+    for(p = 0; p < number_pairs; p++)
+    {
+      for(sig = signals, i = 0; sig != NULL; sig = sig->next, i++)
+        if((i == pairs[p][0] || i == pairs[p][1]) &&
+           nmmtl_synthesize_signal(object,sig->name)) break;
+      if(sig != NULL) break;
+    }
+    if(p == number_pairs)
+    {
+      if(second < 0)
+      {
+        printf("Error: conductor %s is in no differential pair\n",
+               object->name);
+        status = FAIL;
+      }
+      pairs[0][0] = first;
+      pairs[0][1] = second;
+      p = 0;
+    }
+    if(status == SUCCESS)
+    {
+      nmmtl_mixed_mode_calculate(1,&pairs[p],electrostatic_induction,
+                                 inductance,&zdiff,&zcomm,&vdiff,&vcomm);
+      synthesis->impedance = zdiff;
+    }
+  }
+  else if(status == SUCCESS)
+    synthesis->impedance = characteristic_impedance[first];
+
+  /* nearly touching conductors can leave the solve meaningless */
+  if(status == SUCCESS && !(synthesis->impedance > 0.0 &&
+                            synthesis->impedance < DBL_MAX))
+    status = FAIL;
+
+  if(status == SUCCESS)
+  {
+    *difference = synthesis->impedance - synthesis->target;
+    /* on a line of its own after the solver's progress, which can end
+       in an asymmetry banner */
+    printf("%sSynthesis: solve %d %s %s = %15.7e meters %s = %g Ohms\n",
+           OUTPUT_PRODUCTS & OUTPUT_PROGRESS ? "\n" : "",
+           synthesis->solves, object->name, synthesis->parameter, exp(x),
+           synthesis->differential ? "Zdiff" : "Z0", synthesis->impedance);
+  }
+
+  if(electrostatic_induction != NULL)
+    free2((void **)electrostatic_induction);
+  if(inductance != NULL) free2((void **)inductance);
+  free(characteristic_impedance);
+  free(propagation_velocity);
+  free(equivalent_dielectric);
+  free(pairs);
+  nmmtl_free_dielectrics(dielectrics);
+  nmmtl_free_contours(signals);
+  nmmtl_free_contours(groundwires);
+
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_synthesize_signal
+
+  FUNCTIONAL DESCRIPTION:
+
+  Whether a signal is one of a conductor's: its name is the conductor's
+  followed by the type of conductor and a number.
+
+  FORMAL PARAMETERS:
+
+  XSCTN_OBJECT_P object   - the conductor
+  const char *name        - the signal name
+
+  RETURN VALUE:
+
+  TRUE or FALSE
+
+  CALLING SEQUENCE:
+
+  if(nmmtl_synthesize_signal(object,name)) ...
+
+  */
+
+static int nmmtl_synthesize_signal(XSCTN_OBJECT_P object, const char *name)
+{
+  size_t length = strlen(object->name);
+
+  return(strncmp(name,object->name,length) == 0 &&
+         name[length] == object->type &&
+         name[length+1] >= '0' && name[length+1] <= '9');
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_synthesize_brent
+
+  FUNCTIONAL DESCRIPTION:
+
+  Brent's method for the logarithm of the dimension between a and b, at
+  which the impedance is on opposite sides of the target: inverse
+  quadratic or secant steps where they stay inside the bracket and
+  shrink it fast enough, bisection where not.  It stops when the
+  impedance is within SYNTHESIS_TOLERANCE of the target or the bracket
+  is that small.
+
+  FORMAL PARAMETERS:
+
+  SYNTHESIS_P synthesis   - the synthesis
+  double a,b              - the bracket
+  double fa,fb            - impedance less target at a and b
+  double *root            - out: the logarithm of the dimension
+  double *difference      - out: impedance less target there
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if a solve fails or SYNTHESIS_MAX_SOLVES is reached
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_synthesize_brent(synthesis,a,b,fa,fb,&root,&difference);
+
+  */
+
+static int nmmtl_synthesize_brent(SYNTHESIS_P synthesis, double a, double b,
+                                  double fa, double fb, double *root,
+                                  double *difference)
+{
+  double c,fc,d,e;
+  double m,tol,p,q,r,s;
+  int status;
+
+  c = a;
+  fc = fa;
+  d = e = b - a;
+
+  for(;;)
+  {
+    /* keep b the best estimate, with the root between b and c */
+    if((fb < 0.0) == (fc < 0.0))
+    {
+      c = a;
+      fc = fa;
+      d = e = b - a;
+    }
+    if(fabs(fc) < fabs(fb))
+    {
+      a = b;  b = c;  c = a;
+      fa = fb;  fb = fc;  fc = fa;
+    }
+
+    *root = b;
+    *difference = fb;
+    tol = 2.0*DBL_EPSILON*fabs(b) + 0.5*SYNTHESIS_TOLERANCE;
+    m = 0.5*(c - b);
+    if(fabs(m) <= tol || fabs(fb) <= SYNTHESIS_TOLERANCE * synthesis->target)
+      return(SUCCESS);
+    if(synthesis->solves >= SYNTHESIS_MAX_SOLVES) return(FAIL);
+
+    if(fabs(e) < tol || fabs(fa) <= fabs(fb))
+    {
+      /* bisect */
+      d = e = m;
+    }
+    else
+    {
+      s = fb/fa;
+      if(a == c)
+      {
+        /* secant */
+        p = 2.0*m*s;
+        q = 1.0 - s;
+      }
+      else
+      {
+        /* inverse quadratic */
+        q = fa/fc;
+        r = fb/fc;
+        p = s*(2.0*m*q*(q - r) - (b - a)*(r - 1.0));
+        q = (q - 1.0)*(r - 1.0)*(s - 1.0);
+      }
+      if(p > 0.0) q = -q;
+      else p = -p;
+
+      if(2.0*p < 3.0*m*q - fabs(tol*q) && p < fabs(0.5*e*q))
+      {
+        e = d;
+        d = p/q;
+      }
+      else
+      {
+        d = e = m;
+      }
+    }
+
+    a = b;
+    fa = fb;
+    b += fabs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+    status = nmmtl_synthesize_solve(synthesis,b,&fb);
+    if(status != SUCCESS) return(status);
+  }
+}
@@ -64,16 +64,17 @@ void nmmtl_unload(double *potential_vector,int conductor_number,
       CONDUCTOR_DATA_P conductor_data)
 {
   int i;
-  CELEMENTS_P cel;
+  CELEMENTS_P cel,cel_end;
 
   cel = conductor_data[conductor_number].elements;
-  while(cel != NULL)
+  cel_end = cel + conductor_data[conductor_number].number_elements;
+  while(cel < cel_end)
   {
-    for(i=0; i < INTERP_PTS; i++)
+    for(i=0; i < ELEMENT_PTS; i++)
     {
       potential_vector[cel->node[i]] = 0.0;
     }
-    cel = cel->next;
+    cel++;
   }
 }
 
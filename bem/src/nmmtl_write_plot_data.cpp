@@ -43,13 +43,13 @@
 void nmmtl_write_plot_data(
          CONTOURS_P signal,
          int conductor_counter,
-         DELEMENTS_P die_elements,
+         ELEMENT_STORE_P element_store,
          CONDUCTOR_DATA_P conductor_data,
          double *sigma_vector,
          FILE *outputFile) {
   int cond_num;
-  CELEMENTS_P cel;
-  DELEMENTS_P die;
+  CELEMENTS_P cel,cel_end;
+  DELEMENTS_P die,die_end;
   int i;
 
   fprintf(outputFile,"Start Solution Output:\n");
@@ -57,61 +57,63 @@ void nmmtl_write_plot_data(
   fprintf(outputFile,"\n");
   for(cond_num = 0;cond_num <= conductor_counter; cond_num++)
     {
-      cel=conductor_data[cond_num].elements;
-      while(cel != NULL)
+      cel = conductor_data[cond_num].elements;
+      cel_end = cel + conductor_data[cond_num].number_elements;
+      while(cel < cel_end)
   {
     fprintf(outputFile,"Element Type: Conductor\n");
 
     fprintf(outputFile,"X Points:");
-    for (i = 0; i < INTERP_PTS; i++)
+    for (i = 0; i < ELEMENT_PTS; i++)
       fprintf(outputFile," %e",cel->xpts[i]);
     fprintf(outputFile,"\n");
 
     fprintf(outputFile,"Y Points:");
-    for (i = 0; i < INTERP_PTS; i++)
+    for (i = 0; i < ELEMENT_PTS; i++)
       fprintf(outputFile," %e",cel->ypts[i]);
     fprintf(outputFile,"\n");
 
     if (cel->edge[0])
       {
-        fprintf(outputFile,"Edge: 0 %e\n",cel->edge[0]->nu);
+        fprintf(outputFile,"Edge: 0 %e\n",cel->nu[0]);
       }
     if (cel->edge[1])
       {
-        fprintf(outputFile,"Edge: 1 %e\n",cel->edge[1]->nu);
+        fprintf(outputFile,"Edge: 1 %e\n",cel->nu[1]);
       }
     fprintf(outputFile,"Charge Values:");
-    for (i = 0; i < INTERP_PTS; i++)
+    for (i = 0; i < ELEMENT_PTS; i++)
       fprintf(outputFile," %e",sigma_vector[cel->node[i]]);
     fprintf(outputFile,"\n");
     fprintf(outputFile,"\n");
 
-    cel = cel->next;
+    cel++;
   } /* while looping on elements of particular conductor */
     } /* for all conductors */
 
-  die = die_elements;
-  while (die != NULL)
+  die = element_store->delements;
+  die_end = die + element_store->number_delements;
+  while(die < die_end)
     {
       fprintf(outputFile,"Element Type: Dielectric\n");
       fprintf(outputFile,"X Points:");
-      for (i = 0; i < INTERP_PTS; i++)
+      for (i = 0; i < ELEMENT_PTS; i++)
   fprintf(outputFile," %e",die->xpts[i]);
       fprintf(outputFile,"\n");
 
       fprintf(outputFile,"Y Points:");
-      for (i = 0; i < INTERP_PTS; i++)
+      for (i = 0; i < ELEMENT_PTS; i++)
   fprintf(outputFile," %e",die->ypts[i]);
       fprintf(outputFile,"\n");
 
       fprintf(outputFile,"Charge Values:");
-      for (i = 0; i < INTERP_PTS; i++)
+      for (i = 0; i < ELEMENT_PTS; i++)
   fprintf(outputFile," %e",sigma_vector[die->node[i]]);
       fprintf(outputFile,"\n");
 
       fprintf(outputFile,"\n");
 
-      die = die->next;
+      die++;
     }
   fprintf(outputFile,"End Solution Output:\n");
 }
@@ -0,0 +1,1775 @@
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  Contains the in-memory cross section: the mmtl_xsctn_* functions which
+  build one up object by object, nmmtl_xsctn_expand which turns it into
+  the dielectric and contour lists the rest of NMMTL works on, and
+  nmmtl_xsctn_finish, the final pass over those lists shared with
+  nmmtl_parse_xsctn.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <string.h>
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* the object array grows by this many entries at a time */
+#define XSCTN_OBJECT_INCREMENT 16
+
+/* usual size of an arena block, bigger requests get a block of their own */
+#define XSCTN_ARENA_BLOCK_SIZE 4096
+
+/* arena data starts this far into a block, and allocations are rounded
+   up to a multiple of XSCTN_ARENA_ALIGN, so that doubles are aligned */
+#define XSCTN_ARENA_ALIGN sizeof(double)
+#define XSCTN_ARENA_HEADER \
+  ((sizeof(XSCTN_ARENA_BLOCK) + XSCTN_ARENA_ALIGN - 1) / XSCTN_ARENA_ALIGN * \
+   XSCTN_ARENA_ALIGN)
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static XSCTN_OBJECT_P nmmtl_xsctn_new_object(MMTL_XSCTN_P xsctn, int kind);
+
+static XSCTN_OBJECT_P nmmtl_xsctn_new_conductors(MMTL_XSCTN_P xsctn,
+                                                 const char *name,
+                                                 int primitive,
+                                                 int type,
+                                                 double x_offset,
+                                                 double y_offset,
+                                                 int number,
+                                                 double pitch,
+                                                 double conductivity);
+
+static double nmmtl_xsctn_add_point(POLYPOINTS_P *tail, double x, double y,
+                                    double *minimum_dimension);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_create
+
+  FUNCTIONAL DESCRIPTION:
+
+  Allocate an empty cross section.  The header attributes start out the
+  way nmmtl_parse_xsctn treats a file which does not set them: default
+  conductivity, and coupling length and risetime left to their defaults.
+
+  FORMAL PARAMETERS:
+
+  None
+
+  RETURN VALUE:
+
+  the new cross section, NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  xsctn = mmtl_xsctn_create();
+
+  */
+
+MMTL_XSCTN_P mmtl_xsctn_create(void)
+{
+  MMTL_XSCTN_P xsctn;
+
+  xsctn = (MMTL_XSCTN_P)calloc(1,sizeof(MMTL_XSCTN));
+  if(xsctn == NULL) return(NULL);
+
+  xsctn->cntr_seg = 6;
+  xsctn->pln_seg = 15;
+  xsctn->coupling = 0.0;
+  xsctn->risetime = 0.0;
+  xsctn->conductivity = DEFAULT_CONDUCTIVITY;
+  nmmtl_mesh_settings_default(&xsctn->settings);
+
+  return(xsctn);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_free
+
+  FUNCTIONAL DESCRIPTION:
+
+  Release a cross section and every object in it.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section, may be NULL
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_free(xsctn);
+
+  */
+
+void mmtl_xsctn_free(MMTL_XSCTN_P xsctn)
+{
+  XSCTN_ARENA_BLOCK_P block, next;
+
+  if(xsctn == NULL) return;
+
+  for(block = xsctn->arena; block != NULL; block = next)
+  {
+    next = block->next;
+    free(block);
+  }
+  free(xsctn->objects);
+  free(xsctn);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_segments
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the number of contour segments (CSEG) and plane/dielectric
+  segments (DSEG).
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  int cntr_seg         - CSEG
+  int pln_seg          - DSEG
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_segments(xsctn,20,40);
+
+  */
+
+void mmtl_xsctn_set_segments(MMTL_XSCTN_P xsctn, int cntr_seg, int pln_seg)
+{
+  xsctn->cntr_seg = cntr_seg;
+  xsctn->pln_seg = pln_seg;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_coupling
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the coupling length and risetime used for the crosstalk figures.
+  A value of zero selects the same default nmmtl_parse_xsctn uses.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double coupling      - coupling length, meters
+  double risetime      - risetime, seconds
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_coupling(xsctn,0.0254,100e-12);
+
+  */
+
+void mmtl_xsctn_set_coupling(MMTL_XSCTN_P xsctn, double coupling,
+                             double risetime)
+{
+  xsctn->coupling = coupling;
+  xsctn->risetime = risetime;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_conductivity
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the conductivity used for signals which do not give their own.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double conductivity  - siemens/meter
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_conductivity(xsctn,5.8e7);
+
+  */
+
+void mmtl_xsctn_set_conductivity(MMTL_XSCTN_P xsctn, double conductivity)
+{
+  xsctn->conductivity = conductivity;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_polygon_tolerance
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set how far the outline of a polygon conductor may be moved to drop
+  vertices before it is broken into elements, see
+  nmmtl_simplify_polygon.  Repeated and collinear vertices, and jitter
+  smaller than the tolerance, go; true corners stay.  Zero, the
+  default, leaves the outlines as given.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double tolerance     - meters
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_polygon_tolerance(xsctn,0.1e-6);
+
+  */
+
+void mmtl_xsctn_set_polygon_tolerance(MMTL_XSCTN_P xsctn, double tolerance)
+{
+  xsctn->polygon_tolerance = tolerance;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_sensitivities
+
+  FUNCTIONAL DESCRIPTION:
+
+  Ask for the derivatives of B and L with respect to the permittivities,
+  layer thicknesses and conductor widths along with the solution (see
+  nmmtl_sensitivity.cpp).  They are not worked out by default.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  int sensitivities    - non-zero for the derivatives
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_sensitivities(xsctn,1);
+
+  */
+
+void mmtl_xsctn_set_sensitivities(MMTL_XSCTN_P xsctn, int sensitivities)
+{
+  xsctn->sensitivities = sensitivities != 0;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_element_order
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the order of interpolation on the elements: 1 (linear), 2
+  (quadratic, the default) or 3 (cubic).  Elements of higher order reach
+  the same accuracy with fewer of them.  Anything else gets the default.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  int order            - 1, 2 or 3
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_element_order(xsctn,3);
+
+  */
+
+void mmtl_xsctn_set_element_order(MMTL_XSCTN_P xsctn, int order)
+{
+  xsctn->settings.element_order = order;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_refine
+
+  FUNCTIONAL DESCRIPTION:
+
+  Refine the mesh automatically, from the divisions the segments give,
+  until the electrostatic induction and inductance matrices settle to
+  within a tolerance relative to their largest diagonal terms, see
+  nmmtl_qsp_refine.  Zero, the default, solves the mesh the segments
+  give once.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double tolerance     - relative change, 0 for no refinement
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_refine(xsctn,0.001);
+
+  */
+
+void mmtl_xsctn_set_refine(MMTL_XSCTN_P xsctn, double tolerance)
+{
+  xsctn->settings.refine = tolerance;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_extrapolate
+
+  FUNCTIONAL DESCRIPTION:
+
+  Solve the cross section on 2 or 3 meshes at once, with 1, 1.5 and 2
+  times the divisions the segments give, and extrapolate the results,
+  see nmmtl_qsp_extrapolate.  Anything else, 0 the default, solves the
+  one mesh.  Refinement, if set too, takes precedence.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  int levels           - how many meshes, 2 or 3
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_extrapolate(xsctn,3);
+
+  */
+
+void mmtl_xsctn_set_extrapolate(MMTL_XSCTN_P xsctn, int levels)
+{
+  xsctn->settings.extrapolate = levels;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_grading
+
+  FUNCTIONAL DESCRIPTION:
+
+  Grade the elements: along the conductor sides, each element this much
+  larger than the one before it moving away from a corner; and along
+  the upper ground plane, this much larger moving away from the region
+  over the conductors.  1, the default, or anything less, divides
+  evenly.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double corner        - growth away from conductor corners
+  double plane         - growth along the upper ground plane
+
+  RETURN VALUE:
+
+  None
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_grading(xsctn,1.3,1.2);
+
+  */
+
+void mmtl_xsctn_set_grading(MMTL_XSCTN_P xsctn, double corner, double plane)
+{
+  xsctn->settings.corner_grading = corner;
+  xsctn->settings.plane_grading = plane;
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_set_frequencies
+
+  FUNCTIONAL DESCRIPTION:
+
+  Set the frequencies the conductance matrix due to the loss tangents
+  of the dielectrics is wanted at.  With none, the default, it is not
+  calculated.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn        - the cross section
+  int number_frequencies    - how many, at most MMTL_MAX_FREQUENCIES
+  const double *frequencies - the frequencies, Hz
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if there are too many or one is not positive
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_set_frequencies(xsctn,3,frequencies);
+
+  */
+
+int mmtl_xsctn_set_frequencies(MMTL_XSCTN_P xsctn, int number_frequencies,
+                               const double *frequencies)
+{
+  int f;
+
+  if(number_frequencies < 0 || number_frequencies > MMTL_MAX_FREQUENCIES)
+    return(FAIL);
+  for(f = 0; f < number_frequencies; f++)
+    if(!(frequencies[f] > 0.0)) return(FAIL);
+
+  xsctn->number_frequencies = number_frequencies;
+  for(f = 0; f < number_frequencies; f++)
+    xsctn->frequencies[f] = frequencies[f];
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_differential_pair
+
+  FUNCTIONAL DESCRIPTION:
+
+  Name two signals as a differential pair, to have their differential
+  and common mode impedances and velocities calculated.  The names are
+  those the results give the signals.  Without any, pairs are found
+  from the names of the conductors (see nmmtl_mixed_mode_pairs).
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn        - the cross section
+  const char *positive      - the signal driven positive
+  const char *negative      - and its complement
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if there are already MMTL_MAX_PAIRS pairs or a name is
+  too long
+
+  CALLING SEQUENCE:
+
+  mmtl_xsctn_add_differential_pair(xsctn,"dpR0","dnR1");
+
+  */
+
+int mmtl_xsctn_add_differential_pair(MMTL_XSCTN_P xsctn, const char *positive,
+                                     const char *negative)
+{
+  if(xsctn->number_pairs == MMTL_MAX_PAIRS ||
+     strlen(positive) >= SIZE_SIG_NAME || strlen(negative) >= SIZE_SIG_NAME)
+    return(FAIL);
+
+  strcpy(xsctn->pairs[xsctn->number_pairs][0],positive);
+  strcpy(xsctn->pairs[xsctn->number_pairs][1],negative);
+  xsctn->number_pairs++;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_ground_plane
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a ground plane.  The first one is the lower ground plane and must
+  come before any dielectric layer, the second one closes the stack at
+  the top (stripline).
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_ground_plane(xsctn);
+
+  */
+
+int mmtl_xsctn_add_ground_plane(MMTL_XSCTN_P xsctn)
+{
+  if(nmmtl_xsctn_new_object(xsctn,XSCTN_GROUND_PLANE) == NULL) return(FAIL);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_dielectric_layer
+
+  FUNCTIONAL DESCRIPTION:
+
+  Stack a dielectric layer, spanning the whole cross section, on top of
+  the layers added so far.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double thickness     - meters
+  double permittivity  - relative dielectric constant
+  double loss_tangent  - loss tangent
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or the thickness is not positive
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_dielectric_layer(xsctn,32e-6,3.2,0.0);
+
+  */
+
+int mmtl_xsctn_add_dielectric_layer(MMTL_XSCTN_P xsctn,
+                                    double thickness,
+                                    double permittivity,
+                                    double loss_tangent)
+{
+  XSCTN_OBJECT_P object;
+
+  if(thickness <= 0.0) return(FAIL);
+
+  object = nmmtl_xsctn_new_object(xsctn,XSCTN_DIELECTRIC_LAYER);
+  if(object == NULL) return(FAIL);
+
+  object->height = thickness;
+  object->permittivity = permittivity;
+  object->loss_tangent = loss_tangent;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_rectangle_dielectric
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a row of number dielectric blocks sitting on top of the layers
+  added so far.  The first one starts at x_offset, the others follow at
+  pitch intervals.  These do not raise the top of the stack.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  double width         - meters
+  double height        - meters
+  double permittivity  - relative dielectric constant
+  double loss_tangent  - loss tangent
+  double x_offset      - left edge of the first block, meters
+  int number           - number of blocks
+  double pitch         - spacing of the blocks, meters
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or the block is empty
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_rectangle_dielectric(xsctn,50e-6,10e-6,4.0,0.0,
+                                               0.0,1,0.0);
+
+  */
+
+int mmtl_xsctn_add_rectangle_dielectric(MMTL_XSCTN_P xsctn,
+                                        double width,
+                                        double height,
+                                        double permittivity,
+                                        double loss_tangent,
+                                        double x_offset,
+                                        int number,
+                                        double pitch)
+{
+  XSCTN_OBJECT_P object;
+
+  if(width <= 0.0 || height <= 0.0 || number < 1) return(FAIL);
+
+  object = nmmtl_xsctn_new_object(xsctn,XSCTN_RECTANGLE_DIELECTRIC);
+  if(object == NULL) return(FAIL);
+
+  object->width = width;
+  object->height = height;
+  object->permittivity = permittivity;
+  object->loss_tangent = loss_tangent;
+  object->x_offset = x_offset;
+  object->number = number;
+  object->pitch = pitch;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_rectangle_conductors
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a set of number rectangular conductors.  The lower left corner of
+  the first one is at (x_offset, top of the stack + y_offset), the others
+  follow at pitch intervals.  As in the .xsctn file, a name starting with
+  "gr" makes them ground wires, anything else signals named name, 'R' and
+  a running index.  A conductivity of zero selects the cross section
+  default.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  const char *name     - name of the set
+  double width         - meters
+  double height        - meters
+  double x_offset      - meters
+  double y_offset      - meters
+  int number           - number of conductors in the set
+  double pitch         - spacing of the conductors, meters
+  double conductivity  - siemens/meter, 0 for the default
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or the conductor is empty
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_rectangle_conductors(xsctn,"line",20e-6,5e-6,
+                                               0.0,0.0,2,100e-6,0.0);
+
+  */
+
+int mmtl_xsctn_add_rectangle_conductors(MMTL_XSCTN_P xsctn,
+                                        const char *name,
+                                        double width,
+                                        double height,
+                                        double x_offset,
+                                        double y_offset,
+                                        int number,
+                                        double pitch,
+                                        double conductivity)
+{
+  XSCTN_OBJECT_P object;
+
+  if(width <= 0.0 || height <= 0.0) return(FAIL);
+
+  object = nmmtl_xsctn_new_conductors(xsctn,name,RECTANGLE,RECTANGLE,
+                                      x_offset,y_offset,number,pitch,
+                                      conductivity);
+  if(object == NULL) return(FAIL);
+
+  object->width = width;
+  object->height = height;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_trapezoid_conductors
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a set of number trapezoidal conductors, centered over each other
+  and placed like mmtl_xsctn_add_rectangle_conductors.  Signal names use
+  the keyletter 'T'.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  const char *name     - name of the set
+  double bottom_width  - meters
+  double top_width     - meters
+  double height        - meters
+  double x_offset      - meters
+  double y_offset      - meters
+  int number           - number of conductors in the set
+  double pitch         - spacing of the conductors, meters
+  double conductivity  - siemens/meter, 0 for the default
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or the conductor is empty
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_trapezoid_conductors(xsctn,"trap",18e-6,20e-6,
+                                               5e-6,0.0,0.0,3,100e-6,
+                                               4.25e7);
+
+  */
+
+int mmtl_xsctn_add_trapezoid_conductors(MMTL_XSCTN_P xsctn,
+                                        const char *name,
+                                        double bottom_width,
+                                        double top_width,
+                                        double height,
+                                        double x_offset,
+                                        double y_offset,
+                                        int number,
+                                        double pitch,
+                                        double conductivity)
+{
+  XSCTN_OBJECT_P object;
+
+  if(bottom_width <= 0.0 || top_width <= 0.0 || height <= 0.0) return(FAIL);
+
+  object = nmmtl_xsctn_new_conductors(xsctn,name,POLYGON,'T',
+                                      x_offset,y_offset,number,pitch,
+                                      conductivity);
+  if(object == NULL) return(FAIL);
+
+  object->bottom_width = bottom_width;
+  object->top_width = top_width;
+  object->height = height;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_circle_conductors
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a set of number round conductors.  The box around the first one
+  has its lower left corner at (x_offset, top of the stack + y_offset).
+  Signal names use the keyletter 'C'.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  const char *name     - name of the set
+  double diameter      - meters
+  double x_offset      - meters
+  double y_offset      - meters
+  int number           - number of conductors in the set
+  double pitch         - spacing of the conductors, meters
+  double conductivity  - siemens/meter, 0 for the default
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or the conductor is empty
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_circle_conductors(xsctn,"wire",100e-6,
+                                            0.0,10e-6,2,200e-6,0.0);
+
+  */
+
+int mmtl_xsctn_add_circle_conductors(MMTL_XSCTN_P xsctn,
+                                     const char *name,
+                                     double diameter,
+                                     double x_offset,
+                                     double y_offset,
+                                     int number,
+                                     double pitch,
+                                     double conductivity)
+{
+  XSCTN_OBJECT_P object;
+
+  if(diameter <= 0.0) return(FAIL);
+
+  object = nmmtl_xsctn_new_conductors(xsctn,name,CIRCLE,'C',
+                                      x_offset,y_offset,number,pitch,
+                                      conductivity);
+  if(object == NULL) return(FAIL);
+
+  object->diameter = diameter;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  mmtl_xsctn_add_polygon_conductor
+
+  FUNCTIONAL DESCRIPTION:
+
+  Add a single conductor with an arbitrary polygonal outline.  The x
+  coordinates are taken as is, the y coordinates are relative to the top
+  of the layers added so far.  The outline is closed if the last point
+  does not repeat the first.  Signal names use the keyletter 'G'.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  const char *name     - name of the conductor
+  int number_points    - number of vertices
+  const double *x      - vertex x coordinates, meters
+  const double *y      - vertex y coordinates, meters
+  double conductivity  - siemens/meter, 0 for the default
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL if out of memory or fewer than three vertices
+
+  CALLING SEQUENCE:
+
+  status = mmtl_xsctn_add_polygon_conductor(xsctn,"etch",n,x,y,0.0);
+
+  */
+
+int mmtl_xsctn_add_polygon_conductor(MMTL_XSCTN_P xsctn,
+                                     const char *name,
+                                     int number_points,
+                                     const double *x,
+                                     const double *y,
+                                     double conductivity)
+{
+  XSCTN_OBJECT_P object;
+  double *points;
+  int i;
+
+  if(number_points < 3) return(FAIL);
+
+  points = (double *)nmmtl_xsctn_arena_alloc(xsctn,sizeof(double) * 2 *
+                                             (size_t)number_points);
+  if(points == NULL) return(FAIL);
+
+  for(i = 0; i < number_points; i++)
+  {
+    points[2*i] = x[i];
+    points[2*i+1] = y[i];
+  }
+
+  object = nmmtl_xsctn_new_conductors(xsctn,name,POLYGON,POLYGON,
+                                      0.0,0.0,1,0.0,conductivity);
+  if(object == NULL) return(FAIL);
+
+  object->number_points = number_points;
+  object->points = points;
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_arena_alloc
+
+  FUNCTIONAL DESCRIPTION:
+
+  Allocate size bytes, aligned for doubles, from the arena of the cross
+  section.  The memory lives until mmtl_xsctn_free; there is no way to
+  give back a single allocation.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  size_t size          - bytes wanted
+
+  RETURN VALUE:
+
+  the memory, NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  points = (double *)nmmtl_xsctn_arena_alloc(xsctn,sizeof(double) * 2 * n);
+
+  */
+
+void *nmmtl_xsctn_arena_alloc(MMTL_XSCTN_P xsctn, size_t size)
+{
+  XSCTN_ARENA_BLOCK_P block;
+  size_t block_size;
+  void *memory;
+
+  size = (size + XSCTN_ARENA_ALIGN - 1) / XSCTN_ARENA_ALIGN * XSCTN_ARENA_ALIGN;
+
+  block = xsctn->arena;
+  if(block == NULL || block->size - block->used < size)
+  {
+    block_size = size > XSCTN_ARENA_BLOCK_SIZE ? size : XSCTN_ARENA_BLOCK_SIZE;
+    block = (XSCTN_ARENA_BLOCK_P)malloc(XSCTN_ARENA_HEADER + block_size);
+    if(block == NULL) return(NULL);
+    block->used = 0;
+    block->size = block_size;
+
+    /* an oversize block goes behind the current one, which may still
+       have room for small allocations */
+    if(xsctn->arena != NULL && block_size > XSCTN_ARENA_BLOCK_SIZE)
+    {
+      block->next = xsctn->arena->next;
+      xsctn->arena->next = block;
+    }
+    else
+    {
+      block->next = xsctn->arena;
+      xsctn->arena = block;
+    }
+  }
+
+  memory = (char *)block + XSCTN_ARENA_HEADER + block->used;
+  block->used += size;
+  return(memory);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_new_object
+
+  FUNCTIONAL DESCRIPTION:
+
+  Append a zeroed object of the given kind to the cross section,
+  growing the object array as needed.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  int kind             - one of the XSCTN_* constants
+
+  RETURN VALUE:
+
+  the new object, NULL if out of memory
+
+  CALLING SEQUENCE:
+
+  object = nmmtl_xsctn_new_object(xsctn,XSCTN_GROUND_PLANE);
+
+  */
+
+static XSCTN_OBJECT_P nmmtl_xsctn_new_object(MMTL_XSCTN_P xsctn, int kind)
+{
+  XSCTN_OBJECT_P object;
+
+  if(xsctn->number_objects == xsctn->allocated_objects)
+  {
+    int allocated = xsctn->allocated_objects + XSCTN_OBJECT_INCREMENT;
+
+    object = (XSCTN_OBJECT_P)realloc(xsctn->objects,
+                                     sizeof(XSCTN_OBJECT) * (size_t)allocated);
+    if(object == NULL) return(NULL);
+    xsctn->objects = object;
+    xsctn->allocated_objects = allocated;
+  }
+
+  object = &xsctn->objects[xsctn->number_objects++];
+  memset(object,0,sizeof(XSCTN_OBJECT));
+  object->kind = kind;
+  object->number = 1;
+  return(object);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_new_conductors
+
+  FUNCTIONAL DESCRIPTION:
+
+  Append a conductor set object and fill in what all conductor shapes
+  have in common.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn   - the cross section
+  const char *name     - name of the set
+  int primitive        - RECTANGLE, POLYGON or CIRCLE
+  int type             - keyletter for the signal names
+  double x_offset      - meters
+  double y_offset      - meters
+  int number           - number of conductors in the set
+  double pitch         - meters
+  double conductivity  - siemens/meter, 0 for the default
+
+  RETURN VALUE:
+
+  the new object, NULL if out of memory or a bad set
+
+  CALLING SEQUENCE:
+
+  object = nmmtl_xsctn_new_conductors(xsctn,name,CIRCLE,'C',...);
+
+  */
+
+static XSCTN_OBJECT_P nmmtl_xsctn_new_conductors(MMTL_XSCTN_P xsctn,
+                                                 const char *name,
+                                                 int primitive,
+                                                 int type,
+                                                 double x_offset,
+                                                 double y_offset,
+                                                 int number,
+                                                 double pitch,
+                                                 double conductivity)
+{
+  XSCTN_OBJECT_P object;
+  char *name_copy;
+  size_t length;
+
+  if(name == NULL || number < 1) return(NULL);
+
+  length = strlen(name) + 1;
+  name_copy = (char *)nmmtl_xsctn_arena_alloc(xsctn,length);
+  if(name_copy == NULL) return(NULL);
+  memcpy(name_copy,name,length);
+
+  object = nmmtl_xsctn_new_object(xsctn,XSCTN_CONDUCTORS);
+  if(object == NULL) return(NULL);
+
+  object->name = name_copy;
+  object->primitive = primitive;
+  object->type = type;
+  object->x_offset = x_offset;
+  object->y_offset = y_offset;
+  object->number = number;
+  object->pitch = pitch;
+  object->conductivity = conductivity;
+  return(object);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_add_point
+
+  FUNCTIONAL DESCRIPTION:
+
+  Append a point to a polygon outline under construction, returning the
+  length of the side it closes and keeping track of the smallest side.
+
+  FORMAL PARAMETERS:
+
+  POLYPOINTS_P *tail          - last point so far, advanced to the new one
+  double x, y                 - the new point
+  double *minimum_dimension   - smallest dimension so far
+
+  RETURN VALUE:
+
+  length of the side from the previous point
+
+  CALLING SEQUENCE:
+
+  perimeter += nmmtl_xsctn_add_point(&tail,x,y,&minimum_dimension);
+
+  */
+
+static double nmmtl_xsctn_add_point(POLYPOINTS_P *tail, double x, double y,
+                                    double *minimum_dimension)
+{
+  POLYPOINTS_P point;
+  double length;
+
+  point = (POLYPOINTS_P)malloc(sizeof(POLYPOINTS));
+  point->next = NULL;
+  point->x = x;
+  point->y = y;
+
+  length = sqrt((x - (*tail)->x)*(x - (*tail)->x) +
+                (y - (*tail)->y)*(y - (*tail)->y));
+
+  /* keep track of smallest dimension */
+  if(length < *minimum_dimension) *minimum_dimension = length;
+
+  (*tail)->next = point;
+  *tail = point;
+  return(length);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_outline_elements
+
+  FUNCTIONAL DESCRIPTION:
+
+  Break a traced polygon outline into line segments the way the solver
+  will, and count the segments (sides) and boundary elements it makes.
+  With a keep mask from nmmtl_simplify_polygon only the vertices kept
+  are used, so calling it with and without the mask gives the real
+  saving of a simplification.
+
+  FORMAL PARAMETERS:
+
+  const double *points        - x,y pairs of the outline
+  int number_points           - number of vertices
+  const unsigned char *keep   - vertices to use, or NULL for all of them
+  int cntr_seg                - CSEG
+  int *sides                  - line segments made
+  int *elements               - boundary elements made
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_xsctn_outline_elements(points,number_points,keep,
+                                        cntr_seg,&sides,&elements);
+
+  */
+
+int nmmtl_xsctn_outline_elements(const double *points, int number_points,
+                                 const unsigned char *keep, int cntr_seg,
+                                 int *sides, int *elements)
+{
+  struct contour outline;
+  POLYPOINTS_P tail, point, next_point;
+  LINE_SEGMENTS_P segments = NULL, segment;
+  EXTENT_DATA extent_data;
+  double minimum_dimension = DBL_MAX;
+  int first, p, status;
+
+  *sides = *elements = 0;
+  for(first = 0; first < number_points && keep != NULL && !keep[first];
+      first++);
+  if(first >= number_points) return(FAIL);
+
+  outline.next = NULL;
+  outline.block = NULL;
+  outline.name[0] = '\0';
+  outline.primitive = POLYGON;
+  outline.x0 = outline.x1 = 0.0;
+  outline.points = tail = (POLYPOINTS_P)malloc(sizeof(POLYPOINTS));
+  tail->next = NULL;
+  tail->x = points[2*first];
+  tail->y = points[2*first+1];
+  outline.y0 = outline.y1 = tail->y;
+  for(p = first + 1; p < number_points; p++)
+  {
+    if(keep != NULL && !keep[p]) continue;
+    outline.x0 += nmmtl_xsctn_add_point(&tail,points[2*p],points[2*p+1],
+                                        &minimum_dimension);
+  }
+  if(tail->x != outline.points->x || tail->y != outline.points->y)
+    outline.x0 += nmmtl_xsctn_add_point(&tail,outline.points->x,
+                                        outline.points->y,&minimum_dimension);
+
+  extent_data.left_cond_extent = DBL_MAX;
+  extent_data.right_cond_extent = -DBL_MAX;
+  extent_data.min_cond_height = DBL_MAX;
+  status = nmmtl_evaluate_polygons(cntr_seg,
+#ifndef NO_HALF_MIN_CHECKING
+                                   0.5 * minimum_dimension,
+#endif
+                                   0,&outline,&segments,&extent_data);
+
+  for(segment = segments; segment != NULL; segment = segment->next)
+  {
+    (*sides)++;
+    *elements += segment->divisions;
+  }
+  nmmtl_free_segments(segments,NULL,NULL);
+  for(point = outline.points; point != NULL; point = next_point)
+  {
+    next_point = point->next;
+    free(point);
+  }
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_expand
+
+  FUNCTIONAL DESCRIPTION:
+
+  Turn a cross section into the dielectric, signal and ground wire lists
+  and the header values the rest of NMMTL works on.  The outputs are
+  those of nmmtl_parse_xsctn and follow the same conventions: layers
+  stack up from y=0, conductors sit relative to the top of the stack as
+  it was when they were added, both lists are built by pushing on the
+  front, and conductor sets are expanded into one contour per member.
+  The contours of each list are allocated in one array (see the block
+  field of CONTOURS), to be freed with nmmtl_free_contours as usual.
+
+  FORMAL PARAMETERS:
+
+  MMTL_XSCTN_P xsctn                    - the cross section
+
+  outputs - see nmmtl_parse_xsctn:
+
+  int *cntr_seg, int *pln_seg, double *coupling, double *risetime,
+  double *conductivity, double *half_minimum_dimension, int *gnd_planes,
+  double *top_ground_plane_thickness,
+  double *bottom_ground_plane_thickness,
+  struct dielectric **dielectrics, struct contour **signals,
+  struct contour **groundwires, int *num_signals, int *num_grounds
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL
+
+  CALLING SEQUENCE:
+
+  status = nmmtl_xsctn_expand(xsctn,&cntr_seg,&pln_seg,...);
+
+  */
+
+int nmmtl_xsctn_expand(MMTL_XSCTN_P xsctn,
+                       int *cntr_seg,
+                       int *pln_seg,
+                       double *coupling,
+                       double *risetime,
+                       double *conductivity,
+                       double *half_minimum_dimension,
+                       int *gnd_planes,
+                       double *top_ground_plane_thickness,
+                       double *bottom_ground_plane_thickness,
+                       struct dielectric **dielectrics,
+                       struct contour **signals,
+                       struct contour **groundwires,
+                       int *num_signals,
+                       int *num_grounds)
+{
+  XSCTN_OBJECT_P object;
+  struct dielectric *d_temp;
+  struct contour *c_temp, *signal_block = NULL, *ground_block = NULL;
+  POLYPOINTS_P tail;
+  double offset = 1.0e20;
+  double highest_dielectric = -1.0e20;
+  double minimum_dimension = DBL_MAX;
+  double totWidth = 0.0;
+  double yCoord = 0.0;
+  double width, tw, cx, cy;
+  int i, indx, p, first;
+  int signal_contours = 0, ground_contours = 0;
+  unsigned char *keep = NULL;
+  int sides, elements, kept_sides, kept_elements;
+
+  *cntr_seg = xsctn->cntr_seg;
+  *pln_seg = xsctn->pln_seg;
+  *conductivity = xsctn->conductivity;
+  *gnd_planes = 0;
+  *dielectrics = NULL;
+  *signals = NULL;
+  *groundwires = NULL;
+  *num_signals = 0;
+  *num_grounds = 0;
+
+  *risetime = xsctn->risetime;
+  if(*risetime == 0.0) *risetime = DEFAULT_RISETIME * 1.0e-12;
+
+  *coupling = xsctn->coupling;
+  if(*coupling == 0.0) *coupling = DEFAULT_COUPLING * INCHES_TO_METERS;
+
+  /* same (user units) default as nmmtl_parse_xsctn */
+  *top_ground_plane_thickness = DEFAULT_GND_THICK / MILS_TO_METERS;
+  *bottom_ground_plane_thickness = DEFAULT_GND_THICK / MILS_TO_METERS;
+
+  /* the contours of each list are allocated together, one per member of
+     every conductor set */
+  for(i = 0; i < xsctn->number_objects; i++)
+  {
+    object = &xsctn->objects[i];
+    if(object->kind != XSCTN_CONDUCTORS) continue;
+    if(strncmp(object->name,"gr",2)) signal_contours += object->number;
+    else ground_contours += object->number;
+  }
+  if(signal_contours > 0)
+    signal_block = (struct contour *)
+      malloc(sizeof(struct contour) * (size_t)signal_contours);
+  if(ground_contours > 0)
+    ground_block = (struct contour *)
+      malloc(sizeof(struct contour) * (size_t)ground_contours);
+
+  for(i = 0; i < xsctn->number_objects; i++)
+  {
+    object = &xsctn->objects[i];
+
+    switch(object->kind)
+    {
+    case XSCTN_GROUND_PLANE:
+      if(++(*gnd_planes) > 2)
+      {
+        printf ("* Warning: There are %d groundplanes in the design...reset to 2\n",
+                *gnd_planes);
+        *gnd_planes = 2;
+      }
+      break;
+
+    case XSCTN_DIELECTRIC_LAYER:
+      if(*gnd_planes == 0)
+      {
+        printf ("* ERROR: There must be a bottom ground plane!\n");
+        /* an array no contour is on yet is not freed with the lists */
+        if(*signals == NULL) free(signal_block);
+        if(*groundwires == NULL) free(ground_block);
+        return(FAIL);
+      }
+      d_temp = (struct dielectric *)malloc(sizeof(struct dielectric));
+      d_temp->constant = object->permittivity;
+      d_temp->tangent = object->loss_tangent;
+      d_temp->x0 = d_temp->x1 = 0;
+      d_temp->y0 = yCoord;
+      yCoord += object->height;
+      d_temp->y1 = yCoord;
+
+      /* insert dielectric onto plain list */
+      d_temp->next = *dielectrics;
+      *dielectrics = d_temp;
+
+      if(d_temp->y1 > highest_dielectric) highest_dielectric = d_temp->y1;
+      if(d_temp->y0 < offset) offset = d_temp->y0;
+      if(object->height < minimum_dimension)
+        minimum_dimension = object->height;
+      break;
+
+    case XSCTN_RECTANGLE_DIELECTRIC:
+      for(indx = 0; indx < object->number; indx++)
+      {
+        d_temp = (struct dielectric *)malloc(sizeof(struct dielectric));
+        d_temp->constant = object->permittivity;
+        d_temp->tangent = object->loss_tangent;
+        d_temp->x0 = object->x_offset + indx * object->pitch;
+        d_temp->x1 = d_temp->x0 + object->width;
+        d_temp->y0 = yCoord;
+        d_temp->y1 = yCoord + object->height;
+
+        d_temp->next = *dielectrics;
+        *dielectrics = d_temp;
+
+        if(d_temp->y1 > highest_dielectric) highest_dielectric = d_temp->y1;
+        if(d_temp->y0 < offset) offset = d_temp->y0;
+        if(object->height < minimum_dimension)
+          minimum_dimension = object->height;
+      }
+      break;
+
+    case XSCTN_CONDUCTORS:
+
+      /* total width of the conductor set and smallest dimension */
+      width = 0.0;
+      tw = 0.0;
+      switch(object->primitive)
+      {
+      case RECTANGLE:
+        tw = object->x_offset + (object->number - 1) * object->pitch +
+          object->width;
+        if(object->width < minimum_dimension)
+          minimum_dimension = object->width;
+        if(object->height < minimum_dimension)
+          minimum_dimension = object->height;
+        break;
+      case POLYGON:
+        if(object->points != NULL)
+        {
+          /* rightmost vertex */
+          tw = object->points[0];
+          for(p = 1; p < object->number_points; p++)
+            if(object->points[2*p] > tw) tw = object->points[2*p];
+        }
+        else
+        {
+          /* trapezoid: centered in the wider of its two widths */
+          width = object->bottom_width;
+          if(object->top_width > width) width = object->top_width;
+          tw = object->x_offset + (object->number - 1) * object->pitch +
+            width;
+          width *= 0.5;
+          if(object->top_width < minimum_dimension)
+            minimum_dimension = object->top_width;
+          if(object->bottom_width < minimum_dimension)
+            minimum_dimension = object->bottom_width;
+        }
+        break;
+      case CIRCLE:
+        tw = object->x_offset + (object->number - 1) * object->pitch +
+          object->diameter;
+        if(object->diameter < minimum_dimension)
+          minimum_dimension = object->diameter;
+        break;
+      }
+      if(tw > totWidth)
+      {
+        totWidth = tw;
+        if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+          printf("Total width: %g\n",totWidth);
+      }
+
+      cx = object->x_offset;
+      cy = yCoord + object->y_offset;
+
+      /* thin out a traced outline before it is broken into segments */
+      if(object->primitive == POLYGON && object->points != NULL &&
+         xsctn->polygon_tolerance > 0.0)
+      {
+        keep = (unsigned char *)malloc((size_t)object->number_points);
+        nmmtl_simplify_polygon(object->points,object->number_points,
+                               xsctn->polygon_tolerance,keep);
+        if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+        {
+          nmmtl_xsctn_outline_elements(object->points,object->number_points,
+                                       NULL,xsctn->cntr_seg,&sides,&elements);
+          nmmtl_xsctn_outline_elements(object->points,object->number_points,
+                                       keep,xsctn->cntr_seg,&kept_sides,
+                                       &kept_elements);
+          printf("Polygon %s: %d of %d sides kept, %d of %d elements\n",
+                 object->name,kept_sides,sides,kept_elements,elements);
+        }
+      }
+
+      for(indx = 0; indx < object->number; indx++)
+      {
+        if(strncmp(object->name,"gr",2))
+        {
+          c_temp = &signal_block[*num_signals];
+          c_temp->block = signal_block;
+        }
+        else
+        {
+          c_temp = &ground_block[*num_grounds];
+          c_temp->block = ground_block;
+        }
+        c_temp->next = NULL;
+        c_temp->points = NULL;
+        c_temp->name[0] = '\0';
+        c_temp->primitive = object->primitive;
+
+        switch(object->primitive)
+        {
+        case RECTANGLE:
+          c_temp->x0 = cx;
+          c_temp->y0 = cy;
+          c_temp->x1 = cx + object->width;
+          c_temp->y1 = cy + object->height;
+          break;
+        case CIRCLE:
+          c_temp->x0 = cx + object->diameter * 0.5;
+          c_temp->y0 = cy + object->diameter * 0.5;
+          c_temp->x1 = object->diameter * 0.5;
+          c_temp->y1 = 0;
+          break;
+        case POLYGON:
+          /* x0 accumulates the perimeter, y0 and y1 are the lowest and
+             highest y */
+          c_temp->x0 = 0.0;
+          c_temp->x1 = 0.0;
+          c_temp->points = tail = (POLYPOINTS_P)malloc(sizeof(POLYPOINTS));
+          tail->next = NULL;
+          if(object->points != NULL)
+          {
+            for(first = 0; keep != NULL && !keep[first]; first++);
+            tail->x = object->points[2*first];
+            tail->y = cy + object->points[2*first+1];
+            c_temp->y0 = c_temp->y1 = tail->y;
+            for(p = first + 1; p < object->number_points; p++)
+            {
+              if(keep != NULL && !keep[p]) continue;
+              c_temp->x0 += nmmtl_xsctn_add_point(&tail,object->points[2*p],
+                                                  cy + object->points[2*p+1],
+                                                  &minimum_dimension);
+              if(tail->y < c_temp->y0) c_temp->y0 = tail->y;
+              if(tail->y > c_temp->y1) c_temp->y1 = tail->y;
+            }
+            /* close the outline */
+            if(tail->x != c_temp->points->x || tail->y != c_temp->points->y)
+              c_temp->x0 += nmmtl_xsctn_add_point(&tail,c_temp->points->x,
+                                                  c_temp->points->y,
+                                                  &minimum_dimension);
+          }
+          else
+          {
+            c_temp->y0 = cy;
+            c_temp->y1 = cy + object->height;
+            tail->x = cx + width - object->bottom_width * 0.5;
+            tail->y = cy;
+            c_temp->x0 += nmmtl_xsctn_add_point(&tail,
+                                                cx + width - object->top_width * 0.5,
+                                                cy + object->height,
+                                                &minimum_dimension);
+            c_temp->x0 += nmmtl_xsctn_add_point(&tail,
+                                                cx + width + object->top_width * 0.5,
+                                                cy + object->height,
+                                                &minimum_dimension);
+            c_temp->x0 += nmmtl_xsctn_add_point(&tail,
+                                                cx + width + object->bottom_width * 0.5,
+                                                cy,
+                                                &minimum_dimension);
+            c_temp->x0 += nmmtl_xsctn_add_point(&tail,
+                                                cx + width - object->bottom_width * 0.5,
+                                                cy,
+                                                &minimum_dimension);
+          }
+          break;
+        }
+
+        /* Check if this is a conductor that should be defined as a
+           ground wire. */
+        if(strncmp(object->name,"gr",2))
+        {
+          c_temp->conductivity = object->conductivity;
+          c_temp->next = *signals;
+          *signals = c_temp;
+          if(snprintf(c_temp->name,SIZE_SIG_NAME,"%s%c%d",object->name,
+                      object->type,*num_signals) >= SIZE_SIG_NAME)
+            fprintf(stderr,"Warning: signal name truncated to %s\n",
+                    c_temp->name);
+          (*num_signals)++;
+          if(OUTPUT_PRODUCTS & OUTPUT_PROGRESS)
+            printf("Conductivity %s = %g siemens/meter\n",
+                   c_temp->name,c_temp->conductivity);
+        }
+        else
+        {
+          c_temp->conductivity = 0.;
+          c_temp->next = *groundwires;
+          *groundwires = c_temp;
+          (*num_grounds)++;
+        }
+        cx += object->pitch;
+      }
+      free(keep);
+      keep = NULL;
+      break;
+    }
+  }
+
+  return(nmmtl_xsctn_finish(totWidth,offset,highest_dielectric,
+                            minimum_dimension,half_minimum_dimension,
+                            gnd_planes,top_ground_plane_thickness,
+                            bottom_ground_plane_thickness,
+                            dielectrics,signals,groundwires,num_grounds));
+}
+
+
+/*
+
+  FUNCTION NAME:  nmmtl_xsctn_finish
+
+  FUNCTIONAL DESCRIPTION:
+
+  Final pass over a freshly read cross section.  Layers which were not
+  given an x extent span from -total_width to 2*total_width, everything is
+  offset so the top of the bottom ground plane is at y=0, and ground
+  wire rectangles which really are ground planes are taken off the
+  ground wire list.  Common to nmmtl_parse_xsctn and nmmtl_xsctn_expand.
+
+  FORMAL PARAMETERS:
+
+  double total_width                 - right edge of the conductor region
+  double offset                      - lowest dielectric y
+  double highest_dielectric          - highest dielectric y
+  double minimum_dimension           - smallest geometric dimension
+
+  outputs - see nmmtl_parse_xsctn:
+
+  double *half_minimum_dimension, int *gnd_planes,
+  double *top_ground_plane_thickness,
+  double *bottom_ground_plane_thickness,
+  struct dielectric **dielectrics, struct contour **signals,
+  struct contour **groundwires, int *num_grounds
+
+  RETURN VALUE:
+
+  SUCCESS, FAIL
+
+  CALLING SEQUENCE:
+
+  return(nmmtl_xsctn_finish(totWidth,offset,highest_dielectric,...));
+
+  */
+
+int nmmtl_xsctn_finish(double total_width,
+                       double offset,
+                       double highest_dielectric,
+                       double minimum_dimension,
+                       double *half_minimum_dimension,
+                       int *gnd_planes,
+                       double *top_ground_plane_thickness,
+                       double *bottom_ground_plane_thickness,
+                       struct dielectric **dielectrics,
+                       struct contour **signals,
+                       struct contour **groundwires,
+                       int *num_grounds)
+{
+  struct dielectric *d_temp;
+  struct contour *c_temp,*c_prev;
+  struct contour *ground_block = NULL; /* array of those taken off */
+  int upper_ground_planes = 0;  /* keep count of drawn ground planes */
+  int lower_ground_planes = 0;
+  double ground_x_min = DBL_MAX, ground_x_max = DBL_MIN;
+
+  d_temp = *dielectrics;
+  while ( d_temp != NULL ) {
+    if ( d_temp->x0 == 0 && d_temp->x1 == 0 ) {
+      d_temp->x0 = -total_width;
+      d_temp->x1 = d_temp->x0 + 3.0 * total_width;
+    }
+    d_temp = d_temp->next;
+  }
+
+  /* Offset all y dimensions to make top of bottom ground plane at */
+  /* y=0.0 */
+
+  if (offset != 0.0) {
+    if (nmmtl_set_offset(offset, *dielectrics, *signals, *groundwires) != SUCCESS) {
+      printf("ERROR in nmmtl_set_offset: Cannot set offset\n");
+      return(FAIL);
+    }
+  }
+  highest_dielectric -= offset;
+
+  /* now, check to see if ground planes were really specified by */
+  /* drawing rectanges.  If so, the bottom ground plane will be */
+  /* now at y=0, since the offset operation was completed. */
+
+  /* ordinarily there should be one of each, but the following code */
+  /* is extra robust, just in case there are more. */
+
+  if (*gnd_planes == 0 && *groundwires != NULL) {
+    /* loop and take off all elements on groundwire list which */
+    /* would qualify as lower ground planes.  If there is more */
+    /* than one, so warn the user. */
+
+    c_prev = NULL;
+    c_temp = *groundwires;
+    while(c_temp != NULL) {
+      if(c_temp->primitive == 'R') {
+        if(c_temp->y1 == 0.0) {
+          lower_ground_planes++;
+          if(lower_ground_planes > 1) {
+            printf ("**** Too many lower groundplanes...reset to 1\n");
+          }
+          *gnd_planes = 1;
+          (*num_grounds)--;
+
+          /* save fullest extent of x dimensions of ground plane */
+          if(ground_x_min > c_temp->x0) ground_x_min = c_temp->x0;
+          if(ground_x_max < c_temp->x1) ground_x_max = c_temp->x1;
+
+          /* record ground plane thickness */
+          *bottom_ground_plane_thickness = c_temp->y1 - c_temp->y0;
+
+          if(c_prev == NULL) {
+            /* remove first item from the list */
+            *groundwires = c_temp->next;
+            ground_block = c_temp->block;
+            c_temp = *groundwires;
+          } else {
+            /* remove from list */
+            c_prev->next = c_temp->next;
+            ground_block = c_temp->block;
+            c_temp = c_prev->next;
+          }
+        } else {
+          c_prev = c_temp; c_temp = c_temp->next;
+        }
+      } else {
+        c_prev = c_temp; c_temp = c_temp->next;
+      }
+    }
+  }
+
+
+  /* Now try to find an upper ground plane - its x dimensions must */
+  /* match exactly */
+
+  if(*gnd_planes == 1 && *groundwires != NULL) {
+    /* loop and take off all elements on groundwire list which */
+    /* would qualify as an upper ground planes.  If there is more */
+    /* than one, so warn the user. */
+
+    c_prev = NULL;
+    c_temp = *groundwires;
+    while(c_temp != NULL) {
+      if(c_temp->primitive == 'R') {
+        if (c_temp->y0 == highest_dielectric &&
+        ground_x_min == c_temp->x0 && ground_x_max == c_temp->x1 ) {
+          (*num_grounds)--;
+
+          upper_ground_planes++;
+          if(upper_ground_planes > 1)
+          {
+            printf ("**** Too many upper groundplanes...reset to 2\n");
+          }
+          *gnd_planes = 2;
+
+          /* record ground plane thickness */
+          *top_ground_plane_thickness = c_temp->y1 - c_temp->y0;
+
+          /* remove from the list of groundwires */
+          if(c_prev == NULL) {
+            /* remove first item from the list */
+            *groundwires = c_temp->next;
+            ground_block = c_temp->block;
+            c_temp = *groundwires;
+          } else {
+            /* remove from list */
+            c_prev->next = c_temp->next;
+            ground_block = c_temp->block;
+            c_temp = c_prev->next;
+          }
+        } else {
+          c_prev = c_temp; c_temp = c_temp->next;
+        }
+      } else {
+        c_prev = c_temp; c_temp = c_temp->next;
+      }
+    }
+  }
+
+  /* warning to the user if bottom ground plane is missing - it
+     will go on and assume one exists, below the lowest dielectric layer */
+  if(*gnd_planes < 1) {
+    printf ("* Warning: There isn't a groundplane\n");
+  }
+
+  /* ground planes taken off stay in the array of the ground wires,
+     which goes with the list unless the list is now empty */
+  if(*groundwires == NULL) free(ground_block);
+
+  *half_minimum_dimension = .5 * minimum_dimension;
+
+  return(SUCCESS);
+}
@@ -14,14 +14,18 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
 
 #define TRUE 1
 #define FALSE 0
 #define SUCCESS 1
 #define FAIL 0
 
-#define MAXUNITS 1000
-#define MAXPREFIXES 50
+#define UNIT_HASH_SIZE 256           // power of two, over twice the units
+
+#define CONVERSION_CACHE_SIZE 1024   // power of two
+#define CONVERSION_KEY_SIZE 64
+#define CONVERSION_KEY_SEP '\001'
 
 #define MAXSUBUNITS 500
 
@@ -29,10 +33,105 @@
 
 static const char *powerstring="^";
 
-static struct {
+// The unit and prefix tables are compiled in.  A unit value holding
+// PRIMITIVECHAR is a primitive unit.  Prefixes are matched in order, so
+// the longer names come before the one letter abbreviations.
+static const struct {
   const char *uname;
   const char *uval;
-} unittable[MAXUNITS];
+} unittable[] = {
+  { "m", "!a!" },
+  { "kg", "!b!" },
+  { "sec", "!c!" },
+  { "coul", "!d!" },
+  { "candela", "!e!" },
+  { "dollar", "!f!" },
+  { "bit", "!h!" },
+  { "erlang", "!i!" },
+  { "K", "!j!" },
+  { "fuzz", "1" },
+  { "pi", "3.14159265358979323846" },
+  { "c", "2.99792458e+8 m/sec fuzz" },
+  { "g", "9.80665 m/sec2" },
+  { "au", "1.49597871e+11 m fuzz" },
+  { "mole", "6.022169e+23 fuzz" },
+  { "e", "1.6021917e-19 coul fuzz" },
+  { "radian", ".5 / pi" },
+  { "degree", "1|180 pi-radian" },
+  { "circle", "2 pi-radian" },
+  { "second", "sec" },
+  { "s", "sec" },
+  { "minute", "60 sec" },
+  { "min", "minute" },
+  { "hour", "60 min" },
+  { "hr", "hour" },
+  { "day", "24 hr" },
+  { "da", "day" },
+  { "week", "7 day" },
+  { "year", "365.24219879 day fuzz" },
+  { "yr", "year" },
+  { "month", "1|12 year" },
+  { "meter", "m" },
+  { "cm", "centimeter" },
+  { "CM", "centimeter" },
+  { "mm", "millimeter" },
+  { "km", "kilometer" },
+  { "nm", "nanometer" },
+  { "um", "micrometer" },
+  { "micron", "micrometer" },
+  { "angstrom", "decinanometer" },
+  { "inch", "2.54 cm" },
+  { "in", "inch" },
+  { "IN", "inch" },
+  { "foot", "12 in" },
+  { "feet", "foot" },
+  { "ft", "foot" },
+  { "yard", "3 ft" },
+  { "yd", "yard" },
+  { "mil", "1e-3 in" },
+  { "newton", "kg-m/sec2" },
+  { "nt", "newton" },
+  { "N", "newton" },
+  { "joule", "nt-m" },
+  { "cal", "4.1868 joule" },
+  { "coulomb", "coul" },
+  { "C", "coul" },
+  { "ampere", "coul/sec" },
+  { "amp", "ampere" },
+  { "A", "ampere" },
+  { "watt", "joule/sec" },
+  { "volt", "watt/amp" },
+  { "V", "volt" },
+  { "ohm", "volt/amp" },
+  { "Ohm", "volt/amp" },
+  { "kilohm", "kiloohm" },
+  { "Megohm", "megaohm" },
+  { "megohm", "megaohm" },
+  { "mho", "/ohm" },
+  { "siemen", "/ohm" },
+  { "Siemen", "/ohm" },
+  { "farad", "coul/volt" },
+  { "Farad", "coul/volt" },
+  { "F", "farad" },
+  { "nf", "nanofarad" },
+  { "pf", "picofarad" },
+  { "ff", "femtofarad" },
+  { "henry", "sec2/farad" },
+  { "Henry", "sec2/farad" },
+  { "H", "henry" },
+  { "mh", "millihenry" },
+  { "weber", "volt-sec" },
+  { "maxwell", "1e-8 weber" },
+  { "hertz", "/sec" },
+  { "Hertz", "/sec" },
+  { "Hz", "hertz" },
+  { "kHz", "kilohertz" },
+  { "GHz", "gigahertz" },
+  { "MHz", "megahertz" },
+  { "hz", "/sec" },
+  { "khz", "1e+3 /sec" },
+  { "mhz", "1e+6 /sec" },
+};
 
 struct unittype {
   char *numerator[MAXSUBUNITS];
@@ -40,16 +139,81 @@ struct unittype {
   double factor;
 };
 
-static struct {
+static const struct {
   const char *prefixname;
   const char *prefixval;
-} prefixtable[MAXPREFIXES];
+} prefixtable[] = {
+  { "yotta", "1e24" },
+  { "zetta", "1e21" },
+  { "exa", "1e18" },
+  { "peta", "1e15" },
+  { "tera", "1e12" },
+  { "giga", "1e9" },
+  { "Giga", "1e9" },
+  { "mega", "1e6" },
+  { "Meg", "1e6" },
+  { "Mega", "1e6" },
+  { "myria", "1e4" },
+  { "kilo", "1e3" },
+  { "hecto", "1e2" },
+  { "deka", "1e1" },
+  { "deci", "1e-1" },
+  { "centi", "1e-2" },
+  { "milli", "1e-3" },
+  { "micro", "1e-6" },
+  { "nano", "1e-9" },
+  { "pico", "1e-12" },
+  { "femto", "1e-15" },
+  { "atto", "1e-18" },
+  { "zopto", "1e-21" },
+  { "yocto", "1e-24" },
+  { "semi", ".5" },
+  { "demi", ".5" },
+  { "Y", "yotta" },
+  { "Z", "zetta" },
+  { "E", "exa" },
+  { "P", "peta" },
+  { "T", "tera" },
+  { "G", "giga" },
+  { "M", "mega" },
+  { "S", "siemen" },
+  { "k", "kilo" },
+  { "h", "hecto" },
+  { "da", "deka" },
+  { "d", "deci" },
+  { "c", "centi" },
+  { "m", "milli" },
+  { "u", "micro" },
+  { "n", "nano" },
+  { "p", "pico" },
+  { "f", "femto" },
+  { "a", "atto" },
+  { "z", "zopto" },
+  { "y", "yocto" },
+};
 
 
 static char *NULLUNIT=(char *)"";
 
-static int unitcount    = 0;
-static int prefixcount  = 0;
+static const int unitcount   = (int)(sizeof(unittable)/sizeof(unittable[0]));
+static const int prefixcount = (int)(sizeof(prefixtable)/sizeof(prefixtable[0]));
+
+// Open addressing index from unit name to unittable entry, built once by
+// setunits().  Entries hold the table index plus one, zero is empty.
+static short unithash[UNIT_HASH_SIZE];
+static pthread_once_t unithash_once = PTHREAD_ONCE_INIT;
+
+// Memo of conversion factors: the unit part of a from string and the to
+// string map to the factor for one of the from units, so a string that
+// has been converted before costs one hashed lookup and a multiply.
+struct conversioncache {
+  char key[CONVERSION_KEY_SIZE];     // units, CONVERSION_KEY_SEP, to string
+  int status;                        // SUCCESS or FAIL
+  double factor;
+};
+static struct conversioncache conversion_cache[CONVERSION_CACHE_SIZE];
+static int conversion_cache_count = 0;
+static pthread_mutex_t conversion_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 
@@ -65,286 +229,48 @@ char *dupstr(const char *str) {
 }
 
 
+// FNV-1a hash of a string, for the unit index and the conversion memo.
+static unsigned int hashstring(const char *str) {
+  unsigned int hash = 2166136261u;
+  while (*str) {
+    hash ^= (unsigned char)*str++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+static void buildunithash(void) {
+  int i;
+  unsigned int slot;
+
+  for (i = 0; i < unitcount; i++) {
+    slot = hashstring(unittable[i].uname) & (UNIT_HASH_SIZE-1);
+    while (unithash[slot])
+      slot = (slot+1) & (UNIT_HASH_SIZE-1);
+    unithash[slot] = (short)(i+1);
+  }
+}
+
+
+// Builds the unit name index.  conversion() does this on first use; it is
+// safe to call any number of times, from any thread.
 void setunits(void) {
-  unittable[0].uname = "m";
-  unittable[0].uval = "!a!";
-  unittable[1].uname = "kg";
-  unittable[1].uval = "!b!";
-  unittable[2].uname = "sec";
-  unittable[2].uval = "!c!";
-  unittable[3].uname = "coul";
-  unittable[3].uval = "!d!";
-  unittable[4].uname = "candela";
-  unittable[4].uval = "!e!";
-  unittable[5].uname = "dollar";
-  unittable[5].uval = "!f!";
-  unittable[6].uname = "bit";
-  unittable[6].uval = "!h!";
-  unittable[7].uname = "erlang";
-  unittable[7].uval = "!i!";
-  unittable[8].uname = "K";
-  unittable[8].uval = "!j!";
-  prefixtable[0].prefixname = "yotta";
-  prefixtable[0].prefixval = "1e24";
-  prefixtable[1].prefixname = "zetta";
-  prefixtable[1].prefixval = "1e21";
-  prefixtable[2].prefixname = "exa";
-  prefixtable[2].prefixval = "1e18";
-  prefixtable[3].prefixname = "peta";
-  prefixtable[3].prefixval = "1e15";
-  prefixtable[4].prefixname = "tera";
-  prefixtable[4].prefixval = "1e12";
-  prefixtable[5].prefixname = "giga";
-  prefixtable[5].prefixval = "1e9";
-  prefixtable[6].prefixname = "Giga";
-  prefixtable[6].prefixval = "1e9";
-  prefixtable[7].prefixname = "mega";
-  prefixtable[7].prefixval = "1e6";
-  prefixtable[8].prefixname = "Meg";
-  prefixtable[8].prefixval = "1e6";
-  prefixtable[9].prefixname = "Mega";
-  prefixtable[9].prefixval = "1e6";
-  prefixtable[10].prefixname = "myria";
-  prefixtable[10].prefixval = "1e4";
-  prefixtable[11].prefixname = "kilo";
-  prefixtable[11].prefixval = "1e3";
-  prefixtable[12].prefixname = "hecto";
-  prefixtable[12].prefixval = "1e2";
-  prefixtable[13].prefixname = "deka";
-  prefixtable[13].prefixval = "1e1";
-  prefixtable[14].prefixname = "deci";
-  prefixtable[14].prefixval = "1e-1";
-  prefixtable[15].prefixname = "centi";
-  prefixtable[15].prefixval = "1e-2";
-  prefixtable[16].prefixname = "milli";
-  prefixtable[16].prefixval = "1e-3";
-  prefixtable[17].prefixname = "micro";
-  prefixtable[17].prefixval = "1e-6";
-  prefixtable[18].prefixname = "nano";
-  prefixtable[18].prefixval = "1e-9";
-  prefixtable[19].prefixname = "pico";
-  prefixtable[19].prefixval = "1e-12";
-  prefixtable[20].prefixname = "femto";
-  prefixtable[20].prefixval = "1e-15";
-  prefixtable[21].prefixname = "atto";
-  prefixtable[21].prefixval = "1e-18";
-  prefixtable[22].prefixname = "zopto";
-  prefixtable[22].prefixval = "1e-21";
-  prefixtable[23].prefixname = "yocto";
-  prefixtable[23].prefixval = "1e-24";
-  prefixtable[24].prefixname = "semi";
-  prefixtable[24].prefixval = ".5";
-  prefixtable[25].prefixname = "demi";
-  prefixtable[25].prefixval = ".5";
-  prefixtable[26].prefixname = "Y";
-  prefixtable[26].prefixval = "yotta";
-  prefixtable[27].prefixname = "Z";
-  prefixtable[27].prefixval = "zetta";
-  prefixtable[28].prefixname = "E";
-  prefixtable[28].prefixval = "exa";
-  prefixtable[29].prefixname = "P";
-  prefixtable[29].prefixval = "peta";
-  prefixtable[30].prefixname = "T";
-  prefixtable[30].prefixval = "tera";
-  prefixtable[31].prefixname = "G";
-  prefixtable[31].prefixval = "giga";
-  prefixtable[32].prefixname = "M";
-  prefixtable[32].prefixval = "mega";
-  prefixtable[33].prefixname = "S";
-  prefixtable[33].prefixval = "siemen";
-  prefixtable[34].prefixname = "k";
-  prefixtable[34].prefixval = "kilo";
-  prefixtable[35].prefixname = "h";
-  prefixtable[35].prefixval = "hecto";
-  prefixtable[36].prefixname = "da";
-  prefixtable[36].prefixval = "deka";
-  prefixtable[37].prefixname = "d";
-  prefixtable[37].prefixval = "deci";
-  prefixtable[38].prefixname = "c";
-  prefixtable[38].prefixval = "centi";
-  prefixtable[39].prefixname = "m";
-  prefixtable[39].prefixval = "milli";
-  prefixtable[40].prefixname = "u";
-  prefixtable[40].prefixval = "micro";
-  prefixtable[41].prefixname = "n";
-  prefixtable[41].prefixval = "nano";
-  prefixtable[42].prefixname = "p";
-  prefixtable[42].prefixval = "pico";
-  prefixtable[43].prefixname = "f";
-  prefixtable[43].prefixval = "femto";
-  prefixtable[44].prefixname = "a";
-  prefixtable[44].prefixval = "atto";
-  prefixtable[45].prefixname = "z";
-  prefixtable[45].prefixval = "zopto";
-  prefixtable[46].prefixname = "y";
-  prefixtable[46].prefixval = "yocto";
-  unittable[9].uname = "fuzz";
-  unittable[9].uval = "1";
-  unittable[10].uname = "pi";
-  unittable[10].uval = "3.14159265358979323846";
-  unittable[11].uname = "c";
-  unittable[11].uval = "2.99792458e+8 m/sec fuzz";
-  unittable[12].uname = "g";
-  unittable[12].uval = "9.80665 m/sec2";
-  unittable[13].uname = "au";
-  unittable[13].uval = "1.49597871e+11 m fuzz";
-  unittable[14].uname = "mole";
-  unittable[14].uval = "6.022169e+23 fuzz";
-  unittable[15].uname = "e";
-  unittable[15].uval = "1.6021917e-19 coul fuzz";
-  unittable[16].uname = "radian";
-  unittable[16].uval = ".5 / pi";
-  unittable[17].uname = "degree";
-  unittable[17].uval = "1|180 pi-radian";
-  unittable[18].uname = "circle";
-  unittable[18].uval = "2 pi-radian";
-  unittable[19].uname = "second";
-  unittable[19].uval = "sec";
-  unittable[20].uname = "s";
-  unittable[20].uval = "sec";
-  unittable[21].uname = "minute";
-  unittable[21].uval = "60 sec";
-  unittable[22].uname = "min";
-  unittable[22].uval = "minute";
-  unittable[23].uname = "hour";
-  unittable[23].uval = "60 min";
-  unittable[24].uname = "hr";
-  unittable[24].uval = "hour";
-  unittable[25].uname = "day";
-  unittable[25].uval = "24 hr";
-  unittable[26].uname = "da";
-  unittable[26].uval = "day";
-  unittable[27].uname = "week";
-  unittable[27].uval = "7 day";
-  unittable[28].uname = "year";
-  unittable[28].uval = "365.24219879 day fuzz";
-  unittable[29].uname = "yr";
-  unittable[29].uval = "year";
-  unittable[30].uname = "month";
-  unittable[30].uval = "1|12 year";
-  unittable[31].uname = "meter";
-  unittable[31].uval = "m";
-  unittable[32].uname = "cm";
-  unittable[32].uval = "centimeter";
-  unittable[33].uname = "CM";
-  unittable[33].uval = "centimeter";
-  unittable[34].uname = "mm";
-  unittable[34].uval = "millimeter";
-  unittable[35].uname = "km";
-  unittable[35].uval = "kilometer";
-  unittable[36].uname = "nm";
-  unittable[36].uval = "nanometer";
-  unittable[37].uname = "um";
-  unittable[37].uval = "micrometer";
-  unittable[38].uname = "micron";
-  unittable[38].uval = "micrometer";
-  unittable[39].uname = "angstrom";
-  unittable[39].uval = "decinanometer";
-  unittable[40].uname = "inch";
-  unittable[40].uval = "2.54 cm";
-  unittable[41].uname = "in";
-  unittable[41].uval = "inch";
-  unittable[42].uname = "IN";
-  unittable[42].uval = "inch";
-  unittable[43].uname = "foot";
-  unittable[43].uval = "12 in";
-  unittable[44].uname = "feet";
-  unittable[44].uval = "foot";
-  unittable[45].uname = "ft";
-  unittable[45].uval = "foot";
-  unittable[46].uname = "yard";
-  unittable[46].uval = "3 ft";
-  unittable[47].uname = "yd";
-  unittable[47].uval = "yard";
-  unittable[48].uname = "mil";
-  unittable[48].uval = "1e-3 in";
-  unittable[49].uname = "newton";
-  unittable[49].uval = "kg-m/sec2";
-  unittable[50].uname = "nt";
-  unittable[50].uval = "newton";
-  unittable[51].uname = "N";
-  unittable[51].uval = "newton";
-  unittable[52].uname = "joule";
-  unittable[52].uval = "nt-m";
-  unittable[53].uname = "cal";
-  unittable[53].uval = "4.1868 joule";
-  unittable[54].uname = "coulomb";
-  unittable[54].uval = "coul";
-  unittable[55].uname = "C";
-  unittable[55].uval = "coul";
-  unittable[56].uname = "ampere";
-  unittable[56].uval = "coul/sec";
-  unittable[57].uname = "amp";
-  unittable[57].uval = "ampere";
-  unittable[58].uname = "A";
-  unittable[58].uval = "ampere";
-  unittable[59].uname = "watt";
-  unittable[59].uval = "joule/sec";
-  unittable[60].uname = "volt";
-  unittable[60].uval = "watt/amp";
-  unittable[61].uname = "V";
-  unittable[61].uval = "volt";
-  unittable[62].uname = "ohm";
-  unittable[62].uval = "volt/amp";
-  unittable[63].uname = "Ohm";
-  unittable[63].uval = "volt/amp";
-  unittable[64].uname = "kilohm";
-  unittable[64].uval = "kiloohm";
-  unittable[65].uname = "Megohm";
-  unittable[65].uval = "megaohm";
-  unittable[66].uname = "megohm";
-  unittable[66].uval = "megaohm";
-  unittable[67].uname = "mho";
-  unittable[67].uval = "/ohm";
-  unittable[68].uname = "siemen";
-  unittable[68].uval = "/ohm";
-  unittable[69].uname = "Siemen";
-  unittable[69].uval = "/ohm";
-  unittable[70].uname = "farad";
-  unittable[70].uval = "coul/volt";
-  unittable[71].uname = "Farad";
-  unittable[71].uval = "coul/volt";
-  unittable[72].uname = "F";
-  unittable[72].uval = "farad";
-  unittable[73].uname = "nf";
-  unittable[73].uval = "nanofarad";
-  unittable[74].uname = "pf";
-  unittable[74].uval = "picofarad";
-  unittable[75].uname = "ff";
-  unittable[75].uval = "femtofarad";
-  unittable[76].uname = "henry";
-  unittable[76].uval = "sec2/farad";
-  unittable[77].uname = "Henry";
-  unittable[77].uval = "sec2/farad";
-  unittable[78].uname = "H";
-  unittable[78].uval = "henry";
-  unittable[79].uname = "mh";
-  unittable[79].uval = "millihenry";
-  unittable[80].uname = "weber";
-  unittable[80].uval = "volt-sec";
-  unittable[81].uname = "maxwell";
-  unittable[81].uval = "1e-8 weber";
-  unittable[82].uname = "hertz";
-  unittable[82].uval = "/sec";
-  unittable[83].uname = "Hertz";
-  unittable[83].uval = "/sec";
-  unittable[84].uname = "Hz";
-  unittable[84].uval = "hertz";
-  unittable[85].uname = "kHz";
-  unittable[85].uval = "kilohertz";
-  unittable[86].uname = "GHz";
-  unittable[86].uval = "gigahertz";
-  unittable[87].uname = "MHz";
-  unittable[87].uval = "megahertz";
-  unittable[88].uname = "hz";
-  unittable[88].uval = "/sec";
-  unittable[89].uname = "khz";
-  unittable[89].uval = "1e+3 /sec";
-  unittable[90].uname = "mhz";
-  unittable[90].uval = "1e+6 /sec";
-
-  unitcount = 91;
-  prefixcount = 47;
+  pthread_once(&unithash_once, buildunithash);
+}
+
+
+// Returns the unittable index of the named unit, or -1.
+static int findunit(const char *name) {
+  unsigned int slot;
+
+  slot = hashstring(name) & (UNIT_HASH_SIZE-1);
+  while (unithash[slot]) {
+    if (!strcmp(unittable[unithash[slot]-1].uname, name))
+      return unithash[slot]-1;
+    slot = (slot+1) & (UNIT_HASH_SIZE-1);
+  }
+  return -1;
 }
 
 
@@ -419,7 +345,7 @@ void showunit(struct unittype *theunit) {
 //   Returns 0 for successful addition, nonzero on error.
 int addunit(struct unittype *theunit, const char *toadd, int flip) {
   char *scratch,*savescr;
-  char *item;
+  char *item, *saveptr;
   char *divider, *slash;
   int doingtop;
 
@@ -433,7 +359,7 @@ int addunit(struct unittype *theunit, const char *toadd, int flip) {
   doingtop=1;
   do
       {
-      item=strtok(scratch," *\t\n/");
+      item=strtok_r(scratch," *\t\n/",&saveptr);
       while(item)
     {
     if (strchr("0123456789.",*item))
@@ -486,7 +412,7 @@ int addunit(struct unittype *theunit, const char *toadd, int flip) {
           if (addsubunit(doingtop^flip?theunit->numerator:theunit->denominator,item))
             return 1;
       }
-      item=strtok(NULL," *\t/\n");
+      item=strtok_r(NULL," *\t/\n",&saveptr);
     }
     doingtop--;
     if (slash) {
@@ -529,6 +455,8 @@ void cancelunit(struct unittype *theunit) {
   while(*num && *den) {
     comp = strcmp(*den,*num);
     if (!comp) {
+      if (*den != NULLUNIT) free(*den);
+      if (*num != NULLUNIT) free(*num);
       *den ++= NULLUNIT;
       *num ++= NULLUNIT;
     } else if (comp<0) {
@@ -539,62 +467,40 @@ void cancelunit(struct unittype *theunit) {
   }
 }
 
-static char buffer[100];  /* buffer for lookupunit answers with prefixes */
+static thread_local char buffer[100];  /* buffer for lookupunit answers with prefixes */
 
 //Looks up the definition for the specified unit.
 //Returns a pointer to the definition or a null pointer
 //if the specified unit does not appear in the units table.
+//Plurals ("s", "es") and a trailing "^" are dropped if need be.
 const char *lookupunit(char *unit) {
   int i;
-  char *copy;
+  size_t length;
+  char copy[sizeof(buffer)];
 
-  for(i=0;i<unitcount;i++)
-      {
-      if (!strcmp(unittable[i].uname,unit)) return unittable[i].uval;
-      }
+  if ((i = findunit(unit)) >= 0) return unittable[i].uval;
+
+  length = strlen(unit);
+  if (length + 8 > sizeof(buffer)) return 0;   // room for a prefix value
 
-  if (unit[strlen(unit)-1]=='^')
+  if (unit[length-1]=='^' || unit[length-1]=='s')
       {
-      copy=dupstr(unit);
-      copy[strlen(copy)-1]=0;
-      for(i=0;i<unitcount;i++)
+      strcpy(copy,unit);
+      copy[length-1]=0;
+      if (findunit(copy) >= 0)
     {
-    if (!strcmp(unittable[i].uname,copy))
-        {
-        strcpy(buffer,copy);
-        free(copy);
-        return buffer;
-        }
+    strcpy(buffer,copy);
+    return buffer;
     }
-      free(copy);
-      }
-  if (unit[strlen(unit)-1]=='s')
-      {
-      copy=dupstr(unit);
-      copy[strlen(copy)-1]=0;
-      for(i=0;i<unitcount;i++)
+      if (unit[length-1]=='s' && length > 1 && copy[length-2]=='e')
     {
-    if (!strcmp(unittable[i].uname,copy))
+    copy[length-2]=0;
+    if (findunit(copy) >= 0)
         {
         strcpy(buffer,copy);
-        free(copy);
         return buffer;
         }
     }
-      if (copy[strlen(copy)-1]=='e')
-    {
-    copy[strlen(copy)-1]=0;
-    for(i=0;i<unitcount;i++)
-        {
-        if (!strcmp(unittable[i].uname,copy))
-      {
-      strcpy(buffer,copy);
-      free(copy);
-      return buffer;
-      }
-        }
-    }
-      free(copy);
       }
   for(i=0;i<prefixcount;i++)
       {
@@ -685,6 +591,44 @@ int completereduce(struct unittype *unit) {
 }
 
 
+// Frees the subunit strings of the specified unit.
+void freeunit(struct unittype *theunit) {
+  char **ptr;
+
+  for (ptr = theunit->numerator; *ptr; ptr++)
+    if (*ptr != NULLUNIT) free(*ptr);
+  for (ptr = theunit->denominator; *ptr; ptr++)
+    if (*ptr != NULLUNIT) free(*ptr);
+  initializeunit(theunit);
+}
+
+
+// Finds, by full symbolic reduction, the factor taking one of the from
+// units to the to units.  Returns SUCCESS or FAIL (unknown unit).
+static int unitfactor(const char *units, const char *to_string,
+                      double *factor) {
+  char havestr[CONVERSION_KEY_SIZE+2];
+  struct unittype have, want;
+  int status = FAIL;
+
+  snprintf(havestr, sizeof(havestr), "1 %s", units);
+
+  initializeunit(&have);
+  initializeunit(&want);
+  addunit(&have,havestr,0);
+  if (completereduce(&have) == 0) {
+    addunit(&want,to_string,0);
+    if (completereduce(&want) == 0) {
+      *factor = have.factor/want.factor;
+      status = SUCCESS;
+    }
+  }
+  freeunit(&have);
+  freeunit(&want);
+  return status;
+}
+
+
 //@F///////////////////////////////////////////////////////////////////////////
 //
 //  Function Name         conversion
@@ -695,126 +639,141 @@ int completereduce(struct unittype *unit) {
 // pico) and units(meters, henries, seconds) to a to string (consisting
 // only of scale factor and units).
 //
+// The factor for each pair of unit strings is found by symbolic reduction
+// once and then kept in conversion_cache, so repeated conversions do not
+// allocate or reduce anything.  Safe to call from several threads.
+//
 //  Formal Arguments
 //  Return Value
 //
 //F@///////////////////////////////////////////////////////////////////////////
 
 int conversion(char *from_string, char *to_string, double &scaled_number) {
-  char *remove_all_spaces(char *string);
-  char *local_from_string = strdup(from_string);
-  char *havestr, *wantstr;
-  struct unittype have, want;
-  double number;
-  int status;
-  int i, j, unitspt;
+  char text[CONVERSION_KEY_SIZE];
+  char key[CONVERSION_KEY_SIZE];
+  char *number_text, *units, *end;
+  const char *from;
+  size_t length, units_length, to_length;
+  int last_digit;
   int negative_number=FALSE;
+  int cached = FALSE;
+  int status = FAIL;
+  unsigned int slot = 0;
+  double number, factor = 0.0;
 
-  // Remove any spaces embedded in the from_string to facilitate parsing.
-  remove_all_spaces(local_from_string);
-
-  // Read the ASCII units file for each conversion, which allows
-  // more conversions to be added 'on the fly'.
-  if ( (unitcount==0) || (prefixcount==0) ) {
-    setunits();
-  }
-
-  if (local_from_string == NULL) {
+  if (from_string == NULL) {
     fprintf(stderr, "A string to convert from must be specified.");
     return -1;
-  } else {
-    // Insist that the units be separated from the actual number and
-    // copy verbatim the number into an internal string.  This technique
-    // avoids any conversions possibly performed by a scanf.
-    havestr = new char[strlen(local_from_string)+2];
-
-    // If a negative sign is present at the beginning of the number, then
-    // strip it since the units converter cannot handle it.  Flag this as
-    // the case, and restore the negative sign later to the converted
-    // number.
-    if(local_from_string[0] != '-') {
-      strcpy(havestr, local_from_string);
-    } else {
-      negative_number = TRUE;
-      strcpy(havestr, &local_from_string[1]);
-    }
-    //
-    // Scan backwards in the string until the first digit is found.
-    // Any character at or before this point is assumed to be the physical
-    // number and any character after this point is assumed to be the units
-    // and scale factor.  In this way, '1.0ps', '1.0 ps', '1000.0fs',
-    // '1000.0 fs', '1e3fs', and '1e3 fs' are converted correctly.
-    //
-    j = (int)strlen(havestr);
-    unitspt = j;
-    while ( !isdigit(havestr[unitspt]) ) {
-      unitspt--;
-      if(unitspt < 0) {
-        // no physical number was provided.
-        unitspt = j;
-        break;
-      }
-    }
-    // Insert a space after the physical number (before the units).
-    for(i = j; i > unitspt; --i) {
-      havestr[i+1] = havestr[i];
-    }
-    havestr[i+1] = ' ';
   }
-
   if (to_string == NULL) {
     fprintf(stderr, "A string to convert to must be specified.");
     return -2;
-  } else {
-    // Allocate memory to work with this string internally.
-    wantstr = new char[strlen(to_string)+1];
-    strcpy(wantstr, to_string);
   }
 
-  // Calculate the conversion factor.
-  initializeunit(&have);
-  addunit(&have,havestr,0);
-  if (completereduce(&have) == 0) {
-    initializeunit(&want);
-    addunit(&want,wantstr,0);
-    if (completereduce(&want) == 0) {
-      // For the simple case of a 0.0 value, the number is 0.0 in any
-      // units.  No conversion is performed and the 0.0 value is returned.
-      if (1 == sscanf(havestr, "%lf", &number)) {
-        //FIXME: do not compare floating point number against zero
-        if (number == 0.0) {
-          scaled_number = 0.0;
-          status = SUCCESS;
-        } else {
-          // Return the result.
-          if (negative_number == FALSE) {
-            scaled_number = have.factor/want.factor;
-          } else {
-            scaled_number = -1.0*have.factor/want.factor;
-          }
-          status = SUCCESS;
+  setunits();
+
+  // Copy the from_string without any spaces to facilitate parsing.
+  for (length = 0, from = from_string; *from; from++) {
+    if (isspace(*from)) continue;
+    if (length + 1 >= sizeof(text)) {
+      printf("Value too long to convert: %s\n", from_string);
+      return FAIL;
+    }
+    text[length++] = *from;
+  }
+  text[length] = '\0';
+
+  // If a negative sign is present at the beginning of the number, then
+  // strip it and restore it to the converted number.
+  number_text = text;
+  if (number_text[0] == '-') {
+    negative_number = TRUE;
+    number_text++;
+  }
+
+  // Any character at or before the last digit is assumed to be the
+  // physical number and anything after it the units and scale factor.  In
+  // this way, '1.0ps', '1.0 ps', '1000.0fs', '1e3fs' are converted
+  // correctly.
+  last_digit = (int)strlen(number_text) - 1;
+  while (last_digit >= 0 && !isdigit(number_text[last_digit]))
+    last_digit--;
+  if (last_digit < 0) {
+    // no physical number was provided.
+    printf("No number in value: %s\n", from_string);
+    return FAIL;
+  }
+  units = number_text + last_digit + 1;
+
+  number = strtod(number_text, &end);
+  if (end != units) {
+    printf("Cannot read the number in value: %s\n", from_string);
+    return FAIL;
+  }
+
+  // For the simple case of a 0.0 value, the number is 0.0 in any
+  // units.  No conversion is performed and the 0.0 value is returned.
+  //FIXME: do not compare floating point number against zero
+  if (number == 0.0) {
+    scaled_number = 0.0;
+    return SUCCESS;
+  }
+
+  // look for the factor in the memo
+  units_length = strlen(units);
+  to_length = strlen(to_string);
+  if (units_length + to_length + 2 <= sizeof(key)) {
+    memcpy(key, units, units_length);
+    key[units_length] = CONVERSION_KEY_SEP;
+    memcpy(key + units_length + 1, to_string, to_length + 1);
+
+    pthread_mutex_lock(&conversion_cache_lock);
+    slot = hashstring(key) & (CONVERSION_CACHE_SIZE-1);
+    while (conversion_cache[slot].key[0]) {
+      if (!strcmp(conversion_cache[slot].key, key)) {
+        status = conversion_cache[slot].status;
+        factor = conversion_cache[slot].factor;
+        cached = TRUE;
+        break;
+      }
+      slot = (slot+1) & (CONVERSION_CACHE_SIZE-1);
+    }
+    pthread_mutex_unlock(&conversion_cache_lock);
+  }
+
+  if (!cached) {
+    status = unitfactor(units, to_string, &factor);
+
+    // remember it, as long as the memo is not getting crowded
+    if (units_length + to_length + 2 <= sizeof(key)) {
+      pthread_mutex_lock(&conversion_cache_lock);
+      if (conversion_cache_count < CONVERSION_CACHE_SIZE*3/4) {
+        slot = hashstring(key) & (CONVERSION_CACHE_SIZE-1);
+        while (conversion_cache[slot].key[0] &&
+               strcmp(conversion_cache[slot].key, key))
+          slot = (slot+1) & (CONVERSION_CACHE_SIZE-1);
+        if (!conversion_cache[slot].key[0]) {
+          strcpy(conversion_cache[slot].key, key);
+          conversion_cache[slot].status = status;
+          conversion_cache[slot].factor = factor;
+          conversion_cache_count++;
         }
-      } else {
-        // An error has occurred during the conversion.
-        status = FAIL;
       }
-    } else {
-      // An error has occurred during the conversion.
-      status = FAIL;
+      pthread_mutex_unlock(&conversion_cache_lock);
     }
-  } else {
-    // An error has occurred during the conversion.
-    //
-    status = FAIL;
+  } else if (status != SUCCESS) {
+    printf("Unknown units: %s\n", units);
   }
 
-  // Deallocate the local memory.
-  delete [] wantstr;
-  delete [] havestr;
-  delete [] local_from_string;
+  if (status != SUCCESS) return (FAIL);
+
+  // Return the result.
+  if (negative_number == FALSE)
+    scaled_number = number*factor;
+  else
+    scaled_number = -1.0*number*factor;
 
-  // Return the status to the calling routine.
-  return (status);
+  return (SUCCESS);
   }
 
 #endif
@@ -0,0 +1,1223 @@
+
+/*
+
+  FACILITY:  NMMTL
+
+  MODULE DESCRIPTION:
+
+  mmtl_check, the program the CTest tests of mmtl_bem run.  Each test
+  copies an example cross section into its own directory, runs mmtl_bem
+  on it in one of its modes and checks what comes out:
+
+  mmtl_check deck mmtl_bem deck.xsctn reference.result
+    B, L and Z0 in the .result agree with those of the reference
+
+  mmtl_check serve mmtl_bem deck.xsctn reference.result
+    "mmtl_bem --serve" answers the deck twice with the same response,
+    in the protocol of nmmtl_serve.cpp and with the B, L and Z0 of the
+    reference, answers a request it cannot read with an error, and one
+    longer than SERVE_MAX_REQUEST with an error that ends the session
+
+  mmtl_check synthesize mmtl_bem deck.xsctn conductor option Z0|Zdiff target
+    "mmtl_bem --synthesize" reaches the target impedance
+
+  mmtl_check monte-carlo mmtl_bem deck.xsctn samples seed object option
+                         normal|uniform spread
+    "mmtl_bem --monte-carlo" solves every sample, and gives the same
+    statistics with one worker as with three
+
+  mmtl_check field-grid mmtl_bem deck.xsctn x0,x1,nx,y0,y1,ny signals
+    "mmtl_bem --field-grid" writes a grid file of the size its format
+    (see nmmtl_field_grid.cpp) gives, with finite values
+
+  mmtl_check refine mmtl_bem deck.xsctn tolerance fine.result
+    automatic mesh refinement to the tolerance converges, to a Z0
+    within CHECK_REFINE_FACTOR times the tolerance of that of a much
+    finer mesh than the deck's
+
+  mmtl_check polygon vertices
+    a microstrip whose conductor is a jittered rectangle traced with
+    that many vertices, built with mmtl_xsctn_add_polygon_conductor and
+    solved in the library: simplified with mmtl_xsctn_set_polygon_tolerance
+    it has fewer boundary elements and a Z0 within CHECK_POLYGON_CHANGE
+    of the unsimplified outline's
+
+  The exit status is 0 if the check passes and 1 if not, with the reason
+  on stdout.
+
+  CREATION DATE:  Sun Oct 18 2026
+
+  */
+
+
+/*
+ *******************************************************************
+ **  INCLUDE FILES
+ *******************************************************************
+ */
+
+#include "nmmtl.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+/*
+ *******************************************************************
+ **  PREPROCESSOR CONSTANTS
+ *******************************************************************
+ */
+
+/* relative difference from the reference that B, L and Z0 may have */
+#define CHECK_TOLERANCE 1.0e-5
+
+/* below this fraction of the largest value of a matrix, a difference is
+   taken relative to that fraction instead (the small mutual terms) */
+#define CHECK_FLOOR 1.0e-3
+
+/* relative difference from the fine mesh that Z0 may have after mesh
+   refinement, as a multiple of the refinement tolerance */
+#define CHECK_REFINE_FACTOR 3.0
+
+/* the polygon check: CSEG, the size of the jitter of the traced outline,
+   the polygon tolerance that removes it, and the relative difference in
+   Z0 that the simplified outline may make */
+#define CHECK_POLYGON_CSEG 200
+#define CHECK_POLYGON_JITTER 0.2e-6
+#define CHECK_POLYGON_TOLERANCE 1.0e-6
+#define CHECK_POLYGON_CHANGE 5.0e-3
+
+/* most values of one quantity, longest name of a cross section, and
+   longest command */
+#define CHECK_MAX_VALUES 1024
+#define CHECK_NAME_SIZE 256
+#define CHECK_COMMAND_SIZE 4096
+
+/*
+ *******************************************************************
+ **  STRUCTURE DECLARATIONS AND TYPE DEFINTIONS
+ *******************************************************************
+ */
+
+/* the values of one quantity, in the order they are written */
+typedef struct check_values
+{
+  const char *name;
+  int number;
+  double values[CHECK_MAX_VALUES];
+} CHECK_VALUES, *CHECK_VALUES_P;
+
+/* B, L and Z0 */
+#define CHECK_QUANTITIES 3
+static const char *check_names[CHECK_QUANTITIES] = { "B", "L", "Z0" };
+
+/*
+ *******************************************************************
+ **  FUNCTION DECLARATIONS
+ *******************************************************************
+ */
+
+static char *check_read_file(const char *path, size_t *length);
+static int check_copy_deck(const char *deck, char *name, size_t size);
+static int check_run(const char *command);
+static int check_result_values(const char *path, CHECK_VALUES *quantities);
+static int check_compare(const char *what, CHECK_VALUES_P got,
+                         CHECK_VALUES_P want);
+static int check_deck(int argc, char **argv);
+static int check_serve(int argc, char **argv);
+static int check_synthesize(int argc, char **argv);
+static int check_monte_carlo(int argc, char **argv);
+static int check_field_grid(int argc, char **argv);
+static int check_refine(int argc, char **argv);
+static int check_polygon_z0(const double *x, const double *y, int vertices,
+                            double tolerance, double *z0);
+static int check_polygon(int argc, char **argv);
+
+/*
+ *******************************************************************
+ **  FUNCTION DEFINITIONS
+ *******************************************************************
+ */
+
+
+int main(int argc, char **argv)
+{
+  int status;
+
+  if(argc == 3 && strcmp(argv[1],"polygon") == 0)
+    return(check_polygon(argc,argv) == SUCCESS ? 0 : 1);
+
+  if(argc < 4)
+  {
+    printf("usage: mmtl_check deck|serve|synthesize|monte-carlo|field-grid|"
+           "refine mmtl_bem deck.xsctn ...\n"
+           "       mmtl_check polygon vertices\n");
+    return 1;
+  }
+
+  if(strcmp(argv[1],"deck") == 0)
+    status = check_deck(argc,argv);
+  else if(strcmp(argv[1],"serve") == 0)
+    status = check_serve(argc,argv);
+  else if(strcmp(argv[1],"synthesize") == 0)
+    status = check_synthesize(argc,argv);
+  else if(strcmp(argv[1],"monte-carlo") == 0)
+    status = check_monte_carlo(argc,argv);
+  else if(strcmp(argv[1],"field-grid") == 0)
+    status = check_field_grid(argc,argv);
+  else if(strcmp(argv[1],"refine") == 0)
+    status = check_refine(argc,argv);
+  else
+  {
+    printf("mmtl_check: unknown check %s\n",argv[1]);
+    status = FAIL;
+  }
+
+  return(status == SUCCESS ? 0 : 1);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_read_file
+
+  FUNCTIONAL DESCRIPTION:
+
+  Reads a whole file into memory, with a NUL after it.
+
+  FORMAL PARAMETERS:
+
+  const char *path  - the file
+  size_t *length    - out: its length
+
+  RETURN VALUE:
+
+  the text, to be freed, or NULL if it cannot be read
+
+  CALLING SEQUENCE:
+
+  text = check_read_file(path,&length);
+
+  */
+
+static char *check_read_file(const char *path, size_t *length)
+{
+  FILE *file;
+  char *text;
+  long size;
+
+  if((file = fopen(path,"rb")) == NULL)
+  {
+    printf("mmtl_check: cannot open %s\n",path);
+    return(NULL);
+  }
+  fseek(file,0,SEEK_END);
+  size = ftell(file);
+  fseek(file,0,SEEK_SET);
+  text = (char *)malloc((size_t)size + 1);
+  *length = fread(text,1,(size_t)size,file);
+  text[*length] = '\0';
+  fclose(file);
+  return(text);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_copy_deck
+
+  FUNCTIONAL DESCRIPTION:
+
+  Copies a cross section into the current directory, where mmtl_bem
+  writes its output files, and gives the name to run it by.
+
+  FORMAL PARAMETERS:
+
+  const char *deck  - path of the .xsctn file
+  char *name        - out: its name, without directory or .xsctn
+  size_t size       - size of name
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_copy_deck(deck,name,sizeof(name));
+
+  */
+
+static int check_copy_deck(const char *deck, char *name, size_t size)
+{
+  const char *base;
+  char filespec[CHECK_COMMAND_SIZE];
+  char *text;
+  size_t length, dot;
+  FILE *file;
+
+  base = strrchr(deck,'/');
+  base = base == NULL ? deck : base + 1;
+  dot = strlen(base);
+  if(dot > 6 && strcmp(base + dot - 6,".xsctn") == 0) dot -= 6;
+  snprintf(name,size,"%.*s",(int)dot,base);
+
+  if((text = check_read_file(deck,&length)) == NULL) return(FAIL);
+  snprintf(filespec,sizeof(filespec),"%s.xsctn",name);
+  if((file = fopen(filespec,"wb")) == NULL)
+  {
+    printf("mmtl_check: cannot write %s\n",filespec);
+    free(text);
+    return(FAIL);
+  }
+  fwrite(text,1,length,file);
+  fclose(file);
+  free(text);
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_run
+
+  FUNCTIONAL DESCRIPTION:
+
+  Runs a command through the shell and says if it failed.
+
+  FORMAL PARAMETERS:
+
+  const char *command - the command
+
+  RETURN VALUE:
+
+  SUCCESS if it exits with status 0, FAIL if not
+
+  CALLING SEQUENCE:
+
+  status = check_run(command);
+
+  */
+
+static int check_run(const char *command)
+{
+  int status = system(command);
+
+  if(status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    printf("mmtl_check: %s failed\n",command);
+    return(FAIL);
+  }
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_result_values
+
+  FUNCTIONAL DESCRIPTION:
+
+  Reads B, L and Z0 from a .result file: the values of the "Mutual and
+  Self Electrostatic Induction:", "Mutual and Self Inductance:" and
+  "Characteristic Impedance (Ohms):" blocks, each ending at a blank
+  line.
+
+  FORMAL PARAMETERS:
+
+  const char *path          - the .result file
+  CHECK_VALUES *quantities  - out: B, L and Z0
+
+  RETURN VALUE:
+
+  SUCCESS, or FAIL if the file cannot be read or a block is missing
+
+  CALLING SEQUENCE:
+
+  status = check_result_values(path,quantities);
+
+  */
+
+static int check_result_values(const char *path, CHECK_VALUES *quantities)
+{
+  static const char *headers[CHECK_QUANTITIES] = {
+    "Mutual and Self Electrostatic Induction:",
+    "Mutual and Self Inductance:",
+    "Characteristic Impedance (Ohms):"
+  };
+  char *text, *line, *next, *equals;
+  size_t length;
+  int q, block = -1;
+
+  if((text = check_read_file(path,&length)) == NULL) return(FAIL);
+
+  for(q = 0; q < CHECK_QUANTITIES; q++)
+  {
+    quantities[q].name = check_names[q];
+    quantities[q].number = 0;
+  }
+
+  for(line = text; *line != '\0'; line = next)
+  {
+    next = strchr(line,'\n');
+    if(next == NULL) next = line + strlen(line);
+    else *next++ = '\0';
+
+    if(*line == '\0')
+    {
+      block = -1;
+      continue;
+    }
+    for(q = 0; q < CHECK_QUANTITIES; q++)
+      if(strcmp(line,headers[q]) == 0) block = q;
+    if(block < 0 || (equals = strrchr(line,'=')) == NULL) continue;
+    if(quantities[block].number == CHECK_MAX_VALUES) continue;
+    quantities[block].values[quantities[block].number++] =
+      strtod(equals + 1,NULL);
+  }
+  free(text);
+
+  for(q = 0; q < CHECK_QUANTITIES; q++)
+    if(quantities[q].number == 0)
+    {
+      printf("mmtl_check: no %s in %s\n",check_names[q],path);
+      return(FAIL);
+    }
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_compare
+
+  FUNCTIONAL DESCRIPTION:
+
+  Compares the values of a quantity with the reference, to within
+  CHECK_TOLERANCE of each value, or of CHECK_FLOOR of the largest one
+  if that is more.  Where the reference is not a number (the impedances
+  of example-microstrip-2TMP, whose B and L are far from symmetric),
+  the value must not be one either.
+
+  FORMAL PARAMETERS:
+
+  const char *what     - where the values come from, for the messages
+  CHECK_VALUES_P got   - the values
+  CHECK_VALUES_P want  - the reference
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_compare(what,&got,&want);
+
+  */
+
+static int check_compare(const char *what, CHECK_VALUES_P got,
+                         CHECK_VALUES_P want)
+{
+  double largest = 0.0, scale;
+  int i, status = SUCCESS;
+
+  if(got->number != want->number)
+  {
+    printf("%s: %d values of %s, the reference has %d\n",what,got->number,
+           got->name,want->number);
+    return(FAIL);
+  }
+
+  for(i = 0; i < want->number; i++)
+    if(fabs(want->values[i]) > largest) largest = fabs(want->values[i]);
+
+  for(i = 0; i < want->number; i++)
+  {
+    if(isnan(want->values[i]) && isnan(got->values[i])) continue;
+    scale = fabs(want->values[i]);
+    if(scale < CHECK_FLOOR * largest) scale = CHECK_FLOOR * largest;
+    if(!(fabs(got->values[i] - want->values[i]) <= CHECK_TOLERANCE * scale))
+    {
+      printf("%s: %s value %d is %.8e, the reference %.8e\n",what,
+             got->name,i + 1,got->values[i],want->values[i]);
+      status = FAIL;
+    }
+  }
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_deck
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check deck mmtl_bem deck.xsctn reference.result
+
+  Solves the deck and compares B, L and Z0 with the reference.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_deck(argc,argv);
+
+  */
+
+static int check_deck(int argc, char **argv)
+{
+  CHECK_VALUES got[CHECK_QUANTITIES], want[CHECK_QUANTITIES];
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE];
+  char filespec[CHECK_NAME_SIZE + 8];
+  int q, status = SUCCESS;
+
+  if(argc != 5)
+  {
+    printf("usage: mmtl_check deck mmtl_bem deck.xsctn reference.result\n");
+    return(FAIL);
+  }
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+  snprintf(command,sizeof(command),"'%s' '%s' > '%s.stdout'",argv[2],name,
+           name);
+  if(check_run(command) != SUCCESS) return(FAIL);
+
+  snprintf(filespec,sizeof(filespec),"%s.result",name);
+  if(check_result_values(filespec,got) != SUCCESS ||
+     check_result_values(argv[4],want) != SUCCESS)
+    return(FAIL);
+
+  for(q = 0; q < CHECK_QUANTITIES; q++)
+    if(check_compare(filespec,&got[q],&want[q]) != SUCCESS)
+      status = FAIL;
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_serve
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check serve mmtl_bem deck.xsctn reference.result
+
+  Sends "mmtl_bem --serve" the deck twice, then a request it cannot
+  read, then one longer than SERVE_MAX_REQUEST and then the deck again,
+  on stdin.  The first two responses must be the same, with each of the
+  lines of nmmtl_serve.cpp holding the number of values it should, and
+  B, L and Z0 as in the reference.  The third must be an error, the
+  fourth "error request too large", and the last request must not be
+  answered.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_serve(argc,argv);
+
+  */
+
+static int check_serve(int argc, char **argv)
+{
+  /* the lines every response has, and how many values, n being the
+     number of signals: 1 for n, 2 for n*n */
+  static const struct {
+    const char *label;
+    int square;
+  } lines[] = {
+    { "names", 1 }, { "B", 2 }, { "L", 2 }, { "Rdc", 2 }, { "Z0", 1 },
+    { "v", 1 }, { "er", 1 }, { "fxt", 2 }, { "bxt", 2 }
+  };
+  CHECK_VALUES got[CHECK_QUANTITIES], want[CHECK_QUANTITIES];
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE];
+  char *deck, *text, *responses[4], *line, *next, *word;
+  size_t length, deck_length, written;
+  int count, n = 0, number, found, q, ll, status = SUCCESS;
+  FILE *request;
+
+  if(argc != 5)
+  {
+    printf("usage: mmtl_check serve mmtl_bem deck.xsctn reference.result\n");
+    return(FAIL);
+  }
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+  if((deck = check_read_file(argv[3],&deck_length)) == NULL) return(FAIL);
+  if((request = fopen("request","w")) == NULL)
+  {
+    printf("mmtl_check: cannot write request\n");
+    free(deck);
+    return(FAIL);
+  }
+  fprintf(request,"%s\n.\n%s\n.\nnot a cross section\n.\n",deck,deck);
+  for(written = 0; written <= SERVE_MAX_REQUEST; written += 64)
+    fprintf(request,"%-63s\n","# padding");
+  fprintf(request,".\n%s\n.\n",deck);
+  fclose(request);
+  free(deck);
+
+  snprintf(command,sizeof(command),
+           "'%s' --serve --workers 2 < request > response 2> serve.log",
+           argv[2]);
+  if(check_run(command) != SUCCESS) return(FAIL);
+  if((text = check_read_file("response",&length)) == NULL) return(FAIL);
+
+  /* split the responses at their period lines */
+  count = 0;
+  word = text;
+  for(line = text; *line != '\0' && count < 4; line = next)
+  {
+    next = strchr(line,'\n');
+    next = next == NULL ? line + strlen(line) : next + 1;
+    if(line[0] == '.' && (line[1] == '\n' || line[1] == '\0'))
+    {
+      *line = '\0';
+      responses[count++] = word;
+      word = next;
+    }
+  }
+  if(count != 4 || *word != '\0')
+  {
+    printf("mmtl_check serve: %d responses, not 4, before the session "
+           "ended\n",count + (*word != '\0'));
+    free(text);
+    return(FAIL);
+  }
+
+  if(strcmp(responses[0],responses[1]) != 0)
+  {
+    printf("mmtl_check serve: the same request got different responses\n");
+    status = FAIL;
+  }
+  if(strncmp(responses[2],"error ",6) != 0)
+  {
+    printf("mmtl_check serve: a bad request got no error\n");
+    status = FAIL;
+  }
+  if(strcmp(responses[3],"error request too large\n") != 0)
+  {
+    printf("mmtl_check serve: a request too large got no error\n");
+    status = FAIL;
+  }
+  if(sscanf(responses[0],"ok %d",&n) != 1 || n < 1)
+  {
+    printf("mmtl_check serve: the response does not start with ok n\n");
+    free(text);
+    return(FAIL);
+  }
+
+  for(q = 0; q < CHECK_QUANTITIES; q++)
+  {
+    got[q].name = check_names[q];
+    got[q].number = 0;
+  }
+
+  for(ll = 0; ll < (int)(sizeof(lines) / sizeof(lines[0])); ll++)
+  {
+    found = FALSE;
+    for(line = responses[0]; *line != '\0'; line = next + 1)
+    {
+      next = strchr(line,'\n');
+      if(next == NULL) break;
+      length = strlen(lines[ll].label);
+      if(strncmp(line,lines[ll].label,length) != 0 || line[length] != ' ')
+        continue;
+
+      found = TRUE;
+      q = -1;
+      if(strcmp(lines[ll].label,"B") == 0) q = 0;
+      if(strcmp(lines[ll].label,"L") == 0) q = 1;
+      if(strcmp(lines[ll].label,"Z0") == 0) q = 2;
+      number = 0;
+      for(word = line + length; word < next; )
+      {
+        while(word < next && *word == ' ') word++;
+        if(word == next) break;
+        if(q >= 0 && number < CHECK_MAX_VALUES)
+          got[q].values[number] = strtod(word,NULL);
+        number++;
+        while(word < next && *word != ' ') word++;
+      }
+      if(q >= 0) got[q].number = number < CHECK_MAX_VALUES ? number :
+                   CHECK_MAX_VALUES;
+      if(number != (lines[ll].square == 2 ? n * n : n))
+      {
+        printf("mmtl_check serve: %s has %d values for %d signals\n",
+               lines[ll].label,number,n);
+        status = FAIL;
+      }
+      break;
+    }
+    if(!found)
+    {
+      printf("mmtl_check serve: no %s in the response\n",lines[ll].label);
+      status = FAIL;
+    }
+  }
+  free(text);
+
+  if(check_result_values(argv[4],want) != SUCCESS) return(FAIL);
+  for(q = 0; q < CHECK_QUANTITIES; q++)
+    if(check_compare("mmtl_check serve",&got[q],&want[q]) != SUCCESS)
+      status = FAIL;
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_synthesize
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check synthesize mmtl_bem deck.xsctn conductor option Z0|Zdiff target
+
+  Runs the synthesis and checks that it ends with the impedance within
+  SYNTHESIS_TOLERANCE of the target, in no more than
+  SYNTHESIS_MAX_SOLVES solves.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_synthesize(argc,argv);
+
+  */
+
+static int check_synthesize(int argc, char **argv)
+{
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE], kind[16];
+  char *text, *last, *gives;
+  size_t length;
+  double target, impedance, dimension;
+  int solves;
+
+  if(argc != 8)
+  {
+    printf("usage: mmtl_check synthesize mmtl_bem deck.xsctn conductor "
+           "option Z0|Zdiff target\n");
+    return(FAIL);
+  }
+  target = atof(argv[7]);
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+  snprintf(command,sizeof(command),
+           "'%s' --synthesize '%s' '%s' '%s' '%s' '%s' > synthesis",
+           argv[2],name,argv[4],argv[5],argv[6],argv[7]);
+  if(check_run(command) != SUCCESS) return(FAIL);
+  if((text = check_read_file("synthesis",&length)) == NULL) return(FAIL);
+
+  /* the last line: "Synthesis: c -option = x meters gives Z0 = z Ohms
+     in s solves" */
+  last = NULL;
+  for(gives = strstr(text,"\nSynthesis: "); gives != NULL;
+      gives = strstr(gives + 1,"\nSynthesis: "))
+    last = gives + 1;
+  gives = last == NULL ? NULL : strstr(last," meters gives ");
+  if(gives == NULL ||
+     sscanf(gives," meters gives %15s = %lf Ohms in %d solves",kind,
+            &impedance,&solves) != 3 ||
+     sscanf(strchr(last,'=') + 1,"%lf",&dimension) != 1)
+  {
+    printf("mmtl_check synthesize: no result in the output\n");
+    free(text);
+    return(FAIL);
+  }
+  free(text);
+
+  printf("%s %s = %g meters gives %s = %g Ohms in %d solves\n",argv[4],
+         argv[5],dimension,kind,impedance,solves);
+  if(strcmp(kind,argv[6]) != 0 || !(dimension > 0.0) ||
+     !(fabs(impedance - target) <= SYNTHESIS_TOLERANCE * target) ||
+     solves > SYNTHESIS_MAX_SOLVES)
+  {
+    printf("mmtl_check synthesize: did not reach %s = %g Ohms\n",argv[6],
+           target);
+    return(FAIL);
+  }
+  return(SUCCESS);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_monte_carlo
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check monte-carlo mmtl_bem deck.xsctn samples seed object option
+                         normal|uniform spread
+
+  Runs the samples with one worker and again with three.  Every sample
+  must be solved, and as the values of a sample depend only on the seed,
+  the statistics and histograms must be the same.  A run with the next
+  seed must give different ones.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_monte_carlo(argc,argv);
+
+  */
+
+static int check_monte_carlo(int argc, char **argv)
+{
+  static const char *runs[3] = { "one", "three", "next" };
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE], solved[64];
+  char *text[3], *statistics[3];
+  size_t length;
+  unsigned long seed;
+  int r, status = SUCCESS;
+
+  if(argc != 10)
+  {
+    printf("usage: mmtl_check monte-carlo mmtl_bem deck.xsctn samples seed "
+           "object option normal|uniform spread\n");
+    return(FAIL);
+  }
+  seed = strtoul(argv[5],NULL,10);
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+
+  snprintf(solved,sizeof(solved),"\nMonte Carlo: %d samples solved, 0 failed",
+           atoi(argv[4]));
+  for(r = 0; r < 3; r++)
+  {
+    snprintf(command,sizeof(command),
+             "'%s' --monte-carlo '%s' '%s' %lu --workers %d "
+             "'%s' '%s' '%s' '%s' > '%s' 2> '%s.log'",
+             argv[2],name,argv[4],r == 2 ? seed + 1 : seed,r == 0 ? 1 : 3,
+             argv[6],argv[7],argv[8],argv[9],runs[r],runs[r]);
+    text[r] = NULL;
+    statistics[r] = NULL;
+    if(check_run(command) != SUCCESS ||
+       (text[r] = check_read_file(runs[r],&length)) == NULL)
+    {
+      status = FAIL;
+      continue;
+    }
+    if((statistics[r] = strstr(text[r],solved)) == NULL)
+    {
+      printf("mmtl_check monte-carlo: %s workers did not solve every "
+             "sample\n",runs[r]);
+      status = FAIL;
+    }
+  }
+
+  if(status == SUCCESS && strcmp(statistics[0],statistics[1]) != 0)
+  {
+    printf("mmtl_check monte-carlo: one and three workers differ\n");
+    status = FAIL;
+  }
+  if(status == SUCCESS && strcmp(statistics[0],statistics[2]) == 0)
+  {
+    printf("mmtl_check monte-carlo: seeds %lu and %lu give the same "
+           "samples\n",seed,seed + 1);
+    status = FAIL;
+  }
+  for(r = 0; r < 3; r++) free(text[r]);
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_field_grid
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check field-grid mmtl_bem deck.xsctn x0,x1,nx,y0,y1,ny signals
+
+  Solves the deck with --field-grid and reads the .result_field_grid
+  back: a FGRD record with the grid, then a FELD record with the
+  potential and field at nx by ny points for each of the signals, and
+  nothing more.  Every value must be finite.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_field_grid(argc,argv);
+
+  */
+
+static int check_field_grid(int argc, char **argv)
+{
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE];
+  char filespec[CHECK_NAME_SIZE + 20];
+  char *text;
+  size_t length, position, expected, p;
+  uint64_t count;
+  double x0, x1, y0, y1;
+  int nx, ny, header[4], signals, fields = 0, status = SUCCESS;
+  float value;
+
+  if(argc != 6 ||
+     sscanf(argv[4],"%lf,%lf,%d,%lf,%lf,%d",&x0,&x1,&nx,&y0,&y1,&ny) != 6)
+  {
+    printf("usage: mmtl_check field-grid mmtl_bem deck.xsctn "
+           "x0,x1,nx,y0,y1,ny signals\n");
+    return(FAIL);
+  }
+  signals = atoi(argv[5]);
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+  snprintf(command,sizeof(command),
+           "'%s' '%s' --field-grid '%s' > '%s.stdout'",argv[2],name,
+           argv[4],name);
+  if(check_run(command) != SUCCESS) return(FAIL);
+
+  snprintf(filespec,sizeof(filespec),"%s.result_field_grid",name);
+  if((text = check_read_file(filespec,&length)) == NULL) return(FAIL);
+
+  expected = 12 + 4 * sizeof(int) + 4 * sizeof(double) +
+    (size_t)signals * (12 + SIZE_SIG_NAME +
+                       3 * sizeof(float) * (size_t)nx * (size_t)ny);
+  if(length != expected)
+  {
+    printf("mmtl_check field-grid: %s is %lu bytes, not %lu\n",filespec,
+           (unsigned long)length,(unsigned long)expected);
+    free(text);
+    return(FAIL);
+  }
+
+  /* the grid */
+  memcpy(&count,text + 4,sizeof(count));
+  memcpy(header,text + 12,sizeof(header));
+  if(memcmp(text,"FGRD",4) != 0 ||
+     count != 4 * sizeof(int) + 4 * sizeof(double) ||
+     header[0] != 1 || header[1] != 0x01020304 ||
+     header[2] != nx || header[3] != ny)
+  {
+    printf("mmtl_check field-grid: bad FGRD record\n");
+    free(text);
+    return(FAIL);
+  }
+  position = 12 + (size_t)count;
+
+  /* a field for each signal */
+  while(position < length && status == SUCCESS)
+  {
+    memcpy(&count,text + position + 4,sizeof(count));
+    if(memcmp(text + position,"FELD",4) != 0 ||
+       count != SIZE_SIG_NAME + 3 * sizeof(float) * (size_t)nx * (size_t)ny)
+    {
+      printf("mmtl_check field-grid: bad FELD record %d\n",fields + 1);
+      status = FAIL;
+      break;
+    }
+    for(p = position + 12 + SIZE_SIG_NAME; p < position + 12 + count;
+        p += sizeof(float))
+    {
+      memcpy(&value,text + p,sizeof(value));
+      if(!isfinite(value))
+      {
+        printf("mmtl_check field-grid: FELD record %d is not finite\n",
+               fields + 1);
+        status = FAIL;
+        break;
+      }
+    }
+    position += 12 + (size_t)count;
+    fields++;
+  }
+  free(text);
+
+  if(status == SUCCESS && fields != signals)
+  {
+    printf("mmtl_check field-grid: %d fields for %d signals\n",fields,
+           signals);
+    status = FAIL;
+  }
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_refine
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check refine mmtl_bem deck.xsctn tolerance fine.result
+
+  Solves the deck with NMMTL_REFINE set to the tolerance.  The
+  refinement must say it converged, and each Z0 must be within
+  CHECK_REFINE_FACTOR times the tolerance of that of the fine mesh.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_refine(argc,argv);
+
+  */
+
+static int check_refine(int argc, char **argv)
+{
+  CHECK_VALUES got[CHECK_QUANTITIES], want[CHECK_QUANTITIES];
+  char name[CHECK_NAME_SIZE], command[CHECK_COMMAND_SIZE];
+  char filespec[CHECK_NAME_SIZE + 8];
+  char *text;
+  size_t length;
+  double tolerance, difference;
+  int i, status = SUCCESS;
+
+  if(argc != 6 || (tolerance = atof(argv[4])) <= 0.0)
+  {
+    printf("usage: mmtl_check refine mmtl_bem deck.xsctn tolerance "
+           "fine.result\n");
+    return(FAIL);
+  }
+
+  if(check_copy_deck(argv[3],name,sizeof(name)) != SUCCESS) return(FAIL);
+  snprintf(command,sizeof(command),"%s='%s' '%s' '%s' > '%s.stdout'",
+           REFINE_VARIABLE,argv[4],argv[2],name,name);
+  if(check_run(command) != SUCCESS) return(FAIL);
+
+  snprintf(filespec,sizeof(filespec),"%s.stdout",name);
+  if((text = check_read_file(filespec,&length)) == NULL) return(FAIL);
+  if(strstr(text,"Mesh refinement converged") == NULL)
+  {
+    printf("%s: the mesh refinement did not converge\n",filespec);
+    status = FAIL;
+  }
+  free(text);
+
+  snprintf(filespec,sizeof(filespec),"%s.result",name);
+  if(check_result_values(filespec,got) != SUCCESS ||
+     check_result_values(argv[5],want) != SUCCESS)
+    return(FAIL);
+  if(got[2].number != want[2].number)
+  {
+    printf("%s: %d values of Z0, the fine mesh has %d\n",filespec,
+           got[2].number,want[2].number);
+    return(FAIL);
+  }
+
+  for(i = 0; i < want[2].number; i++)
+  {
+    difference = fabs(got[2].values[i] - want[2].values[i]) /
+      fabs(want[2].values[i]);
+    if(!(difference <= CHECK_REFINE_FACTOR * tolerance))
+    {
+      printf("%s: Z0 %d is %.6g, %.3g%% from the fine mesh's %.6g\n",
+             filespec,i + 1,got[2].values[i],difference * 100.0,
+             want[2].values[i]);
+      status = FAIL;
+    }
+  }
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_polygon_z0
+
+  FUNCTIONAL DESCRIPTION:
+
+  Solves, through the library, a microstrip whose conductor is the
+  outline given, simplified to the tolerance if it is not 0.
+
+  FORMAL PARAMETERS:
+
+  const double *x, *y   - the outline, meters
+  int vertices          - its number of vertices
+  double tolerance      - polygon tolerance, meters
+  double *z0            - out: the Z0 of the line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_polygon_z0(x,y,vertices,tolerance,&z0);
+
+  */
+
+static int check_polygon_z0(const double *x, const double *y, int vertices,
+                            double tolerance, double *z0)
+{
+  MMTL_XSCTN_P xsctn;
+  MMTL_RESULTS_P results;
+  int status = FAIL;
+
+  if((xsctn = mmtl_xsctn_create()) == NULL) return(FAIL);
+  mmtl_xsctn_set_segments(xsctn,CHECK_POLYGON_CSEG,40);
+  mmtl_xsctn_set_polygon_tolerance(xsctn,tolerance);
+  if(mmtl_xsctn_add_ground_plane(xsctn) == SUCCESS &&
+     mmtl_xsctn_add_dielectric_layer(xsctn,100e-6,4.3,0.0) == SUCCESS &&
+     mmtl_xsctn_add_polygon_conductor(xsctn,"trace",vertices,x,y,0.0) ==
+     SUCCESS &&
+     mmtl_xsctn_solve(xsctn,&results) == MMTL_SUCCESS)
+  {
+    *z0 = results->characteristic_impedance[0];
+    mmtl_results_free(results);
+    status = SUCCESS;
+  }
+  else
+    printf("the polygon with tolerance %g cannot be solved\n",tolerance);
+
+  mmtl_xsctn_free(xsctn);
+  return(status);
+}
+
+
+/*
+
+  FUNCTION NAME:  check_polygon
+
+  FUNCTIONAL DESCRIPTION:
+
+  mmtl_check polygon vertices
+
+  Traces a 200 by 35 micron rectangle with that many vertices, those of
+  the sides and the top moved in by up to CHECK_POLYGON_JITTER, as an
+  etched outline would be; the bottom lies flat on the dielectric.  Simplifying it with a polygon tolerance of
+  CHECK_POLYGON_TOLERANCE must leave fewer boundary elements and change
+  Z0 by no more than CHECK_POLYGON_CHANGE.
+
+  FORMAL PARAMETERS:
+
+  int argc, char **argv - the command line
+
+  RETURN VALUE:
+
+  SUCCESS or FAIL
+
+  CALLING SEQUENCE:
+
+  status = check_polygon(argc,argv);
+
+  */
+
+static int check_polygon(int argc, char **argv)
+{
+  static const double corner[5][2] = {
+    { 0.0, 0.0 }, { 0.0, 35e-6 }, { 200e-6, 35e-6 }, { 200e-6, 0.0 },
+    { 0.0, 0.0 } };
+  double *x, *y, *points;
+  unsigned char *keep;
+  double t, jitter, length, z0, simplified_z0, difference;
+  int vertices, per_side, side, i, n, status = SUCCESS;
+  int sides, elements, kept_sides, kept_elements;
+
+  if(argc != 3 || (vertices = atoi(argv[2])) < 8)
+  {
+    printf("usage: mmtl_check polygon vertices (at least 8)\n");
+    return(FAIL);
+  }
+
+  /* trace the rectangle clockwise, with a deterministic jitter into it
+     normal to each side but the bottom; the corners stay where they are
+     and so remain its outermost points */
+  per_side = vertices / 4;
+  vertices = 4 * per_side;
+  x = (double *)malloc(sizeof(double) * (size_t)vertices);
+  y = (double *)malloc(sizeof(double) * (size_t)vertices);
+  points = (double *)malloc(sizeof(double) * 2 * (size_t)vertices);
+  keep = (unsigned char *)malloc((size_t)vertices);
+  for(n = 0, side = 0; side < 4; side++)
+  {
+    length = sqrt((corner[side+1][0] - corner[side][0]) *
+                  (corner[side+1][0] - corner[side][0]) +
+                  (corner[side+1][1] - corner[side][1]) *
+                  (corner[side+1][1] - corner[side][1]));
+    for(i = 0; i < per_side; i++, n++)
+    {
+      t = (double)i / per_side;
+      jitter = i == 0 || side == 3 ? 0.0 :
+        0.5 * CHECK_POLYGON_JITTER * (1.0 + sin(7.3 * n));
+      x[n] = corner[side][0] + t * (corner[side+1][0] - corner[side][0]) +
+        jitter * (corner[side+1][1] - corner[side][1]) / length;
+      y[n] = corner[side][1] + t * (corner[side+1][1] - corner[side][1]) -
+        jitter * (corner[side+1][0] - corner[side][0]) / length;
+      points[2*n] = x[n];
+      points[2*n+1] = y[n];
+    }
+  }
+
+  /* the boundary elements of the outline, as the solver breaks it up */
+  nmmtl_simplify_polygon(points,vertices,CHECK_POLYGON_TOLERANCE,keep);
+  if(nmmtl_xsctn_outline_elements(points,vertices,NULL,CHECK_POLYGON_CSEG,&sides,
+                                  &elements) != SUCCESS ||
+     nmmtl_xsctn_outline_elements(points,vertices,keep,CHECK_POLYGON_CSEG,
+                                  &kept_sides,&kept_elements) != SUCCESS)
+  {
+    printf("the outline cannot be broken into segments\n");
+    status = FAIL;
+  }
+  else if(kept_elements >= elements)
+  {
+    printf("simplified, the outline has %d elements, unsimplified %d\n",
+           kept_elements,elements);
+    status = FAIL;
+  }
+
+  if(status == SUCCESS &&
+     check_polygon_z0(x,y,vertices,0.0,&z0) == SUCCESS &&
+     check_polygon_z0(x,y,vertices,CHECK_POLYGON_TOLERANCE,
+                      &simplified_z0) == SUCCESS)
+  {
+    difference = fabs(simplified_z0 - z0) / z0;
+    printf("%d sides and %d elements: Z0 %.6g, %d sides and %d elements: "
+           "Z0 %.6g\n",sides,elements,z0,kept_sides,kept_elements,
+           simplified_z0);
+    if(!(difference <= CHECK_POLYGON_CHANGE))
+    {
+      printf("the simplified Z0 is %.3g%% from the unsimplified\n",
+             difference * 100.0);
+      status = FAIL;
+    }
+  }
+  else
+    status = FAIL;
+
+  free(x);
+  free(y);
+  free(points);
+  free(keep);
+  return(status);
+}